@@ -0,0 +1,60 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef WARFARE_TRACK_ALLOCATIONS
+
+// Number of calls to the global operator new, relaxed because it is only read for reporting
+static std::atomic<std::size_t> allocationCount(0);
+
+// Shared by every form of operator new, counts the call and gets the memory from malloc
+static void* countedAllocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(std::size_t size) { return countedAllocate(size); }
+void* operator new[](std::size_t size) { return countedAllocate(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAllocate(size); }
+    catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAllocate(size); }
+    catch (...) { return nullptr; }
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+bool isAllocationTrackingEnabled() {
+    return true;
+}
+
+std::size_t getAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool isAllocationTrackingEnabled() {
+    return false;
+}
+
+std::size_t getAllocationCount() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Logger.h"
+
+#include <SFML/System/Clock.hpp>
+#include <cstddef>
+
+// Debug tool for finding heap allocations in the frame loop
+// When the game is built with WARFARE_TRACK_ALLOCATIONS (the CMake option of the same name), AllocationTracker.cpp replaces the global
+// operator new and counts every call, otherwise the count is always 0 and the monitor does nothing
+
+// Returns true if allocations are being counted in this build
+bool isAllocationTrackingEnabled();
+
+// Returns the number of heap allocations made since the program started
+std::size_t getAllocationCount();
+
+// Watches the allocation count each frame while a level is running and reports any frames that allocated
+// The first few frames of a level are skipped as warm up, because containers and caches grow to their working size then.
+// After that a running level shouldn't allocate at all, so any allocation is reported as an error rather than as information
+class AllocationMonitor {
+public:
+    // Constructor with the number of warm up frames to skip and how often to print a report in seconds
+    AllocationMonitor(int warmUpFrames = 120, float reportInterval = 5.f)
+        : warmUpFrames(warmUpFrames), reportInterval(reportInterval) {
+    }
+
+    // Method to call at the start of every frame
+    void beginFrame() {
+        frameStartCount = getAllocationCount();
+    }
+
+    // Method to call at the end of every frame, with whether a level was running during it
+    void endFrame(bool levelRunning) {
+        if (!isAllocationTrackingEnabled()) {
+            return;
+        }
+        if (!levelRunning) {
+            levelFrames = 0;  // Leaving the level starts the warm up again next time
+            return;
+        }
+        if (++levelFrames <= warmUpFrames) {
+            return;
+        }
+
+        std::size_t allocations = getAllocationCount() - frameStartCount;
+        ++steadyFrames;
+        if (allocations > 0) {
+            ++framesWithAllocations;
+            totalAllocations += allocations;
+            if (allocations > worstFrame) {
+                worstFrame = allocations;
+            }
+        }
+
+        if (reportClock.getElapsedTime().asSeconds() >= reportInterval) {
+            if (framesWithAllocations > 0) {
+                LOG_ERROR("[allocations] {} gameplay frames, {} allocated when none should, {} allocations in total, worst frame {}",
+                    steadyFrames, framesWithAllocations, totalAllocations, worstFrame);
+            }
+            else {
+                LOG_INFO("[allocations] {} gameplay frames, none allocated", steadyFrames);
+            }
+            steadyFrames = 0;
+            framesWithAllocations = 0;
+            totalAllocations = 0;
+            worstFrame = 0;
+            reportClock.restart();
+        }
+    }
+
+private:
+    int warmUpFrames;
+    float reportInterval;
+    int levelFrames = 0;
+    std::size_t frameStartCount = 0;
+    std::size_t steadyFrames = 0;
+    std::size_t framesWithAllocations = 0;
+    std::size_t totalAllocations = 0;
+    std::size_t worstFrame = 0;
+    sf::Clock reportClock;
+};
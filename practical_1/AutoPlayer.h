@@ -0,0 +1,140 @@
+#pragma once
+
+#include "PlayerInput.h"
+#include "SeededRandom.h"
+#include "WorldSnapshot.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cmath>
+#include <cstdint>
+
+// Scripted stand-in for the keyboard, so the levels can be played for hours by themselves for soak and performance runs.
+// It only looks at what the renderer gets (a WorldSnapshot) and only answers with a PlayerInput, so the level is updated through
+// exactly the same path as when someone is playing: Player::updateMovement and Player::updateShooting with the input it returns.
+// Every tick it holds fire and picks the one direction whose next fraction of a second looks best: close to a spot a little way
+// to the left of the nearest enemy, level with it so the shots hit, and as far from the enemy bullets as it can get.
+// The player keeps flying the way it was last pushed, so one direction is always held. If the terrain stops the player
+// the direction it was stuck going is avoided for a second. The seed picks how it weaves up and down, so runs can be repeated
+class AutoPlayer {
+public:
+    explicit AutoPlayer(std::uint32_t seed = 1)
+        : random(seed) {
+        reset();
+    }
+
+    // Method to forget the last level, called when a new one starts
+    void reset() {
+        lastPosition = sf::Vector2f(-1.f, -1.f);
+        lastDirection = 0;
+        stuckTime = 0.f;
+        blockedDirection = -1;
+        blockedTime = 0.f;
+        weaveTime = 0.f;
+        weaveOffset = 0.f;
+    }
+
+    // Method to decide the controls for one tick from the newest snapshot of the level
+    PlayerInput decide(const WorldSnapshot& view, const sf::FloatRect& worldBounds, float playerSpeed, float deltaTime) {
+        const sf::Vector2f size = view.player.size;
+        const sf::Vector2f position = view.player.position;
+
+        // Notice when the terrain has stopped the player, and keep away from that direction for a while
+        if (lastPosition.x >= 0.f && std::abs(position.x - lastPosition.x) + std::abs(position.y - lastPosition.y) < playerSpeed * deltaTime * 0.25f) {
+            stuckTime += deltaTime;
+            if (stuckTime > 0.25f) {
+                blockedDirection = lastDirection;
+                blockedTime = 1.f;
+                stuckTime = 0.f;
+            }
+        }
+        else {
+            stuckTime = 0.f;
+        }
+        lastPosition = position;
+        blockedTime -= deltaTime;
+
+        // Weave up and down a little around the line of the target, changing every couple of seconds
+        weaveTime -= deltaTime;
+        if (weaveTime <= 0.f) {
+            weaveTime = 1.5f + static_cast<float>(random.next() % 1000) / 1000.f;
+            weaveOffset = static_cast<float>(static_cast<int>(random.next() % 301) - 150);
+        }
+
+        // Head for a spot in front of the nearest enemy, or the middle of the world when there are none left
+        sf::Vector2f goal(worldBounds.left + worldBounds.width / 2.f, worldBounds.top + worldBounds.height / 2.f);
+        float nearest = -1.f;
+        for (const SnapshotRect& enemy : view.enemies) {
+            sf::Vector2f offset = enemy.position - position;
+            float distance = offset.x * offset.x + offset.y * offset.y;
+            if (nearest < 0.f || distance < nearest) {
+                nearest = distance;
+                goal = sf::Vector2f(enemy.position.x - standOff, enemy.position.y + enemy.size.y / 2.f - size.y / 2.f + weaveOffset);
+            }
+        }
+        goal.x = std::max(worldBounds.left, std::min(goal.x, worldBounds.left + worldBounds.width - size.x));
+        goal.y = std::max(worldBounds.top, std::min(goal.y, worldBounds.top + worldBounds.height - size.y));
+
+        // Score each direction by where it would take the player in the look ahead time, lower is better
+        static const float directionX[4] = { 0.f, 0.f, -1.f, 1.f };
+        static const float directionY[4] = { -1.f, 1.f, 0.f, 0.f };
+        const float step = playerSpeed * lookAhead;
+        int best = lastDirection;
+        float bestScore = 0.f;
+        for (int direction = 0; direction < 4; ++direction) {
+            sf::Vector2f candidate(position.x + directionX[direction] * step, position.y + directionY[direction] * step);
+            candidate.x = std::max(worldBounds.left, std::min(candidate.x, worldBounds.left + worldBounds.width - size.x));
+            candidate.y = std::max(worldBounds.top, std::min(candidate.y, worldBounds.top + worldBounds.height - size.y));
+
+            sf::Vector2f toGoal = goal - candidate;
+            float score = std::sqrt(toGoal.x * toGoal.x + toGoal.y * toGoal.y) + dangerWeight * getDanger(view, candidate + size / 2.f);
+            if (direction == blockedDirection && blockedTime > 0.f) {
+                score += blockedPenalty;
+            }
+            if (direction == 0 || score < bestScore) {
+                best = direction;
+                bestScore = score;
+            }
+        }
+        lastDirection = best;
+
+        PlayerInput input;
+        input.up = best == 0;
+        input.down = best == 1;
+        input.left = best == 2;
+        input.right = best == 3;
+        input.fire = true;
+        return input;
+    }
+
+private:
+    static constexpr float standOff = 450.f;       // How far to the left of its target the bot tries to stay
+    static constexpr float lookAhead = 0.15f;      // Seconds ahead each direction is judged at
+    static constexpr float dangerRadius = 140.f;   // Enemy bullets further than this from the player's middle are ignored
+    static constexpr float dangerWeight = 400.f;   // How many pixels of detour one bullet right on top of the player is worth
+    static constexpr float blockedPenalty = 10000.f;
+
+    // Returns how dangerous a point is, every enemy bullet near it adds more the closer it is
+    static float getDanger(const WorldSnapshot& view, const sf::Vector2f& centre) {
+        float danger = 0.f;
+        for (std::size_t i = view.playerBulletCount; i < view.bullets.size(); ++i) {
+            const SnapshotRect& bullet = view.bullets[i];
+            sf::Vector2f offset = bullet.position + bullet.size / 2.f - centre;
+            float distance = std::sqrt(offset.x * offset.x + offset.y * offset.y);
+            if (distance < dangerRadius) {
+                float closeness = 1.f - distance / dangerRadius;
+                danger += closeness * closeness;
+            }
+        }
+        return danger;
+    }
+
+    SeededRandom random;
+    sf::Vector2f lastPosition;
+    int lastDirection;
+    float stuckTime;
+    int blockedDirection;
+    float blockedTime;
+    float weaveTime;
+    float weaveOffset;
+};
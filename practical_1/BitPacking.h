@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Writes values into a byte buffer using only as many bits as each one needs, sf::Packet can only write whole bytes
+// Bits fill each byte from its lowest bit up, BitReader reads them back in the same order
+class BitWriter {
+public:
+    // Method to empty the buffer but keep its memory
+    void clear() {
+        bytes.clear();
+        scratch = 0;
+        scratchBits = 0;
+    }
+
+    // Method to write the lowest bits of a value, bits can be anything from 0 to 32
+    void write(std::uint32_t value, int bits) {
+        if (bits == 0) {
+            return;
+        }
+        scratch |= static_cast<std::uint64_t>(value & mask(bits)) << scratchBits;
+        scratchBits += bits;
+        while (scratchBits >= 8) {
+            bytes.push_back(static_cast<std::uint8_t>(scratch));
+            scratch >>= 8;
+            scratchBits -= 8;
+        }
+    }
+
+    // Method to write a value in groups of four bits, each followed by a bit saying whether another group comes after it
+    // Small values like the gaps between entity ids only take five bits this way
+    void writeVariable(std::uint32_t value) {
+        do {
+            std::uint32_t group = value & 15u;
+            value >>= 4;
+            write(group | (value != 0 ? 16u : 0u), 5);
+        } while (value != 0);
+    }
+
+    // Method to write out the last part filled byte, call it before sending the bytes
+    void flush() {
+        if (scratchBits > 0) {
+            bytes.push_back(static_cast<std::uint8_t>(scratch));
+            scratch = 0;
+            scratchBits = 0;
+        }
+    }
+
+    std::size_t getBitCount() const {
+        return bytes.size() * 8 + scratchBits;
+    }
+
+    const std::vector<std::uint8_t>& getBytes() const {
+        return bytes;
+    }
+
+private:
+    static std::uint32_t mask(int bits) {
+        return bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1u;
+    }
+
+    std::vector<std::uint8_t> bytes;
+    std::uint64_t scratch = 0;  // Bits written that don't make up a whole byte yet
+    int scratchBits = 0;
+};
+
+// Reads values written by a BitWriter, reading past the end gives zeros and marks the reader as failed rather than reading out of bounds
+class BitReader {
+public:
+    BitReader(const void* data, std::size_t size)
+        : data(static_cast<const std::uint8_t*>(data)), size(size), position(0), scratch(0), scratchBits(0), failed(false) {
+    }
+
+    // Method to read a value written with the same number of bits
+    std::uint32_t read(int bits) {
+        if (bits == 0) {
+            return 0;
+        }
+        while (scratchBits < bits) {
+            if (position < size) {
+                scratch |= static_cast<std::uint64_t>(data[position++]) << scratchBits;
+            }
+            else {
+                failed = true;
+            }
+            scratchBits += 8;
+        }
+        std::uint32_t value = static_cast<std::uint32_t>(scratch & (bits >= 32 ? 0xFFFFFFFFull : (1ull << bits) - 1ull));
+        scratch >>= bits;
+        scratchBits -= bits;
+        return value;
+    }
+
+    // Method to read a value written by writeVariable(), more than eight groups can't come from a 32 bit value so they fail the reader
+    std::uint32_t readVariable() {
+        std::uint32_t value = 0;
+        for (int shift = 0; shift < 32; shift += 4) {
+            std::uint32_t group = read(5);
+            value |= (group & 15u) << shift;
+            if ((group & 16u) == 0) {
+                return value;
+            }
+        }
+        failed = true;
+        return value;
+    }
+
+    // Returns false if anything was read past the end of the data or didn't make sense
+    bool isValid() const {
+        return !failed;
+    }
+
+    // Method for the reader's user to mark the data as broken, for example when it refers to something that doesn't exist
+    void fail() {
+        failed = true;
+    }
+
+private:
+    const std::uint8_t* data;
+    std::size_t size;
+    std::size_t position;
+    std::uint64_t scratch;
+    int scratchBits;
+    bool failed;
+};
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "Projectiles.h"
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Bullet patterns for enemy fire (rings, spirals, aimed bursts, waves), each pattern is plain data describing one volley
+// The angle and speed of every bullet in the volley are worked out once when the pattern is made, so firing is a rotation of those
+// tables written straight into the projectile storage in one batch
+
+// Which way a pattern's volley is pointed when it is fired
+enum class PatternAim {
+    Fixed,     // Always the pattern's own angle, for example straight left
+    AtPlayer,  // Centred on the direction to the player
+    Rotating   // Turns by the pattern's spin after every volley, for spirals
+};
+
+// Description of a pattern, this is what designers edit
+struct PatternDefinition {
+    PatternAim aim = PatternAim::Fixed;
+    float angle = 3.14159265f;    // Radians, the direction for fixed patterns and the starting direction for rotating ones (0 is right, pi is left)
+    int count = 1;                // Bullets in each volley
+    float arc = 0.f;              // Radians the volley is spread over, a full circle (2 pi) or more makes an evenly spaced ring
+    float speed = 800.f;          // Pixels per second
+    float speedVariation = 0.f;   // Fraction the speed rises and falls by across the volley, which bends the volley into a wave
+    float spin = 0.f;             // Radians a rotating pattern turns between volleys
+    float cooldown = 0.2f;        // Seconds between volleys
+    int damage = 5;
+};
+
+// A pattern ready to fire, with its angle and speed tables worked out
+class BulletPattern {
+public:
+    BulletPattern() : BulletPattern(PatternDefinition()) {
+    }
+
+    explicit BulletPattern(const PatternDefinition& definition)
+        : definition(definition) {
+        buildTables();
+    }
+
+    const PatternDefinition& getDefinition() const {
+        return definition;
+    }
+
+    // Seconds to wait between volleys
+    float getCooldown() const {
+        return definition.cooldown;
+    }
+
+    // Method to fire one volley from a centre point into the projectile storage, aimAngle is the direction to the player
+    // The phase is the shooter's own spin for rotating patterns, it is moved on by this volley
+    void fire(ProjectileStorage& projectiles, float centreX, float centreY, float aimAngle, float& phase) const {
+        float baseAngle = definition.angle;
+        if (definition.aim == PatternAim::AtPlayer) {
+            baseAngle = aimAngle;
+        }
+        else if (definition.aim == PatternAim::Rotating) {
+            baseAngle += phase;
+            phase = std::fmod(phase + definition.spin, 6.28318531f);
+        }
+
+        // Every bullet's direction is its table entry rotated by the base angle, this is the only trigonometry in the volley
+        const float rotateCos = std::cos(baseAngle);
+        const float rotateSin = std::sin(baseAngle);
+        const float startX = centreX - projectiles.getProjectileSize().x / 2.f;
+        const float startY = centreY - projectiles.getProjectileSize().y / 2.f;
+        const int damage = definition.damage;
+
+        const std::size_t count = cosTable.size();
+        const std::size_t first = projectiles.appendBatch(count);
+        float* x = projectiles.x.data() + first;
+        float* y = projectiles.y.data() + first;
+        float* previousX = projectiles.previousX.data() + first;
+        float* previousY = projectiles.previousY.data() + first;
+        float* velocityX = projectiles.velocityX.data() + first;
+        float* velocityY = projectiles.velocityY.data() + first;
+        int* damages = projectiles.damage.data() + first;
+        for (std::size_t i = 0; i < count; ++i) {
+            x[i] = previousX[i] = startX;
+            y[i] = previousY[i] = startY;
+            velocityX[i] = (cosTable[i] * rotateCos - sinTable[i] * rotateSin) * speedTable[i];
+            velocityY[i] = (cosTable[i] * rotateSin + sinTable[i] * rotateCos) * speedTable[i];
+            damages[i] = damage;
+        }
+    }
+
+private:
+    // Method to work out the direction and speed of each bullet in the volley relative to the base angle
+    void buildTables() {
+        const int count = definition.count > 0 ? definition.count : 1;
+        const float fullCircle = 6.28318531f;
+        cosTable.resize(count);
+        sinTable.resize(count);
+        speedTable.resize(count);
+
+        for (int i = 0; i < count; ++i) {
+            // A ring spaces its bullets all the way round, anything narrower spreads them evenly from one edge of the arc to the other
+            float offset = 0.f;
+            float across = count > 1 ? static_cast<float>(i) / (count - 1) : 0.5f;  // 0 at one edge of the volley, 1 at the other
+            if (definition.arc >= fullCircle) {
+                offset = fullCircle * i / count;
+            }
+            else if (count > 1) {
+                offset = definition.arc * (across - 0.5f);
+            }
+            cosTable[i] = std::cos(offset);
+            sinTable[i] = std::sin(offset);
+            speedTable[i] = definition.speed * (1.f + definition.speedVariation * std::sin(across * fullCircle));
+        }
+    }
+
+    PatternDefinition definition;
+    std::vector<float> cosTable;
+    std::vector<float> sinTable;
+    std::vector<float> speedTable;
+};
+
+// A pattern the game is built with, the data files can replace any of these by defining a pattern with the same name
+struct BuiltInPattern {
+    const char* name;
+    PatternDefinition definition;
+};
+
+// Returns the patterns the game is built with, this is the only place their values are written down
+inline const std::vector<BuiltInPattern>& getBuiltInPatterns() {
+    static const std::vector<BuiltInPattern> builtIn = [] {
+        std::vector<BuiltInPattern> patterns;
+
+        PatternDefinition straight;  // The original enemy shot, one bullet straight to the left
+        patterns.push_back({ "straight", straight });
+
+        PatternDefinition aimedBurst;
+        aimedBurst.aim = PatternAim::AtPlayer;
+        aimedBurst.count = 5;
+        aimedBurst.arc = 0.5f;
+        aimedBurst.speed = 650.f;
+        aimedBurst.cooldown = 1.f;
+        patterns.push_back({ "aimedBurst", aimedBurst });
+
+        PatternDefinition ring;
+        ring.count = 24;
+        ring.arc = 6.28318531f;
+        ring.speed = 350.f;
+        ring.cooldown = 1.5f;
+        ring.damage = 4;
+        patterns.push_back({ "ring", ring });
+
+        PatternDefinition spiral;
+        spiral.aim = PatternAim::Rotating;
+        spiral.angle = 0.f;
+        spiral.count = 4;
+        spiral.arc = 6.28318531f;
+        spiral.speed = 300.f;
+        spiral.spin = 0.2f;
+        spiral.cooldown = 0.08f;
+        spiral.damage = 3;
+        patterns.push_back({ "spiral", spiral });
+
+        PatternDefinition wave;
+        wave.aim = PatternAim::AtPlayer;
+        wave.count = 15;
+        wave.arc = 1.2f;
+        wave.speed = 450.f;
+        wave.speedVariation = 0.3f;
+        wave.cooldown = 1.2f;
+        patterns.push_back({ "wave", wave });
+
+        PatternDefinition bossRing;  // 500 bullets in one volley
+        bossRing.aim = PatternAim::Rotating;
+        bossRing.count = 500;
+        bossRing.arc = 6.28318531f;
+        bossRing.speed = 250.f;
+        bossRing.spin = 0.05f;
+        bossRing.cooldown = 3.f;
+        bossRing.damage = 10;
+        patterns.push_back({ "bossRing", bossRing });
+        return patterns;
+    }();
+    return builtIn;
+}
+
+// Returns true if the game is built with a pattern of this name, without building any of the patterns
+inline bool isBuiltInPattern(const std::string& name) {
+    for (const BuiltInPattern& pattern : getBuiltInPatterns()) {
+        if (name == pattern.name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Every pattern by name, patterns are stored in a node based map so pointers to them stay valid when more are added
+class BulletPatternLibrary {
+public:
+    // Constructor which adds the built in patterns
+    BulletPatternLibrary() {
+        for (const BuiltInPattern& pattern : getBuiltInPatterns()) {
+            add(pattern.name, pattern.definition);
+        }
+    }
+
+    // Method to add a pattern, or replace the one with the same name
+    void add(const std::string& name, const PatternDefinition& definition) {
+        patterns[name] = BulletPattern(definition);
+    }
+
+    // Method to add a pattern that has already been built, or replace the one with the same name. Enemies pointing at the old
+    // pattern fire the new one from then on, so this must only be called when nothing is firing
+    void add(const std::string& name, BulletPattern&& pattern) {
+        patterns[name] = std::move(pattern);
+    }
+
+    // Returns the pattern with this name, or nullptr if there isn't one
+    const BulletPattern* find(const std::string& name) const {
+        auto found = patterns.find(name);
+        return found != patterns.end() ? &found->second : nullptr;
+    }
+
+private:
+    std::unordered_map<std::string, BulletPattern> patterns;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+
+// Camera class wrapping an sf::View that follows the player around a world larger than the screen
+// It also stores the world bounds so entities can be culled against the view and projectiles despawned at the edge of the world
+class Camera {
+public:
+    // Constructor for the camera with the size of the view (normally the window size) and the rectangle the world covers
+    Camera(const sf::Vector2f& viewSize, const sf::FloatRect& worldBounds)
+        : worldBounds(worldBounds) {
+        view.setSize(viewSize);
+        view.setCenter(viewSize / 2.f);
+    }
+
+    // Method to centre the view on a target, clamped so the camera never shows anything outside the world
+    void follow(const sf::Vector2f& target) {
+        sf::Vector2f halfSize = view.getSize() / 2.f;
+        sf::Vector2f center;
+        center.x = clampAxis(target.x, worldBounds.left + halfSize.x, worldBounds.left + worldBounds.width - halfSize.x);
+        center.y = clampAxis(target.y, worldBounds.top + halfSize.y, worldBounds.top + worldBounds.height - halfSize.y);
+        view.setCenter(center);
+    }
+
+    // Method to change the size of the view, such as when the window switches between fullscreen and windowed
+    void setViewSize(const sf::Vector2f& viewSize) {
+        view.setSize(viewSize);
+    }
+
+    // Returns the view so it can be set on the window before drawing the world
+    const sf::View& getView() const {
+        return view;
+    }
+
+    // Returns the rectangle of the world currently covered by the view
+    sf::FloatRect getViewBounds() const {
+        sf::Vector2f size = view.getSize();
+        sf::Vector2f center = view.getCenter();
+        return sf::FloatRect(center.x - size.x / 2.f, center.y - size.y / 2.f, size.x, size.y);
+    }
+
+    // Returns the top left corner of the view in world coordinates
+    sf::Vector2f getPosition() const {
+        return view.getCenter() - view.getSize() / 2.f;
+    }
+
+    // Boolean method for culling, returns true if any part of the bounds can be seen by the camera
+    bool isVisible(const sf::FloatRect& bounds) const {
+        return getViewBounds().intersects(bounds);
+    }
+
+    // Returns the rectangle the whole world covers
+    const sf::FloatRect& getWorldBounds() const {
+        return worldBounds;
+    }
+
+    // Boolean method returning true if any part of the bounds is still inside the world
+    bool isInsideWorld(const sf::FloatRect& bounds) const {
+        return worldBounds.intersects(bounds);
+    }
+
+private:
+    // Clamps a value between a minimum and maximum, if the world is smaller than the view on this axis the view is centred on the world instead
+    static float clampAxis(float value, float minimum, float maximum) {
+        if (minimum > maximum) {
+            return (minimum + maximum) / 2.f;
+        }
+        return std::max(minimum, std::min(value, maximum));
+    }
+
+    sf::View view;
+    sf::FloatRect worldBounds;
+};
@@ -0,0 +1,416 @@
+#pragma once
+
+#include "CoopSession.h"
+#include "NetProtocol.h"
+#include "NetReplication.h"
+#include "PlayerInput.h"
+#include "TileCollision.h"
+
+#include <SFML/Network.hpp>
+#include <SFML/System/Time.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// An enemy or bullet to draw, in world pixels
+struct CoopEntityView {
+    float x;
+    float y;
+    std::uint8_t kind;  // A NetEntityKind
+};
+
+// A player to draw, in world pixels
+struct CoopPlayerView {
+    float x;
+    float y;
+    int health;
+    bool local;  // The player this client controls
+};
+
+// Client side of co-op play, with no window or audio so the game and the bot clients can both use it
+// The local player is predicted: each tick's input moves it straight away with the same movement code the server uses, and is kept until the server
+// says it has used it. When a snapshot comes in the player is put back where the server had it and every input the server hasn't used yet is replayed
+// on top, any difference from where it was drawn is shrunk away over a few ticks rather than snapping.
+// Everything else is drawn a little in the past, between the two buffered snapshots either side of the render time, so it moves smoothly however
+// the snapshots arrive. How far in the past adapts to the gap between snapshots and how much their arrival jitters
+class CoopClient {
+public:
+    explicit CoopClient(const TileCollision& terrain)
+        : terrain(terrain), slot(-1), session(-1), tickRate(60.f), sequence(0), errorX(0.f), errorY(0.f),
+        newestTick(0), lastArrivalTick(0), averageGap(2.f), jitter(0.f), renderTick(0.0), rendering(false),
+        snapshotCount(0), outOfOrderCount(0), fullCount(0), decodeFailures(0), receivedBytes(0), mostEntities(0),
+        correctionCount(0), totalCorrection(0.0), largestCorrection(0.f), renderCount(0), underrunCount(0) {
+    }
+
+    // Method to open the client's socket and say Hello to the server, returns false if no socket could be opened
+    bool connect(const sf::IpAddress& serverAddress, unsigned short serverPort) {
+        address = serverAddress;
+        port = serverPort;
+        if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Done) {
+            return false;
+        }
+        socket.setBlocking(false);
+        sendHello();
+        return true;
+    }
+
+    // Method to tell the server the client is leaving, Goodbye is sent a few times as nothing comes back to say it arrived
+    void disconnect() {
+        sf::Packet packet;
+        packet << static_cast<sf::Uint8>(NetMessage::Goodbye);
+        for (int i = 0; i < 3; ++i) {
+            socket.send(packet, address, port);
+        }
+        slot = -1;
+    }
+
+    // Method to run one client tick, call it at the server's tick rate (see getTickRate)
+    // It reads everything the server has sent, moves the local player with this tick's input and sends the input to the server
+    void tick(const PlayerInput& input, sf::Time now) {
+        receive(now);
+
+        if (!isWelcomed()) {
+            // Say Hello again every half a second until the server answers, in case a packet was lost
+            if (now - lastHello > sf::milliseconds(500)) {
+                sendHello();
+                lastHello = now;
+            }
+            return;
+        }
+
+        // Keep the input until the server has used it, and move the local player with it now rather than waiting to hear back
+        PendingInput pendingInput;
+        pendingInput.sequence = ++sequence;
+        pendingInput.input = input;
+        pending.push_back(pendingInput);
+        if (pending.size() > maxPendingInputs) {
+            pending.pop_front();
+        }
+        if (predicted.health > 0) {
+            CoopSession::movePlayer(predicted, input, 1.f / tickRate, terrain, worldBounds);
+        }
+
+        // Send the newest few inputs so a lost packet doesn't lose any, the server ignores the ones it already has
+        std::size_t count = std::min(pending.size(), netInputsPerMessage);
+        sf::Packet packet;
+        packet << static_cast<sf::Uint8>(NetMessage::Input) << decoder.getNewestTick() << sequence << static_cast<sf::Uint8>(count);
+        for (std::size_t i = pending.size() - count; i < pending.size(); ++i) {
+            packet << pending[i].input.pack();
+        }
+        socket.send(packet, address, port);
+
+        // Shrink what is left of the last correction so the local player slides to where it should be
+        errorX *= correctionDecay;
+        errorY *= correctionDecay;
+    }
+
+    // Method to work out what to draw at this moment, the remote player and every enemy and bullet are interpolated and the local player is predicted
+    void interpolate(sf::Time now, std::vector<CoopEntityView>& entities, std::vector<CoopPlayerView>& players) {
+        entities.clear();
+        players.clear();
+        if (buffer.empty()) {
+            return;
+        }
+        advanceRenderTick(now);
+
+        // Throw away snapshots the render time has gone past, keeping the one just before it to interpolate from
+        while (buffer.size() >= 2 && buffer[1].tick <= renderTick) {
+            buffer.pop_front();
+        }
+        const BufferedSnapshot& from = buffer.front();
+        const BufferedSnapshot* to = buffer.size() >= 2 ? &buffer[1] : nullptr;
+        float t = 0.f;
+        if (to != nullptr && renderTick > from.tick) {
+            t = static_cast<float>((renderTick - from.tick) / (to->tick - from.tick));
+        }
+        else if (to == nullptr && renderTick > from.tick) {
+            ++underrunCount;  // The next snapshot is late, hold the newest one rather than guess
+        }
+        ++renderCount;
+
+        // Entities that exist in the snapshot before the render time are drawn, moving towards where they are in the next one if they are still in it
+        std::size_t j = 0;
+        for (const ReplicatedEntity& entity : from.entities) {
+            float x = quantizer.dequantizeX(entity.x);
+            float y = quantizer.dequantizeY(entity.y);
+            if (to != nullptr) {
+                while (j < to->entities.size() && to->entities[j].id < entity.id) {
+                    ++j;
+                }
+                if (j < to->entities.size() && to->entities[j].id == entity.id) {
+                    x += (quantizer.dequantizeX(to->entities[j].x) - x) * t;
+                    y += (quantizer.dequantizeY(to->entities[j].y) - y) * t;
+                }
+            }
+            entities.push_back({ x, y, entity.kind });
+        }
+
+        for (std::size_t i = 0; i < from.players.size(); ++i) {
+            const NetPlayer& player = from.players[i];
+            if (!player.connected || static_cast<int>(i) == slot) {
+                continue;
+            }
+            float x = player.x;
+            float y = player.y;
+            if (to != nullptr && i < to->players.size()) {
+                x += (to->players[i].x - x) * t;
+                y += (to->players[i].y - y) * t;
+            }
+            players.push_back({ x, y, player.health, false });
+        }
+        if (isWelcomed()) {
+            players.push_back({ predicted.x + errorX, predicted.y + errorY, predicted.health, true });
+        }
+    }
+
+    bool isWelcomed() const { return slot >= 0; }
+    int getSlot() const { return slot; }
+    int getSession() const { return session; }
+    float getTickRate() const { return tickRate; }
+    const sf::FloatRect& getWorldBounds() const { return worldBounds; }
+
+    // Returns the newest snapshot received, for the score, the wave and the players' health
+    const NetSnapshot& getSnapshot() const { return snapshot; }
+
+    // Returns how far in the past the remote entities are drawn, in seconds
+    float getInterpolationDelay() const { return targetDelay() / tickRate; }
+
+    // Counts for checking the client is working, used by the loopback bots
+    std::size_t getSnapshotCount() const { return snapshotCount; }
+    std::size_t getOutOfOrderCount() const { return outOfOrderCount; }
+    std::size_t getFullCount() const { return fullCount; }
+    std::size_t getDecodeFailures() const { return decodeFailures; }
+    std::size_t getReceivedBytes() const { return receivedBytes; }
+    std::size_t getMostEntities() const { return mostEntities; }
+    std::uint32_t getLastAckedInput() const { return lastAckedInput; }
+    std::size_t getCorrectionCount() const { return correctionCount; }
+    float getAverageCorrection() const { return correctionCount > 0 ? static_cast<float>(totalCorrection / correctionCount) : 0.f; }
+    float getLargestCorrection() const { return largestCorrection; }
+    std::size_t getRenderCount() const { return renderCount; }
+    std::size_t getUnderrunCount() const { return underrunCount; }
+
+private:
+    // An input the server hasn't said it has used yet
+    struct PendingInput {
+        std::uint32_t sequence;
+        PlayerInput input;
+    };
+
+    // A snapshot waiting to be drawn
+    struct BufferedSnapshot {
+        std::uint32_t tick;
+        std::vector<ReplicatedEntity> entities;
+        std::vector<NetPlayer> players;
+    };
+
+    // About a second of inputs at 60 ticks per second, if the server hasn't used them by then the oldest are forgotten
+    static const std::size_t maxPendingInputs = 64;
+    // Snapshots kept for interpolation, far more than the largest delay needs
+    static const std::size_t maxBufferedSnapshots = 32;
+    // How much of a correction is left after each tick, so most of it is gone in about ten ticks
+    static constexpr float correctionDecay = 0.8f;
+    // Corrections bigger than this (a respawn, or a long stall) are snapped to straight away instead of being smoothed
+    static constexpr float snapDistance = 100.f;
+
+    void sendHello() {
+        sf::Packet packet;
+        packet << static_cast<sf::Uint8>(NetMessage::Hello) << netProtocolVersion;
+        socket.send(packet, address, port);
+    }
+
+    void receive(sf::Time now) {
+        sf::Packet packet;
+        sf::IpAddress sender;
+        unsigned short senderPort;
+        while (socket.receive(packet, sender, senderPort) == sf::Socket::Done) {
+            receivedBytes += packet.getDataSize();
+            sf::Uint8 type = 0;
+            packet >> type;
+            if (type == static_cast<sf::Uint8>(NetMessage::Welcome)) {
+                sf::Uint16 sessionIndex = 0;
+                sf::Uint8 playerSlot = 0;
+                float rate = 0.f;
+                sf::FloatRect bounds;
+                if (!isWelcomed() && packet >> sessionIndex >> playerSlot >> rate >> bounds.left >> bounds.top >> bounds.width >> bounds.height) {
+                    session = sessionIndex;
+                    slot = playerSlot;
+                    tickRate = rate;
+                    worldBounds = bounds;
+                    quantizer = PositionQuantizer(bounds);
+                }
+            }
+            else if (type == static_cast<sf::Uint8>(NetMessage::Snapshot) && isWelcomed()) {
+                NetSnapshot& received = incoming;
+                if (!received.read(packet) || !readEntityDelta(packet, decoder, quantizer, received)) {
+                    ++decodeFailures;
+                    continue;
+                }
+                ++snapshotCount;
+                mostEntities = std::max(mostEntities, received.entities.size());
+                if (received.tick <= newestTick) {
+                    ++outOfOrderCount;  // Still worth buffering if it is newer than what is being drawn
+                }
+                else {
+                    measureArrival(received.tick, now);
+                    newestTick = received.tick;
+                    reconcile(received);
+                    snapshot = received;
+                }
+                bufferSnapshot(received);
+            }
+            else if (type == static_cast<sf::Uint8>(NetMessage::Full)) {
+                ++fullCount;
+            }
+        }
+    }
+
+    // Method to put the local player where the server had it and replay every input the server hasn't used yet on top
+    void reconcile(const NetSnapshot& received) {
+        if (slot >= static_cast<int>(received.players.size())) {
+            return;
+        }
+        const NetPlayer& server = received.players[slot];
+        lastAckedInput = server.lastInput;
+        while (!pending.empty() && pending.front().sequence <= server.lastInput) {
+            pending.pop_front();
+        }
+
+        float shownX = predicted.x;
+        float shownY = predicted.y;
+        predicted.x = server.x;
+        predicted.y = server.y;
+        predicted.directionX = server.directionX;
+        predicted.directionY = server.directionY;
+        predicted.health = server.health;
+        if (predicted.health > 0) {
+            for (const PendingInput& input : pending) {
+                CoopSession::movePlayer(predicted, input.input, 1.f / tickRate, terrain, worldBounds);
+            }
+        }
+
+        // Carry the difference over into the error so the player is drawn where it was and slides to the corrected position
+        float correctionX = shownX - predicted.x;
+        float correctionY = shownY - predicted.y;
+        float correction = std::sqrt(correctionX * correctionX + correctionY * correctionY);
+        if (correction > 0.01f && snapshotCount > 1) {
+            ++correctionCount;
+            totalCorrection += correction;
+            largestCorrection = std::max(largestCorrection, correction);
+        }
+        if (correction > snapDistance) {
+            errorX = 0.f;
+            errorY = 0.f;
+        }
+        else {
+            errorX += correctionX;
+            errorY += correctionY;
+        }
+    }
+
+    // Method to keep a running average of the ticks between snapshots and of how late or early they arrive compared with that, both in ticks
+    void measureArrival(std::uint32_t tick, sf::Time now) {
+        if (lastArrivalTick != 0) {
+            float tickGap = static_cast<float>(tick - lastArrivalTick);
+            float arrivalGap = (now - lastArrival).asSeconds() * tickRate;
+            averageGap += (tickGap - averageGap) / 16.f;
+            jitter += (std::abs(arrivalGap - tickGap) - jitter) / 16.f;
+        }
+        lastArrival = now;
+        lastArrivalTick = tick;
+    }
+
+    // Delay the remote entities are drawn with, in ticks: one gap between snapshots so there is usually one to interpolate to,
+    // plus enough to cover the jitter, but never more than a quarter of a second
+    float targetDelay() const {
+        return std::min(averageGap + 1.f + jitter * 3.f, tickRate * 0.25f);
+    }
+
+    // Method to move the render time on, it runs a little fast or slow to follow the delay as the jitter changes rather than jumping
+    void advanceRenderTick(sf::Time now) {
+        double serverTick = lastArrivalTick + (now - lastArrival).asSeconds() * tickRate;
+        double target = serverTick - targetDelay();
+        if (!rendering || std::abs(target - renderTick) > tickRate * 0.5f) {
+            renderTick = target;
+            rendering = true;
+        }
+        else {
+            double elapsed = (now - lastRender).asSeconds() * tickRate;
+            double rate = 1.0 + std::max(-0.1, std::min(0.1, (target - renderTick) * 0.1));
+            renderTick += elapsed * rate;
+        }
+        lastRender = now;
+    }
+
+    // Method to add a snapshot to the interpolation buffer in tick order, anything older than what is being drawn is no use
+    void bufferSnapshot(const NetSnapshot& received) {
+        if (!buffer.empty() && received.tick <= buffer.front().tick && rendering) {
+            return;
+        }
+        auto position = std::find_if(buffer.begin(), buffer.end(), [&received](const BufferedSnapshot& buffered) {
+            return buffered.tick >= received.tick;
+            });
+        if (position != buffer.end() && position->tick == received.tick) {
+            return;
+        }
+        BufferedSnapshot buffered;
+        buffered.tick = received.tick;
+        buffered.entities = received.entities;
+        buffered.players = received.players;
+        buffer.insert(position, std::move(buffered));
+        if (buffer.size() > maxBufferedSnapshots) {
+            buffer.pop_front();
+        }
+    }
+
+    const TileCollision& terrain;
+    sf::UdpSocket socket;
+    sf::IpAddress address;
+    unsigned short port = 0;
+    sf::Time lastHello;
+
+    // What the server told the client when it joined
+    int slot;     // -1 until the server welcomes the client
+    int session;
+    float tickRate;
+    sf::FloatRect worldBounds;
+    PositionQuantizer quantizer;
+
+    // Prediction
+    CoopSession::Player predicted;  // The local player as the client thinks it is now
+    std::deque<PendingInput> pending;
+    std::uint32_t sequence;
+    std::uint32_t lastAckedInput = 0;
+    float errorX;  // What is left of the corrections, added to where the local player is drawn
+    float errorY;
+
+    // Snapshots
+    ReplicationDecoder decoder;
+    NetSnapshot incoming;
+    NetSnapshot snapshot;
+    std::uint32_t newestTick;
+
+    // Interpolation
+    std::deque<BufferedSnapshot> buffer;
+    sf::Time lastArrival;
+    std::uint32_t lastArrivalTick;
+    float averageGap;  // Ticks between snapshots
+    float jitter;      // How far snapshots arrive from when they are expected, in ticks
+    double renderTick;
+    bool rendering;
+    sf::Time lastRender;
+
+    // Counts
+    std::size_t snapshotCount;
+    std::size_t outOfOrderCount;
+    std::size_t fullCount;
+    std::size_t decodeFailures;
+    std::size_t receivedBytes;
+    std::size_t mostEntities;
+    std::size_t correctionCount;
+    double totalCorrection;
+    float largestCorrection;
+    std::size_t renderCount;
+    std::size_t underrunCount;
+};
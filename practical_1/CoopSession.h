@@ -0,0 +1,430 @@
+#pragma once
+
+#include "DeterministicWorld.h"
+#include "EnemyBehaviours.h"
+#include "FlowField.h"
+#include "NetProtocol.h"
+#include "PlayerInput.h"
+#include "Projectiles.h"
+#include "TileCollision.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// One co-op game on the dedicated server, up to two players against waves of archetype enemies
+// Everything here is plain data and the headless parts of the level (the swarm, the projectile storage, the flow field and the tile collision),
+// so a server can run many sessions on one thread without a window, an OpenGL context or an audio device.
+// The session only moves forward when step() is called, the server calls it at its fixed tick rate
+// A deterministic session plays on a DeterministicWorld instead of the float simulation, in lockstep: the world only takes a tick once every
+// player's input for it has arrived, so given the same inputs it plays out the same on every machine. The players, inputs and snapshots
+// are handled the same way in both, so the server and the clients don't need to know which one a session is
+class CoopSession {
+public:
+    static const int maxPlayers = 2;
+
+    // Most inputs kept waiting for a player, the same as the client keeps waiting to be acknowledged so none it has predicted are dropped
+    static const int maxQueuedInputs = 64;
+
+    // Most queued inputs used in one tick, so a player whose inputs arrived late catches up over a few ticks rather than jumping
+    static const int maxInputsPerTick = 3;
+
+    // A player in the session, the movement and firing follow the single player rules but count time in ticks rather than with a clock
+    struct Player {
+        static constexpr float size = 50.f;
+        static constexpr float speed = 300.f;
+        static constexpr float fireCooldown = 0.1f;
+        static constexpr float bulletSpeed = 1200.f;
+        static constexpr float respawnTime = 3.f;
+        static const int maxHealth = 100;
+        static const int bulletDamage = 5;
+
+        bool connected = false;
+        float x = 0.f;
+        float y = 0.f;
+        int health = 0;
+        int directionX = 0;        // The player keeps flying the way they last pressed, like in the single player levels
+        int directionY = 0;
+        float fireTimer = 0.f;     // Seconds until the player can fire again
+        float respawnTimer = 0.f;  // Seconds until a dead player comes back
+        PlayerInput input;            // Controls of the last input used
+        std::uint32_t lastInput = 0;  // Sequence number of the last input used, the client replays everything after it
+
+        // Inputs waiting to be used. Each one moves the player exactly once, the same as the client did when it predicted it,
+        // so where the server has the player after lastInput is where the client predicted it would be
+        PlayerInput queued[maxQueuedInputs];
+        std::uint32_t queuedSequence[maxQueuedInputs];
+        int queuedFirst = 0;
+        int queuedCount = 0;
+        std::uint32_t lastQueued = 0;  // Newest sequence number queued, so inputs sent again in later packets are only queued once
+
+        sf::FloatRect getBounds() const {
+            return sf::FloatRect(x, y, size, size);
+        }
+    };
+
+    // Constructor with the terrain to collide with, which can be shared by every session on the server, the world it covers
+    // and whether to play on the deterministic simulation, which has to be stepped at deterministicTickRate
+    CoopSession(const TileCollision& terrain, const sf::FloatRect& worldBounds, bool deterministic = false)
+        : terrain(terrain), worldBounds(worldBounds), tick(0), wave(0), score(0) {
+        if (deterministic) {
+            deterministicWorld.reset(new DeterministicWorld(terrain, sf::IntRect(worldBounds)));
+            copyDeterministicState();
+            return;
+        }
+        playerBullets.reserve(512);
+        enemyBullets.reserve(4096);
+        spawnWave();
+    }
+
+    // Method to add a player to the first free slot, returns the slot or -1 if the session is full
+    int addPlayer() {
+        for (int slot = 0; slot < maxPlayers; ++slot) {
+            if (!players[slot].connected) {
+                players[slot] = Player();
+                players[slot].connected = true;
+                respawn(slot);
+                if (deterministicWorld) {
+                    deterministicWorld->addPlayer();  // Both take the first free slot, so it is the same one
+                    copyDeterministicState();
+                }
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    void removePlayer(int slot) {
+        players[slot].connected = false;
+        if (deterministicWorld) {
+            deterministicWorld->removePlayer(slot);
+        }
+    }
+
+    int getPlayerCount() const {
+        int count = 0;
+        for (const Player& player : players) {
+            count += player.connected ? 1 : 0;
+        }
+        return count;
+    }
+
+    bool hasFreeSlot() const {
+        return getPlayerCount() < maxPlayers;
+    }
+
+    // Method to queue the controls a player held for one of their ticks, inputs that have been queued already or arrive out of order are ignored
+    // When the queue is full the input isn't queued, nothing already queued is dropped and the client sends it again in its next few packets
+    void setInput(int slot, std::uint32_t sequence, const PlayerInput& input) {
+        Player& player = players[slot];
+        if (sequence <= player.lastQueued || player.queuedCount == maxQueuedInputs) {
+            return;
+        }
+        int index = (player.queuedFirst + player.queuedCount) % maxQueuedInputs;
+        player.queued[index] = input;
+        player.queuedSequence[index] = sequence;
+        ++player.queuedCount;
+        player.lastQueued = sequence;
+    }
+
+    // Method to move a player for one tick with the controls they are holding, used by the session and by clients predicting their own player
+    // so both move the player in exactly the same way
+    static void movePlayer(Player& player, const PlayerInput& input, float deltaTime, const TileCollision& terrain, const sf::FloatRect& worldBounds) {
+        if (input.up || input.down || input.left || input.right) {
+            player.directionX = input.up || input.down ? 0 : (input.left ? -1 : 1);
+            player.directionY = input.up ? -1 : (input.down ? 1 : 0);
+        }
+
+        float previousX = player.x;
+        float previousY = player.y;
+        player.x += player.directionX * Player::speed * deltaTime;
+        player.y += player.directionY * Player::speed * deltaTime;
+        player.x = std::max(worldBounds.left, std::min(player.x, worldBounds.left + worldBounds.width - Player::size));
+        player.y = std::max(worldBounds.top, std::min(player.y, worldBounds.top + worldBounds.height - Player::size));
+        if (terrain.overlapsSolid(player.getBounds())) {
+            player.x = previousX;
+            player.y = previousY;
+        }
+    }
+
+    const Player& getPlayer(int slot) const {
+        return players[slot];
+    }
+
+    std::uint32_t getTick() const {
+        return tick;
+    }
+
+    // Method to run one tick of the session
+    void step(float deltaTime) {
+        ++tick;
+        if (deterministicWorld) {
+            stepDeterministic();
+            return;
+        }
+
+        playerBullets.update(deltaTime);
+        playerBullets.hitWorld(worldBounds, terrain);
+        enemyBullets.update(deltaTime);
+        enemyBullets.hitWorld(worldBounds, terrain);
+
+        for (int slot = 0; slot < maxPlayers; ++slot) {
+            updatePlayer(slot, deltaTime);
+        }
+
+        // Enemy bullets hit every player they cross, then player bullets hit the first swarm enemy along their path
+        for (Player& player : players) {
+            if (isActive(player)) {
+                damage(player, enemyBullets.hitTarget(player.getBounds()));
+            }
+        }
+        enemyBullets.removeHit();
+
+        for (std::size_t i = 0; i < playerBullets.size(); ++i) {
+            float earliestHit = 2.f;
+            sf::FloatRect start(playerBullets.previousX[i], playerBullets.previousY[i], ProjectileStorage::width, ProjectileStorage::height);
+            sf::Vector2f displacement(playerBullets.x[i] - playerBullets.previousX[i], playerBullets.y[i] - playerBullets.previousY[i]);
+            if (int* health = swarm.findSweptHit(start, displacement, earliestHit)) {
+                *health -= playerBullets.damage[i];
+                playerBullets.hit[i] = 1;
+            }
+        }
+        playerBullets.removeHit();
+        score += static_cast<std::uint32_t>(swarm.removeDead());
+
+        // The swarm goes after whichever player has the most health, so a player who is low can get away
+        int target = findTarget();
+        if (target >= 0) {
+            Player& player = players[target];
+            flowField.update(sf::Vector2f(player.x + Player::size / 2.f, player.y + Player::size / 2.f), terrain, worldBounds);
+            damage(player, swarm.update(player.getBounds(), flowField, enemyBullets, deltaTime));
+        }
+
+        if (swarm.size() == 0) {
+            spawnWave();
+        }
+    }
+
+    // Method to fill in a network snapshot of the session, with every enemy and bullet quantized and sorted by id ready for the replication
+    void writeSnapshot(NetSnapshot& snapshot, const PositionQuantizer& quantizer) const {
+        snapshot.clear();
+        snapshot.tick = tick;
+        snapshot.wave = static_cast<sf::Uint16>(wave);
+        snapshot.score = static_cast<sf::Uint16>(std::min<std::uint32_t>(score, 0xFFFF));
+        for (const Player& player : players) {
+            NetPlayer netPlayer;
+            netPlayer.x = player.x;
+            netPlayer.y = player.y;
+            netPlayer.directionX = static_cast<sf::Int8>(player.directionX);
+            netPlayer.directionY = static_cast<sf::Int8>(player.directionY);
+            netPlayer.health = static_cast<sf::Uint8>(std::max(0, player.health));
+            netPlayer.connected = player.connected ? 1 : 0;
+            netPlayer.lastInput = player.lastInput;
+            snapshot.players.push_back(netPlayer);
+        }
+        if (deterministicWorld) {
+            writeEnemies<Chaser>(snapshot, quantizer, deterministicWorld->getSwarm(), NetChaser);
+            writeEnemies<Strafer>(snapshot, quantizer, deterministicWorld->getSwarm(), NetStrafer);
+            writeEnemies<Kamikaze>(snapshot, quantizer, deterministicWorld->getSwarm(), NetKamikaze);
+            writeEnemies<Turret>(snapshot, quantizer, deterministicWorld->getSwarm(), NetTurret);
+            writeEnemies<Spiral>(snapshot, quantizer, deterministicWorld->getSwarm(), NetSpiral);
+            writeProjectiles(snapshot, quantizer, deterministicWorld->getPlayerBullets(), NetPlayerBullet);
+            writeProjectiles(snapshot, quantizer, deterministicWorld->getEnemyBullets(), NetEnemyBullet);
+        }
+        else {
+            writeEnemies<Chaser>(snapshot, quantizer, swarm, NetChaser);
+            writeEnemies<Strafer>(snapshot, quantizer, swarm, NetStrafer);
+            writeEnemies<Kamikaze>(snapshot, quantizer, swarm, NetKamikaze);
+            writeEnemies<Turret>(snapshot, quantizer, swarm, NetTurret);
+            writeEnemies<Spiral>(snapshot, quantizer, swarm, NetSpiral);
+            writeProjectiles(snapshot, quantizer, playerBullets, NetPlayerBullet);
+            writeProjectiles(snapshot, quantizer, enemyBullets, NetEnemyBullet);
+        }
+        std::sort(snapshot.entities.begin(), snapshot.entities.end(), [](const ReplicatedEntity& a, const ReplicatedEntity& b) {
+            return a.id < b.id;
+            });
+    }
+
+private:
+    static bool isActive(const Player& player) {
+        return player.connected && player.health > 0;
+    }
+
+    // Method to move one player, fire their gun and bring them back if they have been dead long enough
+    void updatePlayer(int slot, float deltaTime) {
+        Player& player = players[slot];
+        if (!player.connected) {
+            return;
+        }
+        if (player.health <= 0) {
+            player.respawnTimer -= deltaTime;
+            if (player.respawnTimer <= 0.f) {
+                respawn(slot);
+            }
+        }
+
+        // Use the queued inputs, each exactly once. If none has arrived in time the player waits for it rather than moving on its own,
+        // the client didn't move without one either. Inputs that arrive late are caught up on over the next few ticks.
+        // A dead player's inputs are used up without moving them, the same as the client does while it has no player to predict
+        for (int used = 0; used < maxInputsPerTick && player.queuedCount > 0; ++used) {
+            player.input = player.queued[player.queuedFirst];
+            player.lastInput = player.queuedSequence[player.queuedFirst];
+            player.queuedFirst = (player.queuedFirst + 1) % maxQueuedInputs;
+            --player.queuedCount;
+            if (player.health > 0) {
+                applyInput(player, deltaTime);
+            }
+        }
+    }
+
+    // Method to move a player and fire their gun for one of their inputs
+    void applyInput(Player& player, float deltaTime) {
+        const PlayerInput& input = player.input;
+        movePlayer(player, input, deltaTime, terrain, worldBounds);
+
+        player.fireTimer -= deltaTime;
+        if (input.fire && player.fireTimer <= 0.f) {
+            player.fireTimer = Player::fireCooldown;
+            playerBullets.push(player.x + Player::size, player.y + Player::size / 2.f, 1.f, 0.f, Player::bulletSpeed, Player::bulletDamage);
+        }
+    }
+
+    void respawn(int slot) {
+        Player& player = players[slot];
+        player.x = 200.f;
+        player.y = 300.f + slot * 300.f;
+        player.health = Player::maxHealth;
+        player.directionX = 0;
+        player.directionY = 0;
+        player.fireTimer = 0.f;
+    }
+
+    void damage(Player& player, int amount) {
+        if (amount <= 0 || player.health <= 0) {
+            return;
+        }
+        player.health = std::max(0, player.health - amount);
+        if (player.health == 0) {
+            player.respawnTimer = Player::respawnTime;
+        }
+    }
+
+    // Returns the living player with the most health, or -1 if nobody is alive
+    int findTarget() const {
+        int target = -1;
+        for (int slot = 0; slot < maxPlayers; ++slot) {
+            if (isActive(players[slot]) && (target < 0 || players[slot].health > players[target].health)) {
+                target = slot;
+            }
+        }
+        return target;
+    }
+
+    // Method to start the next wave, each one brings more of every archetype in from the right of the world
+    void spawnWave() {
+        ++wave;
+        float right = worldBounds.left + worldBounds.width;
+        int groups = static_cast<int>(wave);
+        for (int i = 0; i < 4 + groups * 2; ++i) {
+            swarm.spawn<Chaser>(right - 400.f - (i % 4) * 60.f, 150.f + (i * 137) % 1800, i * 0.3f);
+        }
+        for (int i = 0; i < groups; ++i) {
+            swarm.spawn<Kamikaze>(right - 100.f, 250.f + (i * 311) % 1600);
+            swarm.spawn<Strafer>(right - 300.f, 200.f + (i * 419) % 1600, i * 1.7f);
+        }
+        if (wave % 2 == 0) {
+            swarm.spawn<Turret>(right - 800.f, worldBounds.top + worldBounds.height / 2.f);
+        }
+        if (wave % 3 == 0) {
+            swarm.spawn<Spiral>(right - 1200.f, worldBounds.top + worldBounds.height / 2.f);
+        }
+    }
+
+    // Method to run one tick of a deterministic session, each player's queued inputs are used exactly once like in the float simulation
+    // The world only steps when every connected player has an input waiting, so a player whose inputs are late holds the session up
+    // rather than the world guessing for them, and it catches up by up to maxInputsPerTick steps once they arrive
+    void stepDeterministic() {
+        for (int used = 0; used < maxInputsPerTick; ++used) {
+            PlayerInput inputs[maxPlayers];
+            for (int slot = 0; slot < maxPlayers; ++slot) {
+                if (players[slot].connected && players[slot].queuedCount == 0) {
+                    copyDeterministicState();
+                    return;
+                }
+            }
+            for (int slot = 0; slot < maxPlayers; ++slot) {
+                Player& player = players[slot];
+                if (!player.connected) {
+                    continue;
+                }
+                player.input = player.queued[player.queuedFirst];
+                player.lastInput = player.queuedSequence[player.queuedFirst];
+                player.queuedFirst = (player.queuedFirst + 1) % maxQueuedInputs;
+                --player.queuedCount;
+                inputs[slot] = player.input;
+            }
+            deterministicWorld->step(inputs);
+        }
+        copyDeterministicState();
+    }
+
+    // Method to copy the deterministic world's players, wave and score into the session's own, so the server and the snapshots read them the same way
+    void copyDeterministicState() {
+        for (int slot = 0; slot < maxPlayers; ++slot) {
+            const DeterministicWorld::Player& source = deterministicWorld->getPlayer(slot);
+            Player& player = players[slot];
+            player.x = fixedToFloat(source.x);
+            player.y = fixedToFloat(source.y);
+            player.health = source.health;
+            player.directionX = source.directionX;
+            player.directionY = source.directionY;
+        }
+        wave = deterministicWorld->getWave();
+        score = deterministicWorld->getScore();
+    }
+
+    template <typename Archetype, typename Swarm>
+    static void writeEnemies(NetSnapshot& snapshot, const PositionQuantizer& quantizer, const Swarm& enemySwarm, NetEntityKind kind) {
+        const auto& enemies = enemySwarm.template get<Archetype>();
+        writeEntities(snapshot, quantizer, enemies.x, enemies.y, enemies.id, kind);
+    }
+
+    template <typename Projectiles>
+    static void writeProjectiles(NetSnapshot& snapshot, const PositionQuantizer& quantizer, const Projectiles& projectiles, NetEntityKind kind) {
+        writeEntities(snapshot, quantizer, projectiles.x, projectiles.y, projectiles.id, kind);
+    }
+
+    // Positions in pixels, from the float simulation or the deterministic one
+    static float toPixels(float value) {
+        return value;
+    }
+
+    static float toPixels(Fixed value) {
+        return fixedToFloat(value);
+    }
+
+    // Every storage counts its ids from 1, so the kind goes in the low bits of the replicated id to keep them unique across the session
+    template <typename Position>
+    static void writeEntities(NetSnapshot& snapshot, const PositionQuantizer& quantizer, const std::vector<Position>& x, const std::vector<Position>& y,
+        const std::vector<std::uint32_t>& id, NetEntityKind kind) {
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            snapshot.entities.push_back({ (id[i] << replicatedKindBits) | kind, static_cast<std::uint8_t>(kind),
+                quantizer.quantizeX(toPixels(x[i])), quantizer.quantizeY(toPixels(y[i])) });
+        }
+    }
+
+    const TileCollision& terrain;
+    sf::FloatRect worldBounds;
+    Player players[maxPlayers];
+    EnemySwarm swarm;
+    ProjectileStorage playerBullets;
+    ProjectileStorage enemyBullets;
+    FlowField flowField;
+    std::unique_ptr<DeterministicWorld> deterministicWorld;  // Only made for a deterministic session, it then holds the enemies and bullets
+    std::uint32_t tick;
+    std::uint32_t wave;
+    std::uint32_t score;
+};
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "GameData.h"
+#include "Logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Watches the data directory and reloads the tuning, enemy and level files whenever one of them is saved, so the game can be balanced
+// while it is running. Everything slow happens on the watcher's own thread: waiting for the change, reading and checking the files
+// and building the bullet pattern tables. A set of files that passes the checks is left waiting as one GameData, and the game picks
+// it up with takeUpdate() between two ticks, so a tick never sees half of an old set and half of a new one.
+// On Linux the directory is watched with inotify, everywhere else the files' modification times are checked a few times a second
+class DataWatcher {
+public:
+    // The directory should end with a slash
+    explicit DataWatcher(const std::string& directory)
+        : directory(directory), running(false), hasUpdate(false), reloadCount(0), rejectedCount(0) {
+    }
+
+    ~DataWatcher() {
+        stop();
+    }
+
+    DataWatcher(const DataWatcher&) = delete;
+    DataWatcher& operator=(const DataWatcher&) = delete;
+
+    // Method to load the files for the first time and start watching them, the first load happens straight away so it is
+    // waiting for the first takeUpdate() call. The watch is set up before the first load so a save in between isn't missed
+    void start() {
+        stop();
+        beginWatching();
+        reload();
+        running = true;
+        thread = std::thread(&DataWatcher::run, this);
+    }
+
+    void stop() {
+        running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+#ifdef __linux__
+        if (notify >= 0) {
+            close(notify);
+            notify = -1;
+        }
+#endif
+    }
+
+    // Method for the simulation to pick up the newest set of files, returns nullptr if nothing has changed since the last call
+    // When nothing has changed this is a single atomic load, so it can be called every tick
+    std::shared_ptr<GameData> takeUpdate() {
+        if (!hasUpdate.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(updateMutex);
+        hasUpdate.store(false, std::memory_order_relaxed);
+        return std::move(update);
+    }
+
+    // Number of sets of files that have been loaded and the number that were turned down
+    std::size_t getReloadCount() const {
+        return reloadCount;
+    }
+
+    std::size_t getRejectedCount() const {
+        return rejectedCount;
+    }
+
+private:
+    // Method to load and check every file, a good set replaces any set that is still waiting, a bad one is logged and dropped
+    void reload() {
+        std::shared_ptr<GameData> data = std::make_shared<GameData>();
+        DataError error;
+        if (!loadGameData(directory, *data, error)) {
+            ++rejectedCount;
+            LOG_ERROR("Game data not reloaded, {} line {}: {}", error.file, error.line, error.reason);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(updateMutex);
+            update = std::move(data);
+            hasUpdate.store(true, std::memory_order_release);
+        }
+        ++reloadCount;
+        LOG_INFO("Game data loaded ({} sets so far)", static_cast<unsigned>(reloadCount));
+    }
+
+    // Method to start watching the directory, or if it can't be watched to take the files' stamps to compare against
+    void beginWatching() {
+#ifdef __linux__
+        // Editors often save by writing a new file and renaming it over the old one, so the directory is watched rather than the files
+        notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notify >= 0 && inotify_add_watch(notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) >= 0) {
+            return;
+        }
+        if (notify >= 0) {
+            close(notify);
+            notify = -1;
+        }
+        LOG_WARNING("Can't watch the game data directory with inotify, checking the files for changes instead");
+#endif
+        for (int i = 0; i < gameDataFileCount; ++i) {
+            lastStamps[i] = getStamp(i);
+        }
+    }
+
+    // Method run by the watcher thread, it waits for a data file to change and then reloads all of them
+    void run() {
+#ifdef __linux__
+        if (notify >= 0) {
+            watchWithInotify();
+            return;
+        }
+#endif
+        watchModificationTimes();
+    }
+
+#ifdef __linux__
+    void watchWithInotify() {
+        alignas(inotify_event) char buffer[4096];
+        while (running) {
+            // Wake up regularly to check whether the watcher has been stopped
+            pollfd waiting = { notify, POLLIN, 0 };
+            if (poll(&waiting, 1, 100) <= 0) {
+                continue;
+            }
+
+            bool changed = false;
+            ssize_t length;
+            while ((length = read(notify, buffer, sizeof(buffer))) > 0) {
+                for (char* position = buffer; position < buffer + length; ) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(position);
+                    changed = changed || (event->len > 0 && isDataFile(event->name));
+                    position += sizeof(inotify_event) + event->len;
+                }
+            }
+
+            // One save can be several events, and saving all the files at once even more, so wait for them to settle before reading
+            if (changed) {
+                settle();
+                while (read(notify, buffer, sizeof(buffer)) > 0) {
+                }
+                reload();
+            }
+        }
+    }
+#endif
+
+    void watchModificationTimes() {
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            bool changed = false;
+            for (int i = 0; i < gameDataFileCount; ++i) {
+                FileStamp stamp = getStamp(i);
+                changed = changed || stamp.time != lastStamps[i].time || stamp.size != lastStamps[i].size;
+                lastStamps[i] = stamp;
+            }
+            if (changed) {
+                settle();
+                for (int i = 0; i < gameDataFileCount; ++i) {
+                    lastStamps[i] = getStamp(i);
+                }
+                reload();
+            }
+        }
+    }
+
+    // Method to give an editor a moment to finish writing before the files are read
+    void settle() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    // When a data file was last written and how big it is, the size catches a second save within the same second
+    struct FileStamp {
+        long long time;
+        long long size;
+    };
+
+    // Returns the stamp of a data file, -1 for both if it isn't there
+    FileStamp getStamp(int file) const {
+        struct stat status;
+        if (stat((directory + gameDataFiles[file]).c_str(), &status) != 0) {
+            return { -1, -1 };
+        }
+        return { static_cast<long long>(status.st_mtime), static_cast<long long>(status.st_size) };
+    }
+
+    static bool isDataFile(const char* name) {
+        for (int i = 0; i < gameDataFileCount; ++i) {
+            if (std::strcmp(name, gameDataFiles[i]) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string directory;
+    std::thread thread;
+    std::atomic<bool> running;
+#ifdef __linux__
+    int notify = -1;  // The inotify instance, or -1 when the files' stamps are checked instead
+#endif
+    FileStamp lastStamps[gameDataFileCount];
+
+    // The newest good set of files waiting for the game
+    std::mutex updateMutex;
+    std::shared_ptr<GameData> update;
+    std::atomic<bool> hasUpdate;
+
+    std::atomic<std::size_t> reloadCount;
+    std::atomic<std::size_t> rejectedCount;
+};
@@ -0,0 +1,883 @@
+#pragma once
+
+#include "BulletPattern.h"
+#include "EnemyBehaviours.h"
+#include "FixedPoint.h"
+#include "FlowField.h"
+#include "PlayerInput.h"
+#include "Projectiles.h"
+#include "TileCollision.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+// Deterministic version of the co-op simulation, for lockstep networking and for checking replays
+// It plays by the same rules as CoopSession with the same archetypes and tuning values, but every position, velocity and angle is 16.16 fixed point
+// (see FixedPoint.h), every timer counts whole ticks and the tick rate is fixed, so there is no float maths anywhere in a tick.
+// Two machines, or two builds with different compilers or optimisation levels, given the same inputs end every tick with exactly the same state.
+// The whole state is hashed at the end of every tick, so two runs can compare one number per tick and see the tick they first went different
+
+const int deterministicTickRate = 60;
+
+// Methods to turn tuning values in pixels and seconds into what the deterministic simulation counts in
+// Speeds become fixed point pixels per tick so moving is a single add, and times become whole ticks
+constexpr Fixed perTick(float perSecond) {
+    return toFixed(perSecond / deterministicTickRate);
+}
+
+constexpr int secondsToTicks(float seconds) {
+    return static_cast<int>(seconds * deterministicTickRate + 0.5f);
+}
+
+// Hash of the simulation state, FNV-1a over 32 bit words rather than bytes so it doesn't depend on byte order
+// Arrays are taken two words at a time, which halves the chain of multiplies every word has to wait on
+class StateHash {
+public:
+    StateHash() : value(14695981039346656037ull) {
+    }
+
+    void add(std::uint32_t word) {
+        value = (value ^ word) * 1099511628211ull;
+    }
+
+    void addSigned(std::int32_t word) {
+        add(static_cast<std::uint32_t>(word));
+    }
+
+    template <typename Word>
+    void addAll(const std::vector<Word>& words) {
+        add(static_cast<std::uint32_t>(words.size()));
+        const std::size_t count = words.size();
+        std::size_t i = 0;
+        for (; i + 1 < count; i += 2) {
+            std::uint64_t pair = static_cast<std::uint32_t>(words[i]) | (static_cast<std::uint64_t>(static_cast<std::uint32_t>(words[i + 1])) << 32);
+            value = (value ^ pair) * 1099511628211ull;
+        }
+        if (i < count) {
+            add(static_cast<std::uint32_t>(words[i]));
+        }
+    }
+
+    std::uint64_t get() const {
+        return value;
+    }
+
+private:
+    std::uint64_t value;
+};
+
+// Storage for the deterministic projectiles as a structure of arrays, the same layout as ProjectileStorage in fixed point
+// Velocities are per tick, so moving every projectile is two integer adds each
+class FixedProjectiles {
+public:
+    static constexpr Fixed width = toFixed(ProjectileStorage::width);
+    static constexpr Fixed height = toFixed(ProjectileStorage::height);
+
+    void reserve(std::size_t capacity) {
+        x.reserve(capacity); y.reserve(capacity);
+        previousX.reserve(capacity); previousY.reserve(capacity);
+        velocityX.reserve(capacity); velocityY.reserve(capacity);
+        damage.reserve(capacity);
+        hit.reserve(capacity);
+        id.reserve(capacity);
+    }
+
+    // Method to add this many projectiles to the end of the arrays in one go and return the index of the first one, like ProjectileStorage
+    std::size_t appendBatch(std::size_t count) {
+        std::size_t start = x.size();
+        std::size_t end = start + count;
+        x.resize(end); y.resize(end);
+        previousX.resize(end); previousY.resize(end);
+        velocityX.resize(end); velocityY.resize(end);
+        damage.resize(end);
+        hit.resize(end, 0);
+        id.resize(end);
+        for (std::size_t i = start; i < end; ++i) {
+            id[i] = nextId++;
+        }
+        return start;
+    }
+
+    // Method to fire a single projectile from a centre point along a unit direction, at a speed in pixels per tick
+    void push(Fixed centreX, Fixed centreY, Fixed directionX, Fixed directionY, Fixed speed, int projectileDamage) {
+        std::size_t i = appendBatch(1);
+        x[i] = previousX[i] = centreX - width / 2;
+        y[i] = previousY[i] = centreY - height / 2;
+        velocityX[i] = fixedMultiply(directionX, speed);
+        velocityY[i] = fixedMultiply(directionY, speed);
+        damage[i] = projectileDamage;
+    }
+
+    // Method to move every projectile along its velocity, remembering where it started for the swept collision
+    void update() {
+        Fixed* positionX = x.data();
+        Fixed* positionY = y.data();
+        Fixed* startX = previousX.data();
+        Fixed* startY = previousY.data();
+        const Fixed* moveX = velocityX.data();
+        const Fixed* moveY = velocityY.data();
+        const std::size_t count = x.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            startX[i] = positionX[i];
+            startY[i] = positionY[i];
+            positionX[i] += moveX[i];
+            positionY[i] += moveY[i];
+        }
+    }
+
+    // Method to mark every projectile whose path this tick crosses the target, returns the damage they do in total
+    int hitTarget(const FixedRect& target) {
+        int totalDamage = 0;
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            Fixed hitTime;
+            if (!hit[i] && fixedSweptIntersects(FixedRect{ previousX[i], previousY[i], width, height },
+                x[i] - previousX[i], y[i] - previousY[i], target, hitTime)) {
+                hit[i] = 1;
+                totalDamage += damage[i];
+            }
+        }
+        return totalDamage;
+    }
+
+    // Method to mark every projectile that has left the world or flown into the terrain
+    void hitWorld(const FixedRect& worldBounds, const TileCollision& terrain) {
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            FixedRect bounds{ x[i], y[i], width, height };
+            if (!hit[i] && (!worldBounds.intersects(bounds) || overlapsTerrain(terrain, bounds))) {
+                hit[i] = 1;
+            }
+        }
+    }
+
+    // Method to remove every marked projectile by moving the last one into its place
+    void removeHit() {
+        std::size_t i = 0;
+        while (i < x.size()) {
+            if (!hit[i]) {
+                ++i;
+                continue;
+            }
+            std::size_t last = x.size() - 1;
+            x[i] = x[last]; y[i] = y[last];
+            previousX[i] = previousX[last]; previousY[i] = previousY[last];
+            velocityX[i] = velocityX[last]; velocityY[i] = velocityY[last];
+            damage[i] = damage[last];
+            hit[i] = hit[last];
+            id[i] = id[last];
+            x.pop_back(); y.pop_back();
+            previousX.pop_back(); previousY.pop_back();
+            velocityX.pop_back(); velocityY.pop_back();
+            damage.pop_back();
+            hit.pop_back();
+            id.pop_back();
+        }
+    }
+
+    // Method to add every projectile's state to the hash, the previous positions and hit flags are left out as the next tick overwrites them
+    void addToHash(StateHash& hash) const {
+        hash.addAll(x); hash.addAll(y);
+        hash.addAll(velocityX); hash.addAll(velocityY);
+        hash.addAll(damage);
+        hash.addAll(id);
+        hash.add(nextId);
+    }
+
+    std::size_t size() const {
+        return x.size();
+    }
+
+    void clear() {
+        x.clear(); y.clear();
+        previousX.clear(); previousY.clear();
+        velocityX.clear(); velocityY.clear();
+        damage.clear();
+        hit.clear();
+        id.clear();
+    }
+
+    // Boolean method returning true if the rectangle covers any solid tile, the tiles are found by shifting so it is integer only
+    static bool overlapsTerrain(const TileCollision& terrain, const FixedRect& bounds) {
+        const int tileShift = fixedShift + 5;  // Tiles are 32 pixels
+        return terrain.overlapsSolidTiles(bounds.left >> tileShift, bounds.top >> tileShift,
+            (bounds.left + bounds.width) >> tileShift, (bounds.top + bounds.height) >> tileShift);
+    }
+
+    std::vector<Fixed> x;
+    std::vector<Fixed> y;
+    std::vector<Fixed> previousX;
+    std::vector<Fixed> previousY;
+    std::vector<Fixed> velocityX;  // Pixels per tick
+    std::vector<Fixed> velocityY;
+    std::vector<int> damage;
+    std::vector<std::uint8_t> hit;
+    std::vector<std::uint32_t> id;
+    std::uint32_t nextId = 1;
+};
+
+// A bullet pattern ready to fire into the deterministic projectiles, built from the same PatternDefinition as BulletPattern
+// The tables are worked out with the fixed point sine rather than std::sin, so they are the same on every build
+class FixedPattern {
+public:
+    explicit FixedPattern(const PatternDefinition& definition)
+        : aim(definition.aim), angle(toFixed(definition.angle)), spin(toFixed(definition.spin)),
+        cooldown(secondsToTicks(definition.cooldown)), damage(definition.damage) {
+        const int count = definition.count > 0 ? definition.count : 1;
+        const Fixed arc = toFixed(definition.arc);
+        const Fixed speed = perTick(definition.speed);
+        const Fixed speedVariation = toFixed(definition.speedVariation);
+        cosTable.resize(count);
+        sinTable.resize(count);
+        speedTable.resize(count);
+
+        for (int i = 0; i < count; ++i) {
+            Fixed offset = 0;
+            Fixed across = count > 1 ? fixedDivide(intToFixed(i), intToFixed(count - 1)) : fixedHalf;
+            if (arc >= fixedTwoPi) {
+                offset = static_cast<Fixed>(static_cast<std::int64_t>(fixedTwoPi) * i / count);
+            }
+            else if (count > 1) {
+                offset = fixedMultiply(arc, across - fixedHalf);
+            }
+            cosTable[i] = fixedCos(offset);
+            sinTable[i] = fixedSin(offset);
+            speedTable[i] = fixedMultiply(speed, fixedOne + fixedMultiply(speedVariation, fixedSin(fixedMultiply(across, fixedTwoPi))));
+        }
+    }
+
+    // Ticks to wait between volleys
+    int getCooldown() const {
+        return cooldown;
+    }
+
+    // Method to fire one volley from a centre point, aimX and aimY are the unit direction to the player
+    // The phase is the shooter's own spin for rotating patterns, it is moved on by this volley
+    void fire(FixedProjectiles& projectiles, Fixed centreX, Fixed centreY, Fixed aimX, Fixed aimY, Fixed& phase) const {
+        Fixed rotateCos = aimX;
+        Fixed rotateSin = aimY;
+        if (aim != PatternAim::AtPlayer) {
+            Fixed baseAngle = angle;
+            if (aim == PatternAim::Rotating) {
+                baseAngle += phase;
+                phase = fixedWrapAngle(phase + spin);
+            }
+            rotateCos = fixedCos(baseAngle);
+            rotateSin = fixedSin(baseAngle);
+        }
+
+        const Fixed startX = centreX - FixedProjectiles::width / 2;
+        const Fixed startY = centreY - FixedProjectiles::height / 2;
+        const std::size_t count = cosTable.size();
+        const std::size_t first = projectiles.appendBatch(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            projectiles.x[first + i] = projectiles.previousX[first + i] = startX;
+            projectiles.y[first + i] = projectiles.previousY[first + i] = startY;
+            projectiles.velocityX[first + i] = fixedMultiply(fixedMultiply(cosTable[i], rotateCos) - fixedMultiply(sinTable[i], rotateSin), speedTable[i]);
+            projectiles.velocityY[first + i] = fixedMultiply(fixedMultiply(cosTable[i], rotateSin) + fixedMultiply(sinTable[i], rotateCos), speedTable[i]);
+            projectiles.damage[first + i] = damage;
+        }
+    }
+
+private:
+    PatternAim aim;
+    Fixed angle;
+    Fixed spin;
+    int cooldown;
+    int damage;
+    std::vector<Fixed> cosTable;
+    std::vector<Fixed> sinTable;
+    std::vector<Fixed> speedTable;  // Pixels per tick
+};
+
+// Everything a fixed point kernel needs to know about the world for one tick, the same as BehaviourContext
+struct FixedContext {
+    Fixed playerX;  // Centre of the player
+    Fixed playerY;
+    FixedRect playerBounds;
+    const FlowField* flowField;
+    FixedProjectiles* projectiles;
+    int playerDamage;
+};
+
+// Storage for every enemy of one archetype in the deterministic simulation, the same layout as BehaviourArrays
+struct FixedEnemyArrays {
+    std::vector<Fixed> x;
+    std::vector<Fixed> y;
+    std::vector<Fixed> velocityX;  // Pixels per tick
+    std::vector<Fixed> velocityY;
+    std::vector<int> timer;        // Ticks left until the next shot
+    std::vector<Fixed> phase;      // Radians, kept between 0 and 2 pi
+    std::vector<int> health;
+    std::vector<std::uint32_t> id;
+    std::uint32_t nextId = 1;
+
+    std::size_t size() const {
+        return x.size();
+    }
+
+    void add(Fixed spawnX, Fixed spawnY, int spawnHealth, int spawnTimer, Fixed spawnPhase) {
+        x.push_back(spawnX);
+        y.push_back(spawnY);
+        velocityX.push_back(0);
+        velocityY.push_back(0);
+        timer.push_back(spawnTimer);
+        phase.push_back(spawnPhase);
+        health.push_back(spawnHealth);
+        id.push_back(nextId++);
+    }
+
+    // Method to remove every enemy with no health left by swapping the last one in, returns how many were removed
+    std::size_t removeDead() {
+        std::size_t removed = 0;
+        std::size_t i = 0;
+        while (i < x.size()) {
+            if (health[i] > 0) {
+                ++i;
+                continue;
+            }
+            std::size_t last = x.size() - 1;
+            x[i] = x[last]; y[i] = y[last];
+            velocityX[i] = velocityX[last]; velocityY[i] = velocityY[last];
+            timer[i] = timer[last]; phase[i] = phase[last];
+            health[i] = health[last];
+            id[i] = id[last];
+            x.pop_back(); y.pop_back();
+            velocityX.pop_back(); velocityY.pop_back();
+            timer.pop_back(); phase.pop_back();
+            health.pop_back();
+            id.pop_back();
+            ++removed;
+        }
+        return removed;
+    }
+
+    void addToHash(StateHash& hash) const {
+        hash.addAll(x); hash.addAll(y);
+        hash.addAll(velocityX); hash.addAll(velocityY);
+        hash.addAll(timer); hash.addAll(phase);
+        hash.addAll(health);
+        hash.addAll(id);
+        hash.add(nextId);
+    }
+
+    void clear() {
+        x.clear(); y.clear();
+        velocityX.clear(); velocityY.clear();
+        timer.clear(); phase.clear();
+        health.clear();
+        id.clear();
+    }
+};
+
+// Each archetype's fixed point kernel, the same behaviour as its BehaviourKernel with the tuning values taken from there
+template <typename Archetype>
+struct FixedKernel;
+
+// Shared passes for the fixed point kernels
+
+inline void countDownTicks(FixedEnemyArrays& enemies) {
+    int* timer = enemies.timer.data();
+    const std::size_t count = enemies.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        timer[i] -= 1;
+    }
+}
+
+inline void integrateVelocities(FixedEnemyArrays& enemies) {
+    Fixed* x = enemies.x.data();
+    Fixed* y = enemies.y.data();
+    const Fixed* velocityX = enemies.velocityX.data();
+    const Fixed* velocityY = enemies.velocityY.data();
+    const std::size_t count = enemies.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        x[i] += velocityX[i];
+        y[i] += velocityY[i];
+    }
+}
+
+// Method to point every enemy's velocity straight at the player, an enemy right on the player's centre stops
+inline void steerAtPlayer(FixedEnemyArrays& enemies, const FixedContext& context, Fixed halfSize, Fixed speed) {
+    const Fixed* x = enemies.x.data();
+    const Fixed* y = enemies.y.data();
+    Fixed* velocityX = enemies.velocityX.data();
+    Fixed* velocityY = enemies.velocityY.data();
+    const std::size_t count = enemies.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        Fixed directionX = 0;
+        Fixed directionY = 0;
+        fixedNormalize(context.playerX - (x[i] + halfSize), context.playerY - (y[i] + halfSize), directionX, directionY);
+        velocityX[i] = fixedMultiply(directionX, speed);
+        velocityY[i] = fixedMultiply(directionY, speed);
+    }
+}
+
+inline void fireAimedShots(FixedEnemyArrays& enemies, FixedContext& context, Fixed halfSize, int cooldown, Fixed shotSpeed, int damage) {
+    for (std::size_t i = 0; i < enemies.size(); ++i) {
+        if (enemies.timer[i] > 0) {
+            continue;
+        }
+        enemies.timer[i] += cooldown;
+        Fixed originX = enemies.x[i] + halfSize;
+        Fixed originY = enemies.y[i] + halfSize;
+        Fixed directionX;
+        Fixed directionY;
+        if (fixedNormalize(context.playerX - originX, context.playerY - originY, directionX, directionY)) {
+            context.projectiles->push(originX, originY, directionX, directionY, shotSpeed, damage);
+        }
+    }
+}
+
+inline bool touchesPlayer(const FixedContext& context, Fixed x, Fixed y, Fixed size) {
+    return context.playerBounds.intersects(FixedRect{ x, y, size, size });
+}
+
+template <>
+struct FixedKernel<Chaser> {
+    typedef BehaviourKernel<Chaser> Tuning;
+
+    static void update(FixedEnemyArrays& enemies, FixedContext& context) {
+        const Fixed size = toFixed(Tuning::size);
+        const Fixed speed = perTick(Tuning::speed);
+        const Fixed diagonalSpeed = fixedMultiply(speed, 46341);  // Speed times 1 / sqrt(2)
+        steerAtPlayer(enemies, context, size / 2, speed);
+
+        // The flow field's eight directions at the chaser's speed, the ninth is for cells with no direction where the steering is kept
+        const Fixed directionX[8] = { speed, diagonalSpeed, 0, -diagonalSpeed, -speed, -diagonalSpeed, 0, diagonalSpeed };
+        const Fixed directionY[8] = { 0, diagonalSpeed, speed, diagonalSpeed, 0, -diagonalSpeed, -speed, -diagonalSpeed };
+        const std::size_t count = enemies.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            // The field is sampled at the whole pixel, which converts to a float exactly so the lookup is the same everywhere
+            int direction = context.flowField->sampleDirection(sf::Vector2f(static_cast<float>(fixedFloor(enemies.x[i] + size / 2)),
+                static_cast<float>(fixedFloor(enemies.y[i] + size / 2))));
+            if (direction < 8) {
+                enemies.velocityX[i] = directionX[direction];
+                enemies.velocityY[i] = directionY[direction];
+            }
+        }
+        integrateVelocities(enemies);
+        countDownTicks(enemies);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (enemies.timer[i] <= 0 && touchesPlayer(context, enemies.x[i], enemies.y[i], size)) {
+                enemies.timer[i] = secondsToTicks(Tuning::contactCooldown);
+                context.playerDamage += Tuning::contactDamage;
+            }
+        }
+    }
+};
+
+template <>
+struct FixedKernel<Strafer> {
+    typedef BehaviourKernel<Strafer> Tuning;
+
+    static void update(FixedEnemyArrays& enemies, FixedContext& context) {
+        const Fixed size = toFixed(Tuning::size);
+        const Fixed sweepStep = perTick(Tuning::sweepRate);
+        const Fixed approach = perTick(Tuning::approachSpeed);
+        const Fixed goalX = context.playerX + toFixed(Tuning::holdDistance);
+        const Fixed sweepRange = toFixed(Tuning::sweepRange);
+        const std::size_t count = enemies.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            enemies.phase[i] = fixedWrapAngle(enemies.phase[i] + sweepStep);
+            Fixed goalY = context.playerY + fixedMultiply(fixedSin(enemies.phase[i]), sweepRange);
+            enemies.x[i] += fixedMultiply(goalX - enemies.x[i], approach);
+            enemies.y[i] += fixedMultiply(goalY - enemies.y[i], approach);
+        }
+        countDownTicks(enemies);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (enemies.timer[i] <= 0) {
+                enemies.timer[i] += secondsToTicks(Tuning::cooldown);
+                context.projectiles->push(enemies.x[i], enemies.y[i] + size / 2, -fixedOne, 0, perTick(Tuning::shotSpeed), Tuning::damage);
+            }
+        }
+    }
+};
+
+template <>
+struct FixedKernel<Kamikaze> {
+    typedef BehaviourKernel<Kamikaze> Tuning;
+
+    static void update(FixedEnemyArrays& enemies, FixedContext& context) {
+        const Fixed size = toFixed(Tuning::size);
+        steerAtPlayer(enemies, context, size / 2, perTick(Tuning::speed));
+        integrateVelocities(enemies);
+
+        for (std::size_t i = 0; i < enemies.size(); ++i) {
+            if (touchesPlayer(context, enemies.x[i], enemies.y[i], size)) {
+                context.playerDamage += Tuning::contactDamage;
+                enemies.health[i] = 0;
+            }
+        }
+    }
+};
+
+template <>
+struct FixedKernel<Turret> {
+    typedef BehaviourKernel<Turret> Tuning;
+
+    static void update(FixedEnemyArrays& enemies, FixedContext& context) {
+        countDownTicks(enemies);
+        fireAimedShots(enemies, context, toFixed(Tuning::size) / 2, secondsToTicks(Tuning::cooldown), perTick(Tuning::shotSpeed), Tuning::damage);
+    }
+};
+
+template <>
+struct FixedKernel<Spiral> {
+    typedef BehaviourKernel<Spiral> Tuning;
+
+    static void update(FixedEnemyArrays& enemies, FixedContext& context) {
+        static const FixedPattern volley(Tuning::pattern().getDefinition());
+        const Fixed size = toFixed(Tuning::size);
+        steerAtPlayer(enemies, context, size / 2, perTick(Tuning::speed));
+        integrateVelocities(enemies);
+        countDownTicks(enemies);
+
+        for (std::size_t i = 0; i < enemies.size(); ++i) {
+            if (enemies.timer[i] <= 0) {
+                enemies.timer[i] += volley.getCooldown();
+                volley.fire(*context.projectiles, enemies.x[i] + size / 2, enemies.y[i] + size / 2, fixedOne, 0, enemies.phase[i]);
+            }
+        }
+    }
+};
+
+template <typename Archetype>
+struct FixedEnemySet {
+    FixedEnemyArrays enemies;
+};
+
+// Every archetype enemy in the deterministic simulation, the fixed point version of EnemySwarm
+class FixedSwarm {
+public:
+    // Method to add an enemy, the first shot is staggered by the fraction of the phase like EnemySwarm::spawn
+    template <typename Archetype>
+    void spawn(Fixed x, Fixed y, Fixed phase = 0) {
+        int timer = secondsToTicks(0.5f) + static_cast<int>((static_cast<std::int64_t>(phase & (fixedOne - 1)) * deterministicTickRate) >> fixedShift);
+        get<Archetype>().add(x, y, BehaviourKernel<Archetype>::health, timer, fixedWrapAngle(phase));
+    }
+
+    template <typename Archetype>
+    FixedEnemyArrays& get() {
+        return std::get<FixedEnemySet<Archetype>>(sets).enemies;
+    }
+
+    template <typename Archetype>
+    const FixedEnemyArrays& get() const {
+        return std::get<FixedEnemySet<Archetype>>(sets).enemies;
+    }
+
+    // Method to run every archetype's kernel for one tick, returns how much contact damage the player took
+    int update(const FixedRect& playerBounds, const FlowField& flowField, FixedProjectiles& projectiles) {
+        FixedContext context;
+        context.playerX = playerBounds.left + playerBounds.width / 2;
+        context.playerY = playerBounds.top + playerBounds.height / 2;
+        context.playerBounds = playerBounds;
+        context.flowField = &flowField;
+        context.projectiles = &projectiles;
+        context.playerDamage = 0;
+
+        FixedKernel<Chaser>::update(get<Chaser>(), context);
+        FixedKernel<Strafer>::update(get<Strafer>(), context);
+        FixedKernel<Kamikaze>::update(get<Kamikaze>(), context);
+        FixedKernel<Turret>::update(get<Turret>(), context);
+        FixedKernel<Spiral>::update(get<Spiral>(), context);
+        return context.playerDamage;
+    }
+
+    // Method to find the first enemy a bullet's path hits this tick if it is sooner than earliestHit, returns a pointer to its health or nullptr
+    int* findSweptHit(const FixedRect& bulletStart, Fixed displacementX, Fixed displacementY, Fixed& earliestHit) {
+        int* hit = nullptr;
+        findSweptHit<Chaser>(bulletStart, displacementX, displacementY, earliestHit, hit);
+        findSweptHit<Strafer>(bulletStart, displacementX, displacementY, earliestHit, hit);
+        findSweptHit<Kamikaze>(bulletStart, displacementX, displacementY, earliestHit, hit);
+        findSweptHit<Turret>(bulletStart, displacementX, displacementY, earliestHit, hit);
+        findSweptHit<Spiral>(bulletStart, displacementX, displacementY, earliestHit, hit);
+        return hit;
+    }
+
+    std::size_t removeDead() {
+        return get<Chaser>().removeDead() + get<Strafer>().removeDead() + get<Kamikaze>().removeDead()
+            + get<Turret>().removeDead() + get<Spiral>().removeDead();
+    }
+
+    void addToHash(StateHash& hash) const {
+        get<Chaser>().addToHash(hash);
+        get<Strafer>().addToHash(hash);
+        get<Kamikaze>().addToHash(hash);
+        get<Turret>().addToHash(hash);
+        get<Spiral>().addToHash(hash);
+    }
+
+    std::size_t size() const {
+        return get<Chaser>().size() + get<Strafer>().size() + get<Kamikaze>().size() + get<Turret>().size() + get<Spiral>().size();
+    }
+
+    void clear() {
+        get<Chaser>().clear();
+        get<Strafer>().clear();
+        get<Kamikaze>().clear();
+        get<Turret>().clear();
+        get<Spiral>().clear();
+    }
+
+private:
+    template <typename Archetype>
+    void findSweptHit(const FixedRect& bulletStart, Fixed displacementX, Fixed displacementY, Fixed& earliestHit, int*& hit) {
+        FixedEnemyArrays& enemies = get<Archetype>();
+        const Fixed size = toFixed(BehaviourKernel<Archetype>::size);
+        for (std::size_t i = 0; i < enemies.size(); ++i) {
+            Fixed hitTime;
+            if (fixedSweptIntersects(bulletStart, displacementX, displacementY, FixedRect{ enemies.x[i], enemies.y[i], size, size }, hitTime)
+                && hitTime < earliestHit) {
+                earliestHit = hitTime;
+                hit = &enemies.health[i];
+            }
+        }
+    }
+
+    std::tuple<FixedEnemySet<Chaser>, FixedEnemySet<Strafer>, FixedEnemySet<Kamikaze>, FixedEnemySet<Turret>, FixedEnemySet<Spiral>> sets;
+};
+
+// The deterministic co-op game, up to two players against waves of archetype enemies, stepped one tick at a time with every player's input
+// It can be copied, so a lockstep client can keep the last confirmed state and roll forward from it
+class DeterministicWorld {
+public:
+    static const int maxPlayers = 2;
+
+    // A player, the same rules as CoopSession::Player with every time in ticks
+    struct Player {
+        static constexpr Fixed size = toFixed(50.f);
+        static constexpr Fixed speed = perTick(300.f);
+        static constexpr Fixed bulletSpeed = perTick(1200.f);
+        static const int fireCooldown = 6;    // Ticks, a tenth of a second
+        static const int respawnTime = 180;   // Ticks, three seconds
+        static const int maxHealth = 100;
+        static const int bulletDamage = 5;
+
+        bool connected = false;
+        Fixed x = 0;
+        Fixed y = 0;
+        int health = 0;
+        int directionX = 0;
+        int directionY = 0;
+        int fireTimer = 0;
+        int respawnTimer = 0;
+
+        FixedRect getBounds() const {
+            return FixedRect{ x, y, size, size };
+        }
+    };
+
+    // Constructor with the terrain, which can be shared, and the world in whole pixels
+    DeterministicWorld(const TileCollision& terrain, const sf::IntRect& worldArea)
+        : terrain(&terrain), worldArea(worldArea), tick(0), wave(0), score(0), stateHash(0) {
+        worldBounds = FixedRect{ intToFixed(worldArea.left), intToFixed(worldArea.top), intToFixed(worldArea.width), intToFixed(worldArea.height) };
+        playerBullets.reserve(512);
+        enemyBullets.reserve(4096);
+        spawnWave();
+        stateHash = hashState();
+    }
+
+    // Method to add a player to the first free slot, returns the slot or -1 if the world is full
+    int addPlayer() {
+        for (int slot = 0; slot < maxPlayers; ++slot) {
+            if (!players[slot].connected) {
+                players[slot] = Player();
+                players[slot].connected = true;
+                respawn(slot);
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    void removePlayer(int slot) {
+        players[slot].connected = false;
+    }
+
+    // Method to run one tick with every player's input for it, indexed by slot, in the same order as CoopSession::step
+    void step(const PlayerInput (&inputs)[maxPlayers]) {
+        ++tick;
+
+        playerBullets.update();
+        playerBullets.hitWorld(worldBounds, *terrain);
+        enemyBullets.update();
+        enemyBullets.hitWorld(worldBounds, *terrain);
+
+        for (int slot = 0; slot < maxPlayers; ++slot) {
+            updatePlayer(slot, inputs[slot]);
+        }
+
+        for (Player& player : players) {
+            if (isActive(player)) {
+                damage(player, enemyBullets.hitTarget(player.getBounds()));
+            }
+        }
+        enemyBullets.removeHit();
+
+        for (std::size_t i = 0; i < playerBullets.size(); ++i) {
+            Fixed earliestHit = 2 * fixedOne;
+            FixedRect start{ playerBullets.previousX[i], playerBullets.previousY[i], FixedProjectiles::width, FixedProjectiles::height };
+            if (int* health = swarm.findSweptHit(start, playerBullets.x[i] - playerBullets.previousX[i], playerBullets.y[i] - playerBullets.previousY[i], earliestHit)) {
+                *health -= playerBullets.damage[i];
+                playerBullets.hit[i] = 1;
+            }
+        }
+        playerBullets.removeHit();
+        score += static_cast<std::uint32_t>(swarm.removeDead());
+
+        // The flow field is pointed at the target's whole pixel, which converts to a float exactly
+        int target = findTarget();
+        if (target >= 0) {
+            Player& player = players[target];
+            flowField.update(sf::Vector2f(static_cast<float>(fixedFloor(player.x + Player::size / 2)), static_cast<float>(fixedFloor(player.y + Player::size / 2))),
+                *terrain, sf::FloatRect(worldArea));
+            damage(player, swarm.update(player.getBounds(), flowField, enemyBullets));
+        }
+
+        if (swarm.size() == 0) {
+            spawnWave();
+        }
+        stateHash = hashState();
+    }
+
+    // Returns the hash of the whole state at the end of the last tick, two runs that agree on this agree on everything
+    std::uint64_t getStateHash() const {
+        return stateHash;
+    }
+
+    std::uint32_t getTick() const { return tick; }
+    std::uint32_t getWave() const { return wave; }
+    std::uint32_t getScore() const { return score; }
+    const Player& getPlayer(int slot) const { return players[slot]; }
+    const FixedSwarm& getSwarm() const { return swarm; }
+    const FixedProjectiles& getPlayerBullets() const { return playerBullets; }
+    const FixedProjectiles& getEnemyBullets() const { return enemyBullets; }
+
+private:
+    static bool isActive(const Player& player) {
+        return player.connected && player.health > 0;
+    }
+
+    void updatePlayer(int slot, const PlayerInput& input) {
+        Player& player = players[slot];
+        if (!player.connected) {
+            return;
+        }
+        if (player.health <= 0) {
+            if (--player.respawnTimer <= 0) {
+                respawn(slot);
+            }
+            return;
+        }
+
+        if (input.up || input.down || input.left || input.right) {
+            player.directionX = input.up || input.down ? 0 : (input.left ? -1 : 1);
+            player.directionY = input.up ? -1 : (input.down ? 1 : 0);
+        }
+        Fixed previousX = player.x;
+        Fixed previousY = player.y;
+        player.x = std::max(worldBounds.left, std::min(player.x + player.directionX * Player::speed, worldBounds.left + worldBounds.width - Player::size));
+        player.y = std::max(worldBounds.top, std::min(player.y + player.directionY * Player::speed, worldBounds.top + worldBounds.height - Player::size));
+        if (FixedProjectiles::overlapsTerrain(*terrain, player.getBounds())) {
+            player.x = previousX;
+            player.y = previousY;
+        }
+
+        --player.fireTimer;
+        if (input.fire && player.fireTimer <= 0) {
+            player.fireTimer = Player::fireCooldown;
+            playerBullets.push(player.x + Player::size, player.y + Player::size / 2, fixedOne, 0, Player::bulletSpeed, Player::bulletDamage);
+        }
+    }
+
+    void respawn(int slot) {
+        Player& player = players[slot];
+        player.x = intToFixed(200);
+        player.y = intToFixed(300 + slot * 300);
+        player.health = Player::maxHealth;
+        player.directionX = 0;
+        player.directionY = 0;
+        player.fireTimer = 0;
+    }
+
+    void damage(Player& player, int amount) {
+        if (amount <= 0 || player.health <= 0) {
+            return;
+        }
+        player.health = std::max(0, player.health - amount);
+        if (player.health == 0) {
+            player.respawnTimer = Player::respawnTime;
+        }
+    }
+
+    int findTarget() const {
+        int target = -1;
+        for (int slot = 0; slot < maxPlayers; ++slot) {
+            if (isActive(players[slot]) && (target < 0 || players[slot].health > players[target].health)) {
+                target = slot;
+            }
+        }
+        return target;
+    }
+
+    // Method to start the next wave, the same waves as CoopSession::spawnWave
+    void spawnWave() {
+        ++wave;
+        const int right = worldArea.left + worldArea.width;
+        const int middle = worldArea.top + worldArea.height / 2;
+        int groups = static_cast<int>(wave);
+        for (int i = 0; i < 4 + groups * 2; ++i) {
+            swarm.spawn<Chaser>(intToFixed(right - 400 - (i % 4) * 60), intToFixed(150 + (i * 137) % 1800), i * toFixed(0.3f));
+        }
+        for (int i = 0; i < groups; ++i) {
+            swarm.spawn<Kamikaze>(intToFixed(right - 100), intToFixed(250 + (i * 311) % 1600));
+            swarm.spawn<Strafer>(intToFixed(right - 300), intToFixed(200 + (i * 419) % 1600), i * toFixed(1.7f));
+        }
+        if (wave % 2 == 0) {
+            swarm.spawn<Turret>(intToFixed(right - 800), intToFixed(middle));
+        }
+        if (wave % 3 == 0) {
+            swarm.spawn<Spiral>(intToFixed(right - 1200), intToFixed(middle));
+        }
+    }
+
+    std::uint64_t hashState() const {
+        StateHash hash;
+        hash.add(tick);
+        hash.add(wave);
+        hash.add(score);
+        for (const Player& player : players) {
+            hash.add(player.connected ? 1u : 0u);
+            hash.addSigned(player.x);
+            hash.addSigned(player.y);
+            hash.addSigned(player.health);
+            hash.addSigned(player.directionX);
+            hash.addSigned(player.directionY);
+            hash.addSigned(player.fireTimer);
+            hash.addSigned(player.respawnTimer);
+        }
+        swarm.addToHash(hash);
+        playerBullets.addToHash(hash);
+        enemyBullets.addToHash(hash);
+        return hash.get();
+    }
+
+    const TileCollision* terrain;  // A pointer rather than a reference so the world can be copied and assigned
+    sf::IntRect worldArea;
+    FixedRect worldBounds;
+    Player players[maxPlayers];
+    FixedSwarm swarm;
+    FixedProjectiles playerBullets;
+    FixedProjectiles enemyBullets;
+    FlowField flowField;
+    std::uint32_t tick;
+    std::uint32_t wave;
+    std::uint32_t score;
+    std::uint64_t stateHash;
+};
@@ -0,0 +1,162 @@
+#include "DisplayMode.h"
+#include "Logger.h"
+
+DisplayModeSwitcher::DisplayModeSwitcher(sf::RenderWindow& window, const std::string& title, const sf::Vector2u& windowedSize, bool verticalSync)
+    : window(window), title(title), windowedSize(windowedSize), windowedPosition(window.getPosition()), windowedStyle(0),
+    verticalSync(verticalSync), fullscreen(false), canSwitchInPlace(true), switchPending(false) {
+}
+
+sf::Time DisplayModeSwitcher::setFullscreen(bool enable) {
+    if (enable == fullscreen) {
+        return sf::Time::Zero;
+    }
+
+    if (switchPending) {
+        completePendingSwitch();  // Switching back before the window manager has caught up, so settle the last switch first
+    }
+
+    switchClock.restart();
+    if (enable) {
+        windowedPosition = window.getPosition();
+    }
+
+    bool inPlace = canSwitchInPlace && switchInPlace(enable);
+    if (!inPlace) {
+        canSwitchInPlace = false;
+        switchPending = false;
+        recreate(enable);
+    }
+    fullscreen = enable;
+
+    if (switchPending) {
+        return sf::Time::Zero;  // Finished by handleEvent when the window manager resizes the window
+    }
+    finishSwitch(inPlace);
+    return lastSwitchTime;
+}
+
+void DisplayModeSwitcher::handleEvent(const sf::Event& event) {
+    if (switchPending && event.type == sf::Event::Resized) {
+        completePendingSwitch();
+    }
+}
+
+void DisplayModeSwitcher::update() {
+    // A window manager that ignores the request, or a window already the right size, never sends a resize
+    if (switchPending && switchClock.getElapsedTime() > sf::seconds(2.f)) {
+        LOG_WARNING("The window manager didn't resize the window for the switch to {}", fullscreen ? "fullscreen" : "windowed");
+        completePendingSwitch();
+    }
+}
+
+void DisplayModeSwitcher::completePendingSwitch() {
+    switchPending = false;
+    if (!fullscreen) {
+        window.setSize(windowedSize);
+        window.setPosition(windowedPosition);
+    }
+    finishSwitch(true);
+}
+
+void DisplayModeSwitcher::finishSwitch(bool inPlace) {
+    lastSwitchTime = switchClock.getElapsedTime();
+    LOG_INFO("Switched to {} in {} ms ({})", fullscreen ? "fullscreen" : "windowed", lastSwitchTime.asMicroseconds() / 1000.0,
+        inPlace ? "window and context kept" : "window recreated");
+}
+
+void DisplayModeSwitcher::recreate(bool enable) {
+    // The same context settings as the old window, so the new context shares with the one textures and fonts were made in
+    sf::ContextSettings settings = window.getSettings();
+    if (enable) {
+        window.create(sf::VideoMode::getDesktopMode(), title, sf::Style::None, settings);
+        window.setPosition(sf::Vector2i(0, 0));
+    }
+    else {
+        window.create(sf::VideoMode(windowedSize.x, windowedSize.y), title, sf::Style::Default, settings);
+        window.setPosition(windowedPosition);
+    }
+    window.setVerticalSyncEnabled(verticalSync);  // A new window starts with its own vsync setting
+}
+
+// The platform headers are only included from here down, they define macros (such as None and min) that clash with SFML and the game
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) && !defined(__APPLE__)
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#endif
+
+#if defined(_WIN32)
+
+bool DisplayModeSwitcher::switchInPlace(bool enable) {
+    HWND handle = window.getSystemHandle();
+    if (handle == nullptr) {
+        return false;
+    }
+
+    if (enable) {
+        // Remember the window's style, then make it a borderless popup covering the monitor it is on
+        MONITORINFO monitor = {};
+        monitor.cbSize = sizeof(monitor);
+        if (!GetMonitorInfo(MonitorFromWindow(handle, MONITOR_DEFAULTTONEAREST), &monitor)) {
+            return false;
+        }
+        windowedStyle = static_cast<std::intptr_t>(GetWindowLongPtr(handle, GWL_STYLE));
+        SetWindowLongPtr(handle, GWL_STYLE, static_cast<LONG_PTR>((windowedStyle & ~WS_OVERLAPPEDWINDOW) | WS_POPUP));
+        return SetWindowPos(handle, HWND_TOP, monitor.rcMonitor.left, monitor.rcMonitor.top,
+            monitor.rcMonitor.right - monitor.rcMonitor.left, monitor.rcMonitor.bottom - monitor.rcMonitor.top,
+            SWP_FRAMECHANGED | SWP_NOOWNERZORDER | SWP_SHOWWINDOW) != FALSE;
+    }
+
+    // Put the old style back and size the window so its inside is the windowed size again
+    SetWindowLongPtr(handle, GWL_STYLE, static_cast<LONG_PTR>(windowedStyle));
+    RECT area = { 0, 0, static_cast<LONG>(windowedSize.x), static_cast<LONG>(windowedSize.y) };
+    AdjustWindowRect(&area, static_cast<DWORD>(windowedStyle), FALSE);
+    return SetWindowPos(handle, nullptr, windowedPosition.x, windowedPosition.y, area.right - area.left, area.bottom - area.top,
+        SWP_FRAMECHANGED | SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_SHOWWINDOW) != FALSE;
+}
+
+#elif defined(__unix__) && !defined(__APPLE__)
+
+bool DisplayModeSwitcher::switchInPlace(bool enable) {
+    Display* display = XOpenDisplay(nullptr);
+    if (display == nullptr) {
+        return false;
+    }
+
+    // Ask the window manager to add or remove the fullscreen state, this only works with a window manager that supports it
+    Atom state = XInternAtom(display, "_NET_WM_STATE", True);
+    Atom fullscreenState = XInternAtom(display, "_NET_WM_STATE_FULLSCREEN", True);
+    if (state == None || fullscreenState == None) {
+        XCloseDisplay(display);
+        return false;
+    }
+
+    XEvent event = {};
+    event.xclient.type = ClientMessage;
+    event.xclient.window = static_cast<::Window>(window.getSystemHandle());
+    event.xclient.message_type = state;
+    event.xclient.format = 32;
+    event.xclient.data.l[0] = enable ? 1 : 0;  // _NET_WM_STATE_ADD or _NET_WM_STATE_REMOVE
+    event.xclient.data.l[1] = static_cast<long>(fullscreenState);
+    event.xclient.data.l[2] = 0;
+    event.xclient.data.l[3] = 1;  // The request comes from a normal application
+    Status sent = XSendEvent(display, DefaultRootWindow(display), False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+    XFlush(display);
+    XCloseDisplay(display);
+
+    // The window manager changes the window some time later, the switch is finished when its resize arrives
+    switchPending = sent != 0;
+    return sent != 0;
+}
+
+#else
+
+bool DisplayModeSwitcher::switchInPlace(bool) {
+    return false;  // No in place switch on this platform, the window is recreated instead
+}
+
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+
+// Switches the game window between windowed and fullscreen without throwing away the window
+// Fullscreen is a borderless window covering the whole monitor rather than an exclusive video mode, so the monitor never has to change mode.
+// Where the platform allows it the existing window's style and size are changed in place, which keeps the window's OpenGL context,
+// so nothing drawn with it has to be set up again and the switch takes a few milliseconds instead of hundreds.
+// If the window can't be changed in place it is recreated with the same context settings. Textures, fonts and shaders live in SFML's
+// shared context rather than the window's, so they stay loaded either way and only the window's own context is rebuilt.
+// On X11 the switch is a request to the window manager, which resizes the window in its own time, so the switch only finishes (and is
+// timed) when the resize comes back as an event. Pass every window event to handleEvent and call update once a frame for that
+class DisplayModeSwitcher {
+public:
+    // Constructor with the window to switch, its title and size for windowed mode, and whether vsync should stay on after switching
+    DisplayModeSwitcher(sf::RenderWindow& window, const std::string& title, const sf::Vector2u& windowedSize, bool verticalSync);
+
+    bool isFullscreen() const {
+        return fullscreen;
+    }
+
+    // Method to switch to fullscreen or back to a window, returns how long the switch took
+    // Returns zero if the switch is waiting on the window manager, getLastSwitchTime has the time once it has finished
+    sf::Time setFullscreen(bool enable);
+
+    // Method to switch to whichever mode the window isn't in, returns how long the switch took
+    sf::Time toggle() {
+        return setFullscreen(!fullscreen);
+    }
+
+    // Method to finish a switch that is waiting on the window manager once the window's resize arrives
+    void handleEvent(const sf::Event& event);
+
+    // Method to finish a switch anyway if the window manager never resized the window, called once a frame
+    void update();
+
+    // Returns true while a switch is waiting on the window manager
+    bool isSwitching() const {
+        return switchPending;
+    }
+
+    // Returns how long the last switch took
+    sf::Time getLastSwitchTime() const {
+        return lastSwitchTime;
+    }
+
+private:
+    // Method to change the existing window's style and size in place, returns false if the platform can't do it
+    bool switchInPlace(bool enable);
+
+    // Method to make a new window in the requested mode, used when the window can't be changed in place
+    void recreate(bool enable);
+
+    // Method to finish a switch that was waiting on the window manager, the windowed size and position are only put back once it has
+    // taken the fullscreen state off, otherwise it would undo them
+    void completePendingSwitch();
+
+    // Method to stop the clock on a switch and log how long it took
+    void finishSwitch(bool inPlace);
+
+    sf::RenderWindow& window;
+    std::string title;
+    sf::Vector2u windowedSize;
+    sf::Vector2i windowedPosition;  // Where the window was before going fullscreen, so it goes back to the same place
+    std::intptr_t windowedStyle;    // The platform's own style flags for the window before going fullscreen
+    bool verticalSync;
+    bool fullscreen;
+    bool canSwitchInPlace;          // Cleared the first time changing the window in place fails, so it isn't tried again
+    bool switchPending;             // Set while waiting for the window manager to resize the window
+    sf::Clock switchClock;          // Started when a switch is asked for
+    sf::Time lastSwitchTime;
+};
@@ -0,0 +1,431 @@
+#pragma once
+
+#include "BulletPattern.h"
+#include "FlowField.h"
+#include "Projectiles.h"
+#include "SweptCollision.h"
+#include "WorldSnapshot.h"
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+// Behaviour framework for the enemy types that come in numbers, each type (archetype) keeps its enemies in its own set of arrays
+// and has its own update kernel picked at compile time, so there is no virtual call per enemy and no switch on the type inside the loops.
+// The movement loops only read and write plain float arrays so the compiler can vectorise them, anything with branches (firing, contact damage)
+// is done in a separate pass after
+
+// Archetype tags, these are only used to pick the storage and the kernel
+struct Chaser {};    // Follows the flow field to the player
+struct Strafer {};   // Keeps its distance in front of the player and sweeps up and down, firing straight shots
+struct Kamikaze {};  // Dives straight at the player and explodes on contact
+struct Turret {};    // Stays where it is and fires aimed shots at the player
+struct Spiral {};    // Drifts slowly and fires a rotating stream of shots
+
+// Everything a kernel needs to know about the world for one tick, plus the places it writes its results to
+struct BehaviourContext {
+    float playerX;       // Centre of the player
+    float playerY;
+    sf::FloatRect playerBounds;
+    float deltaTime;
+    const FlowField* flowField;
+    ProjectileStorage* projectiles;  // Where the kernels fire their shots
+    int playerDamage;    // Damage done to the player by contact this tick, added up by the kernels
+};
+
+// Storage for every enemy of one archetype as a structure of arrays, positions are the top left corner
+// Removing an enemy swaps the last one into its place, so the arrays stay packed and nothing after it has to move
+struct BehaviourArrays {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> timer;  // Time left until the next shot
+    std::vector<float> phase;  // Per enemy angle or sweep position, what it means is up to the kernel
+    std::vector<int> health;
+    std::vector<std::uint32_t> id;  // Given out in order as enemies spawn and kept when they are moved, so the network replication can follow them
+    std::uint32_t nextId = 1;
+
+    std::size_t size() const {
+        return x.size();
+    }
+
+    void add(float spawnX, float spawnY, int spawnHealth, float spawnTimer, float spawnPhase) {
+        x.push_back(spawnX);
+        y.push_back(spawnY);
+        velocityX.push_back(0.f);
+        velocityY.push_back(0.f);
+        timer.push_back(spawnTimer);
+        phase.push_back(spawnPhase);
+        health.push_back(spawnHealth);
+        id.push_back(nextId++);
+    }
+
+    // Method to remove every enemy with no health left by swapping the last one in, returns how many were removed
+    std::size_t removeDead() {
+        std::size_t removed = 0;
+        std::size_t i = 0;
+        while (i < x.size()) {
+            if (health[i] > 0) {
+                ++i;
+                continue;
+            }
+            std::size_t last = x.size() - 1;
+            x[i] = x[last]; y[i] = y[last];
+            velocityX[i] = velocityX[last]; velocityY[i] = velocityY[last];
+            timer[i] = timer[last]; phase[i] = phase[last];
+            health[i] = health[last];
+            id[i] = id[last];
+            x.pop_back(); y.pop_back();
+            velocityX.pop_back(); velocityY.pop_back();
+            timer.pop_back(); phase.pop_back();
+            health.pop_back();
+            id.pop_back();
+            ++removed;
+        }
+        return removed;
+    }
+
+    void clear() {
+        x.clear(); y.clear();
+        velocityX.clear(); velocityY.clear();
+        timer.clear(); phase.clear();
+        health.clear();
+        id.clear();
+    }
+};
+
+// Each archetype's kernel is a specialisation of this template, it has the archetype's tuning values and a static update over its arrays
+template <typename Archetype>
+struct BehaviourKernel;
+
+// Passes shared by the kernels, kept as free functions so each kernel's update reads as a list of loops
+
+// Method to count down every shot timer
+inline void countDownTimers(BehaviourArrays& enemies, float deltaTime) {
+    float* timer = enemies.timer.data();
+    const std::size_t count = enemies.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        timer[i] -= deltaTime;
+    }
+}
+
+// Method to move every enemy along its velocity
+inline void integrateVelocities(BehaviourArrays& enemies, float deltaTime) {
+    float* x = enemies.x.data();
+    float* y = enemies.y.data();
+    const float* velocityX = enemies.velocityX.data();
+    const float* velocityY = enemies.velocityY.data();
+    const std::size_t count = enemies.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        x[i] += velocityX[i] * deltaTime;
+        y[i] += velocityY[i] * deltaTime;
+    }
+}
+
+// Method to point every enemy's velocity straight at the player at the given speed
+inline void steerAtPlayer(BehaviourArrays& enemies, const BehaviourContext& context, float halfSize, float speed) {
+    const float* x = enemies.x.data();
+    const float* y = enemies.y.data();
+    float* velocityX = enemies.velocityX.data();
+    float* velocityY = enemies.velocityY.data();
+    const std::size_t count = enemies.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        float directionX = context.playerX - (x[i] + halfSize);
+        float directionY = context.playerY - (y[i] + halfSize);
+        float scale = speed / std::sqrt(directionX * directionX + directionY * directionY + 1.f);  // The 1 stops a divide by zero
+        velocityX[i] = directionX * scale;
+        velocityY[i] = directionY * scale;
+    }
+}
+
+// Method to fire one aimed shot from every enemy whose timer has run out, then start its timer again
+inline void fireAimedShots(BehaviourArrays& enemies, BehaviourContext& context, float halfSize, float cooldown, float shotSpeed, int damage) {
+    for (std::size_t i = 0; i < enemies.size(); ++i) {
+        if (enemies.timer[i] > 0.f) {
+            continue;
+        }
+        enemies.timer[i] += cooldown;
+        float originX = enemies.x[i] + halfSize;
+        float originY = enemies.y[i] + halfSize;
+        float directionX = context.playerX - originX;
+        float directionY = context.playerY - originY;
+        float length = std::sqrt(directionX * directionX + directionY * directionY);
+        if (length > 0.f) {
+            context.projectiles->push(originX, originY, directionX / length, directionY / length, shotSpeed, damage);
+        }
+    }
+}
+
+template <>
+struct BehaviourKernel<Chaser> {
+    static constexpr float size = 40.f;
+    static constexpr float speed = 220.f;
+    static constexpr int health = 30;
+    static constexpr int contactDamage = 5;
+    static constexpr float contactCooldown = 0.5f;  // A chaser touching the player hurts them this often
+    static sf::Color color() { return sf::Color(220, 60, 60); }
+
+    // Chasers don't shoot, they look up the flow field and keep hitting the player every so often while they touch
+    // In the player's own cell the field has no direction, so there they are steered straight at the player instead
+    static void update(BehaviourArrays& enemies, BehaviourContext& context) {
+        steerAtPlayer(enemies, context, size / 2.f, speed);
+
+        const float* x = enemies.x.data();
+        const float* y = enemies.y.data();
+        float* velocityX = enemies.velocityX.data();
+        float* velocityY = enemies.velocityY.data();
+        const std::size_t count = enemies.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            sf::Vector2f direction = context.flowField->sample(sf::Vector2f(x[i] + size / 2.f, y[i] + size / 2.f));
+            if (direction.x != 0.f || direction.y != 0.f) {
+                velocityX[i] = direction.x * speed;
+                velocityY[i] = direction.y * speed;
+            }
+        }
+        integrateVelocities(enemies, context.deltaTime);
+        countDownTimers(enemies, context.deltaTime);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (enemies.timer[i] <= 0.f && context.playerBounds.intersects(sf::FloatRect(x[i], y[i], size, size))) {
+                enemies.timer[i] = contactCooldown;
+                context.playerDamage += contactDamage;
+            }
+        }
+    }
+};
+
+template <>
+struct BehaviourKernel<Strafer> {
+    static constexpr float size = 40.f;
+    static constexpr float holdDistance = 600.f;  // How far in front of the player strafers try to stay
+    static constexpr float approachSpeed = 2.f;   // How quickly they close the gap, per second
+    static constexpr float sweepRange = 250.f;
+    static constexpr float sweepRate = 1.5f;      // Radians per second
+    static constexpr float cooldown = 0.8f;
+    static constexpr float shotSpeed = 700.f;
+    static constexpr int damage = 5;
+    static constexpr int health = 40;
+    static sf::Color color() { return sf::Color(240, 160, 40); }
+
+    // Strafers ease towards a point in front of the player that sweeps up and down, and fire straight to the left
+    static void update(BehaviourArrays& enemies, BehaviourContext& context) {
+        float* x = enemies.x.data();
+        float* y = enemies.y.data();
+        float* phase = enemies.phase.data();
+        const std::size_t count = enemies.size();
+        const float deltaTime = context.deltaTime;
+        for (std::size_t i = 0; i < count; ++i) {
+            phase[i] += sweepRate * deltaTime;
+            float goalX = context.playerX + holdDistance;
+            float goalY = context.playerY + std::sin(phase[i]) * sweepRange;
+            x[i] += (goalX - x[i]) * approachSpeed * deltaTime;
+            y[i] += (goalY - y[i]) * approachSpeed * deltaTime;
+        }
+        countDownTimers(enemies, deltaTime);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (enemies.timer[i] <= 0.f) {
+                enemies.timer[i] += cooldown;
+                context.projectiles->push(x[i], y[i] + size / 2.f, -1.f, 0.f, shotSpeed, damage);
+            }
+        }
+    }
+};
+
+template <>
+struct BehaviourKernel<Kamikaze> {
+    static constexpr float size = 30.f;
+    static constexpr float speed = 420.f;
+    static constexpr int health = 10;
+    static constexpr int contactDamage = 20;
+    static sf::Color color() { return sf::Color(255, 90, 200); }
+
+    // Kamikazes fly straight at the player ignoring the terrain, and use up all their health when they hit
+    static void update(BehaviourArrays& enemies, BehaviourContext& context) {
+        steerAtPlayer(enemies, context, size / 2.f, speed);
+        integrateVelocities(enemies, context.deltaTime);
+
+        for (std::size_t i = 0; i < enemies.size(); ++i) {
+            if (context.playerBounds.intersects(sf::FloatRect(enemies.x[i], enemies.y[i], size, size))) {
+                context.playerDamage += contactDamage;
+                enemies.health[i] = 0;
+            }
+        }
+    }
+};
+
+template <>
+struct BehaviourKernel<Turret> {
+    static constexpr float size = 50.f;
+    static constexpr float cooldown = 1.2f;
+    static constexpr float shotSpeed = 600.f;
+    static constexpr int damage = 8;
+    static constexpr int health = 80;
+    static sf::Color color() { return sf::Color(120, 120, 140); }
+
+    // Turrets don't move, they only fire at the player
+    static void update(BehaviourArrays& enemies, BehaviourContext& context) {
+        countDownTimers(enemies, context.deltaTime);
+        fireAimedShots(enemies, context, size / 2.f, cooldown, shotSpeed, damage);
+    }
+};
+
+template <>
+struct BehaviourKernel<Spiral> {
+    static constexpr float size = 60.f;
+    static constexpr float speed = 40.f;
+    static constexpr int health = 150;
+    static sf::Color color() { return sf::Color(150, 80, 255); }
+
+    // The volley a spiral fires, three arms that turn a little after every volley, the phase array holds each spiral's own turn
+    static const BulletPattern& pattern() {
+        static const BulletPattern spiralPattern = [] {
+            PatternDefinition definition;
+            definition.aim = PatternAim::Rotating;
+            definition.angle = 0.f;
+            definition.count = 3;
+            definition.arc = 6.28318531f;
+            definition.speed = 350.f;
+            definition.spin = 0.3f;
+            definition.cooldown = 0.1f;
+            definition.damage = 3;
+            return BulletPattern(definition);
+        }();
+        return spiralPattern;
+    }
+
+    // Spirals drift towards the player and fire their pattern whenever their timer runs out
+    static void update(BehaviourArrays& enemies, BehaviourContext& context) {
+        steerAtPlayer(enemies, context, size / 2.f, speed);
+        integrateVelocities(enemies, context.deltaTime);
+        countDownTimers(enemies, context.deltaTime);
+
+        const BulletPattern& volley = pattern();
+        for (std::size_t i = 0; i < enemies.size(); ++i) {
+            if (enemies.timer[i] <= 0.f) {
+                enemies.timer[i] += volley.getCooldown();
+                volley.fire(*context.projectiles, enemies.x[i] + size / 2.f, enemies.y[i] + size / 2.f, 0.f, enemies.phase[i]);
+            }
+        }
+    }
+};
+
+// Arrays for one archetype, wrapped so the swarm can look them up by archetype type
+template <typename Archetype>
+struct BehaviourSet {
+    BehaviourArrays enemies;
+};
+
+// Every archetype enemy in the level, each archetype's update runs as its own loop over its own arrays
+class EnemySwarm {
+public:
+    // Method to add an enemy of an archetype, the first shot is staggered by the phase so a group doesn't all fire on the same tick
+    template <typename Archetype>
+    void spawn(float x, float y, float phase = 0.f) {
+        get<Archetype>().add(x, y, BehaviourKernel<Archetype>::health, 0.5f + std::fmod(phase, 1.f), phase);
+    }
+
+    // Returns the arrays for one archetype
+    template <typename Archetype>
+    BehaviourArrays& get() {
+        return std::get<BehaviourSet<Archetype>>(sets).enemies;
+    }
+
+    template <typename Archetype>
+    const BehaviourArrays& get() const {
+        return std::get<BehaviourSet<Archetype>>(sets).enemies;
+    }
+
+    // Method to run every archetype's kernel for one tick, the shots they fire go straight into the projectile storage
+    // Returns how much contact damage the player took
+    int update(const sf::FloatRect& playerBounds, const FlowField& flowField, ProjectileStorage& projectiles, float deltaTime) {
+        BehaviourContext context;
+        context.playerX = playerBounds.left + playerBounds.width / 2.f;
+        context.playerY = playerBounds.top + playerBounds.height / 2.f;
+        context.playerBounds = playerBounds;
+        context.deltaTime = deltaTime;
+        context.flowField = &flowField;
+        context.projectiles = &projectiles;
+        context.playerDamage = 0;
+
+        BehaviourKernel<Chaser>::update(get<Chaser>(), context);
+        BehaviourKernel<Strafer>::update(get<Strafer>(), context);
+        BehaviourKernel<Kamikaze>::update(get<Kamikaze>(), context);
+        BehaviourKernel<Turret>::update(get<Turret>(), context);
+        BehaviourKernel<Spiral>::update(get<Spiral>(), context);
+        return context.playerDamage;
+    }
+
+    // Method to find the first swarm enemy a bullet's path hits this tick, if it is hit sooner than earliestHit
+    // Returns a pointer to its health (or nullptr) and moves earliestHit to the time of the hit
+    int* findSweptHit(const sf::FloatRect& bulletStart, const sf::Vector2f& displacement, float& earliestHit) {
+        int* hit = nullptr;
+        findSweptHit<Chaser>(bulletStart, displacement, earliestHit, hit);
+        findSweptHit<Strafer>(bulletStart, displacement, earliestHit, hit);
+        findSweptHit<Kamikaze>(bulletStart, displacement, earliestHit, hit);
+        findSweptHit<Turret>(bulletStart, displacement, earliestHit, hit);
+        findSweptHit<Spiral>(bulletStart, displacement, earliestHit, hit);
+        return hit;
+    }
+
+    // Method to remove the dead enemies of every archetype, returns how many there were
+    std::size_t removeDead() {
+        return get<Chaser>().removeDead() + get<Strafer>().removeDead() + get<Kamikaze>().removeDead()
+            + get<Turret>().removeDead() + get<Spiral>().removeDead();
+    }
+
+    // Method to add a rectangle for every enemy to a snapshot's list
+    void fillSnapshot(std::vector<SnapshotRect>& rects) const {
+        fillSnapshot<Chaser>(rects);
+        fillSnapshot<Strafer>(rects);
+        fillSnapshot<Kamikaze>(rects);
+        fillSnapshot<Turret>(rects);
+        fillSnapshot<Spiral>(rects);
+    }
+
+    // Returns the number of enemies of every archetype
+    std::size_t size() const {
+        return get<Chaser>().size() + get<Strafer>().size() + get<Kamikaze>().size() + get<Turret>().size() + get<Spiral>().size();
+    }
+
+    void clear() {
+        get<Chaser>().clear();
+        get<Strafer>().clear();
+        get<Kamikaze>().clear();
+        get<Turret>().clear();
+        get<Spiral>().clear();
+    }
+
+private:
+    template <typename Archetype>
+    void findSweptHit(const sf::FloatRect& bulletStart, const sf::Vector2f& displacement, float& earliestHit, int*& hit) {
+        BehaviourArrays& enemies = get<Archetype>();
+        const float size = BehaviourKernel<Archetype>::size;
+        for (std::size_t i = 0; i < enemies.size(); ++i) {
+            float hitTime;
+            if (sweptRectIntersects(bulletStart, displacement, sf::FloatRect(enemies.x[i], enemies.y[i], size, size), hitTime)
+                && hitTime < earliestHit) {
+                earliestHit = hitTime;
+                hit = &enemies.health[i];
+            }
+        }
+    }
+
+    template <typename Archetype>
+    void fillSnapshot(std::vector<SnapshotRect>& rects) const {
+        const BehaviourArrays& enemies = get<Archetype>();
+        const sf::Vector2f size(BehaviourKernel<Archetype>::size, BehaviourKernel<Archetype>::size);
+        const sf::Color color = BehaviourKernel<Archetype>::color();
+        for (std::size_t i = 0; i < enemies.size(); ++i) {
+            rects.push_back({ sf::Vector2f(enemies.x[i], enemies.y[i]), size, color });
+        }
+    }
+
+    std::tuple<BehaviourSet<Chaser>, BehaviourSet<Strafer>, BehaviourSet<Kamikaze>, BehaviourSet<Turret>, BehaviourSet<Spiral>> sets;
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstdint>
+
+// 16.16 fixed point numbers for the deterministic simulation, 16 bits of whole pixels and 16 bits of fraction stored in a plain int32
+// Adding, subtracting and comparing are ordinary integer maths, so the arrays of them vectorise as well as floats do.
+// Everything here is integer only, no float maths and no library calls like std::sqrt or std::sin whose results can change
+// between compilers, optimisation levels and CPUs, so the same inputs always give the same bits on every build.
+// Right shifts of negative numbers are assumed to be arithmetic, which every compiler the game builds with does
+typedef std::int32_t Fixed;
+
+const int fixedShift = 16;
+const Fixed fixedOne = 1 << fixedShift;
+const Fixed fixedHalf = fixedOne / 2;
+const Fixed fixedPi = 205887;       // Pi rounded to the nearest 1/65536
+const Fixed fixedHalfPi = 102944;
+const Fixed fixedTwoPi = 411775;
+
+// Method to turn a float constant into fixed point, rounding to the nearest step. Scaling by a power of two is exact,
+// so this gives the same answer everywhere, it is only for tuning values and level data, never for results of the simulation
+constexpr Fixed toFixed(float value) {
+    return static_cast<Fixed>(value * fixedOne + (value >= 0.f ? 0.5f : -0.5f));
+}
+
+constexpr Fixed intToFixed(int value) {
+    return static_cast<Fixed>(value * fixedOne);
+}
+
+// Method to turn a fixed point number into a float for drawing, nothing that feeds back into the simulation should use this
+inline float fixedToFloat(Fixed value) {
+    return static_cast<float>(value) / fixedOne;
+}
+
+// Returns the whole number of pixels, rounded down
+inline int fixedFloor(Fixed value) {
+    return value >> fixedShift;
+}
+
+inline Fixed fixedMultiply(Fixed a, Fixed b) {
+    return static_cast<Fixed>((static_cast<std::int64_t>(a) * b) >> fixedShift);
+}
+
+inline Fixed fixedDivide(Fixed a, Fixed b) {
+    return static_cast<Fixed>((static_cast<std::int64_t>(a) << fixedShift) / b);
+}
+
+// Returns the number of bits needed to hold the value, 0 for 0, worked out with a binary search so it doesn't need a compiler intrinsic
+inline int bitLength(std::uint64_t value) {
+    int bits = 0;
+    if (value >> 32) { value >>= 32; bits += 32; }
+    if (value >> 16) { value >>= 16; bits += 16; }
+    if (value >> 8) { value >>= 8; bits += 8; }
+    if (value >> 4) { value >>= 4; bits += 4; }
+    if (value >> 2) { value >>= 2; bits += 2; }
+    if (value >> 1) { value >>= 1; bits += 1; }
+    return bits + static_cast<int>(value);
+}
+
+// Returns the square root of a 64 bit number rounded down, one bit of the answer at a time so it is exact
+inline std::uint32_t integerSqrt(std::uint64_t value) {
+    std::uint64_t result = 0;
+    std::uint64_t bit = std::uint64_t(1) << 62;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<std::uint32_t>(result);
+}
+
+inline Fixed fixedSqrt(Fixed value) {
+    return value <= 0 ? 0 : static_cast<Fixed>(integerSqrt(static_cast<std::uint64_t>(value) << fixedShift));
+}
+
+// Table of starting guesses for the inverse square root, one for each of the 768 ranges a number in [2^30, 2^32) can start with
+// Each entry is 2^45 / sqrt of the middle of its range, worked out once with the exact integer square root
+struct InverseSqrtTable {
+    std::uint32_t guesses[768];
+
+    InverseSqrtTable() {
+        for (int i = 0; i < 768; ++i) {
+            std::uint64_t middle = (static_cast<std::uint64_t>(i + 256) << 22) + (1u << 21);
+            guesses[i] = static_cast<std::uint32_t>((std::uint64_t(1) << 60) / integerSqrt(middle << 30));
+        }
+    }
+};
+
+// Method to turn a vector into a unit vector, returns false and leaves the outputs alone for a zero vector
+// Dividing by the length would need a square root and two divides per vector, so instead the squared length is scaled into [2^30, 2^32),
+// the inverse square root is looked up in a table and made accurate with one Newton step, and the vector is multiplied by it.
+// That is only multiplies and shifts, and the result is within a couple of steps of the exact unit vector
+inline bool fixedNormalize(Fixed x, Fixed y, Fixed& unitX, Fixed& unitY) {
+    static const InverseSqrtTable table;
+
+    std::uint64_t squared = static_cast<std::uint64_t>(static_cast<std::int64_t>(x) * x) + static_cast<std::uint64_t>(static_cast<std::int64_t>(y) * y);
+    if (squared == 0) {
+        return false;
+    }
+
+    // squared = mantissa * 4^exponent, with the mantissa 31 or 32 bits long
+    int excess = bitLength(squared) - 31;
+    int exponent = excess >= 0 ? excess / 2 : -((1 - excess) / 2);
+    std::uint64_t mantissa = exponent >= 0 ? squared >> (2 * exponent) : squared << (-2 * exponent);
+
+    // guess is 2^45 / sqrt(mantissa), one Newton step guess * (3 - mantissa * guess^2) / 2 takes it from about 10 correct bits to about 20
+    std::int64_t guess = table.guesses[(mantissa >> 22) - 256];
+    std::int64_t error = static_cast<std::int64_t>(mantissa * static_cast<std::uint64_t>((guess * guess) >> 30));
+    guess = (guess * (((std::int64_t(3) << 60) - error) >> 30)) >> 31;
+
+    // x / sqrt(squared) in 16.16 is x * guess / 2^(45 - 16 + exponent)
+    unitX = static_cast<Fixed>((static_cast<std::int64_t>(x) * guess) >> (29 + exponent));
+    unitY = static_cast<Fixed>((static_cast<std::int64_t>(y) * guess) >> (29 + exponent));
+    return true;
+}
+
+// Method to wrap an angle into [0, 2 pi)
+inline Fixed fixedWrapAngle(Fixed angle) {
+    angle %= fixedTwoPi;
+    return angle < 0 ? angle + fixedTwoPi : angle;
+}
+
+// Returns the sine of an angle in radians, the angle is folded into [0, pi/2] and the sine worked out with its series up to x^9
+// in 2.30 fixed point, which is accurate to within a couple of steps of 16.16
+inline Fixed fixedSin(Fixed angle) {
+    angle = fixedWrapAngle(angle);
+    bool negative = false;
+    if (angle > fixedPi) {
+        angle -= fixedPi;
+        negative = true;
+    }
+    if (angle > fixedHalfPi) {
+        angle = fixedPi - angle;
+    }
+
+    const std::int64_t one = std::int64_t(1) << 30;
+    std::int64_t x = static_cast<std::int64_t>(angle) << 14;
+    std::int64_t squared = (x * x) >> 30;
+    std::int64_t series = one - squared / 72;
+    series = one - ((squared * series) >> 30) / 42;
+    series = one - ((squared * series) >> 30) / 20;
+    series = one - ((squared * series) >> 30) / 6;
+    Fixed result = static_cast<Fixed>((((x * series) >> 30) + (1 << 13)) >> 14);
+    return negative ? -result : result;
+}
+
+inline Fixed fixedCos(Fixed angle) {
+    return fixedSin(fixedWrapAngle(angle) + fixedHalfPi);
+}
+
+// Fixed point rectangle, the same as sf::FloatRect but for the deterministic simulation
+struct FixedRect {
+    Fixed left;
+    Fixed top;
+    Fixed width;
+    Fixed height;
+
+    // Boolean method returning true if the rectangles overlap, touching edges don't count, the same as sf::FloatRect::intersects
+    bool intersects(const FixedRect& other) const {
+        Fixed overlapLeft = left > other.left ? left : other.left;
+        Fixed overlapTop = top > other.top ? top : other.top;
+        Fixed overlapRight = left + width < other.left + other.width ? left + width : other.left + other.width;
+        Fixed overlapBottom = top + height < other.top + other.height ? top + height : other.top + other.height;
+        return overlapLeft < overlapRight && overlapTop < overlapBottom;
+    }
+};
+
+// Method to test a moving rectangle against a still one over the displacement it moved by this tick, the fixed point version of
+// sweptRectIntersects in SweptCollision.h. Sets entryTime to when they first touch, from 0 (the start of the tick) to fixedOne (the end)
+inline bool fixedSweptIntersects(const FixedRect& moving, Fixed displacementX, Fixed displacementY, const FixedRect& target, Fixed& entryTime) {
+    std::int64_t tMin = 0;
+    std::int64_t tMax = fixedOne;
+
+    // The target is grown by the moving rectangle's size so the test is a segment from its corner, clipped against each pair of sides in turn
+    const Fixed origins[2] = { moving.left, moving.top };
+    const Fixed deltas[2] = { displacementX, displacementY };
+    const Fixed minimums[2] = { target.left - moving.width, target.top - moving.height };
+    const Fixed maximums[2] = { target.left + target.width, target.top + target.height };
+
+    // Integer divides are slow, so first throw out targets the box around the whole segment doesn't reach, which is nearly all of them
+    for (int axis = 0; axis < 2; ++axis) {
+        Fixed end = origins[axis] + deltas[axis];
+        if ((origins[axis] < end ? end : origins[axis]) < minimums[axis] || (origins[axis] < end ? origins[axis] : end) > maximums[axis]) {
+            return false;
+        }
+    }
+
+    for (int axis = 0; axis < 2; ++axis) {
+        if (deltas[axis] == 0) {
+            if (origins[axis] < minimums[axis] || origins[axis] > maximums[axis]) {
+                return false;
+            }
+            continue;
+        }
+
+        std::int64_t tNear = (static_cast<std::int64_t>(minimums[axis] - origins[axis]) << fixedShift) / deltas[axis];
+        std::int64_t tFar = (static_cast<std::int64_t>(maximums[axis] - origins[axis]) << fixedShift) / deltas[axis];
+        if (tNear > tFar) {
+            std::int64_t swap = tNear;
+            tNear = tFar;
+            tFar = swap;
+        }
+        tMin = tNear > tMin ? tNear : tMin;
+        tMax = tFar < tMax ? tFar : tMax;
+        if (tMin > tMax) {
+            return false;
+        }
+    }
+
+    entryTime = static_cast<Fixed>(tMin);
+    return true;
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "TileCollision.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Flow field that every enemy chasing the player shares, the world is split into a grid and each cell stores which way to go to reach the player
+// The field is worked out with one breadth first search from the player's cell around the solid terrain, and only when the player moves into
+// a different cell or the terrain changes. Enemies then just look up the cell they are in, so the cost of pathfinding doesn't grow with the enemy count
+class FlowField {
+public:
+    // Constructor for the flow field with the size of each grid cell in pixels
+    explicit FlowField(int cellSize = 64)
+        : cellSize(cellSize), columns(0), rows(0), targetCell(-1), chunkVersion(0) {
+    }
+
+    // Method to make sure the field leads to the target, it only searches again if the target has changed cell or the terrain has streamed in or out
+    void update(const sf::Vector2f& target, const TileCollision& tileMap, const sf::FloatRect& worldBounds) {
+        bool rebuildTerrain = false;
+        if (worldBounds != bounds) {
+            resize(worldBounds);
+            rebuildTerrain = true;
+        }
+        if (tileMap.getChunkVersion() != chunkVersion || blocked.empty()) {
+            rebuildTerrain = true;
+        }
+        if (rebuildTerrain) {
+            chunkVersion = tileMap.getChunkVersion();
+            markBlockedCells(tileMap);
+        }
+
+        int cell = getCellIndex(target);
+        if (cell != targetCell || rebuildTerrain) {
+            targetCell = cell;
+            search();
+        }
+    }
+
+    // Returns the direction to move in from this position as a unit vector, this is a single lookup
+    // Returns a zero vector in the target's own cell and in cells the target can't be reached from, the caller steers straight at the target there
+    sf::Vector2f sample(const sf::Vector2f& position) const {
+        // Unit vectors for the eight directions in the same order as the search's neighbours, the last entry is for cells with no direction
+        static const float diagonal = 0.70710678f;
+        static const sf::Vector2f directionTable[9] = {
+            sf::Vector2f(1.f, 0.f), sf::Vector2f(diagonal, diagonal), sf::Vector2f(0.f, 1.f), sf::Vector2f(-diagonal, diagonal),
+            sf::Vector2f(-1.f, 0.f), sf::Vector2f(-diagonal, -diagonal), sf::Vector2f(0.f, -1.f), sf::Vector2f(diagonal, -diagonal),
+            sf::Vector2f(0.f, 0.f)
+        };
+        return directionTable[sampleDirection(position)];
+    }
+
+    // Returns which of the eight directions to move in from this position, from 0 (right) turning clockwise to 7 (up and right)
+    // Returns 8 where sample() would give a zero vector. The fixed point simulation looks the direction up in its own table
+    int sampleDirection(const sf::Vector2f& position) const {
+        int cell = getCellIndex(position);
+        return cell < 0 ? static_cast<int>(noDirection) : directions[cell];
+    }
+
+    // Returns how many cells away from the target this position is, or -1 if it can't reach the target
+    int getDistance(const sf::Vector2f& position) const {
+        int cell = getCellIndex(position);
+        if (cell < 0 || distances[cell] == unreachable) {
+            return -1;
+        }
+        return distances[cell];
+    }
+
+private:
+    // Distance of cells the target can't be reached from, and the direction of cells with nowhere to go
+    enum : std::uint16_t { unreachable = 0xFFFF };
+    enum : std::uint8_t { noDirection = 8 };
+
+    // Method to size the grid to cover the world
+    void resize(const sf::FloatRect& worldBounds) {
+        bounds = worldBounds;
+        columns = static_cast<int>(worldBounds.width + cellSize - 1) / cellSize;
+        rows = static_cast<int>(worldBounds.height + cellSize - 1) / cellSize;
+        blocked.assign(columns * rows, 0);
+        distances.assign(columns * rows, unreachable);
+        directions.assign(columns * rows, noDirection);
+        queue.reserve(columns * rows);
+        targetCell = -1;
+    }
+
+    // Method to mark every cell that has any solid terrain in it, enemies route around these
+    void markBlockedCells(const TileCollision& tileMap) {
+        for (int y = 0; y < rows; ++y) {
+            for (int x = 0; x < columns; ++x) {
+                // Shrink the cell slightly so it doesn't pick up the tiles along the edge of the next cell
+                sf::FloatRect cellBounds(bounds.left + x * cellSize + 1.f, bounds.top + y * cellSize + 1.f, cellSize - 2.f, cellSize - 2.f);
+                blocked[y * columns + x] = tileMap.overlapsSolid(cellBounds) ? 1 : 0;
+            }
+        }
+    }
+
+    // Returns the index of the cell this position is in, or -1 if it is outside the world
+    int getCellIndex(const sf::Vector2f& position) const {
+        int x = static_cast<int>((position.x - bounds.left) / cellSize);
+        int y = static_cast<int>((position.y - bounds.top) / cellSize);
+        if (position.x < bounds.left || position.y < bounds.top || x >= columns || y >= rows) {
+            return -1;
+        }
+        return y * columns + x;
+    }
+
+    // Method to search outwards from the target's cell to find how far every cell is from it, then point each cell at its closest neighbour
+    void search() {
+        // Offsets to the eight neighbours, the straight ones are at the even indices so the search can step over the diagonals
+        static const int neighbourX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+        static const int neighbourY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+        std::fill(distances.begin(), distances.end(), unreachable);
+        std::fill(directions.begin(), directions.end(), noDirection);
+        if (targetCell < 0) {
+            return;
+        }
+
+        // Breadth first search across the four straight neighbours, the queue is a plain vector read from the front because each cell goes in once
+        queue.clear();
+        queue.push_back(targetCell);
+        distances[targetCell] = 0;
+        for (std::size_t next = 0; next < queue.size(); ++next) {
+            int cell = queue[next];
+            int x = cell % columns;
+            int y = cell / columns;
+            for (int i = 0; i < 8; i += 2) {
+                int neighbourColumn = x + neighbourX[i];
+                int neighbourRow = y + neighbourY[i];
+                if (neighbourColumn < 0 || neighbourRow < 0 || neighbourColumn >= columns || neighbourRow >= rows) {
+                    continue;
+                }
+                int neighbour = neighbourRow * columns + neighbourColumn;
+                if (blocked[neighbour] || distances[neighbour] != unreachable) {
+                    continue;
+                }
+                distances[neighbour] = static_cast<std::uint16_t>(distances[cell] + 1);
+                queue.push_back(neighbour);
+            }
+        }
+
+        // Point each reachable cell at whichever of its eight neighbours is closest to the target
+        // Diagonals are only allowed when both cells beside them are open, so enemies don't clip the corners of the terrain
+        for (int cell : queue) {
+            if (cell == targetCell) {
+                continue;
+            }
+            int x = cell % columns;
+            int y = cell / columns;
+            std::uint16_t best = distances[cell];
+            for (int i = 0; i < 8; ++i) {
+                int neighbourColumn = x + neighbourX[i];
+                int neighbourRow = y + neighbourY[i];
+                if (neighbourColumn < 0 || neighbourRow < 0 || neighbourColumn >= columns || neighbourRow >= rows) {
+                    continue;
+                }
+                if (neighbourX[i] != 0 && neighbourY[i] != 0 &&
+                    (blocked[y * columns + neighbourColumn] || blocked[neighbourRow * columns + x])) {
+                    continue;
+                }
+                std::uint16_t distance = distances[neighbourRow * columns + neighbourColumn];
+                if (distance < best) {
+                    best = distance;
+                    directions[cell] = static_cast<std::uint8_t>(i);
+                }
+            }
+        }
+    }
+
+    int cellSize;
+    int columns;
+    int rows;
+    sf::FloatRect bounds;
+    int targetCell;
+    unsigned chunkVersion;  // Version of the tile map the blocked cells were worked out from
+
+    std::vector<std::uint8_t> blocked;
+    std::vector<std::uint16_t> distances;
+    std::vector<std::uint8_t> directions;  // Index into the direction table for each cell
+    std::vector<int> queue;                // Kept between searches so searching doesn't allocate
+};
+
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// Linear (bump) allocator for data that only has to live for one frame, such as HUD label strings and scratch lists
+// Allocating just moves a pointer along a buffer that is made once, and everything is freed together by reset() at the start of the next frame,
+// so transient data costs no calls to the heap while the game is running
+class FrameArena {
+public:
+    // Constructor for the arena with the number of bytes it can hand out each frame
+    explicit FrameArena(std::size_t capacity)
+        : buffer(new unsigned char[capacity]), capacity(capacity), used(0), peakUsed(0), overflowCount(0) {
+    }
+
+    ~FrameArena() {
+        releaseOverflow();
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Method to get memory from the arena, if the frame has used up the buffer it falls back to the heap and counts the overflow
+    // so the arena size can be raised, overflow memory is still freed by reset()
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        std::size_t start = (used + alignment - 1) & ~(alignment - 1);
+        if (start + size > capacity) {
+            ++overflowCount;
+            overflow.push_back(::operator new(size));
+            return overflow.back();
+        }
+        used = start + size;
+        if (used > peakUsed) {
+            peakUsed = used;
+        }
+        return buffer.get() + start;
+    }
+
+    // Method to free everything handed out this frame, called once at the start of every frame
+    void reset() {
+        used = 0;
+        releaseOverflow();
+    }
+
+    // Method to format a string into the arena like printf, the string is valid until the next reset
+    const char* format(const char* text, ...) {
+        va_list arguments;
+        va_start(arguments, text);
+        va_list copy;
+        va_copy(copy, arguments);
+        int length = std::vsnprintf(nullptr, 0, text, copy);
+        va_end(copy);
+
+        char* result = static_cast<char*>(allocate(static_cast<std::size_t>(length) + 1, 1));
+        std::vsnprintf(result, static_cast<std::size_t>(length) + 1, text, arguments);
+        va_end(arguments);
+        return result;
+    }
+
+    // Returns the number of bytes used so far this frame
+    std::size_t getUsed() const { return used; }
+
+    // Returns the most bytes used in any frame, so the arena can be sized
+    std::size_t getPeakUsed() const { return peakUsed; }
+
+    // Returns how many allocations didn't fit in the arena and had to go to the heap
+    std::size_t getOverflowCount() const { return overflowCount; }
+
+private:
+    void releaseOverflow() {
+        for (void* memory : overflow) {
+            ::operator delete(memory);
+        }
+        overflow.clear();
+    }
+
+    std::unique_ptr<unsigned char[]> buffer;
+    std::size_t capacity;
+    std::size_t used;
+    std::size_t peakUsed;
+    std::size_t overflowCount;
+    std::vector<void*> overflow;
+};
+
+// Allocator adapter so standard containers can put their memory in a frame arena
+// Deallocation does nothing because the arena frees everything at once when it is reset
+template <typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator(FrameArena& arena) : arena(&arena) {}
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : arena(other.getArena()) {}
+
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) {}
+
+    FrameArena* getArena() const { return arena; }
+
+private:
+    FrameArena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return !(a == b);
+}
+
+// Containers that live in a frame arena, they must not be kept past the end of the frame
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
@@ -0,0 +1,345 @@
+// The Visual C++ OpenGL header needs windows.h, which would otherwise define min and max macros
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "FrameCapture.h"
+#include "Logger.h"
+
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+// The pixel buffer functions are newer than the OpenGL 1.1 the system headers promise on every platform, so they are
+// looked up through SFML when the window's context is first active rather than linked against
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+namespace {
+    const unsigned int pixelPackBuffer = 0x88EB;  // GL_PIXEL_PACK_BUFFER
+    const unsigned int streamRead = 0x88E1;       // GL_STREAM_READ
+    const unsigned int readOnly = 0x88B8;         // GL_READ_ONLY
+
+    typedef void (APIENTRY* GenBuffersFunction)(GLsizei, GLuint*);
+    typedef void (APIENTRY* DeleteBuffersFunction)(GLsizei, const GLuint*);
+    typedef void (APIENTRY* BindBufferFunction)(GLenum, GLuint);
+    typedef void (APIENTRY* BufferDataFunction)(GLenum, std::ptrdiff_t, const void*, GLenum);
+    typedef void* (APIENTRY* MapBufferFunction)(GLenum, GLenum);
+    typedef GLboolean(APIENTRY* UnmapBufferFunction)(GLenum);
+
+    GenBuffersFunction genBuffers = nullptr;
+    DeleteBuffersFunction deleteBuffers = nullptr;
+    BindBufferFunction bindBuffer = nullptr;
+    BufferDataFunction bufferData = nullptr;
+    MapBufferFunction mapBuffer = nullptr;
+    UnmapBufferFunction unmapBuffer = nullptr;
+
+    // Method to copy a bottom up RGBA frame (as OpenGL reads it) into a top down one, shrunk by a whole number with a box filter
+    // The alpha is made opaque, the window's alpha means nothing
+    void shrinkFrame(const std::uint8_t* source, unsigned width, unsigned height, unsigned scale, std::uint8_t* destination) {
+        const unsigned shrunkWidth = width / scale;
+        const unsigned shrunkHeight = height / scale;
+        const unsigned area = scale * scale;
+        for (unsigned y = 0; y < shrunkHeight; ++y) {
+            for (unsigned x = 0; x < shrunkWidth; ++x) {
+                unsigned total[4] = { 0, 0, 0, 0 };  // The alpha is added up too but not used
+                for (unsigned sy = 0; sy < scale; ++sy) {
+                    const std::uint8_t* row = source + (static_cast<std::size_t>(height - 1 - (y * scale + sy)) * width + x * scale) * 4;
+                    for (unsigned sx = 0; sx < scale * 4; ++sx) {
+                        total[sx % 4] += row[sx];
+                    }
+                }
+                std::uint8_t* pixel = destination + (static_cast<std::size_t>(y) * shrunkWidth + x) * 4;
+                for (int channel = 0; channel < 3; ++channel) {
+                    pixel[channel] = static_cast<std::uint8_t>(total[channel] / area);
+                }
+                pixel[3] = 255;
+            }
+        }
+    }
+
+    // Method to save an RGBA frame as a PNG
+    bool savePng(const std::string& file, unsigned width, unsigned height, const std::uint8_t* pixels) {
+        sf::Image image;
+        image.create(width, height, pixels);
+        return image.saveToFile(file);
+    }
+}
+
+FrameCapture::FrameCapture(const std::string& outputDirectory, const FrameCaptureSettings& settings)
+    : outputDirectory(outputDirectory), settings(settings), screenshotRequested(false) {
+    this->settings.readbackBuffers = std::max<std::size_t>(2, settings.readbackBuffers);
+    this->settings.stagingFrames = std::max<std::size_t>(1, settings.stagingFrames);
+    this->settings.clipScale = std::max(1u, settings.clipScale);
+
+    staging.resize(this->settings.stagingFrames);
+    for (std::size_t i = this->settings.stagingFrames; i > 0; --i) {
+        freeStaging.push_back(i - 1);
+    }
+    worker = std::thread(&FrameCapture::run, this);
+}
+
+FrameCapture::~FrameCapture() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_one();
+    worker.join();
+
+    // The buffers belong to every context SFML makes since they all share, so a context of its own is enough if the window has closed
+    if (pixelBuffers && !readbacks.empty()) {
+        sf::Context context;
+        releaseBuffers();
+    }
+    LOG_INFO("[capture] {} screenshots and {} clips saved, {} frames dropped, worst capture {} us", savedScreenshots, savedClips,
+        static_cast<unsigned>(droppedCount), worstCaptureTime.asMicroseconds());
+}
+
+void FrameCapture::saveClip() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobs.push_back({ JobKind::SaveClip, 0, 0, 0, false, false });
+    }
+    jobReady.notify_one();
+}
+
+void FrameCapture::capture(sf::RenderWindow& window) {
+    sf::Clock clock;
+    if (!window.setActive(true)) {
+        return;
+    }
+    if (!functionsLoaded) {
+        functionsLoaded = true;
+        pixelBuffers = loadFunctions();
+        if (!pixelBuffers) {
+            LOG_WARNING("[capture] No pixel buffers, frames will be read back straight away and wait for the GPU");
+        }
+    }
+    if (window.getSize() != frameSize) {
+        resize(window.getSize());
+    }
+    ++frameCount;
+
+    // Map the frames that were asked for long enough ago that the GPU has normally finished writing them
+    for (Readback& readback : readbacks) {
+        if (readback.pending && frameCount - readback.frame >= settings.readbackBuffers - 1) {
+            collect(readback);
+        }
+    }
+
+    // Ask for this frame if it is wanted, into the next buffer in the ring (which is mapped first if it is still waiting)
+    bool screenshot = screenshotRequested.exchange(false);
+    bool clip = settings.clipFramesPerSecond > 0.f && clipClock.getElapsedTime().asSeconds() >= nextClipTime;
+    if (clip) {
+        nextClipTime = std::max(nextClipTime + 1.f / settings.clipFramesPerSecond, clipClock.getElapsedTime().asSeconds());
+    }
+    if (screenshot || clip) {
+        Readback& readback = readbacks[nextReadback];
+        nextReadback = (nextReadback + 1) % readbacks.size();
+        if (readback.pending) {
+            collect(readback);
+        }
+        readback.screenshot = screenshot;
+        readback.clip = clip;
+        request(readback);
+    }
+
+    worstCaptureTime = std::max(worstCaptureTime, clock.getElapsedTime());
+}
+
+bool FrameCapture::loadFunctions() {
+    genBuffers = reinterpret_cast<GenBuffersFunction>(sf::Context::getFunction("glGenBuffers"));
+    deleteBuffers = reinterpret_cast<DeleteBuffersFunction>(sf::Context::getFunction("glDeleteBuffers"));
+    bindBuffer = reinterpret_cast<BindBufferFunction>(sf::Context::getFunction("glBindBuffer"));
+    bufferData = reinterpret_cast<BufferDataFunction>(sf::Context::getFunction("glBufferData"));
+    mapBuffer = reinterpret_cast<MapBufferFunction>(sf::Context::getFunction("glMapBuffer"));
+    unmapBuffer = reinterpret_cast<UnmapBufferFunction>(sf::Context::getFunction("glUnmapBuffer"));
+    return genBuffers && deleteBuffers && bindBuffer && bufferData && mapBuffer && unmapBuffer;
+}
+
+// The frames in flight are thrown away when the window changes size, the clip starts again at the new size on the worker
+void FrameCapture::resize(const sf::Vector2u& size) {
+    if (pixelBuffers) {
+        releaseBuffers();
+    }
+    frameSize = size;
+    readbacks.assign(settings.readbackBuffers, Readback());
+    nextReadback = 0;
+    if (!pixelBuffers) {
+        return;
+    }
+
+    const std::ptrdiff_t bytes = static_cast<std::ptrdiff_t>(size.x) * size.y * 4;
+    for (Readback& readback : readbacks) {
+        genBuffers(1, &readback.buffer);
+        bindBuffer(pixelPackBuffer, readback.buffer);
+        bufferData(pixelPackBuffer, bytes, nullptr, streamRead);
+    }
+    bindBuffer(pixelPackBuffer, 0);
+}
+
+void FrameCapture::releaseBuffers() {
+    for (Readback& readback : readbacks) {
+        if (readback.buffer != 0) {
+            deleteBuffers(1, &readback.buffer);
+            readback.buffer = 0;
+        }
+    }
+}
+
+// Method to start reading the frame into a readback buffer, with pixel buffers this returns straight away and the GPU copies it later
+void FrameCapture::request(Readback& readback) {
+    if (!pixelBuffers) {
+        std::size_t index;
+        if (!takeStaging(index)) {
+            return;
+        }
+        staging[index].resize(static_cast<std::size_t>(frameSize.x) * frameSize.y * 4);  // Only allocates the first time at this size
+        glReadPixels(0, 0, static_cast<GLsizei>(frameSize.x), static_cast<GLsizei>(frameSize.y), GL_RGBA, GL_UNSIGNED_BYTE, staging[index].data());
+        queueFrame(index, readback.screenshot, readback.clip);
+        return;
+    }
+
+    bindBuffer(pixelPackBuffer, readback.buffer);
+    glReadPixels(0, 0, static_cast<GLsizei>(frameSize.x), static_cast<GLsizei>(frameSize.y), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    bindBuffer(pixelPackBuffer, 0);
+    readback.pending = true;
+    readback.frame = frameCount;
+}
+
+// Method to map a readback buffer and copy its pixels to a staging frame for the worker
+void FrameCapture::collect(Readback& readback) {
+    readback.pending = false;
+    std::size_t index;
+    if (!takeStaging(index)) {
+        return;
+    }
+
+    const std::size_t bytes = static_cast<std::size_t>(frameSize.x) * frameSize.y * 4;
+    bindBuffer(pixelPackBuffer, readback.buffer);
+    const void* pixels = mapBuffer(pixelPackBuffer, readOnly);
+    if (pixels != nullptr) {
+        staging[index].resize(bytes);
+        std::memcpy(staging[index].data(), pixels, bytes);
+        unmapBuffer(pixelPackBuffer);
+    }
+    bindBuffer(pixelPackBuffer, 0);
+
+    if (pixels == nullptr) {
+        std::lock_guard<std::mutex> lock(stagingMutex);
+        freeStaging.push_back(index);
+        return;
+    }
+    queueFrame(index, readback.screenshot, readback.clip);
+}
+
+// Method to take a free staging frame, if the worker is still busy with all of them the frame is dropped
+bool FrameCapture::takeStaging(std::size_t& index) {
+    std::lock_guard<std::mutex> lock(stagingMutex);
+    if (freeStaging.empty()) {
+        ++droppedCount;
+        return false;
+    }
+    index = freeStaging.back();
+    freeStaging.pop_back();
+    return true;
+}
+
+void FrameCapture::queueFrame(std::size_t stagingIndex, bool screenshot, bool clip) {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobs.push_back({ JobKind::Frame, stagingIndex, frameSize.x, frameSize.y, screenshot, clip });
+    }
+    jobReady.notify_one();
+}
+
+// Method run by the worker thread, it does the jobs in the order they were queued until the capture is destroyed
+void FrameCapture::run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;  // Stopping, and everything queued has been done
+            }
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        if (job.kind == JobKind::SaveClip) {
+            writeClip();
+            continue;
+        }
+        processFrame(job);
+        std::lock_guard<std::mutex> lock(stagingMutex);
+        freeStaging.push_back(job.staging);
+    }
+}
+
+void FrameCapture::processFrame(const Job& job) {
+    const std::vector<std::uint8_t>& pixels = staging[job.staging];
+
+    if (job.clip) {
+        // The clip starts again if the window has changed size, this is the only time its frames are made
+        const unsigned width = job.width / settings.clipScale;
+        const unsigned height = job.height / settings.clipScale;
+        const std::size_t length = std::max<std::size_t>(1, static_cast<std::size_t>(settings.clipFramesPerSecond * settings.clipSeconds));
+        if (width != clipWidth || height != clipHeight || clipFrames.size() != length) {
+            clipWidth = width;
+            clipHeight = height;
+            clipFrames.assign(length, std::vector<std::uint8_t>(static_cast<std::size_t>(width) * height * 4));
+            clipNext = 0;
+            clipCount = 0;
+        }
+        shrinkFrame(pixels.data(), job.width, job.height, settings.clipScale, clipFrames[clipNext].data());
+        clipNext = (clipNext + 1) % clipFrames.size();
+        clipCount = std::min(clipCount + 1, clipFrames.size());
+    }
+
+    if (job.screenshot) {
+        // Full size, turned the right way up and made opaque
+        std::vector<std::uint8_t> flipped(pixels.size());
+        const std::size_t rowBytes = static_cast<std::size_t>(job.width) * 4;
+        for (unsigned y = 0; y < job.height; ++y) {
+            std::memcpy(&flipped[y * rowBytes], &pixels[(job.height - 1 - y) * rowBytes], rowBytes);
+        }
+        for (std::size_t alpha = 3; alpha < flipped.size(); alpha += 4) {
+            flipped[alpha] = 255;
+        }
+        ++savedScreenshots;
+        std::string file = outputDirectory + "screenshot_" + std::to_string(std::time(nullptr)) + "_" + std::to_string(savedScreenshots) + ".png";
+        if (savePng(file, job.width, job.height, flipped.data())) {
+            LOG_INFO("[capture] Saved screenshot {} ({} x {})", savedScreenshots, job.width, job.height);
+        }
+        else {
+            LOG_ERROR("[capture] Couldn't save screenshot {}, does the capture directory exist?", savedScreenshots);
+        }
+    }
+}
+
+// Method to write the clip out oldest frame first, as clip_<time>_<number>_<frame>.png
+void FrameCapture::writeClip() {
+    if (clipCount == 0) {
+        LOG_WARNING("[capture] No frames in the clip to save yet");
+        return;
+    }
+    ++savedClips;
+    const std::string prefix = outputDirectory + "clip_" + std::to_string(std::time(nullptr)) + "_" + std::to_string(savedClips) + "_";
+    const std::size_t first = (clipNext + clipFrames.size() - clipCount) % clipFrames.size();
+    std::size_t written = 0;
+    for (std::size_t i = 0; i < clipCount; ++i) {
+        const std::vector<std::uint8_t>& frame = clipFrames[(first + i) % clipFrames.size()];
+        std::string number = std::to_string(i);
+        number.insert(0, 4 - std::min<std::size_t>(4, number.size()), '0');
+        if (savePng(prefix + number + ".png", clipWidth, clipHeight, frame.data())) {
+            ++written;
+        }
+    }
+    LOG_INFO("[capture] Saved clip {}, {} frames at {} x {}", savedClips, static_cast<unsigned>(written), clipWidth, clipHeight);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// How the frame capture reads back and keeps frames
+struct FrameCaptureSettings {
+    std::size_t readbackBuffers = 3;  // Frames in flight between asking the GPU for the pixels and reading them
+    std::size_t stagingFrames = 4;    // Full size frames waiting for the worker, a capture is dropped rather than waited for if they are all busy
+    float clipFramesPerSecond = 15.f; // How often a frame is kept for the clip, 0 keeps no clip
+    float clipSeconds = 8.f;          // How far back the clip goes
+    unsigned clipScale = 4;           // Clip frames are shrunk by this much along each side so the clip fits in memory
+};
+
+// Screenshots and short clips of the game for bug reports, without stalling the frame they are taken from
+// Copying a frame with Texture::update and copyToImage waits for the GPU to finish drawing, and saving a PNG on the game thread takes
+// far longer than a frame. Instead the frame is read into one of a ring of pixel buffers, which the GPU fills in the background, and
+// it is only mapped a couple of frames later when it is normally finished. The pixels are copied to a staging frame and handed to
+// a worker thread, which shrinks clip frames into the rolling "last few seconds" buffer and encodes screenshots and clips to PNG.
+// The clip buffer and the staging frames are made once and reused, so capturing doesn't allocate, and when the worker falls behind
+// frames are dropped instead of waited for. Drivers without pixel buffers read the frame straight away, which does wait for the GPU
+class FrameCapture {
+public:
+    // Constructor with the directory the screenshots and clips are saved in, it should end with a slash
+    explicit FrameCapture(const std::string& outputDirectory, const FrameCaptureSettings& settings = FrameCaptureSettings());
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Method to save the next frame as a screenshot
+    void requestScreenshot() {
+        screenshotRequested = true;
+    }
+
+    // Method to save the clip buffer as a numbered sequence of PNGs, it is copied and encoded on the worker thread
+    void saveClip();
+
+    // Method to capture the frame that has just been drawn, call it every frame just before display() with the window's context active
+    void capture(sf::RenderWindow& window);
+
+    // Returns how many captured frames were dropped because the worker hadn't finished with the earlier ones
+    std::size_t getDroppedCount() const {
+        return droppedCount;
+    }
+
+    // Returns the longest capture() has taken, which is what capturing costs the frame
+    sf::Time getWorstCaptureTime() const {
+        return worstCaptureTime;
+    }
+
+private:
+    struct Readback {
+        unsigned int buffer = 0;     // The OpenGL pixel buffer
+        bool pending = false;        // Waiting to be mapped
+        bool screenshot = false;     // Also save it as a screenshot, rather than only keeping it for the clip
+        bool clip = false;
+        std::uint64_t frame = 0;     // The frame it was asked for on
+    };
+
+    enum class JobKind {
+        Frame,
+        SaveClip
+    };
+
+    struct Job {
+        JobKind kind;
+        std::size_t staging;  // Which staging frame holds the pixels
+        unsigned width;
+        unsigned height;
+        bool screenshot;
+        bool clip;
+    };
+
+    bool loadFunctions();
+    void resize(const sf::Vector2u& size);
+    void releaseBuffers();
+    void request(Readback& readback);
+    void collect(Readback& readback);
+    bool takeStaging(std::size_t& index);
+    void queueFrame(std::size_t staging, bool screenshot, bool clip);
+    void run();
+    void processFrame(const Job& job);
+    void writeClip();
+
+    std::string outputDirectory;
+    FrameCaptureSettings settings;
+    bool functionsLoaded = false;
+    bool pixelBuffers = false;      // False when the driver has no pixel buffers and frames are read straight away
+    sf::Vector2u frameSize;
+    std::vector<Readback> readbacks;
+    std::size_t nextReadback = 0;
+    std::uint64_t frameCount = 0;
+    sf::Clock clipClock;
+    float nextClipTime = 0.f;
+    std::atomic<bool> screenshotRequested;
+    std::size_t droppedCount = 0;
+    sf::Time worstCaptureTime;
+
+    // Staging frames, handed between the game thread and the worker
+    std::mutex stagingMutex;
+    std::vector<std::vector<std::uint8_t>> staging;
+    std::vector<std::size_t> freeStaging;
+
+    // The rolling clip, only touched by the worker after it has been made
+    std::vector<std::vector<std::uint8_t>> clipFrames;
+    unsigned clipWidth = 0;
+    unsigned clipHeight = 0;
+    std::size_t clipNext = 0;
+    std::size_t clipCount = 0;
+
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::deque<Job> jobs;
+    bool stopping = false;
+    unsigned savedScreenshots = 0;
+    unsigned savedClips = 0;
+    std::thread worker;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Logger.h"
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
+#include <SFML/System/Time.hpp>
+#include <algorithm>
+#include <cmath>
+
+// Frame pacer for the game loop, it holds each frame until its deadline so the game runs at a steady target rate instead of spinning a core
+// Waiting is done in two parts: a coarse sf::sleep for most of the time, then a short spin for the last bit because sleeps can overshoot.
+// How long to spin for adapts to how much the sleeps on this machine actually overshoot
+class FramePacer {
+public:
+    // Constructor for the pacer with the target frame rate for gameplay and the lower rate used for menus to save power
+    FramePacer(float targetRate, float lowPowerRate)
+        : targetRate(targetRate), lowPowerRate(lowPowerRate), lowPowerMode(false), spinMargin(sf::milliseconds(2)) {
+        nextDeadline = clock.getElapsedTime() + getFramePeriod();
+    }
+
+    // Method to change the gameplay frame rate
+    void setTargetRate(float rate) {
+        targetRate = rate;
+    }
+
+    // Method to switch to the low power rate, for menus and the victory and defeat screens where nothing needs to be smooth
+    void setLowPowerMode(bool enabled) {
+        lowPowerMode = enabled;
+    }
+
+    // Returns the frame rate currently being aimed for
+    float getCurrentRate() const {
+        return lowPowerMode ? lowPowerRate : targetRate;
+    }
+
+    // Method to call once per frame after the window has been displayed, it returns once this frame's deadline has been reached
+    void waitForNextFrame() {
+        sf::Time now = clock.getElapsedTime();
+
+        // Sleep for most of the remaining time, leaving the spin margin to finish off precisely
+        sf::Time sleepTime = nextDeadline - now - spinMargin;
+        if (sleepTime > sf::Time::Zero) {
+            sf::sleep(sleepTime);
+            sf::Time slept = clock.getElapsedTime() - now;
+            adaptSpinMargin(slept - sleepTime);
+        }
+
+        // Spin until the deadline
+        while (clock.getElapsedTime() < nextDeadline) {
+        }
+
+        // Record how close to the deadline the frame was released
+        now = clock.getElapsedTime();
+        recordDeadline(now - nextDeadline);
+
+        // Schedule the next deadline from this one so small errors don't build up, unless the frame was so late that
+        // catching up would mean running several frames back to back
+        nextDeadline += getFramePeriod();
+        if (nextDeadline < now) {
+            nextDeadline = now + getFramePeriod();
+        }
+
+        if (reportClock.getElapsedTime().asSeconds() >= reportInterval) {
+            report();
+        }
+    }
+
+    // Returns the average distance from the deadline in microseconds since the last report
+    float getMeanErrorMicroseconds() const {
+        return deadlines > 0 ? static_cast<float>(totalError) / deadlines : 0.f;
+    }
+
+    // Returns the latest a frame was released since the last report in microseconds
+    sf::Int64 getWorstLateMicroseconds() const {
+        return worstLate;
+    }
+
+private:
+    // A frame released more than this after its deadline counts as a missed deadline
+    static constexpr float missThresholdMicroseconds = 1000.f;
+    static constexpr float reportInterval = 10.f;
+
+    sf::Time getFramePeriod() const {
+        return sf::seconds(1.f / getCurrentRate());
+    }
+
+    // Method to move the spin margin towards how much the last sleep overshot, it jumps up straight away if a sleep overshoots more
+    // than the margin and only creeps back down, so one quiet sleep doesn't make the next frame late
+    void adaptSpinMargin(sf::Time overshoot) {
+        sf::Int64 overshootMicroseconds = std::max<sf::Int64>(0, overshoot.asMicroseconds());
+        sf::Int64 margin = spinMargin.asMicroseconds();
+        if (overshootMicroseconds > margin) {
+            margin = overshootMicroseconds;
+        }
+        else {
+            margin = (margin * 15 + overshootMicroseconds) / 16;
+        }
+        spinMargin = sf::microseconds(std::max<sf::Int64>(250, std::min<sf::Int64>(margin, 4000)));
+    }
+
+    // Method to add one frame's deadline error to the statistics
+    void recordDeadline(sf::Time error) {
+        sf::Int64 errorMicroseconds = error.asMicroseconds();
+        ++deadlines;
+        totalError += errorMicroseconds;
+        worstLate = std::max(worstLate, errorMicroseconds);
+        if (errorMicroseconds > missThresholdMicroseconds) {
+            ++missedDeadlines;
+        }
+    }
+
+    // Method to print how accurately the pacer hit its deadlines since the last report and start counting again
+    void report() {
+        LOG_INFO("[frame pacer] target {} fps, mean error {} us, worst {} us late, missed {} of {} deadlines, spin margin {} us",
+            getCurrentRate(), getMeanErrorMicroseconds(), worstLate, missedDeadlines, deadlines, spinMargin.asMicroseconds());
+        deadlines = 0;
+        missedDeadlines = 0;
+        totalError = 0;
+        worstLate = 0;
+        reportClock.restart();
+    }
+
+    float targetRate;
+    float lowPowerRate;
+    bool lowPowerMode;
+    sf::Time spinMargin;
+    sf::Clock clock;
+    sf::Time nextDeadline;
+
+    // Deadline statistics since the last report
+    sf::Clock reportClock;
+    sf::Int64 deadlines = 0;
+    sf::Int64 missedDeadlines = 0;
+    sf::Int64 totalError = 0;
+    sf::Int64 worstLate = 0;
+};
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The sound effects the game can play
+enum class SoundEffect {
+    PlayerShot,
+    EnemyShot,
+    Hit,
+    Explosion,
+    Count
+};
+
+// Game audio service, it streams the background music and plays the sound effects from a fixed pool of voices
+// Every sound buffer is made when the service is created and each voice is tied to one effect's buffer for good, so playing a sound
+// from the game loop never allocates or loads anything. The number of voices playing at once is capped well under OpenAL's source limit:
+// when the cap is reached a new sound takes over the oldest voice of the same or lower priority, or is dropped if everything playing matters more.
+// Each effect can also only be started so often, so a screen full of enemies firing doesn't play hundreds of identical sounds
+class GameAudio {
+public:
+    GameAudio()
+        : voiceBudget(24), stolenCount(0), droppedCount(0), rateLimitedCount(0) {
+        // Priority, voices, shortest gap between plays and volume for each effect
+        settings[static_cast<int>(SoundEffect::PlayerShot)] = { 2, 8, sf::milliseconds(50), 35.f };
+        settings[static_cast<int>(SoundEffect::EnemyShot)] = { 1, 10, sf::milliseconds(40), 20.f };
+        settings[static_cast<int>(SoundEffect::Hit)] = { 2, 6, sf::milliseconds(30), 45.f };
+        settings[static_cast<int>(SoundEffect::Explosion)] = { 3, 6, sf::milliseconds(60), 70.f };
+
+        synthesiseBuffers();
+
+        // Make every voice up front and tie it to its effect's buffer, the voices are never added to or moved after this
+        std::size_t totalVoices = 0;
+        for (int effect = 0; effect < effectCount; ++effect) {
+            totalVoices += settings[effect].voices;
+        }
+        voices.reset(new Voice[totalVoices]);
+        voiceCount = totalVoices;
+
+        std::size_t next = 0;
+        for (int effect = 0; effect < effectCount; ++effect) {
+            firstVoice[effect] = next;
+            for (int i = 0; i < settings[effect].voices; ++i, ++next) {
+                voices[next].sound.setBuffer(buffers[effect]);
+                voices[next].sound.setVolume(settings[effect].volume);
+                voices[next].effect = effect;
+            }
+            lastPlayed[effect] = sf::seconds(-1.f);
+        }
+    }
+
+    ~GameAudio() {
+        // Stop the voices before the buffers they use are destroyed
+        for (std::size_t i = 0; i < voiceCount; ++i) {
+            voices[i].sound.stop();
+        }
+        music.stop();
+    }
+
+    GameAudio(const GameAudio&) = delete;
+    GameAudio& operator=(const GameAudio&) = delete;
+
+    // Method to replace an effect's built in sound with one loaded from a file, this must be called before the game loop starts
+    bool loadEffect(SoundEffect effect, const std::string& file) {
+        int index = static_cast<int>(effect);
+        for (int i = 0; i < settings[index].voices; ++i) {
+            voices[firstVoice[index] + i].sound.stop();
+        }
+        if (!buffers[index].loadFromFile(file)) {
+            std::cerr << "Error loading sound " << file << ", keeping the built in one" << std::endl;
+            synthesise(effect);
+            return false;
+        }
+        return true;
+    }
+
+    // Method to start streaming the background music on a loop, the music is read from the file a bit at a time on SFML's streaming thread
+    bool playMusic(const std::string& file, float volume = 40.f) {
+        if (!music.openFromFile(file)) {
+            std::cerr << "Error loading music " << file << std::endl;
+            return false;
+        }
+        music.setLoop(true);
+        music.setVolume(volume);
+        music.play();
+        return true;
+    }
+
+    void stopMusic() {
+        music.stop();
+    }
+
+    // Method to silence the sound effects, for runs nobody is listening to such as the headless soak test
+    void setMuted(bool mute) {
+        muted = mute;
+    }
+
+    // Method to play a sound effect, this is safe to call as often as the game likes
+    void play(SoundEffect effect, float pitch = 1.f) {
+        if (muted) {
+            return;
+        }
+        int index = static_cast<int>(effect);
+        const EffectSettings& effectSettings = settings[index];
+
+        // Don't start the same effect again too soon after the last one
+        sf::Time now = clock.getElapsedTime();
+        if (now - lastPlayed[index] < effectSettings.minimumGap) {
+            ++rateLimitedCount;
+            return;
+        }
+
+        // Use a free voice of this effect, or take over its own oldest voice if they are all busy
+        Voice* voice = nullptr;
+        Voice* oldest = nullptr;
+        for (int i = 0; i < effectSettings.voices; ++i) {
+            Voice& candidate = voices[firstVoice[index] + i];
+            if (candidate.sound.getStatus() != sf::Sound::Playing) {
+                voice = &candidate;
+                break;
+            }
+            if (oldest == nullptr || candidate.startTime < oldest->startTime) {
+                oldest = &candidate;
+            }
+        }
+
+        if (voice == nullptr) {
+            voice = oldest;
+            voice->sound.stop();
+            ++stolenCount;
+        }
+        else if (countPlayingVoices() >= voiceBudget) {
+            // Too many sounds are playing in total, so stop the least important one to make room
+            Voice* victim = findVoiceToSteal(effectSettings.priority);
+            if (victim == nullptr) {
+                ++droppedCount;  // Everything playing is more important than this sound
+                return;
+            }
+            victim->sound.stop();
+            ++stolenCount;
+        }
+
+        voice->sound.setPitch(pitch);
+        voice->sound.play();
+        voice->startTime = now;
+        lastPlayed[index] = now;
+    }
+
+    // Returns how many voices have been stopped early to make room for another sound
+    std::size_t getStolenCount() const { return stolenCount; }
+
+    // Returns how many sounds weren't played because every voice was busy with something more important
+    std::size_t getDroppedCount() const { return droppedCount; }
+
+    // Returns how many sounds weren't played because the same effect had only just been played
+    std::size_t getRateLimitedCount() const { return rateLimitedCount; }
+
+private:
+    static const int effectCount = static_cast<int>(SoundEffect::Count);
+    static const unsigned sampleRate = 44100;
+
+    struct EffectSettings {
+        int priority;          // Higher priority sounds can take voices from lower ones
+        int voices;            // How many of this effect can play at once
+        sf::Time minimumGap;   // Shortest time between two plays of this effect
+        float volume;
+    };
+
+    struct Voice {
+        sf::Sound sound;
+        int effect = 0;
+        sf::Time startTime;
+    };
+
+    std::size_t countPlayingVoices() const {
+        std::size_t playing = 0;
+        for (std::size_t i = 0; i < voiceCount; ++i) {
+            if (voices[i].sound.getStatus() == sf::Sound::Playing) {
+                ++playing;
+            }
+        }
+        return playing;
+    }
+
+    // Returns the playing voice with the lowest priority not above this one, the oldest if there are several, or nullptr if there isn't one
+    Voice* findVoiceToSteal(int priority) {
+        Voice* victim = nullptr;
+        for (std::size_t i = 0; i < voiceCount; ++i) {
+            Voice& candidate = voices[i];
+            int candidatePriority = settings[candidate.effect].priority;
+            if (candidatePriority > priority || candidate.sound.getStatus() != sf::Sound::Playing) {
+                continue;
+            }
+            if (victim == nullptr || candidatePriority < settings[victim->effect].priority ||
+                (candidatePriority == settings[victim->effect].priority && candidate.startTime < victim->startTime)) {
+                victim = &candidate;
+            }
+        }
+        return victim;
+    }
+
+    // Method to make the built in sound for every effect, so the game has sound without any sound files
+    void synthesiseBuffers() {
+        for (int effect = 0; effect < effectCount; ++effect) {
+            synthesise(static_cast<SoundEffect>(effect));
+        }
+    }
+
+    // Method to make one effect's built in sound, a falling tone for shots and a burst of fading noise for hits and explosions
+    void synthesise(SoundEffect effect) {
+        float length = 0.1f;
+        float startFrequency = 0.f;
+        float endFrequency = 0.f;
+        float noise = 0.f;  // How much of the sound is noise rather than tone, 0 to 1
+        switch (effect) {
+        case SoundEffect::PlayerShot: length = 0.08f; startFrequency = 1400.f; endFrequency = 500.f; noise = 0.1f; break;
+        case SoundEffect::EnemyShot:  length = 0.1f;  startFrequency = 700.f;  endFrequency = 250.f; noise = 0.1f; break;
+        case SoundEffect::Hit:        length = 0.06f; startFrequency = 300.f;  endFrequency = 150.f; noise = 0.7f; break;
+        case SoundEffect::Explosion:  length = 0.6f;  startFrequency = 120.f;  endFrequency = 40.f;  noise = 0.9f; break;
+        default: break;
+        }
+
+        std::size_t sampleCount = static_cast<std::size_t>(length * sampleRate);
+        std::vector<sf::Int16> samples(sampleCount);
+        std::uint32_t random = 12345;
+        float tonePhase = 0.f;
+        float smoothedNoise = 0.f;
+        for (std::size_t i = 0; i < sampleCount; ++i) {
+            float progress = static_cast<float>(i) / sampleCount;
+            float frequency = startFrequency + (endFrequency - startFrequency) * progress;
+            tonePhase += 6.28318531f * frequency / sampleRate;
+            float tone = tonePhase - 6.28318531f * std::floor(tonePhase / 6.28318531f) < 3.14159265f ? 1.f : -1.f;  // Square wave
+
+            random = random * 1664525u + 1013904223u;
+            float white = static_cast<float>(random >> 8) / 8388608.f - 1.f;
+            smoothedNoise += (white - smoothedNoise) * (frequency / 2000.f);  // Lower tones get a darker, rumbling noise
+
+            float envelope = (1.f - progress) * (1.f - progress);
+            float value = (tone * (1.f - noise) + smoothedNoise * noise * 2.f) * envelope;
+            samples[i] = static_cast<sf::Int16>(std::max(-1.f, std::min(1.f, value)) * 20000.f);
+        }
+        buffers[static_cast<int>(effect)].loadFromSamples(samples.data(), samples.size(), 1, sampleRate);
+    }
+
+    EffectSettings settings[effectCount];
+    sf::SoundBuffer buffers[effectCount];
+    std::size_t firstVoice[effectCount];
+    sf::Time lastPlayed[effectCount];
+
+    std::unique_ptr<Voice[]> voices;
+    std::size_t voiceCount;
+    std::size_t voiceBudget;  // Most voices allowed to play at once across every effect
+    bool muted = false;
+
+    sf::Music music;
+    sf::Clock clock;
+
+    std::size_t stolenCount;
+    std::size_t droppedCount;
+    std::size_t rateLimitedCount;
+};
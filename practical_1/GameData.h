@@ -0,0 +1,462 @@
+#pragma once
+
+#include "BulletPattern.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Tuning, enemy, weapon and level data loaded from text files, so balance changes don't need the game rebuilding.
+// Each file is a list of sections, each section a list of "key = value" lines, # starts a comment:
+//
+//     [player]                       speed, fireCooldown, bulletSpeed, bulletDamage
+//     [enemy]                        health, width, height, pattern (used by every level enemy)
+//     [pattern <name>]               aim (fixed, player or rotating), angle, count, arc, speed, speedVariation, spin, cooldown, damage
+//     [level <1 to 10>]              enemy = x y speedFactor [pattern], swarm = <chaser|strafer|kamikaze|turret|spiral> x y [phase]
+//
+// Anything a file leaves out keeps the value the game is built with, and a level that isn't in the files uses the one in main.cpp.
+// A set of files is only used if every line in it is valid, so a half saved or mistyped file never reaches the game
+
+// The player's movement and weapon
+struct PlayerTuning {
+    float speed = 300.f;        // Pixels per second
+    float fireCooldown = 0.1f;  // Seconds between shots
+    float bulletSpeed = 1200.f; // Pixels per second
+    int bulletDamage = 5;
+};
+
+// What every level enemy starts with, the speed and position come from the level
+struct EnemyTuning {
+    int health = 50;
+    float width = 50.f;
+    float height = 50.f;
+    std::string pattern = "straight";
+};
+
+// The archetypes a level can add to the swarm
+enum class SwarmKind {
+    Chaser,
+    Strafer,
+    Kamikaze,
+    Turret,
+    Spiral
+};
+
+struct EnemySpawn {
+    float x;
+    float y;
+    float speedFactor;    // Fraction of the player's speed
+    std::string pattern;  // Empty for the [enemy] pattern
+    float fireRate = 1.f; // How many times as often as its pattern's cooldown the enemy fires, only the endless waves change this
+};
+
+struct SwarmSpawn {
+    SwarmKind kind;
+    float x;
+    float y;
+    float phase;
+};
+
+struct LevelDefinition {
+    std::vector<EnemySpawn> enemies;
+    std::vector<SwarmSpawn> swarm;
+};
+
+// A pattern from the files, its angle and speed tables are built when the files are loaded so switching to it is only a move
+struct LoadedPattern {
+    std::string name;
+    BulletPattern pattern;
+};
+
+// Everything loaded from one set of files
+struct GameData {
+    PlayerTuning player;
+    EnemyTuning enemy;
+    std::vector<LoadedPattern> patterns;
+    std::map<int, LevelDefinition> levels;
+};
+
+// Why a set of files was turned down, the file and reason are string literals so they can be passed straight to the logger
+struct DataError {
+    const char* file = "";
+    int line = 0;
+    const char* reason = "";
+};
+
+// The files that are read from the data directory, in this order
+const char* const gameDataFiles[] = { "player.txt", "enemies.txt", "levels.txt" };
+const int gameDataFileCount = 3;
+const int gameDataLevelCount = 10;
+
+// Method to read a float, the whole text has to be the number
+inline bool parseDataFloat(const std::string& text, float& value) {
+    char* end = nullptr;
+    value = std::strtof(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && std::isfinite(value);
+}
+
+inline bool parseDataInt(const std::string& text, int& value) {
+    char* end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    value = static_cast<int>(parsed);
+    return !text.empty() && *end == '\0' && parsed == value;
+}
+
+// Method to remove spaces and tabs from both ends of some text
+inline std::string trimData(const std::string& text) {
+    std::size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    std::size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+// Reads the data files into a GameData, line by line, stopping at the first problem
+class GameDataParser {
+public:
+    explicit GameDataParser(GameData& data)
+        : data(data) {
+    }
+
+    // Method to read one file, returns false and fills in the error if any line in it is wrong
+    bool parse(std::istream& input, const char* file, DataError& error) {
+        error.file = file;
+        section = Section::None;
+        currentPattern = nullptr;
+        currentLevel = nullptr;
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(input, line)) {
+            ++lineNumber;
+            error.line = lineNumber;
+            std::size_t comment = line.find('#');
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+            line = trimData(line);
+            if (line.empty()) {
+                continue;
+            }
+
+            const char* reason = line[0] == '[' ? parseSection(line) : parseValue(line);
+            if (reason != nullptr) {
+                error.reason = reason;
+                return false;
+            }
+        }
+
+        // Patterns are only checked once their whole section has been read
+        if (const char* reason = finishPattern()) {
+            error.reason = reason;
+            return false;
+        }
+        return true;
+    }
+
+    // Method to check the things that can only be checked once every file has been read, the patterns enemies use have to exist
+    bool validate(DataError& error) const {
+        error = DataError();
+        error.file = "(all files)";
+
+        auto known = [this](const std::string& name) {
+            if (isBuiltInPattern(name)) {
+                return true;
+            }
+            for (const LoadedPattern& loaded : data.patterns) {
+                if (loaded.name == name) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        if (!known(data.enemy.pattern)) {
+            error.reason = "the [enemy] pattern doesn't exist";
+            return false;
+        }
+        for (const auto& level : data.levels) {
+            for (const EnemySpawn& spawn : level.second.enemies) {
+                if (!spawn.pattern.empty() && !known(spawn.pattern)) {
+                    error.line = level.first;
+                    error.reason = "a level enemy uses a pattern that doesn't exist (line is the level number)";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    enum class Section { None, Player, Enemy, Pattern, Level };
+
+    // Method to start a new section, returns the reason if the header is wrong
+    const char* parseSection(const std::string& line) {
+        if (const char* reason = finishPattern()) {
+            return reason;
+        }
+        if (line.back() != ']') {
+            return "a section header has no closing ]";
+        }
+
+        std::istringstream header(line.substr(1, line.size() - 2));
+        std::string name;
+        std::string argument;
+        std::string extra;
+        header >> name >> argument >> extra;
+        if (!extra.empty()) {
+            return "a section header has too many words";
+        }
+
+        if (name == "player" && argument.empty()) {
+            section = Section::Player;
+        }
+        else if (name == "enemy" && argument.empty()) {
+            section = Section::Enemy;
+        }
+        else if (name == "pattern") {
+            if (argument.empty()) {
+                return "a [pattern] section needs a name";
+            }
+            for (const LoadedPattern& loaded : data.patterns) {
+                if (loaded.name == argument) {
+                    return "the same pattern is defined twice";
+                }
+            }
+            section = Section::Pattern;
+            patternName = argument;
+            patternDefinition = PatternDefinition();
+            currentPattern = &patternDefinition;
+        }
+        else if (name == "level") {
+            int level = 0;
+            if (!parseDataInt(argument, level) || level < 1 || level > gameDataLevelCount) {
+                return "a [level] section needs a level number from 1 to 10";
+            }
+            if (data.levels.count(level) > 0) {
+                return "the same level is defined twice";
+            }
+            section = Section::Level;
+            currentLevel = &data.levels[level];
+        }
+        else {
+            return "unknown section, expected player, enemy, pattern <name> or level <number>";
+        }
+        return nullptr;
+    }
+
+    // Method to read a key = value line in the current section
+    const char* parseValue(const std::string& line) {
+        std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            return "expected key = value";
+        }
+        std::string key = trimData(line.substr(0, equals));
+        std::string value = trimData(line.substr(equals + 1));
+
+        switch (section) {
+        case Section::Player:
+            return parsePlayerValue(key, value);
+        case Section::Enemy:
+            return parseEnemyValue(key, value);
+        case Section::Pattern:
+            return parsePatternValue(key, value);
+        case Section::Level:
+            return parseLevelValue(key, value);
+        default:
+            return "a value before the first section";
+        }
+    }
+
+    const char* parsePlayerValue(const std::string& key, const std::string& value) {
+        PlayerTuning& player = data.player;
+        if (key == "speed") {
+            return parseDataFloat(value, player.speed) && player.speed > 0.f ? nullptr : "player speed must be a number above 0";
+        }
+        if (key == "fireCooldown") {
+            return parseDataFloat(value, player.fireCooldown) && player.fireCooldown >= 0.01f ? nullptr : "player fireCooldown must be at least 0.01";
+        }
+        if (key == "bulletSpeed") {
+            return parseDataFloat(value, player.bulletSpeed) && player.bulletSpeed > 0.f ? nullptr : "player bulletSpeed must be a number above 0";
+        }
+        if (key == "bulletDamage") {
+            return parseDataInt(value, player.bulletDamage) && player.bulletDamage >= 0 ? nullptr : "player bulletDamage must be a whole number, 0 or more";
+        }
+        return "unknown [player] key";
+    }
+
+    const char* parseEnemyValue(const std::string& key, const std::string& value) {
+        EnemyTuning& enemy = data.enemy;
+        if (key == "health") {
+            return parseDataInt(value, enemy.health) && enemy.health > 0 ? nullptr : "enemy health must be a whole number above 0";
+        }
+        if (key == "width") {
+            return parseDataFloat(value, enemy.width) && enemy.width > 0.f ? nullptr : "enemy width must be a number above 0";
+        }
+        if (key == "height") {
+            return parseDataFloat(value, enemy.height) && enemy.height > 0.f ? nullptr : "enemy height must be a number above 0";
+        }
+        if (key == "pattern") {
+            enemy.pattern = value;
+            return value.empty() ? "enemy pattern needs a name" : nullptr;
+        }
+        return "unknown [enemy] key";
+    }
+
+    const char* parsePatternValue(const std::string& key, const std::string& value) {
+        PatternDefinition& pattern = *currentPattern;
+        if (key == "aim") {
+            if (value == "fixed") {
+                pattern.aim = PatternAim::Fixed;
+            }
+            else if (value == "player") {
+                pattern.aim = PatternAim::AtPlayer;
+            }
+            else if (value == "rotating") {
+                pattern.aim = PatternAim::Rotating;
+            }
+            else {
+                return "pattern aim must be fixed, player or rotating";
+            }
+            return nullptr;
+        }
+        if (key == "angle") {
+            return parseDataFloat(value, pattern.angle) ? nullptr : "pattern angle must be a number";
+        }
+        if (key == "count") {
+            return parseDataInt(value, pattern.count) ? nullptr : "pattern count must be a whole number";
+        }
+        if (key == "arc") {
+            return parseDataFloat(value, pattern.arc) ? nullptr : "pattern arc must be a number";
+        }
+        if (key == "speed") {
+            return parseDataFloat(value, pattern.speed) ? nullptr : "pattern speed must be a number";
+        }
+        if (key == "speedVariation") {
+            return parseDataFloat(value, pattern.speedVariation) ? nullptr : "pattern speedVariation must be a number";
+        }
+        if (key == "spin") {
+            return parseDataFloat(value, pattern.spin) ? nullptr : "pattern spin must be a number";
+        }
+        if (key == "cooldown") {
+            return parseDataFloat(value, pattern.cooldown) ? nullptr : "pattern cooldown must be a number";
+        }
+        if (key == "damage") {
+            return parseDataInt(value, pattern.damage) ? nullptr : "pattern damage must be a whole number";
+        }
+        return "unknown [pattern] key";
+    }
+
+    // Method to check the pattern that was being read and build it, nothing happens if the last section wasn't a pattern
+    const char* finishPattern() {
+        if (currentPattern == nullptr) {
+            return nullptr;
+        }
+        const PatternDefinition& pattern = *currentPattern;
+        currentPattern = nullptr;
+        if (pattern.count < 1 || pattern.count > 2000) {
+            return "pattern count must be from 1 to 2000";
+        }
+        if (pattern.arc < 0.f) {
+            return "pattern arc can't be negative";
+        }
+        if (pattern.speed <= 0.f) {
+            return "pattern speed must be above 0";
+        }
+        if (pattern.speedVariation < 0.f || pattern.speedVariation >= 1.f) {
+            return "pattern speedVariation must be from 0 up to (not including) 1";
+        }
+        if (pattern.cooldown < 0.01f) {
+            return "pattern cooldown must be at least 0.01";
+        }
+        if (pattern.damage < 0) {
+            return "pattern damage can't be negative";
+        }
+        data.patterns.push_back({ patternName, BulletPattern(pattern) });
+        return nullptr;
+    }
+
+    const char* parseLevelValue(const std::string& key, const std::string& value) {
+        std::istringstream words(value);
+        std::vector<std::string> fields;
+        std::string word;
+        while (words >> word) {
+            fields.push_back(word);
+        }
+
+        if (key == "enemy") {
+            EnemySpawn spawn;
+            if (fields.size() < 3 || fields.size() > 4 ||
+                !parseDataFloat(fields[0], spawn.x) || !parseDataFloat(fields[1], spawn.y) || !parseDataFloat(fields[2], spawn.speedFactor)) {
+                return "a level enemy is written as enemy = x y speedFactor [pattern]";
+            }
+            if (spawn.speedFactor < 0.f) {
+                return "a level enemy's speedFactor can't be negative";
+            }
+            if (fields.size() == 4) {
+                spawn.pattern = fields[3];
+            }
+            currentLevel->enemies.push_back(spawn);
+            return nullptr;
+        }
+        if (key == "swarm") {
+            SwarmSpawn spawn;
+            spawn.phase = 0.f;
+            if (fields.size() < 3 || fields.size() > 4 ||
+                !parseDataFloat(fields[1], spawn.x) || !parseDataFloat(fields[2], spawn.y) || (fields.size() == 4 && !parseDataFloat(fields[3], spawn.phase))) {
+                return "a swarm enemy is written as swarm = archetype x y [phase]";
+            }
+            static const std::pair<const char*, SwarmKind> kinds[] = {
+                { "chaser", SwarmKind::Chaser }, { "strafer", SwarmKind::Strafer }, { "kamikaze", SwarmKind::Kamikaze },
+                { "turret", SwarmKind::Turret }, { "spiral", SwarmKind::Spiral }
+            };
+            for (const auto& kind : kinds) {
+                if (fields[0] == kind.first) {
+                    spawn.kind = kind.second;
+                    currentLevel->swarm.push_back(spawn);
+                    return nullptr;
+                }
+            }
+            return "swarm archetype must be chaser, strafer, kamikaze, turret or spiral";
+        }
+        return "unknown [level] key, expected enemy or swarm";
+    }
+
+    GameData& data;
+    Section section = Section::None;
+    std::string patternName;
+    PatternDefinition patternDefinition;
+    PatternDefinition* currentPattern = nullptr;  // The pattern being read, or nullptr outside a pattern section
+    LevelDefinition* currentLevel = nullptr;
+};
+
+// Method to load every data file in a directory into a new GameData, a missing file is skipped so its values stay as the game's own
+// Returns false and fills in the error if any file has a problem, in which case nothing from any of the files should be used
+inline bool loadGameData(const std::string& directory, GameData& data, DataError& error) {
+    data = GameData();
+    GameDataParser parser(data);
+    for (int i = 0; i < gameDataFileCount; ++i) {
+        std::ifstream file(directory + gameDataFiles[i]);
+        if (file && !parser.parse(file, gameDataFiles[i], error)) {
+            return false;
+        }
+    }
+
+    // A level with nothing in it would be won the moment it started, which is never what the designer meant
+    for (const auto& level : data.levels) {
+        if (level.second.enemies.empty() && level.second.swarm.empty()) {
+            error = DataError();
+            error.file = "(all files)";
+            error.line = level.first;
+            error.reason = "a level has no enemies (line is the level number)";
+            return false;
+        }
+    }
+    return parser.validate(error);
+}
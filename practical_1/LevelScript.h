@@ -0,0 +1,310 @@
+#pragma once
+
+#include "SlotMap.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <vector>
+
+// Level scripts are sequences such as "spawn a wave, wait 3 seconds or until it is cleared, spawn the boss" written as one function
+// that gives control back to the scheduler whenever it has to wait, and carries on from the same place when the wait is over.
+// The game is C++14, so instead of C++20 coroutines a script is a resumable function in the style of a protothread: its body goes
+// between SCRIPT_BEGIN and SCRIPT_END and each wait is a SCRIPT_AWAIT, which remembers the line it stopped on and jumps back there
+// the next time the script is resumed. Like any stackless coroutine nothing on the stack survives a wait, so anything a script needs
+// after waiting has to be a member of the script (local variables can't be declared across a SCRIPT_AWAIT at all)
+
+// Method to open a script's body, it jumps to wherever the script last stopped
+#define SCRIPT_BEGIN switch (resumePoint) { case 0:
+
+// Method to wait, the script returns the wait to the scheduler and is resumed on the line after once it is over
+#define SCRIPT_AWAIT(wait) do { resumePoint = __LINE__; return (wait); case __LINE__:; } while (0)
+
+// Method to close a script's body, once it gets here the script has finished and the scheduler removes it
+#define SCRIPT_END } resumePoint = -1; return finished()
+
+// What a script is waiting for when it gives control back
+template <typename Context>
+struct ScriptWait {
+    enum Kind {
+        Finished,
+        Ticks,      // A number of scheduler updates
+        Seconds,    // An amount of simulation time
+        Signal,     // Until the game raises a signal, or the timeout runs out
+        Condition   // Until a check on the context passes, or the timeout runs out
+    };
+
+    Kind kind = Finished;
+    double amount = 0.0;  // The ticks or seconds to wait, or the timeout for a signal or condition (0 waits for ever)
+    int signal = 0;
+    bool (*condition)(const Context&) = nullptr;  // A plain function so waiting on it never allocates
+};
+
+// A level script, made by deriving from this and writing resume() with SCRIPT_BEGIN, SCRIPT_AWAIT and SCRIPT_END
+// The context is whatever the scripts act on, it is passed in every time the script is resumed
+template <typename Context>
+class Script {
+public:
+    using Wait = ScriptWait<Context>;
+
+    virtual ~Script() = default;
+
+    // Method to run the script until its next wait, which it returns
+    virtual Wait resume(Context& context) = 0;
+
+    // Returns true if the script was resumed because its signal or condition wait timed out rather than being met
+    bool timedOut() const {
+        return waitTimedOut;
+    }
+
+protected:
+    // The waits a script can return with SCRIPT_AWAIT
+    static Wait waitTicks(int ticks) {
+        Wait wait;
+        wait.kind = Wait::Ticks;
+        wait.amount = ticks;
+        return wait;
+    }
+
+    static Wait waitSeconds(double seconds) {
+        Wait wait;
+        wait.kind = Wait::Seconds;
+        wait.amount = seconds;
+        return wait;
+    }
+
+    static Wait waitForSignal(int signal, double timeout = 0.0) {
+        Wait wait;
+        wait.kind = Wait::Signal;
+        wait.signal = signal;
+        wait.amount = timeout;
+        return wait;
+    }
+
+    static Wait waitUntil(bool (*condition)(const Context&), double timeout = 0.0) {
+        Wait wait;
+        wait.kind = Wait::Condition;
+        wait.condition = condition;
+        wait.amount = timeout;
+        return wait;
+    }
+
+    static Wait finished() {
+        return Wait();
+    }
+
+    int resumePoint = 0;  // The line the script last stopped on, used by the SCRIPT_ macros
+
+private:
+    template <typename> friend class ScriptScheduler;
+    bool waitTimedOut = false;
+};
+
+// Runs level scripts on simulation time, each script is only resumed when what it is waiting for has happened
+// Scripts waiting on ticks or seconds sit in a queue ordered by when they wake, so each update only looks at the front of it however many
+// scripts are asleep. Scripts waiting on a signal sit in that signal's list until the game raises it. Only condition waits are checked
+// every update, so they are for the rare case where there's no signal to wait on.
+// Every wait has its own number, so when a signal or condition with a timeout is met the timeout left in the queue is ignored.
+// A signal wait that times out or is stopped takes itself out of its signal's list, so signals that are rarely raised don't collect them.
+// The scheduler is only used by whichever thread runs the simulation, the same as the rest of the level
+template <typename Context>
+class ScriptScheduler {
+public:
+    using Wait = ScriptWait<Context>;
+
+    // Method to add a script, it first runs at the next update. Returns a handle that can stop it
+    SlotHandle start(std::unique_ptr<Script<Context>> script) {
+        Entry entry;
+        entry.script = std::move(script);
+        SlotHandle handle = scripts.insert(std::move(entry));
+        ready.push_back({ handle, 0, false });
+        return handle;
+    }
+
+    // Method to stop a script before it has finished, its waits left in the queues are ignored
+    void stop(SlotHandle handle) {
+        if (const Entry* entry = scripts.get(handle)) {
+            forgetSignalWait(handle, *entry);
+            scripts.erase(handle);
+        }
+    }
+
+    // Method to stop every script and empty the queues
+    void clear() {
+        scripts.clear();
+        timers = TimerQueue();
+        tickTimers = TimerQueue();
+        for (std::vector<WaitRef>& waiters : signalWaiters) {
+            waiters.clear();
+        }
+        conditionWaiters.clear();
+        ready.clear();
+    }
+
+    // Method for the game to raise a signal, every script waiting on it is resumed at the next update
+    void raise(int signal) {
+        if (signal < 0 || static_cast<std::size_t>(signal) >= signalWaiters.size()) {
+            return;
+        }
+        std::vector<WaitRef>& waiters = signalWaiters[signal];
+        ready.insert(ready.end(), waiters.begin(), waiters.end());
+        waiters.clear();
+    }
+
+    // Method to move simulation time on by one tick and resume every script whose wait is over, in the order they woke
+    void update(Context& context, double deltaTime) {
+        now += deltaTime;
+        ++tick;
+
+        wakeTimers(timers, now);
+        wakeTimers(tickTimers, static_cast<double>(tick));
+
+        // Condition waits are the only ones that cost anything while they wait
+        for (std::size_t i = 0; i < conditionWaiters.size(); ) {
+            const WaitRef& waiter = conditionWaiters[i];
+            const Entry* entry = scripts.get(waiter.handle);
+            bool stale = entry == nullptr || entry->waitId != waiter.waitId;
+            if (stale || entry->condition(context)) {
+                if (!stale) {
+                    ready.push_back(waiter);
+                }
+                conditionWaiters[i] = conditionWaiters.back();
+                conditionWaiters.pop_back();
+            }
+            else {
+                ++i;
+            }
+        }
+
+        // Resume the scripts that are ready, ones woken while doing this (by a wait of 0) go again at the next update
+        resuming.swap(ready);
+        for (const WaitRef& waiter : resuming) {
+            resume(waiter, context);
+        }
+        resuming.clear();
+    }
+
+    // Returns how many scripts haven't finished
+    std::size_t size() const {
+        return scripts.size();
+    }
+
+    // Returns the simulation time the scheduler has got to in seconds
+    double getTime() const {
+        return now;
+    }
+
+private:
+    struct Entry {
+        std::unique_ptr<Script<Context>> script;
+        std::uint32_t waitId = 0;  // Changed every time the script is resumed, so leftover wake ups for an old wait are ignored
+        int signal = -1;           // The signal the script is waiting on, or -1
+        bool (*condition)(const Context&) = nullptr;
+    };
+
+    // One wake up for one wait of one script
+    struct WaitRef {
+        SlotHandle handle;
+        std::uint32_t waitId;
+        bool timeout;  // True if this wake up is the timeout of a signal or condition wait
+    };
+
+    struct Timer {
+        double when;
+        std::uint64_t order;  // Scripts that wake at the same time are resumed in the order they went to sleep
+        WaitRef waiter;
+
+        bool operator>(const Timer& other) const {
+            return when > other.when || (when == other.when && order > other.order);
+        }
+    };
+
+    using TimerQueue = std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>>;
+
+    void wakeTimers(TimerQueue& queue, double upTo) {
+        while (!queue.empty() && queue.top().when <= upTo) {
+            ready.push_back(queue.top().waiter);
+            queue.pop();
+        }
+    }
+
+    void resume(const WaitRef& waiter, Context& context) {
+        Entry* entry = scripts.get(waiter.handle);
+        if (entry == nullptr || entry->waitId != waiter.waitId) {
+            return;  // Stopped, or already woken by something else
+        }
+        if (waiter.timeout) {
+            forgetSignalWait(waiter.handle, *entry);  // The signal wasn't raised in time, so the script is no longer waiting on it
+        }
+        entry->signal = -1;
+        ++entry->waitId;
+        entry->script->waitTimedOut = waiter.timeout;
+        Wait wait = entry->script->resume(context);
+        schedule(waiter.handle, *entry, wait);
+    }
+
+    // Method to put a script in the right queue for what it is now waiting on
+    void schedule(SlotHandle handle, Entry& entry, const Wait& wait) {
+        WaitRef waiter = { handle, entry.waitId, false };
+        switch (wait.kind) {
+        case Wait::Finished:
+            scripts.erase(handle);
+            return;
+        case Wait::Ticks:
+            tickTimers.push({ static_cast<double>(tick) + std::max(1.0, wait.amount), nextOrder++, waiter });
+            return;
+        case Wait::Seconds:
+            timers.push({ now + wait.amount, nextOrder++, waiter });
+            return;
+        case Wait::Signal:
+            if (wait.signal >= 0) {
+                if (static_cast<std::size_t>(wait.signal) >= signalWaiters.size()) {
+                    signalWaiters.resize(wait.signal + 1);
+                }
+                signalWaiters[wait.signal].push_back(waiter);
+                entry.signal = wait.signal;
+            }
+            break;
+        case Wait::Condition:
+            entry.condition = wait.condition;
+            if (wait.condition != nullptr) {
+                conditionWaiters.push_back(waiter);
+            }
+            break;
+        }
+
+        // Signal and condition waits can also time out
+        if (wait.amount > 0.0) {
+            waiter.timeout = true;
+            timers.push({ now + wait.amount, nextOrder++, waiter });
+        }
+    }
+
+    // Method to take a script's signal wait out of its signal's list, the list is short so it is searched
+    void forgetSignalWait(SlotHandle handle, const Entry& entry) {
+        if (entry.signal < 0) {
+            return;
+        }
+        std::vector<WaitRef>& waiters = signalWaiters[entry.signal];
+        for (std::size_t i = 0; i < waiters.size(); ++i) {
+            if (waiters[i].handle == handle && waiters[i].waitId == entry.waitId) {
+                waiters[i] = waiters.back();
+                waiters.pop_back();
+                return;
+            }
+        }
+    }
+
+    SlotMap<Entry> scripts;
+    TimerQueue timers;      // Waits on seconds, and the timeouts of signal and condition waits
+    TimerQueue tickTimers;  // Waits on ticks, ordered by the tick they wake on
+    std::vector<std::vector<WaitRef>> signalWaiters;
+    std::vector<WaitRef> conditionWaiters;
+    std::vector<WaitRef> ready;
+    std::vector<WaitRef> resuming;
+    double now = 0.0;
+    std::uint64_t tick = 0;
+    std::uint64_t nextOrder = 0;
+};
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+// Asynchronous logger for the game, logging from the game loop only copies the message's arguments into a lock-free ring buffer
+// and a background thread does the formatting and printing, so the game never waits on the console.
+// Messages below WARFARE_LOG_LEVEL are removed when compiling, and each place that logs can only print a few times a second,
+// anything past that is counted and the count is printed with the next message that gets through.
+//
+// Use the macros with a string literal and up to six arguments, each {} in the text is replaced by the next argument:
+//     LOG_INFO("Level {} clicked!", level);
+// Text arguments must be string literals or other strings that live for the whole game, because they are printed later
+
+// Log levels, from the most detailed to the most serious
+#define WARFARE_LOG_DEBUG 0
+#define WARFARE_LOG_INFO 1
+#define WARFARE_LOG_WARNING 2
+#define WARFARE_LOG_ERROR 3
+
+// The lowest level that is compiled in, it can be set from CMake
+#ifndef WARFARE_LOG_LEVEL
+#define WARFARE_LOG_LEVEL WARFARE_LOG_INFO
+#endif
+
+// Limits how often one place in the code can log, it allows a burst of messages in each window and counts the rest
+class LogRateLimiter {
+public:
+    // Returns true if a message may be printed now, and sets skipped to how many were held back since the last one that was
+    bool allow(std::int64_t now, std::uint32_t& skipped) {
+        std::int64_t start = windowStart.load(std::memory_order_relaxed);
+        if (now - start >= windowLength) {
+            // A new window, the first thread to get here resets the count
+            if (windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+                windowCount.store(0, std::memory_order_relaxed);
+            }
+        }
+        if (windowCount.fetch_add(1, std::memory_order_relaxed) >= burst) {
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        skipped = suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    static const std::int64_t windowLength = 1000000000;  // One second in nanoseconds
+    static const std::uint32_t burst = 5;                 // Messages allowed in each window
+
+    std::atomic<std::int64_t> windowStart{ -windowLength };
+    std::atomic<std::uint32_t> windowCount{ 0 };
+    std::atomic<std::uint32_t> suppressed{ 0 };
+};
+
+// One argument of a log message, stored as a number or a pointer so capturing it is just a copy
+struct LogArgument {
+    enum Type : std::uint8_t { Signed, Unsigned, Floating, Text, Character };
+    Type type;
+    union {
+        long long signedValue;
+        unsigned long long unsignedValue;
+        double floatingValue;
+        const char* textValue;
+    };
+};
+
+// Everything needed to print one message later
+struct LogRecord {
+    static const int maxArguments = 6;
+
+    std::int64_t time;       // Nanoseconds since the logger started
+    const char* format;
+    std::uint32_t skipped;   // Messages from the same place held back by the rate limiter since the last one
+    std::uint8_t level;
+    std::uint8_t argumentCount;
+    LogArgument arguments[maxArguments];
+};
+
+class Logger {
+public:
+    // Returns the logger, it is made the first time something logs and its writer thread is stopped when the game exits
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    ~Logger() {
+        running = false;
+        if (writer.joinable()) {
+            writer.join();
+        }
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Method to log a message, this is what the macros call, it never blocks and if the ring buffer is full the message is dropped and counted
+    template <typename... Arguments>
+    void log(int level, LogRateLimiter& limiter, const char* format, const Arguments&... arguments) {
+        static_assert(sizeof...(Arguments) <= LogRecord::maxArguments, "Too many arguments for one log message");
+
+        std::int64_t now = getTime();
+        std::uint32_t skipped = 0;
+        if (!limiter.allow(now, skipped)) {
+            return;
+        }
+
+        // Claim a slot in the ring buffer, each producer moves the write position on with a compare and swap
+        std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[position & mask];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (difference < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);  // The writer has fallen a whole buffer behind
+                return;
+            }
+            else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        LogRecord& record = slot->record;
+        record.time = now;
+        record.format = format;
+        record.skipped = skipped;
+        record.level = static_cast<std::uint8_t>(level);
+        record.argumentCount = static_cast<std::uint8_t>(sizeof...(Arguments));
+        capture(record.arguments, arguments...);
+        slot->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    // Returns how many messages were dropped because the ring buffer was full
+    std::size_t getDroppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    static const std::size_t capacity = 8192;  // Must be a power of two
+    static const std::size_t mask = capacity - 1;
+
+    // A slot in the ring buffer, the sequence number says whether it is free for the producers or ready for the writer
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        LogRecord record;
+    };
+
+    Logger()
+        : slots(new Slot[capacity]), enqueuePosition(0), dequeuePosition(0), dropped(0), running(true),
+        start(std::chrono::steady_clock::now()) {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        output.reserve(64 * 1024);
+        writer = std::thread(&Logger::writeLoop, this);
+    }
+
+    std::int64_t getTime() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Overloads to turn each kind of argument into a LogArgument
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, LogArgument>::type makeArgument(T value) {
+        LogArgument argument;
+        argument.type = std::is_same<T, char>::value ? LogArgument::Character : LogArgument::Signed;
+        argument.signedValue = value;
+        return argument;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, LogArgument>::type makeArgument(T value) {
+        LogArgument argument;
+        argument.type = LogArgument::Unsigned;
+        argument.unsignedValue = value;
+        return argument;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value, LogArgument>::type makeArgument(T value) {
+        LogArgument argument;
+        argument.type = LogArgument::Floating;
+        argument.floatingValue = value;
+        return argument;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value, LogArgument>::type makeArgument(T value) {
+        return makeArgument(static_cast<typename std::underlying_type<T>::type>(value));
+    }
+
+    static LogArgument makeArgument(const char* value) {
+        LogArgument argument;
+        argument.type = LogArgument::Text;
+        argument.textValue = value;
+        return argument;
+    }
+
+    static void capture(LogArgument*) {
+    }
+
+    template <typename First, typename... Rest>
+    static void capture(LogArgument* destination, const First& first, const Rest&... rest) {
+        *destination = makeArgument(first);
+        capture(destination + 1, rest...);
+    }
+
+    // Method run by the writer thread, it empties the ring buffer, formats everything it took out and writes it in one go
+    void writeLoop() {
+        for (;;) {
+            bool stopping = !running.load();
+            std::size_t written = 0;
+            LogRecord record;
+            while (pop(record)) {
+                format(record);
+                ++written;
+            }
+            flush();
+
+            if (stopping && written == 0) {
+                return;
+            }
+            if (written == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+    }
+
+    // Method for the writer to take the oldest finished message out of the ring buffer, only the writer thread calls this
+    bool pop(LogRecord& record) {
+        Slot& slot = slots[dequeuePosition & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+            return false;
+        }
+        record = slot.record;
+        slot.sequence.store(dequeuePosition + capacity, std::memory_order_release);
+        ++dequeuePosition;
+        return true;
+    }
+
+    // Method to format a message onto the end of the output text
+    void format(const LogRecord& record) {
+        static const char* const levelNames[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+        char prefix[48];
+        std::snprintf(prefix, sizeof(prefix), "[%10.3f] %-7s ", record.time / 1e9, levelNames[record.level & 3]);
+        output += prefix;
+
+        int next = 0;
+        for (const char* c = record.format; *c != '\0'; ++c) {
+            if (c[0] == '{' && c[1] == '}' && next < record.argumentCount) {
+                appendArgument(record.arguments[next++]);
+                ++c;
+            }
+            else {
+                output += *c;
+            }
+        }
+        if (record.skipped > 0) {
+            char repeats[48];
+            std::snprintf(repeats, sizeof(repeats), " (%u similar messages skipped)", record.skipped);
+            output += repeats;
+        }
+        output += '\n';
+    }
+
+    void appendArgument(const LogArgument& argument) {
+        char text[32];
+        switch (argument.type) {
+        case LogArgument::Signed: std::snprintf(text, sizeof(text), "%lld", argument.signedValue); break;
+        case LogArgument::Unsigned: std::snprintf(text, sizeof(text), "%llu", argument.unsignedValue); break;
+        case LogArgument::Floating: std::snprintf(text, sizeof(text), "%g", argument.floatingValue); break;
+        case LogArgument::Character: text[0] = static_cast<char>(argument.signedValue); text[1] = '\0'; break;
+        case LogArgument::Text: output += argument.textValue != nullptr ? argument.textValue : "(null)"; return;
+        }
+        output += text;
+    }
+
+    void flush() {
+        if (output.empty()) {
+            return;
+        }
+        std::fwrite(output.data(), 1, output.size(), stdout);
+        std::fflush(stdout);
+        output.clear();
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<std::size_t> enqueuePosition;  // Kept on its own cache line from what the writer touches
+    alignas(64) std::size_t dequeuePosition;
+    std::atomic<std::size_t> dropped;
+    std::atomic<bool> running;
+    std::chrono::steady_clock::time_point start;
+    std::string output;  // Formatted text waiting to be written, only used by the writer thread
+    std::thread writer;
+};
+
+// The logging macros, anything below WARFARE_LOG_LEVEL compiles to nothing, and each use gets its own rate limiter
+#define WARFARE_LOG(level, ...) \
+    do { \
+        if (level >= WARFARE_LOG_LEVEL) { \
+            static LogRateLimiter warfareLogLimiter; \
+            Logger::instance().log(level, warfareLogLimiter, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(...) WARFARE_LOG(WARFARE_LOG_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) WARFARE_LOG(WARFARE_LOG_INFO, __VA_ARGS__)
+#define LOG_WARNING(...) WARFARE_LOG(WARFARE_LOG_WARNING, __VA_ARGS__)
+#define LOG_ERROR(...) WARFARE_LOG(WARFARE_LOG_ERROR, __VA_ARGS__)
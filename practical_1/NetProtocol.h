@@ -0,0 +1,114 @@
+#pragma once
+
+#include "NetReplication.h"
+
+#include <SFML/Config.hpp>
+#include <SFML/Network/Packet.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Messages sent between the co-op clients and the dedicated server over UDP, every datagram is one sf::Packet that starts with its type
+// Clients send Hello to join, then Input every tick, and Goodbye when they leave. The server answers Hello with Welcome (or Full)
+// and sends every client in a session a Snapshot of the world at the snapshot rate.
+// Players are sent exactly, there are only two of them and a client needs its own player's exact state to replay its inputs on top of.
+// Enemies and bullets follow as a bit packed delta from NetReplication.h, written against the newest snapshot the client acknowledged in its Input
+
+// Most inputs a client sends in one Input message
+const std::size_t netInputsPerMessage = 4;
+
+// Version of the protocol, a server ignores clients that say Hello with a different one
+const sf::Uint16 netProtocolVersion = 3;
+
+// Port the dedicated server listens on unless it is told otherwise
+const unsigned short netDefaultPort = 54000;
+
+enum class NetMessage : sf::Uint8 {
+    Hello = 1,     // Client to server: protocol version
+    Input = 2,     // Client to server: the tick of the newest snapshot the client has read, then the newest input sequence number
+                   // and a count of packed controls, oldest first. The last few inputs are sent every time so one lost packet loses nothing
+    Goodbye = 3,   // Client to server: nothing else
+    Welcome = 10,  // Server to client: session id, player slot, the tick rate and the world bounds the positions are quantized in
+    Snapshot = 11, // Server to client: a NetSnapshot, then the byte count and bytes of the entities' delta
+    Full = 12      // Server to client: every session is full, try again later
+};
+
+// One player in a snapshot
+struct NetPlayer {
+    float x = 0.f;
+    float y = 0.f;
+    sf::Int8 directionX = 0;  // Which way the player is flying, movement carries on in it with no keys held
+    sf::Int8 directionY = 0;
+    sf::Uint8 health = 0;
+    sf::Uint8 connected = 0;
+    sf::Uint32 lastInput = 0;  // Sequence number of the newest input the server has used for this player
+};
+
+// Kinds of replicated entity, the enemy archetypes and then which side fired a bullet
+enum NetEntityKind : std::uint8_t {
+    NetChaser = 0,
+    NetStrafer = 1,
+    NetKamikaze = 2,
+    NetTurret = 3,
+    NetSpiral = 4,
+    NetPlayerBullet = 5,
+    NetEnemyBullet = 6
+};
+
+// Everything a client needs to draw one tick of its session
+struct NetSnapshot {
+    // Most bytes of entity delta in one snapshot, so with the header a snapshot stays inside one unfragmented datagram
+    static const std::size_t entityByteBudget = 1200;
+
+    sf::Uint32 tick = 0;
+    sf::Uint16 wave = 0;
+    sf::Uint16 score = 0;
+    std::vector<NetPlayer> players;
+    std::vector<ReplicatedEntity> entities;  // Sorted by id. Filled in by the session on the server and by the ReplicationDecoder on a client
+
+    void clear() {
+        players.clear();
+        entities.clear();
+    }
+
+    // Method to write the tick, score and players after the message type, the entities are written separately for each client
+    void write(sf::Packet& packet) const {
+        packet << tick << wave << score;
+        packet << static_cast<sf::Uint8>(players.size());
+        for (const NetPlayer& player : players) {
+            packet << player.x << player.y << player.directionX << player.directionY << player.health << player.connected << player.lastInput;
+        }
+    }
+
+    // Method to read what write() wrote, returns false if the packet was cut short. The entities are left as they were
+    bool read(sf::Packet& packet) {
+        sf::Uint8 playerCount = 0;
+        if (!(packet >> tick >> wave >> score >> playerCount)) {
+            return false;
+        }
+        players.resize(playerCount);
+        for (NetPlayer& player : players) {
+            packet >> player.x >> player.y >> player.directionX >> player.directionY >> player.health >> player.connected >> player.lastInput;
+        }
+        return static_cast<bool>(packet);
+    }
+};
+
+// Method to add an encoded entity delta to the end of a packet, as a byte count and then the bytes
+inline void writeEntityDelta(sf::Packet& packet, const BitWriter& writer) {
+    const std::vector<std::uint8_t>& bytes = writer.getBytes();
+    packet << static_cast<sf::Uint16>(bytes.size());
+    if (!bytes.empty()) {
+        packet.append(bytes.data(), bytes.size());
+    }
+}
+
+// Method to decode the entity delta at the end of a snapshot packet into the snapshot, returns false if it was cut short or couldn't be decoded
+inline bool readEntityDelta(sf::Packet& packet, ReplicationDecoder& decoder, const PositionQuantizer& quantizer, NetSnapshot& snapshot) {
+    sf::Uint16 byteCount = 0;
+    if (!(packet >> byteCount) || packet.getDataSize() - packet.getReadPosition() < byteCount) {
+        return false;
+    }
+    BitReader reader(static_cast<const char*>(packet.getData()) + packet.getReadPosition(), byteCount);
+    return decoder.decode(snapshot.tick, reader, quantizer, snapshot.entities);
+}
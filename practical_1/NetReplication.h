@@ -0,0 +1,410 @@
+#pragma once
+
+#include "BitPacking.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Snapshot replication for the co-op server, it sends each client only what changed in the world since the last snapshot that client acknowledged.
+// Positions are quantized to half pixels and bit packed with only as many bits as the world needs, entities that haven't moved cost nothing,
+// entities that moved a little cost a few bits, and anything outside the client's interest area is left out (and removed on the client when it leaves it).
+// The server keeps one ReplicationEncoder per client and each client keeps one ReplicationDecoder, both hold the last few snapshots so either side
+// can rebuild whichever one the other refers to
+
+// Bits used for an entity's kind, which is its enemy archetype or which side fired a bullet
+const int replicatedKindBits = 3;
+
+// One enemy or bullet as it is sent, with its position already quantized
+struct ReplicatedEntity {
+    std::uint32_t id;    // Unique in its session, the list of entities is always sorted by it
+    std::uint8_t kind;
+    std::uint16_t x;     // Top left corner in quantized steps from the top left of the world
+    std::uint16_t y;
+};
+
+// Part of the world a client is sent entities in, in quantized steps and inclusive at both ends
+struct InterestArea {
+    std::uint32_t left;
+    std::uint32_t top;
+    std::uint32_t right;
+    std::uint32_t bottom;
+
+    bool contains(const ReplicatedEntity& entity) const {
+        return entity.x >= left && entity.x <= right && entity.y >= top && entity.y <= bottom;
+    }
+};
+
+// Converts world positions to and from whole numbers of half pixels measured from the top left of the world
+// The number of bits each axis takes is worked out from the size of the world, which the client is told when it joins
+class PositionQuantizer {
+public:
+    static const int stepsPerPixel = 2;
+
+    PositionQuantizer() : PositionQuantizer(sf::FloatRect(0.f, 0.f, 1.f, 1.f)) {
+    }
+
+    explicit PositionQuantizer(const sf::FloatRect& worldBounds)
+        : bounds(worldBounds), maxX(maxSteps(worldBounds.width)), maxY(maxSteps(worldBounds.height)),
+        bitsX(bitsFor(maxX)), bitsY(bitsFor(maxY)) {
+    }
+
+    // Positions outside the world are clamped to its edge
+    std::uint16_t quantizeX(float x) const {
+        return quantize(x - bounds.left, maxX);
+    }
+
+    std::uint16_t quantizeY(float y) const {
+        return quantize(y - bounds.top, maxY);
+    }
+
+    float dequantizeX(std::uint16_t x) const {
+        return bounds.left + static_cast<float>(x) / stepsPerPixel;
+    }
+
+    float dequantizeY(std::uint16_t y) const {
+        return bounds.top + static_cast<float>(y) / stepsPerPixel;
+    }
+
+    // Method to turn a part of the world into an interest area, parts that hang over the edge of the world are cut off
+    InterestArea quantizeArea(const sf::FloatRect& area) const {
+        return { quantizeX(area.left), quantizeY(area.top), quantizeX(area.left + area.width), quantizeY(area.top + area.height) };
+    }
+
+    // Returns an interest area covering the whole world
+    InterestArea everywhere() const {
+        return { 0, 0, maxX, maxY };
+    }
+
+    int getBitsX() const { return bitsX; }
+    int getBitsY() const { return bitsY; }
+    const sf::FloatRect& getWorldBounds() const { return bounds; }
+
+private:
+    // Worlds bigger than 16 bits of half pixels are clamped, the game's world only needs 14
+    static std::uint32_t maxSteps(float size) {
+        return static_cast<std::uint32_t>(std::min(65535.f, std::max(1.f, std::ceil(size * stepsPerPixel))));
+    }
+
+    static int bitsFor(std::uint32_t value) {
+        int bits = 1;
+        while ((value >> bits) != 0) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    std::uint16_t quantize(float offset, std::uint32_t maximum) const {
+        float steps = std::round(offset * stepsPerPixel);
+        return static_cast<std::uint16_t>(std::max(0.f, std::min(static_cast<float>(maximum), steps)));
+    }
+
+    sf::FloatRect bounds;
+    std::uint32_t maxX;
+    std::uint32_t maxY;
+    int bitsX;
+    int bitsY;
+};
+
+// What is written for each entity that differs from the baseline, End closes one run of ids
+enum class ReplicationOp : std::uint32_t {
+    Removed = 0,  // The client drops the entity
+    Moved = 1,    // Followed by how far it moved on each axis
+    Created = 2,  // Followed by its kind and position
+    End = 3
+};
+
+// Snapshots the encoder and decoder remember, which is how far behind a client's acknowledgement can be before it is sent everything again
+const std::size_t replicationHistorySize = 32;
+
+// A snapshot one side remembers, the entities exactly as the client has them after reading it
+struct ReplicationFrame {
+    std::uint32_t tick = 0;  // 0 is never a real snapshot
+    std::vector<ReplicatedEntity> entities;
+};
+
+// Encoding helpers shared by the encoder and decoder
+
+// Moves are sent as zigzag numbers (0, -1, 1, -2, 2...) with a two bit size class, so an axis that didn't move costs two bits
+const int replicationMoveBits[4] = { 0, 5, 9, 17 };
+
+inline std::uint32_t zigzag(int value) {
+    return value >= 0 ? static_cast<std::uint32_t>(value) * 2u : static_cast<std::uint32_t>(-value) * 2u - 1u;
+}
+
+inline int unzigzag(std::uint32_t value) {
+    return (value & 1u) != 0 ? -static_cast<int>((value + 1u) / 2u) : static_cast<int>(value / 2u);
+}
+
+inline void writeMove(BitWriter& writer, int move) {
+    std::uint32_t value = zigzag(move);
+    std::uint32_t sizeClass = value == 0 ? 0 : (value < 32 ? 1 : (value < 512 ? 2 : 3));
+    writer.write(sizeClass, 2);
+    writer.write(value, replicationMoveBits[sizeClass]);
+}
+
+inline int readMove(BitReader& reader) {
+    std::uint32_t sizeClass = reader.read(2);
+    return unzigzag(reader.read(replicationMoveBits[sizeClass]));
+}
+
+// Returns the remembered snapshot for a tick, or nullptr if it has been forgotten
+inline const ReplicationFrame* findReplicationFrame(const std::vector<ReplicationFrame>& frames, std::uint32_t tick) {
+    if (tick == 0) {
+        return nullptr;
+    }
+    for (const ReplicationFrame& frame : frames) {
+        if (frame.tick == tick) {
+            return &frame;
+        }
+    }
+    return nullptr;
+}
+
+// Server side of the replication for one client
+// Each snapshot is written as the differences from the newest snapshot the client has acknowledged, or from nothing if it hasn't acknowledged one we remember.
+// Records go in id order as two runs, from a cursor to the end and then from the start up to the cursor. When a snapshot runs out of its byte budget
+// the rest is left out and the cursor moves to the first entity that missed out, so the next snapshot starts with it and nothing is starved
+class ReplicationEncoder {
+public:
+    ReplicationEncoder() : frames(replicationHistorySize), nextFrame(0), acknowledged(0), cursor(0) {
+    }
+
+    // Method to record that the client has read the snapshot for this tick, older acknowledgements arriving late are ignored
+    void acknowledge(std::uint32_t tick) {
+        acknowledged = std::max(acknowledged, tick);
+    }
+
+    // Method to write a snapshot of the entities inside the area, which must be sorted by id
+    // byteBudget is the most the records can take up, 0 means there is no limit. Returns how many changes were left out to keep to it
+    std::size_t encode(std::uint32_t tick, const std::vector<ReplicatedEntity>& entities, const InterestArea& area,
+        const PositionQuantizer& quantizer, std::size_t byteBudget, BitWriter& writer) {
+        const ReplicationFrame* baseline = findReplicationFrame(frames, acknowledged);
+        static const std::vector<ReplicatedEntity> nothing;
+        const std::vector<ReplicatedEntity>& previous = baseline != nullptr ? baseline->entities : nothing;
+
+        writer.write(baseline != nullptr ? baseline->tick : 0u, 32);
+        writer.write(cursor, 32);
+
+        this->writer = &writer;
+        this->quantizer = &quantizer;
+        budgetBits = byteBudget > 0 ? byteBudget * 8 : static_cast<std::size_t>(-1);
+        overBudget = false;
+        skipped = 0;
+        firstSkipped = 0;
+        result.clear();
+
+        // The run from the cursor up, then the run from the start up to the cursor
+        std::size_t previousSplit = splitAt(previous, cursor);
+        std::size_t currentSplit = splitAt(entities, cursor);
+        encodeRun(previous, previousSplit, previous.size(), entities, currentSplit, entities.size(), area, cursor);
+        std::size_t firstRunSize = result.size();
+        encodeRun(previous, 0, previousSplit, entities, 0, currentSplit, area, 0);
+        std::rotate(result.begin(), result.begin() + firstRunSize, result.end());
+
+        cursor = overBudget ? firstSkipped : 0;
+
+        // Remember what the client will have so later snapshots can be sent as differences from it
+        ReplicationFrame& frame = frames[nextFrame];
+        nextFrame = (nextFrame + 1) % frames.size();
+        frame.tick = tick;
+        frame.entities.swap(result);
+        return skipped;
+    }
+
+private:
+    // Returns the index of the first entity with an id of at least the given one
+    static std::size_t splitAt(const std::vector<ReplicatedEntity>& entities, std::uint32_t id) {
+        return std::lower_bound(entities.begin(), entities.end(), id, [](const ReplicatedEntity& entity, std::uint32_t value) {
+            return entity.id < value;
+            }) - entities.begin();
+    }
+
+    // Method to walk the baseline and the current entities together in id order and write a record for everything that differs
+    void encodeRun(const std::vector<ReplicatedEntity>& previous, std::size_t i, std::size_t previousEnd,
+        const std::vector<ReplicatedEntity>& current, std::size_t j, std::size_t currentEnd, const InterestArea& area, std::uint32_t runStart) {
+        lastId = runStart;
+        while (true) {
+            while (j < currentEnd && !area.contains(current[j])) {
+                ++j;
+            }
+            bool hasPrevious = i < previousEnd;
+            bool hasCurrent = j < currentEnd;
+            if (!hasPrevious && !hasCurrent) {
+                break;
+            }
+
+            if (hasPrevious && (!hasCurrent || previous[i].id < current[j].id)) {
+                // Gone, or left the client's area
+                if (!beginRecord(ReplicationOp::Removed, previous[i].id)) {
+                    result.push_back(previous[i]);
+                }
+                ++i;
+            }
+            else if (!hasPrevious || current[j].id < previous[i].id) {
+                if (beginRecord(ReplicationOp::Created, current[j].id)) {
+                    writer->write(current[j].kind, replicatedKindBits);
+                    writer->write(current[j].x, quantizer->getBitsX());
+                    writer->write(current[j].y, quantizer->getBitsY());
+                    result.push_back(current[j]);
+                }
+                ++j;
+            }
+            else {
+                if (previous[i].x == current[j].x && previous[i].y == current[j].y) {
+                    result.push_back(current[j]);
+                }
+                else if (beginRecord(ReplicationOp::Moved, current[j].id)) {
+                    writeMove(*writer, static_cast<int>(current[j].x) - previous[i].x);
+                    writeMove(*writer, static_cast<int>(current[j].y) - previous[i].y);
+                    result.push_back(current[j]);
+                }
+                else {
+                    result.push_back(previous[i]);
+                }
+                ++i;
+                ++j;
+            }
+        }
+        writer->write(static_cast<std::uint32_t>(ReplicationOp::End), 2);
+    }
+
+    // Method to start a record if there is room for it, once one change misses out every later one does too so the cursor can pick up from it
+    bool beginRecord(ReplicationOp op, std::uint32_t id) {
+        // The largest a record can be, with room left over for the two End markers
+        const std::size_t largestRecord = 2 + 40 + replicatedKindBits + 2 * (2 + replicationMoveBits[3]) + 4;
+        if (!overBudget && writer->getBitCount() + largestRecord > budgetBits) {
+            overBudget = true;
+            firstSkipped = id;
+        }
+        if (overBudget) {
+            ++skipped;
+            return false;
+        }
+        writer->write(static_cast<std::uint32_t>(op), 2);
+        writer->writeVariable(id - lastId);
+        lastId = id;
+        return true;
+    }
+
+    std::vector<ReplicationFrame> frames;
+    std::size_t nextFrame;       // Which frame the next snapshot is remembered in, the oldest is written over
+    std::uint32_t acknowledged;  // Newest tick the client has acknowledged
+    std::uint32_t cursor;        // Id the next snapshot's records start from
+
+    // State for the snapshot being written
+    BitWriter* writer = nullptr;
+    const PositionQuantizer* quantizer = nullptr;
+    std::size_t budgetBits = 0;
+    bool overBudget = false;
+    std::size_t skipped = 0;
+    std::uint32_t firstSkipped = 0;
+    std::uint32_t lastId = 0;
+    std::vector<ReplicatedEntity> result;
+};
+
+// Client side of the replication, it rebuilds each snapshot's entities from the baseline the server wrote it against
+class ReplicationDecoder {
+public:
+    ReplicationDecoder() : frames(replicationHistorySize), nextFrame(0), newestTick(0) {
+    }
+
+    // Method to read one snapshot's entities into the list given, sorted by id
+    // Returns false and leaves the list alone if the snapshot was written against one this decoder no longer has or the data is broken
+    bool decode(std::uint32_t tick, BitReader& reader, const PositionQuantizer& quantizer, std::vector<ReplicatedEntity>& entities) {
+        std::uint32_t baselineTick = reader.read(32);
+        std::uint32_t cursor = reader.read(32);
+        const ReplicationFrame* baseline = findReplicationFrame(frames, baselineTick);
+        if (baselineTick != 0 && baseline == nullptr) {
+            return false;
+        }
+        static const std::vector<ReplicatedEntity> nothing;
+        const std::vector<ReplicatedEntity>& previous = baseline != nullptr ? baseline->entities : nothing;
+
+        result.clear();
+        std::size_t split = std::lower_bound(previous.begin(), previous.end(), cursor, [](const ReplicatedEntity& entity, std::uint32_t value) {
+            return entity.id < value;
+            }) - previous.begin();
+        decodeRun(reader, quantizer, previous, split, previous.size(), cursor, 0xFFFFFFFFu);
+        std::size_t firstRunSize = result.size();
+        decodeRun(reader, quantizer, previous, 0, split, 0, cursor);
+        if (!reader.isValid()) {
+            return false;
+        }
+        std::rotate(result.begin(), result.begin() + firstRunSize, result.end());
+
+        ReplicationFrame& frame = frames[nextFrame];
+        nextFrame = (nextFrame + 1) % frames.size();
+        frame.tick = tick;
+        frame.entities.swap(result);
+        entities = frame.entities;
+        newestTick = std::max(newestTick, tick);
+        return true;
+    }
+
+    // Returns the newest tick decoded, which is what the client acknowledges to the server
+    std::uint32_t getNewestTick() const {
+        return newestTick;
+    }
+
+private:
+    // Method to apply one run of records to the baseline, ids in the run have to be at least runStart and below runEnd
+    void decodeRun(BitReader& reader, const PositionQuantizer& quantizer, const std::vector<ReplicatedEntity>& previous,
+        std::size_t i, std::size_t previousEnd, std::uint32_t runStart, std::uint32_t runEnd) {
+        std::uint32_t id = runStart;
+        bool first = true;
+        while (reader.isValid()) {
+            ReplicationOp op = static_cast<ReplicationOp>(reader.read(2));
+            if (op == ReplicationOp::End) {
+                break;
+            }
+            // Ids only go up, and only the first record in a run can be on the run's first id
+            std::uint32_t gap = reader.readVariable();
+            if ((gap == 0 && !first) || gap >= runEnd - id) {
+                reader.fail();
+                return;
+            }
+            id += gap;
+            first = false;
+
+            // Everything before the record's entity is unchanged
+            while (i < previousEnd && previous[i].id < id) {
+                result.push_back(previous[i++]);
+            }
+            bool inBaseline = i < previousEnd && previous[i].id == id;
+            if (inBaseline == (op == ReplicationOp::Created)) {
+                reader.fail();
+                return;
+            }
+
+            if (op == ReplicationOp::Created) {
+                ReplicatedEntity entity;
+                entity.id = id;
+                entity.kind = static_cast<std::uint8_t>(reader.read(replicatedKindBits));
+                entity.x = static_cast<std::uint16_t>(reader.read(quantizer.getBitsX()));
+                entity.y = static_cast<std::uint16_t>(reader.read(quantizer.getBitsY()));
+                result.push_back(entity);
+            }
+            else if (op == ReplicationOp::Moved) {
+                ReplicatedEntity entity = previous[i++];
+                entity.x = static_cast<std::uint16_t>(entity.x + readMove(reader));
+                entity.y = static_cast<std::uint16_t>(entity.y + readMove(reader));
+                result.push_back(entity);
+            }
+            else {
+                ++i;
+            }
+        }
+        while (i < previousEnd) {
+            result.push_back(previous[i++]);
+        }
+    }
+
+    std::vector<ReplicationFrame> frames;
+    std::size_t nextFrame;
+    std::uint32_t newestTick;
+    std::vector<ReplicatedEntity> result;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <vector>
+
+// Parallax background made up of any number of layers, each layer is a repeating texture drawn as one quad that covers the view.
+// Scrolling is done by moving the texture coordinates instead of the quad, so every layer costs a single full screen pass
+class ParallaxBackground {
+public:
+
+    // Method to add a layer with the speed it scrolls at in pixels per second, layers are drawn in the order they are added (back to front)
+    // The parallax factor is how much the layer moves with the camera, 0 stays still and 1 moves with the world
+    // The tint lets a layer be faded out with alpha so it can sit on top of the layers behind it
+    void addLayer(sf::Texture& texture, float speed, float parallaxFactor = 0.5f, sf::Color tint = sf::Color::White) {
+        texture.setRepeated(true);  // Repeating the texture means the quad can be any size and the image wraps around
+
+        Layer layer;
+        layer.texture = &texture;
+        layer.speed = speed;
+        layer.parallaxFactor = parallaxFactor;
+        layer.offset = 0.f;
+        for (int i = 0; i < 4; ++i) {
+            layer.quad[i].color = tint;
+        }
+        layers.push_back(layer);
+    }
+
+    // Method to scroll every layer, using the frame time so the clouds move at the same speed whatever the frame rate is
+    void update(float deltaTime) {
+        for (auto& layer : layers) {
+            float textureWidth = static_cast<float>(layer.texture->getSize().x);
+
+            // Wrap the offset around the texture width so the float never grows large enough to lose precision
+            layer.offset = std::fmod(layer.offset + layer.speed * deltaTime, textureWidth);
+        }
+    }
+
+    // Method to tell the background where the camera is in the world, so each layer can be shifted by its parallax factor
+    void setCameraPosition(const sf::Vector2f& position) {
+        cameraPosition = position;
+    }
+
+    // Method to render each layer as one quad covering the target's current view
+    void render(sf::RenderTarget& target) {
+        const sf::View& view = target.getView();
+        sf::Vector2f size = view.getSize();
+        sf::Vector2f topLeft = view.getCenter() - size / 2.f;
+
+        for (auto& layer : layers) {
+            // Corners of the quad in triangle strip order: top left, bottom left, top right, bottom right
+            layer.quad[0].position = topLeft;
+            layer.quad[1].position = sf::Vector2f(topLeft.x, topLeft.y + size.y);
+            layer.quad[2].position = sf::Vector2f(topLeft.x + size.x, topLeft.y);
+            layer.quad[3].position = topLeft + size;
+
+            // Texture coordinates are one texel per pixel, shifted along by the scroll offset and the camera position
+            sf::Vector2f start(layer.offset + cameraPosition.x * layer.parallaxFactor, cameraPosition.y * layer.parallaxFactor);
+            layer.quad[0].texCoords = start;
+            layer.quad[1].texCoords = sf::Vector2f(start.x, start.y + size.y);
+            layer.quad[2].texCoords = sf::Vector2f(start.x + size.x, start.y);
+            layer.quad[3].texCoords = start + size;
+
+            target.draw(layer.quad, 4, sf::TriangleStrip, sf::RenderStates(layer.texture));
+        }
+    }
+
+private:
+    // Data for one layer of the background
+    struct Layer {
+        const sf::Texture* texture;
+        float speed;      // Scroll speed in pixels per second
+        float parallaxFactor;
+        float offset;     // How far the texture has scrolled, kept within the texture width
+        sf::Vertex quad[4];
+    };
+
+    std::vector<Layer> layers;
+    sf::Vector2f cameraPosition;
+};
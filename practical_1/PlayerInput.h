@@ -0,0 +1,40 @@
+#pragma once
+
+#include <SFML/Window/Keyboard.hpp>
+#include <cstdint>
+
+// The controls the player is holding down for one tick
+// Keeping input in its own struct lets the simulation be driven by the keyboard or any other source, and be handed between threads
+struct PlayerInput {
+    bool up = false;
+    bool down = false;
+    bool left = false;
+    bool right = false;
+    bool fire = false;
+
+    // Method to read the WASD and space keys from the keyboard
+    static PlayerInput fromKeyboard() {
+        PlayerInput input;
+        input.up = sf::Keyboard::isKeyPressed(sf::Keyboard::W);
+        input.down = sf::Keyboard::isKeyPressed(sf::Keyboard::S);
+        input.left = sf::Keyboard::isKeyPressed(sf::Keyboard::A);
+        input.right = sf::Keyboard::isKeyPressed(sf::Keyboard::D);
+        input.fire = sf::Keyboard::isKeyPressed(sf::Keyboard::Space);
+        return input;
+    }
+
+    // Methods to pack the controls into one byte and back, so input can be stored in an atomic or sent over the network
+    std::uint8_t pack() const {
+        return static_cast<std::uint8_t>((up ? 1 : 0) | (down ? 2 : 0) | (left ? 4 : 0) | (right ? 8 : 0) | (fire ? 16 : 0));
+    }
+
+    static PlayerInput unpack(std::uint8_t bits) {
+        PlayerInput input;
+        input.up = (bits & 1) != 0;
+        input.down = (bits & 2) != 0;
+        input.left = (bits & 4) != 0;
+        input.right = (bits & 8) != 0;
+        input.fire = (bits & 16) != 0;
+        return input;
+    }
+};
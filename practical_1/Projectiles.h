@@ -0,0 +1,170 @@
+#pragma once
+
+#include "SweptCollision.h"
+#include "TileCollision.h"
+#include "WorldSnapshot.h"
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Storage for projectiles as a structure of arrays, every projectile in one storage is the same size and colour so only what changes is stored.
+// The enemy bullets use the default square red ones, the player's bullets are a second storage with their own size and colour
+// Patterns add whole volleys at once with appendBatch(), which grows each array a single time and hands back where the new ones start,
+// so a boss firing hundreds of bullets in a tick is one append instead of hundreds of bullet objects being built
+class ProjectileStorage {
+public:
+    // Size of every projectile, they are square so they look the same whichever way they fly
+    static constexpr float width = 10.f;
+    static constexpr float height = 10.f;
+
+    // Constructor with the size and colour of the projectiles, the defaults are the enemy bullets
+    explicit ProjectileStorage(const sf::Vector2f& size = sf::Vector2f(width, height), const sf::Color& color = sf::Color::Red)
+        : projectileSize(size), projectileColor(color) {
+    }
+
+    const sf::Vector2f& getProjectileSize() const {
+        return projectileSize;
+    }
+
+    // Method to make room for this many projectiles up front so firing doesn't allocate during a level
+    void reserve(std::size_t capacity) {
+        x.reserve(capacity); y.reserve(capacity);
+        previousX.reserve(capacity); previousY.reserve(capacity);
+        velocityX.reserve(capacity); velocityY.reserve(capacity);
+        damage.reserve(capacity);
+        hit.reserve(capacity);
+        id.reserve(capacity);
+    }
+
+    // Method to add this many projectiles to the end of the arrays in one go and return the index of the first one
+    // The caller fills in every array from that index on apart from the ids, which are given out here. Positions are the top left corner
+    std::size_t appendBatch(std::size_t count) {
+        std::size_t start = x.size();
+        std::size_t end = start + count;
+        x.resize(end); y.resize(end);
+        previousX.resize(end); previousY.resize(end);
+        velocityX.resize(end); velocityY.resize(end);
+        damage.resize(end);
+        hit.resize(end, 0);
+        id.resize(end);
+        for (std::size_t i = start; i < end; ++i) {
+            id[i] = nextId++;
+        }
+        return start;
+    }
+
+    // Method to fire a single projectile from a centre point along a unit direction
+    void push(float centreX, float centreY, float directionX, float directionY, float speed, int projectileDamage) {
+        std::size_t i = appendBatch(1);
+        x[i] = previousX[i] = centreX - projectileSize.x / 2.f;
+        y[i] = previousY[i] = centreY - projectileSize.y / 2.f;
+        velocityX[i] = directionX * speed;
+        velocityY[i] = directionY * speed;
+        damage[i] = projectileDamage;
+    }
+
+    // Method to move every projectile along its velocity, remembering where it started for the swept collision
+    void update(float deltaTime) {
+        float* positionX = x.data();
+        float* positionY = y.data();
+        float* startX = previousX.data();
+        float* startY = previousY.data();
+        const float* moveX = velocityX.data();
+        const float* moveY = velocityY.data();
+        const std::size_t count = x.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            startX[i] = positionX[i];
+            startY[i] = positionY[i];
+            positionX[i] += moveX[i] * deltaTime;
+            positionY[i] += moveY[i] * deltaTime;
+        }
+    }
+
+    // Method to mark every projectile whose path this tick crosses the target, returns the damage they do in total
+    int hitTarget(const sf::FloatRect& target) {
+        int totalDamage = 0;
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            float hitTime;
+            if (!hit[i] && sweptRectIntersects(sf::FloatRect(previousX[i], previousY[i], projectileSize.x, projectileSize.y),
+                sf::Vector2f(x[i] - previousX[i], y[i] - previousY[i]), target, hitTime)) {
+                hit[i] = 1;
+                totalDamage += damage[i];
+            }
+        }
+        return totalDamage;
+    }
+
+    // Method to mark every projectile that has left the world or flown into the terrain
+    void hitWorld(const sf::FloatRect& worldBounds, const TileCollision& tileMap) {
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            sf::FloatRect bounds(x[i], y[i], projectileSize.x, projectileSize.y);
+            if (!hit[i] && (!worldBounds.intersects(bounds) || tileMap.overlapsSolid(bounds))) {
+                hit[i] = 1;
+            }
+        }
+    }
+
+    // Method to remove every marked projectile by moving the last one into its place, so nothing after it has to shift
+    void removeHit() {
+        std::size_t i = 0;
+        while (i < x.size()) {
+            if (!hit[i]) {
+                ++i;
+                continue;
+            }
+            std::size_t last = x.size() - 1;
+            x[i] = x[last]; y[i] = y[last];
+            previousX[i] = previousX[last]; previousY[i] = previousY[last];
+            velocityX[i] = velocityX[last]; velocityY[i] = velocityY[last];
+            damage[i] = damage[last];
+            hit[i] = hit[last];
+            id[i] = id[last];
+            x.pop_back(); y.pop_back();
+            previousX.pop_back(); previousY.pop_back();
+            velocityX.pop_back(); velocityY.pop_back();
+            damage.pop_back();
+            hit.pop_back();
+            id.pop_back();
+        }
+    }
+
+    // Method to add a rectangle for every projectile to a snapshot's list
+    void fillSnapshot(std::vector<SnapshotRect>& rects) const {
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            rects.push_back({ sf::Vector2f(x[i], y[i]), projectileSize, projectileColor });
+        }
+    }
+
+    std::size_t size() const {
+        return x.size();
+    }
+
+    // Method to remove every projectile but keep the memory, ids carry on counting so a new projectile never reuses an old one's
+    void clear() {
+        x.clear(); y.clear();
+        previousX.clear(); previousY.clear();
+        velocityX.clear(); velocityY.clear();
+        damage.clear();
+        hit.clear();
+        id.clear();
+    }
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> previousX;  // Where each projectile was before its last update
+    std::vector<float> previousY;
+    std::vector<float> velocityX;  // Pixels per second
+    std::vector<float> velocityY;
+    std::vector<int> damage;
+    std::vector<std::uint8_t> hit;  // Set when a projectile has hit something and is waiting to be removed
+    std::vector<std::uint32_t> id;  // Stays with a projectile while it is moved around the arrays, so the network replication can follow it
+    std::uint32_t nextId = 1;
+
+private:
+    sf::Vector2f projectileSize;
+    sf::Color projectileColor;
+};
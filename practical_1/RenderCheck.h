@@ -0,0 +1,185 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Golden frame check for the renderer, run from the game with --render-check <directory>
+// Each scene is drawn into an off screen render texture, compared against <directory>/<scene>.png and then drawn again many times
+// to time it, so a change to the renderer can be checked for both what it draws and how long it takes.
+// It doesn't need a GPU: on a build server run it under a virtual display with Mesa's software renderer, for example
+//     LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./PRACTICAL_1 --render-check goldens
+// Run it with --update-goldens whenever a change to what is drawn is intended. A scene with no golden yet has its first frame saved
+// as the golden and is reported as RECORDED instead of failing, the new golden then has to be checked and committed
+class RenderCheck {
+public:
+    // Constructor with the folder the golden images are in, the size to render at and whether to overwrite the goldens
+    RenderCheck(const std::string& goldenDirectory, unsigned width, unsigned height, bool updateGoldens)
+        : goldenDirectory(goldenDirectory), width(width), height(height), updateGoldens(updateGoldens),
+        channelTolerance(16), pixelTolerance(0.001), iterations(100) {
+    }
+
+    // Method to set how far apart two pixels can be on any colour channel and still count as the same,
+    // and the fraction of pixels that can differ before the scene fails. Some slack is needed because
+    // different versions of Mesa or different GPUs don't round text and edges exactly the same
+    void setTolerance(int channel, double pixels) {
+        channelTolerance = channel;
+        pixelTolerance = pixels;
+    }
+
+    // Method to set how many times each scene is drawn for the timings
+    void setIterations(int count) {
+        iterations = std::max(1, count);
+    }
+
+    // Method to add a scene, the draw function should draw one whole frame and give the same picture every time it is called
+    void addScene(const std::string& name, std::function<void(sf::RenderTarget&)> draw) {
+        scenes.push_back({ name, std::move(draw) });
+    }
+
+    // Method to check and time every scene, returns how many scenes failed so it can be used as the exit code
+    int run() {
+        sf::RenderTexture target;
+        if (!target.create(width, height)) {
+            std::printf("Render check: could not create a %ux%u render texture\n", width, height);
+            return static_cast<int>(scenes.size());
+        }
+
+        std::printf("Render check: %u scene(s) at %ux%u, %d frames each, renderer %s\n",
+            static_cast<unsigned>(scenes.size()), width, height, iterations, getRendererName(target).c_str());
+        std::printf("%-16s %-8s %10s %10s %10s %10s\n", "scene", "result", "differ %", "min ms", "median ms", "max ms");
+
+        int failures = 0;
+        int recorded = 0;
+        for (const Scene& scene : scenes) {
+            // The first frame is the one compared, it also uploads any textures and glyphs so they aren't in the timings
+            drawFrame(target, scene);
+            sf::Image actual = target.getTexture().copyToImage();
+            double differentFraction = 0.0;
+            const char* result = checkGolden(scene.name, actual, differentFraction);
+            if (result[0] == 'F') {
+                ++failures;
+            }
+            else if (result[0] == 'R') {
+                ++recorded;
+            }
+
+            std::vector<double> times = timeScene(target, scene);
+            std::printf("%-16s %-8s %10.4f %10.3f %10.3f %10.3f\n", scene.name.c_str(), result, differentFraction * 100.0,
+                times.front(), times[times.size() / 2], times.back());
+        }
+
+        std::printf("Render check: %d of %u scene(s) failed\n", failures, static_cast<unsigned>(scenes.size()));
+        if (recorded > 0) {
+            std::printf("Render check: %d scene(s) had no golden image, their frames were saved to %s as the goldens, check and commit them\n",
+                recorded, goldenDirectory.c_str());
+        }
+        std::fflush(stdout);
+        return failures;
+    }
+
+private:
+    struct Scene {
+        std::string name;
+        std::function<void(sf::RenderTarget&)> draw;
+    };
+
+    // Method to draw one frame of a scene and wait for OpenGL to finish it, so the time measured is the time the frame really took
+    void drawFrame(sf::RenderTexture& target, const Scene& scene) {
+        target.setView(target.getDefaultView());
+        target.clear(sf::Color::Black);
+        scene.draw(target);
+        target.display();
+        if (target.setActive(true)) {
+            glFinish();
+        }
+    }
+
+    // Method to draw a scene many times and return how long each frame took in milliseconds, sorted from fastest to slowest
+    std::vector<double> timeScene(sf::RenderTexture& target, const Scene& scene) {
+        std::vector<double> times;
+        times.reserve(iterations);
+        for (int i = 0; i < iterations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            drawFrame(target, scene);
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        return times;
+    }
+
+    // Method to compare a rendered frame with its golden image, returns the result to print
+    // When the frame fails it is saved next to the golden along with an image showing which pixels differ
+    const char* checkGolden(const std::string& name, const sf::Image& actual, double& differentFraction) {
+        std::string goldenFile = goldenDirectory + "/" + name + ".png";
+        if (updateGoldens) {
+            return actual.saveToFile(goldenFile) ? "UPDATED" : "FAILED";
+        }
+
+        // With no golden to compare against this frame becomes the golden, so a fresh checkout or a new scene doesn't fail every run
+        sf::Image golden;
+        if (!golden.loadFromFile(goldenFile)) {
+            return actual.saveToFile(goldenFile) ? "RECORDED" : "FAILED";
+        }
+        if (golden.getSize() != actual.getSize()) {
+            differentFraction = 1.0;
+            actual.saveToFile(goldenDirectory + "/" + name + ".actual.png");
+            return "FAILED";
+        }
+
+        // Count the pixels that are further apart than the tolerance, and mark them red on a darkened copy of the frame
+        sf::Image difference;
+        difference.create(width, height);
+        const sf::Uint8* expectedPixels = golden.getPixelsPtr();
+        const sf::Uint8* actualPixels = actual.getPixelsPtr();
+        std::size_t differentPixels = 0;
+        for (unsigned y = 0; y < height; ++y) {
+            for (unsigned x = 0; x < width; ++x) {
+                std::size_t i = (static_cast<std::size_t>(y) * width + x) * 4;
+                int worst = 0;
+                for (int channel = 0; channel < 4; ++channel) {
+                    worst = std::max(worst, std::abs(expectedPixels[i + channel] - actualPixels[i + channel]));
+                }
+                if (worst > channelTolerance) {
+                    ++differentPixels;
+                    difference.setPixel(x, y, sf::Color::Red);
+                }
+                else {
+                    difference.setPixel(x, y, sf::Color(actualPixels[i] / 4, actualPixels[i + 1] / 4, actualPixels[i + 2] / 4));
+                }
+            }
+        }
+
+        differentFraction = static_cast<double>(differentPixels) / (static_cast<double>(width) * height);
+        if (differentFraction > pixelTolerance) {
+            actual.saveToFile(goldenDirectory + "/" + name + ".actual.png");
+            difference.saveToFile(goldenDirectory + "/" + name + ".diff.png");
+            return "FAILED";
+        }
+        return "PASSED";
+    }
+
+    // Returns the name of the OpenGL renderer, so the report shows whether it ran on the software renderer or a real GPU
+    static std::string getRendererName(sf::RenderTexture& target) {
+        if (!target.setActive(true)) {
+            return "unknown";
+        }
+        const GLubyte* renderer = glGetString(GL_RENDERER);
+        return renderer != nullptr ? reinterpret_cast<const char*>(renderer) : "unknown";
+    }
+
+    std::string goldenDirectory;
+    unsigned width;
+    unsigned height;
+    bool updateGoldens;
+    int channelTolerance;    // Largest difference on one colour channel that still counts as the same pixel
+    double pixelTolerance;   // Largest fraction of pixels that can differ before a scene fails
+    int iterations;          // Frames drawn to time each scene
+    std::vector<Scene> scenes;
+};
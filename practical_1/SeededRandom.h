@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// Small random number generator (xorshift32) for everything that has to be repeatable from a seed, such as the autoplayer,
+// the endless waves, the bots and the network relay. The same seed always gives the same numbers on every platform and compiler,
+// which std::rand and the distributions in <random> don't promise, and it is only four bytes so it can sit in anything
+class SeededRandom {
+public:
+    // Constructor with a seed, any seed can be used. Close seeds are spread out first so seeds 1, 2, 3 don't start off alike
+    explicit SeededRandom(std::uint32_t seed = 1)
+        : state(seed * 2654435761u + 1u) {
+        if (state == 0) {
+            state = 1;  // xorshift never leaves 0, and one seed lands on it
+        }
+    }
+
+    // Returns the next number, anywhere in the range of a uint32
+    std::uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Returns a number from 0 up to but not including 1
+    float nextUnit() {
+        return static_cast<float>(next() >> 8) / 16777216.f;
+    }
+
+private:
+    std::uint32_t state;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "TripleBuffer.h"
+#include "WorldSnapshot.h"
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+// Runs the level simulation on its own thread at a fixed tick rate, so a slow window.display() doesn't hold up the game logic and the other way round
+// After every tick the simulation fills in a snapshot of the world and publishes it through a triple buffer, the render thread always draws the newest one
+class SimulationThread {
+public:
+    // The step function runs one tick of the simulation with the tick length in seconds and fills in the snapshot it is given
+    using StepFunction = std::function<void(float, WorldSnapshot&)>;
+
+    explicit SimulationThread(float tickRate)
+        : tickRate(tickRate), running(false) {
+    }
+
+    ~SimulationThread() {
+        stop();
+    }
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Method to start ticking the simulation, the step function is only called from the simulation thread until stop() returns
+    void start(StepFunction stepFunction) {
+        stop();
+        step = std::move(stepFunction);
+        running = true;
+        thread = std::thread(&SimulationThread::run, this);
+    }
+
+    // Method to stop the simulation and wait for the thread to finish its current tick
+    void stop() {
+        running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    // Returns true while the simulation thread is ticking
+    bool isRunning() const {
+        return thread.joinable();
+    }
+
+    // Method for the render thread to pick up the newest snapshot, returns true if there was a new one
+    bool updateSnapshot() {
+        return snapshots.update();
+    }
+
+    // Returns the newest snapshot picked up by updateSnapshot(), its tick is 0 until the first tick has been published
+    const WorldSnapshot& getSnapshot() const {
+        return snapshots.getReadBuffer();
+    }
+
+private:
+    // Method run by the simulation thread, it ticks at a fixed rate and sleeps in between
+    void run() {
+        const sf::Time tickLength = sf::seconds(1.f / tickRate);
+        std::uint64_t tick = 0;
+        sf::Clock clock;
+        sf::Time nextTick = clock.getElapsedTime();
+
+        while (running) {
+            WorldSnapshot& snapshot = snapshots.getWriteBuffer();
+            snapshot.clear();
+            step(tickLength.asSeconds(), snapshot);
+            snapshot.tick = ++tick;
+            snapshots.publish();
+
+            // Wait for the next tick, if the simulation has fallen a long way behind it carries on from now instead of trying to catch up
+            nextTick += tickLength;
+            sf::Time now = clock.getElapsedTime();
+            if (nextTick > now) {
+                sf::sleep(nextTick - now);
+            }
+            else if (now - nextTick > tickLength * 4.f) {
+                nextTick = now;
+            }
+        }
+    }
+
+    float tickRate;
+    std::atomic<bool> running;
+    StepFunction step;
+    TripleBuffer<WorldSnapshot> snapshots;
+    std::thread thread;
+};
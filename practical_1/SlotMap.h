@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Handle to an entry in a SlotMap, it stays valid for as long as that entry is in the map however many others come and go
+// Once the entry is removed the handle goes stale rather than pointing at whatever takes its place, because the slot's generation changes
+struct SlotHandle {
+    std::uint32_t slot = 0;
+    std::uint32_t generation = 0;  // Live entries never have generation 0, so a default handle refers to nothing
+
+    bool operator==(const SlotHandle& other) const {
+        return slot == other.slot && generation == other.generation;
+    }
+
+    bool operator!=(const SlotHandle& other) const {
+        return !(*this == other);
+    }
+};
+
+// Container that keeps its values packed together in a vector for fast iteration, and hands out handles that find a value in O(1)
+// Removing a value moves the last one into its place rather than shifting everything after it, so the order of the values isn't kept.
+// Each value lives in a slot that doesn't move while the value is alive, the slot records where in the vector the value is now.
+// Removed slots are reused for new values, lowest first after a clear, with their generation bumped so older handles to them go stale
+template <typename T>
+class SlotMap {
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    // Method to add a value, returns the handle to find it again
+    SlotHandle insert(T value) {
+        std::uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            slot = static_cast<std::uint32_t>(slots.size());
+            slots.push_back({ noValue, 1 });
+        }
+        slots[slot].index = static_cast<std::uint32_t>(values.size());
+        values.push_back(std::move(value));
+        valueSlots.push_back(slot);
+        return { slot, slots[slot].generation };
+    }
+
+    // Method to remove the value a handle refers to, returns false if it was already gone
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        eraseAt(slots[handle.slot].index);
+        return true;
+    }
+
+    // Method to remove the value at a position in the packed values, the last value is moved into its place
+    void eraseAt(std::size_t index) {
+        std::uint32_t slot = valueSlots[index];
+        slots[slot].index = noValue;
+        slots[slot].generation = nextGeneration(slots[slot].generation);
+        freeSlots.push_back(slot);
+
+        if (index + 1 != values.size()) {
+            values[index] = std::move(values.back());
+            valueSlots[index] = valueSlots.back();
+            slots[valueSlots[index]].index = static_cast<std::uint32_t>(index);
+        }
+        values.pop_back();
+        valueSlots.pop_back();
+    }
+
+    // Method to remove every value the predicate returns true for, returns how many were removed
+    template <typename Predicate>
+    std::size_t eraseIf(Predicate predicate) {
+        std::size_t removed = 0;
+        for (std::size_t i = 0; i < values.size(); ) {
+            if (predicate(values[i])) {
+                eraseAt(i);  // The last value is now at i, so check it before moving on
+                ++removed;
+            }
+            else {
+                ++i;
+            }
+        }
+        return removed;
+    }
+
+    // Method to remove every value, the memory is kept and every handle given out so far goes stale
+    void clear() {
+        for (std::uint32_t slot : valueSlots) {
+            slots[slot].index = noValue;
+            slots[slot].generation = nextGeneration(slots[slot].generation);
+        }
+        values.clear();
+        valueSlots.clear();
+
+        // Every slot is free now, stacked so the lowest is reused first and a refilled map gets the same slots in the same order
+        freeSlots.clear();
+        for (std::size_t slot = slots.size(); slot > 0; --slot) {
+            freeSlots.push_back(static_cast<std::uint32_t>(slot - 1));
+        }
+    }
+
+    // Method to make room for a number of values so inserting them doesn't allocate
+    void reserve(std::size_t count) {
+        values.reserve(count);
+        valueSlots.reserve(count);
+        slots.reserve(count);
+        freeSlots.reserve(count);
+    }
+
+    // Returns true if the handle still refers to a value in the map
+    bool contains(SlotHandle handle) const {
+        return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation && slots[handle.slot].index != noValue;
+    }
+
+    // Returns the value a handle refers to, or nullptr if it has been removed
+    T* get(SlotHandle handle) {
+        return contains(handle) ? &values[slots[handle.slot].index] : nullptr;
+    }
+
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &values[slots[handle.slot].index] : nullptr;
+    }
+
+    // Returns the handle of the value at a position in the packed values
+    SlotHandle handleAt(std::size_t index) const {
+        std::uint32_t slot = valueSlots[index];
+        return { slot, slots[slot].generation };
+    }
+
+    // Access to the packed values by position, positions change when values are removed so keep a handle to find one later
+    T& operator[](std::size_t index) {
+        return values[index];
+    }
+
+    const T& operator[](std::size_t index) const {
+        return values[index];
+    }
+
+    T& back() {
+        return values.back();
+    }
+
+    std::size_t size() const {
+        return values.size();
+    }
+
+    bool empty() const {
+        return values.empty();
+    }
+
+    iterator begin() {
+        return values.begin();
+    }
+
+    iterator end() {
+        return values.end();
+    }
+
+    const_iterator begin() const {
+        return values.begin();
+    }
+
+    const_iterator end() const {
+        return values.end();
+    }
+
+private:
+    static const std::uint32_t noValue = 0xFFFFFFFFu;  // Index of a slot that has no value in it
+
+    struct Slot {
+        std::uint32_t index;       // Where the slot's value is in the packed values, or noValue if the slot is free
+        std::uint32_t generation;  // Bumped every time the slot's value is removed
+    };
+
+    // Returns the generation after this one, skipping 0 when it wraps round so it never matches a default handle
+    static std::uint32_t nextGeneration(std::uint32_t generation) {
+        return generation + 1 == 0 ? 1 : generation + 1;
+    }
+
+    std::vector<T> values;
+    std::vector<std::uint32_t> valueSlots;  // The slot of each packed value, in the same order
+    std::vector<Slot> slots;
+    std::vector<std::uint32_t> freeSlots;  // Slots with no value, the next one used is at the back
+};
@@ -0,0 +1,46 @@
+#include "SoakMonitor.h"
+
+// The platform headers are only included here, they define macros (such as min and max) that clash with the game
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+std::size_t getProcessMemory() {
+#if defined(_WIN32)
+    // K32GetProcessMemoryInfo is in kernel32 itself, so this doesn't need psapi.lib linking
+    PROCESS_MEMORY_COUNTERS_EX counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) {
+        return counters.PrivateUsage;
+    }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return static_cast<std::size_t>(info.resident_size);
+    }
+    return 0;
+#elif defined(__linux__)
+    // The second number in statm is the resident set in pages
+    std::size_t pages = 0;
+    std::size_t resident = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(statm, "%zu %zu", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        std::fclose(statm);
+    }
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Watches a long soak run for slow leaks and slow degradation, and fails it if either goes past its threshold
+// Memory is sampled at a fixed interval and compared with the first sample after the warm up, using the smallest of the last few
+// samples so a brief spike at the end doesn't fail the run, only growth that stays does.
+// Frame times depend a lot on which level is being played, so they are kept per level and each level's latest play is compared
+// with its first play after the warm up, which compares like with like however the levels take turns
+
+// Returns the memory the process is using in bytes, its resident set on Linux and macOS and its private bytes on Windows, 0 if unknown
+std::size_t getProcessMemory();
+
+// How far the run may drift before it fails
+struct SoakThresholds {
+    float warmUpSeconds = 60.f;         // Nothing before this counts, caches and containers grow to their working size then
+    float sampleInterval = 10.f;        // Seconds between memory samples
+    float maxMemoryGrowthMB = 64.f;     // Growth from the first sample after the warm up to the end
+    float maxFrameTimeGrowth = 0.5f;    // Fraction a level's mean frame time may rise by between its first and last play
+};
+
+class SoakMonitor {
+public:
+    explicit SoakMonitor(const SoakThresholds& thresholds)
+        : thresholds(thresholds) {
+    }
+
+    // Method to start timing a play of a level
+    void beginLevel(int level) {
+        currentLevel = level;
+        frameTotal = 0.0;
+        frameCount = 0;
+        worstFrame = 0.f;
+    }
+
+    // Method to record one frame (or one tick when running headless), elapsed is the seconds the run has been going
+    void recordFrame(float frameSeconds, float elapsed, std::size_t entities) {
+        this->elapsed = elapsed;
+        if (elapsed >= thresholds.warmUpSeconds) {
+            frameTotal += frameSeconds;
+            ++frameCount;
+            worstFrame = std::max(worstFrame, frameSeconds);
+        }
+        mostEntities = std::max(mostEntities, entities);
+
+        if (elapsed >= nextSample) {
+            nextSample = elapsed + thresholds.sampleInterval;
+            std::size_t memory = getProcessMemory();
+            if (elapsed >= thresholds.warmUpSeconds) {
+                memorySamples.push_back(memory);
+            }
+            LOG_INFO("[soak] {} s, {} KB in use, level {}, {} entities on screen at most since the last sample",
+                static_cast<unsigned>(elapsed), static_cast<unsigned>(memory / 1024), currentLevel, static_cast<unsigned>(mostEntities));
+            mostEntities = 0;
+        }
+    }
+
+    // Method to finish a play of a level, plays too short to time are skipped
+    void endLevel() {
+        if (frameCount < minimumFrames) {
+            return;
+        }
+        float mean = static_cast<float>(frameTotal / frameCount);
+        for (LevelTimes& times : levels) {
+            if (times.level == currentLevel) {
+                times.last = mean;
+                times.worst = std::max(times.worst, worstFrame);
+                ++times.plays;
+                return;
+            }
+        }
+        levels.push_back({ currentLevel, mean, mean, worstFrame, 1 });
+    }
+
+    // Method to print what happened over the run and check it against the thresholds, returns the number of checks that failed
+    int report() const {
+        int failures = 0;
+        auto check = [&failures](bool passed, const char* description) {
+            if (passed) {
+                LOG_INFO("[soak] PASS {}", description);
+            }
+            else {
+                LOG_ERROR("[soak] FAIL {}", description);
+                ++failures;
+            }
+        };
+
+        // Memory, the smallest of the last three samples against the first
+        check(memorySamples.size() >= 4, "the run was long enough to take memory samples after the warm up");
+        if (memorySamples.size() >= 4) {
+            std::size_t settled = *std::min_element(memorySamples.end() - 3, memorySamples.end());
+            double growthMB = (static_cast<double>(settled) - static_cast<double>(memorySamples.front())) / (1024.0 * 1024.0);
+            LOG_INFO("[soak] memory went from {} KB to {} KB, {} MB allowed", static_cast<unsigned>(memorySamples.front() / 1024),
+                static_cast<unsigned>(settled / 1024), thresholds.maxMemoryGrowthMB);
+            check(growthMB <= thresholds.maxMemoryGrowthMB, "memory stayed within the growth allowed");
+        }
+
+        // Frame times, each level against itself
+        bool framesSteady = true;
+        std::size_t comparedLevels = 0;
+        for (const LevelTimes& times : levels) {
+            LOG_INFO("[soak] level {}: {} plays, mean frame {} ms first and {} ms last, worst {} ms", times.level, times.plays,
+                times.first * 1000.f, times.last * 1000.f, times.worst * 1000.f);
+            if (times.plays >= 2) {
+                ++comparedLevels;
+                framesSteady = framesSteady && times.last <= times.first * (1.f + thresholds.maxFrameTimeGrowth);
+            }
+        }
+        check(comparedLevels > 0, "at least one level was played twice after the warm up");
+        check(framesSteady, "no level's mean frame time grew by more than allowed");
+        return failures;
+    }
+
+private:
+    static const std::size_t minimumFrames = 60;
+
+    struct LevelTimes {
+        int level;
+        float first;  // Mean frame time of the first play after the warm up
+        float last;   // And of the latest one
+        float worst;
+        int plays;
+    };
+
+    SoakThresholds thresholds;
+    float elapsed = 0.f;
+    float nextSample = 0.f;
+    std::vector<std::size_t> memorySamples;
+    std::size_t mostEntities = 0;
+
+    int currentLevel = 0;
+    double frameTotal = 0.0;
+    std::size_t frameCount = 0;
+    float worstFrame = 0.f;
+    std::vector<LevelTimes> levels;
+};
@@ -0,0 +1,370 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Texture atlas for the entity art, every sprite is packed onto one or a few large pages so the sprite batch can draw
+// all of them with one draw call per page instead of one texture bind and draw call per entity.
+// The atlas is normally packed ahead of time by the atlas builder (tools/AtlasBuilder.cpp) from the sprite manifest, which writes
+// the pages as atlas_<page>.png and the table of where each sprite went as atlas.txt. If those haven't been built the game packs
+// the manifest itself when it starts, so the art still shows up, it just takes a little longer to start.
+//
+// The manifest lists one sprite per line, files are relative to the manifest and # starts a comment:
+//     <name> <image file> [rotate-left | rotate-right] [flip-x] [tinted]
+// rotate-left and rotate-right turn the image a quarter turn and flip-x mirrors it when it is packed, so art drawn facing up
+// can face the way the entity flies. tinted means the sprite is multiplied by the entity's colour when drawn
+// (for white or grey art shared by entities of different colours), otherwise it is drawn in its own colours.
+// Every atlas also has a "plain" sprite, a white block that draws an entity as a flat rectangle in its colour as it was before
+
+// Where one sprite is in the atlas
+struct AtlasRegion {
+    int page = 0;
+    sf::IntRect rect;     // Pixels on the page, which is what SFML's texture coordinates are in
+    bool tinted = false;  // Multiply by the entity's colour, otherwise draw the sprite in its own colours
+};
+
+// Packs images onto atlas pages, one shelf at a time from the tallest image to the shortest
+class AtlasPacker {
+public:
+    static const int padding = 1;  // Pixels around every sprite, filled with its edge so filtering never picks up the next sprite
+
+    explicit AtlasPacker(int pageSize = 1024)
+        : pageSize(pageSize) {
+        // The plain sprite is a white block, its region is a single point in the middle so every pixel of the rectangle samples white
+        sf::Image white;
+        white.create(2, 2, sf::Color::White);
+        add("plain", white, true);
+    }
+
+    // Method to add one image to be packed, a later image with the same name replaces the earlier one
+    void add(const std::string& name, const sf::Image& image, bool tinted) {
+        for (Source& source : sources) {
+            if (source.name == name) {
+                source.image = image;
+                source.tinted = tinted;
+                return;
+            }
+        }
+        sources.push_back({ name, image, tinted });
+    }
+
+    // Method to read a sprite manifest and add every image in it, returns false with the reason if a line or image is wrong
+    bool addManifest(const std::string& manifestPath, std::string& error) {
+        std::ifstream manifest(manifestPath);
+        if (!manifest) {
+            error = "can't open " + manifestPath;
+            return false;
+        }
+        std::size_t slash = manifestPath.find_last_of("/\\");
+        std::string directory = slash == std::string::npos ? std::string() : manifestPath.substr(0, slash + 1);
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(manifest, line)) {
+            ++lineNumber;
+            line = line.substr(0, line.find('#'));
+            std::istringstream words(line);
+            std::string name;
+            std::string file;
+            if (!(words >> name)) {
+                continue;
+            }
+            if (!(words >> file) || name == "plain") {
+                error = manifestPath + " line " + std::to_string(lineNumber) + ": expected <name> <image file> [options], plain is taken";
+                return false;
+            }
+
+            bool flip = false;
+            bool tinted = false;
+            int quarterTurns = 0;  // Clockwise
+            std::string option;
+            while (words >> option) {
+                if (option == "flip-x") {
+                    flip = true;
+                }
+                else if (option == "rotate-right") {
+                    quarterTurns = 1;
+                }
+                else if (option == "rotate-left") {
+                    quarterTurns = 3;
+                }
+                else if (option == "tinted") {
+                    tinted = true;
+                }
+                else {
+                    error = manifestPath + " line " + std::to_string(lineNumber) + ": unknown option " + option;
+                    return false;
+                }
+            }
+
+            sf::Image image;
+            if (!image.loadFromFile(directory + file)) {
+                error = manifestPath + " line " + std::to_string(lineNumber) + ": can't load " + directory + file;
+                return false;
+            }
+            for (int turn = 0; turn < quarterTurns; ++turn) {
+                image = rotateClockwise(image);
+            }
+            if (flip) {
+                image.flipHorizontally();
+            }
+            add(name, image, tinted);
+        }
+        return true;
+    }
+
+    // Method to pack every image added so far onto pages, returns false with the reason if an image doesn't fit on a page
+    bool pack(std::string& error) {
+        pages.clear();
+        regions.clear();
+
+        // Tallest first, so each shelf wastes as little height as possible
+        std::vector<std::size_t> order(sources.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+            return sources[a].image.getSize().y > sources[b].image.getSize().y;
+        });
+
+        std::vector<int> pageWidths;
+        std::vector<int> pageHeights;
+        int shelfX = 0;
+        int shelfY = 0;
+        int shelfHeight = 0;
+        std::vector<std::pair<std::size_t, AtlasRegion>> placed;
+        for (std::size_t index : order) {
+            const Source& source = sources[index];
+            int width = static_cast<int>(source.image.getSize().x) + padding * 2;
+            int height = static_cast<int>(source.image.getSize().y) + padding * 2;
+            if (width > pageSize || height > pageSize) {
+                error = source.name + " is bigger than an atlas page";
+                return false;
+            }
+
+            // Start a new shelf when the image doesn't fit on the end of this one, and a new page when the shelf doesn't fit on the page
+            if (pageHeights.empty() || shelfX + width > pageSize) {
+                shelfY += shelfHeight;
+                shelfX = 0;
+                shelfHeight = 0;
+            }
+            if (pageHeights.empty() || shelfY + height > pageSize) {
+                pageWidths.push_back(0);
+                pageHeights.push_back(0);
+                shelfX = 0;
+                shelfY = 0;
+                shelfHeight = 0;
+            }
+
+            AtlasRegion region;
+            region.page = static_cast<int>(pageHeights.size()) - 1;
+            region.rect = sf::IntRect(shelfX + padding, shelfY + padding, width - padding * 2, height - padding * 2);
+            region.tinted = source.tinted;
+            placed.push_back({ index, region });
+
+            shelfX += width;
+            shelfHeight = std::max(shelfHeight, height);
+            pageWidths.back() = std::max(pageWidths.back(), shelfX);
+            pageHeights.back() = std::max(pageHeights.back(), shelfY + shelfHeight);
+        }
+
+        // Copy the images onto their pages, each page is only as big as what is on it
+        pages.resize(pageHeights.size());
+        for (std::size_t page = 0; page < pages.size(); ++page) {
+            pages[page].create(static_cast<unsigned>(pageWidths[page]), static_cast<unsigned>(pageHeights[page]), sf::Color::Transparent);
+        }
+        for (const auto& item : placed) {
+            const Source& source = sources[item.first];
+            AtlasRegion region = item.second;
+            copyWithEdges(pages[region.page], source.image, region.rect.left, region.rect.top);
+            if (source.name == "plain") {
+                region.rect = sf::IntRect(region.rect.left + region.rect.width / 2, region.rect.top + region.rect.height / 2, 0, 0);
+            }
+            regions.push_back({ source.name, region });
+        }
+        return true;
+    }
+
+    // Method to write the pages and the table of regions to a directory (which should end with a slash), as the game loads them
+    bool save(const std::string& directory, std::string& error) const {
+        for (std::size_t page = 0; page < pages.size(); ++page) {
+            std::string file = directory + "atlas_" + std::to_string(page) + ".png";
+            if (!pages[page].saveToFile(file)) {
+                error = "can't write " + file;
+                return false;
+            }
+        }
+
+        std::ofstream table(directory + "atlas.txt");
+        table << "warfare-atlas 1 " << pages.size() << "\n";
+        for (const auto& entry : regions) {
+            const AtlasRegion& region = entry.second;
+            table << entry.first << ' ' << region.page << ' ' << region.rect.left << ' ' << region.rect.top << ' '
+                << region.rect.width << ' ' << region.rect.height << ' ' << (region.tinted ? 1 : 0) << "\n";
+        }
+        if (!table) {
+            error = "can't write " + directory + "atlas.txt";
+            return false;
+        }
+        return true;
+    }
+
+    const std::vector<sf::Image>& getPages() const {
+        return pages;
+    }
+
+    const std::vector<std::pair<std::string, AtlasRegion>>& getRegions() const {
+        return regions;
+    }
+
+private:
+    struct Source {
+        std::string name;
+        sf::Image image;
+        bool tinted;
+    };
+
+    static sf::Image rotateClockwise(const sf::Image& image) {
+        const unsigned width = image.getSize().x;
+        const unsigned height = image.getSize().y;
+        sf::Image rotated;
+        rotated.create(height, width);
+        for (unsigned y = 0; y < height; ++y) {
+            for (unsigned x = 0; x < width; ++x) {
+                rotated.setPixel(height - 1 - y, x, image.getPixel(x, y));
+            }
+        }
+        return rotated;
+    }
+
+    // Method to copy an image onto a page and repeat its outside pixels into the padding around it
+    static void copyWithEdges(sf::Image& page, const sf::Image& image, int left, int top) {
+        const int width = static_cast<int>(image.getSize().x);
+        const int height = static_cast<int>(image.getSize().y);
+        for (int y = -padding; y < height + padding; ++y) {
+            for (int x = -padding; x < width + padding; ++x) {
+                int sourceX = std::min(std::max(x, 0), width - 1);
+                int sourceY = std::min(std::max(y, 0), height - 1);
+                page.setPixel(static_cast<unsigned>(left + x), static_cast<unsigned>(top + y),
+                    image.getPixel(static_cast<unsigned>(sourceX), static_cast<unsigned>(sourceY)));
+            }
+        }
+    }
+
+    int pageSize;
+    std::vector<Source> sources;
+    std::vector<sf::Image> pages;
+    std::vector<std::pair<std::string, AtlasRegion>> regions;
+};
+
+// The atlas the game draws with, its pages as textures and each sprite's region by name
+// The textures need an OpenGL context, so nothing is made until load() is called, which has to happen before anything is drawn with it
+class SpriteAtlas {
+public:
+    // Method to load the atlas, the built one in the atlas directory if it is there, otherwise it is packed from the manifest now
+    // Returns false if neither worked, in which case only the plain sprite is there and getError() says why
+    bool load(const std::string& atlasDirectory, const std::string& manifestPath) {
+        if (loadBuilt(atlasDirectory)) {
+            return true;
+        }
+
+        AtlasPacker packer;
+        if (packer.addManifest(manifestPath, error) && packer.pack(error)) {
+            usePacker(packer);
+            return true;
+        }
+
+        AtlasPacker plainOnly;
+        std::string plainError;
+        plainOnly.pack(plainError);
+        usePacker(plainOnly);
+        return false;
+    }
+
+    // Returns the region of a sprite, or the plain sprite if the atlas doesn't have it
+    const AtlasRegion& find(const std::string& name) const {
+        auto found = regions.find(name);
+        return found != regions.end() ? found->second : plain;
+    }
+
+    std::size_t getPageCount() const {
+        return textures.size();
+    }
+
+    const sf::Texture& getTexture(int page) const {
+        return textures[static_cast<std::size_t>(page)];
+    }
+
+    // Number of sprites in the atlas, not counting the plain one
+    std::size_t getSpriteCount() const {
+        return regions.empty() ? 0 : regions.size() - 1;
+    }
+
+    // Why the last load failed, the string lives as long as the atlas
+    const std::string& getError() const {
+        return error;
+    }
+
+private:
+    // Method to read a table and pages written by the atlas builder
+    bool loadBuilt(const std::string& directory) {
+        std::ifstream table(directory + "atlas.txt");
+        std::string magic;
+        int version = 0;
+        std::size_t pageCount = 0;
+        if (!(table >> magic >> version >> pageCount) || magic != "warfare-atlas" || version != 1 || pageCount == 0) {
+            return false;
+        }
+
+        std::unordered_map<std::string, AtlasRegion> loaded;
+        std::string name;
+        AtlasRegion region;
+        int tinted = 0;
+        while (table >> name >> region.page >> region.rect.left >> region.rect.top >> region.rect.width >> region.rect.height >> tinted) {
+            if (region.page < 0 || static_cast<std::size_t>(region.page) >= pageCount) {
+                return false;
+            }
+            region.tinted = tinted != 0;
+            loaded[name] = region;
+        }
+        if (loaded.count("plain") == 0) {
+            return false;
+        }
+
+        std::vector<sf::Texture> pages(pageCount);
+        for (std::size_t page = 0; page < pageCount; ++page) {
+            if (!pages[page].loadFromFile(directory + "atlas_" + std::to_string(page) + ".png")) {
+                return false;
+            }
+        }
+        textures = std::move(pages);
+        regions = std::move(loaded);
+        plain = regions["plain"];
+        return true;
+    }
+
+    // Method to use the pages an atlas packer has just packed
+    void usePacker(const AtlasPacker& packer) {
+        textures.clear();
+        regions.clear();
+        textures.resize(packer.getPages().size());
+        for (std::size_t page = 0; page < textures.size(); ++page) {
+            textures[page].loadFromImage(packer.getPages()[page]);
+        }
+        for (const auto& entry : packer.getRegions()) {
+            regions[entry.first] = entry.second;
+        }
+        plain = regions["plain"];
+    }
+
+    std::vector<sf::Texture> textures;
+    std::unordered_map<std::string, AtlasRegion> regions;
+    AtlasRegion plain;
+    std::string error;
+};
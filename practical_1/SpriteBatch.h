@@ -0,0 +1,62 @@
+#pragma once
+
+#include "SpriteAtlas.h"
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Collects textured rectangles into one vertex array for each atlas page, so however many sprites are added
+// drawing them is one draw call (and one texture bind) per page. Sprites on the same page are drawn in the order they were added
+class SpriteBatch {
+public:
+    explicit SpriteBatch(const SpriteAtlas& atlas)
+        : atlas(atlas) {
+    }
+
+    // Method to empty the batch for a new frame, the vertex arrays keep their memory
+    void clear() {
+        if (pages.size() != atlas.getPageCount()) {
+            pages.assign(atlas.getPageCount(), sf::VertexArray(sf::Triangles));
+        }
+        for (sf::VertexArray& vertices : pages) {
+            vertices.clear();
+        }
+    }
+
+    // Method to add a sprite stretched over a rectangle, tinted sprites are multiplied by the colour and the others drawn as they are
+    void add(const AtlasRegion& region, const sf::Vector2f& position, const sf::Vector2f& size, const sf::Color& color) {
+        if (static_cast<std::size_t>(region.page) >= pages.size()) {
+            return;
+        }
+        const sf::Color vertexColor = region.tinted ? color : sf::Color::White;
+        const sf::FloatRect texture(region.rect);
+        sf::Vector2f topRight(position.x + size.x, position.y);
+        sf::Vector2f bottomLeft(position.x, position.y + size.y);
+        sf::Vector2f bottomRight = position + size;
+        sf::Vector2f textureTopLeft(texture.left, texture.top);
+        sf::Vector2f textureTopRight(texture.left + texture.width, texture.top);
+        sf::Vector2f textureBottomLeft(texture.left, texture.top + texture.height);
+        sf::Vector2f textureBottomRight(texture.left + texture.width, texture.top + texture.height);
+
+        sf::VertexArray& vertices = pages[region.page];
+        vertices.append(sf::Vertex(position, vertexColor, textureTopLeft));
+        vertices.append(sf::Vertex(topRight, vertexColor, textureTopRight));
+        vertices.append(sf::Vertex(bottomLeft, vertexColor, textureBottomLeft));
+        vertices.append(sf::Vertex(bottomLeft, vertexColor, textureBottomLeft));
+        vertices.append(sf::Vertex(topRight, vertexColor, textureTopRight));
+        vertices.append(sf::Vertex(bottomRight, vertexColor, textureBottomRight));
+    }
+
+    // Method to draw everything in the batch, one draw call for each page that has something on it
+    void draw(sf::RenderTarget& target) const {
+        for (std::size_t page = 0; page < pages.size(); ++page) {
+            if (pages[page].getVertexCount() > 0) {
+                target.draw(pages[page], sf::RenderStates(&atlas.getTexture(static_cast<int>(page))));
+            }
+        }
+    }
+
+private:
+    const SpriteAtlas& atlas;
+    std::vector<sf::VertexArray> pages;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+
+// Continuous collision tests for fast moving objects such as bullets
+// Instead of only checking where an object ends up, these test the whole path it moved along during the tick,
+// so a bullet that moves further than a target is wide in one tick still hits it rather than tunnelling through
+
+// Method to test a line segment against a rectangle using the slab method, the segment starts at start and moves by displacement
+// Returns true if it hits and sets entryTime to how far along the segment the hit was, from 0 (the start) to 1 (the end)
+inline bool segmentIntersectsRect(const sf::Vector2f& start, const sf::Vector2f& displacement, const sf::FloatRect& rect, float& entryTime) {
+    float tMin = 0.f;
+    float tMax = 1.f;
+
+    // Clip the segment against the pair of sides on each axis in turn
+    const float origins[2] = { start.x, start.y };
+    const float deltas[2] = { displacement.x, displacement.y };
+    const float minimums[2] = { rect.left, rect.top };
+    const float maximums[2] = { rect.left + rect.width, rect.top + rect.height };
+
+    for (int axis = 0; axis < 2; ++axis) {
+        if (deltas[axis] == 0.f) {
+            // Not moving on this axis, so it has to already be between the two sides
+            if (origins[axis] < minimums[axis] || origins[axis] > maximums[axis]) {
+                return false;
+            }
+            continue;
+        }
+
+        float inverse = 1.f / deltas[axis];
+        float tNear = (minimums[axis] - origins[axis]) * inverse;
+        float tFar = (maximums[axis] - origins[axis]) * inverse;
+        if (tNear > tFar) {
+            std::swap(tNear, tFar);
+        }
+
+        tMin = std::max(tMin, tNear);
+        tMax = std::min(tMax, tFar);
+        if (tMin > tMax) {
+            return false;  // The segment leaves one slab before entering the other, so it misses
+        }
+    }
+
+    entryTime = tMin;
+    return true;
+}
+
+// Method to test a moving rectangle against a still one over the displacement it moved by this tick
+// The target is grown by the size of the moving rectangle, which turns the test into a single segment check from the moving rectangle's corner
+// Returns true if they touch anywhere along the path and sets entryTime to when, from 0 (the start of the tick) to 1 (the end)
+inline bool sweptRectIntersects(const sf::FloatRect& moving, const sf::Vector2f& displacement, const sf::FloatRect& target, float& entryTime) {
+    sf::FloatRect expanded(target.left - moving.width, target.top - moving.height,
+        target.width + moving.width, target.height + moving.height);
+    return segmentIntersectsRect(sf::Vector2f(moving.left, moving.top), displacement, expanded, entryTime);
+}
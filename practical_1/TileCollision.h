@@ -0,0 +1,140 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The solid tiles of the world, split into the same chunks as the tile map, for everything that collides with the terrain
+// It has nothing to do with drawing, so the simulation can use it without a window or an OpenGL context. The tile map keeps it filled in
+// with the chunks it streams around the camera, and the dedicated server loads every chunk of the map into one up front
+class TileCollision {
+public:
+    static const int tileSize = 32;     // Size of one tile in pixels
+    static const int chunkTiles = 32;   // Number of tiles along each side of a chunk
+    static const int chunkSize = tileSize * chunkTiles;  // Size of one chunk in pixels
+    static const int tileTypes = 9;     // Number of tile types in the atlas, laid out left to right
+
+    TileCollision() = default;
+    TileCollision(const TileCollision&) = delete;
+    TileCollision& operator=(const TileCollision&) = delete;
+
+    // Method to read every chunk of a map that covers the world, for when the whole map should be solid at once rather than streamed
+    void loadAllChunks(const std::string& mapDirectory, const sf::FloatRect& worldBounds) {
+        int chunksX = static_cast<int>(std::ceil(worldBounds.width / chunkSize));
+        int chunksY = static_cast<int>(std::ceil(worldBounds.height / chunkSize));
+        for (int y = 0; y < chunksY; ++y) {
+            for (int x = 0; x < chunksX; ++x) {
+                setChunkTiles(chunkKey(x, y), readChunkFile(mapDirectory, x, y));
+            }
+        }
+    }
+
+    // Boolean method returning true if the tile at this world position is solid, this is a hash lookup for the chunk and an index for the tile
+    // Chunks that aren't loaded count as empty. The collision methods can be called from the simulation thread while the main thread streams chunks
+    bool isSolidAt(float worldX, float worldY) const {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        return isSolidAtLocked(worldX, worldY);
+    }
+
+    // Boolean method returning true if any tile under the rectangle is solid, only the cells the rectangle covers are checked
+    bool overlapsSolid(const sf::FloatRect& bounds) const {
+        int firstX = static_cast<int>(std::floor(bounds.left / tileSize));
+        int firstY = static_cast<int>(std::floor(bounds.top / tileSize));
+        int lastX = static_cast<int>(std::floor((bounds.left + bounds.width) / tileSize));
+        int lastY = static_cast<int>(std::floor((bounds.top + bounds.height) / tileSize));
+        return overlapsSolidTiles(firstX, firstY, lastX, lastY);
+    }
+
+    // Boolean method returning true if any tile from the first to the last tile on each axis is solid, the range includes both ends
+    // This takes tile coordinates rather than pixels so the fixed point simulation can check the terrain without any float maths
+    bool overlapsSolidTiles(int firstX, int firstY, int lastX, int lastY) const {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        for (int y = firstY; y <= lastY; ++y) {
+            for (int x = firstX; x <= lastX; ++x) {
+                if (isSolidTileLocked(x, y)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Returns a number that changes every time a chunk is loaded or evicted, so anything built from the solid tiles knows when to rebuild
+    unsigned getChunkVersion() const {
+        return chunkVersion.load();
+    }
+
+protected:
+    // Method to add or replace the tiles of a chunk, the tiles are one byte per tile, row by row, 0 for empty
+    void setChunkTiles(std::int64_t key, std::vector<std::uint8_t> tiles) {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        solidChunks[key] = std::move(tiles);
+        ++chunkVersion;
+    }
+
+    // Method to forget a chunk's tiles, so it counts as empty again
+    void removeChunkTiles(std::int64_t key) {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        solidChunks.erase(key);
+        ++chunkVersion;
+    }
+
+    // Method to read one chunk file into a grid of tile ids, a missing file or short lines are treated as empty tiles
+    static std::vector<std::uint8_t> readChunkFile(const std::string& mapDirectory, int x, int y) {
+        std::vector<std::uint8_t> tiles(chunkTiles * chunkTiles, 0);
+        std::ifstream file(mapDirectory + "chunk_" + std::to_string(x) + "_" + std::to_string(y) + ".txt");
+        std::string line;
+        for (int row = 0; row < chunkTiles && std::getline(file, line); ++row) {
+            for (int column = 0; column < chunkTiles && column < static_cast<int>(line.size()); ++column) {
+                char c = line[column];
+                if (c >= '1' && c <= '0' + tileTypes) {
+                    tiles[row * chunkTiles + column] = static_cast<std::uint8_t>(c - '0');
+                }
+            }
+        }
+        return tiles;
+    }
+
+    // Methods to pack chunk coordinates into one key for the hash map and to get them back out
+    static std::int64_t chunkKey(int x, int y) {
+        return (static_cast<std::int64_t>(x) << 32) | static_cast<std::uint32_t>(y);
+    }
+    static int keyX(std::int64_t key) {
+        return static_cast<int>(key >> 32);
+    }
+    static int keyY(std::int64_t key) {
+        return static_cast<int>(static_cast<std::uint32_t>(key));
+    }
+
+private:
+    // Same as isSolidAt, for when the chunk mutex is already held
+    bool isSolidAtLocked(float worldX, float worldY) const {
+        if (worldX < 0.f || worldY < 0.f) {
+            return false;
+        }
+        return isSolidTileLocked(static_cast<int>(worldX) / tileSize, static_cast<int>(worldY) / tileSize);
+    }
+
+    // Same as isSolidAtLocked, with the tile's coordinates rather than a position in pixels
+    bool isSolidTileLocked(int tileX, int tileY) const {
+        if (tileX < 0 || tileY < 0) {
+            return false;
+        }
+        auto found = solidChunks.find(chunkKey(tileX / chunkTiles, tileY / chunkTiles));
+        if (found == solidChunks.end()) {
+            return false;
+        }
+        return found->second[(tileY % chunkTiles) * chunkTiles + (tileX % chunkTiles)] != 0;
+    }
+
+    // Tile ids of every chunk that is loaded, changed while holding the chunk mutex, collision queries from other threads lock it too
+    std::unordered_map<std::int64_t, std::vector<std::uint8_t>> solidChunks;
+    mutable std::mutex chunkMutex;
+    std::atomic<unsigned> chunkVersion{ 0 };
+};
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "TileCollision.h"
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Tile map for the terrain and obstacles in the world, split into square chunks of tiles
+// Chunks near the camera are read from disk on a worker thread and baked into a vertex buffer against a texture atlas,
+// chunks far away are thrown away again once the map goes over its memory budget, so the whole map is never in memory at once
+//
+// Each chunk is a text file called chunk_X_Y.txt in the map directory, with one line per row of tiles.
+// A '.' is an empty tile and the digits 1 to 9 pick the tile in the atlas, chunks with no file are empty sky
+// The solid tiles of every loaded chunk are kept in the TileCollision the map is built on, so the map can be passed to anything that collides
+class TileMap : public TileCollision {
+public:
+    // Constructor for the tile map with the folder the chunk files are in, the world it covers and how many bytes of chunks it may keep loaded
+    TileMap(const std::string& mapDirectory, const sf::FloatRect& worldBounds, std::size_t memoryBudget)
+        : mapDirectory(mapDirectory), memoryBudget(memoryBudget), memoryUsed(0), running(true) {
+        chunksX = static_cast<int>(std::ceil(worldBounds.width / chunkSize));
+        chunksY = static_cast<int>(std::ceil(worldBounds.height / chunkSize));
+        loader = std::thread(&TileMap::loaderLoop, this);
+    }
+
+    // Stop the loader thread before the map is destroyed
+    ~TileMap() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            running = false;
+        }
+        queueCondition.notify_one();
+        loader.join();
+    }
+
+    TileMap(const TileMap&) = delete;
+    TileMap& operator=(const TileMap&) = delete;
+
+    // Method to load the atlas from a file, if the file can't be loaded a plain coloured atlas is made so the map still draws
+    void loadAtlas(const std::string& filename) {
+        if (!atlas.loadFromFile(filename)) {
+            sf::Image image;
+            image.create(tileSize * tileTypes, tileSize);
+            for (int type = 0; type < tileTypes; ++type) {
+                // Each tile type gets a different shade of grey-green with a darker border
+                sf::Uint8 shade = static_cast<sf::Uint8>(90 + type * 15);
+                for (int y = 0; y < tileSize; ++y) {
+                    for (int x = 0; x < tileSize; ++x) {
+                        bool border = x == 0 || y == 0 || x == tileSize - 1 || y == tileSize - 1;
+                        sf::Uint8 value = border ? static_cast<sf::Uint8>(shade / 2) : shade;
+                        image.setPixel(type * tileSize + x, y, sf::Color(value, static_cast<sf::Uint8>(value + 20), value));
+                    }
+                }
+            }
+            atlas.loadFromImage(image);
+        }
+    }
+
+    // Method to stream chunks in and out around the camera, loaded chunks from the worker thread are baked here on the main thread
+    // because the vertex buffers need the OpenGL context
+    void update(const sf::FloatRect& viewBounds) {
+        // Work out which chunks the view touches plus a ring of one chunk around it, so chunks are loaded before they come on screen
+        int firstX = std::max(0, static_cast<int>(std::floor(viewBounds.left / chunkSize)) - 1);
+        int firstY = std::max(0, static_cast<int>(std::floor(viewBounds.top / chunkSize)) - 1);
+        int lastX = std::min(chunksX - 1, static_cast<int>(std::floor((viewBounds.left + viewBounds.width) / chunkSize)) + 1);
+        int lastY = std::min(chunksY - 1, static_cast<int>(std::floor((viewBounds.top + viewBounds.height) / chunkSize)) + 1);
+
+        // The lists are reused every frame, so once they reach their working size streaming doesn't allocate unless a chunk actually loads
+        wantedChunks.clear();
+        bool requested = false;
+        for (int y = firstY; y <= lastY; ++y) {
+            for (int x = firstX; x <= lastX; ++x) {
+                std::int64_t key = chunkKey(x, y);
+                wantedChunks.push_back(key);
+                if (chunks.find(key) == chunks.end() && requestedChunks.count(key) == 0) {
+                    requestedChunks.insert(key);
+                    std::lock_guard<std::mutex> lock(queueMutex);
+                    loadQueue.push_back(key);
+                    requested = true;
+                }
+            }
+        }
+        if (requested) {
+            queueCondition.notify_one();
+        }
+
+        // Bake any chunks the worker has finished reading
+        finishedChunks.clear();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            finishedChunks.swap(loadedQueue);
+        }
+        for (auto& loaded : finishedChunks) {
+            requestedChunks.erase(loaded.key);
+            if (!isWanted(loaded.key)) {
+                continue;  // The camera has moved away while it was loading, so it isn't needed any more
+            }
+            std::unique_ptr<Chunk> chunk(new Chunk());
+            bakeChunk(*chunk, loaded.tiles, keyX(loaded.key), keyY(loaded.key));
+            memoryUsed += chunk->memory;
+            chunks[loaded.key] = std::move(chunk);
+            setChunkTiles(loaded.key, std::move(loaded.tiles));
+        }
+
+        evictChunks(viewBounds);
+    }
+
+    // Returns true while any chunk that has been asked for is still being read by the worker thread
+    bool isLoading() const {
+        return !requestedChunks.empty();
+    }
+
+    // Method to render the loaded chunks that are inside the view
+    void render(sf::RenderTarget& target, const sf::FloatRect& viewBounds) {
+        sf::RenderStates states(&atlas);
+        for (const auto& entry : chunks) {
+            const Chunk& chunk = *entry.second;
+            if (chunk.vertexCount == 0 || !viewBounds.intersects(chunkBounds(keyX(entry.first), keyY(entry.first)))) {
+                continue;
+            }
+            if (chunk.useVertexBuffer) {
+                target.draw(chunk.vertexBuffer, states);
+            }
+            else {
+                target.draw(chunk.vertices.data(), chunk.vertices.size(), sf::Triangles, states);
+            }
+        }
+    }
+
+    // Returns how many bytes the loaded chunks are using
+    std::size_t getMemoryUsed() const {
+        return memoryUsed;
+    }
+
+    // Returns how many chunks are loaded
+    std::size_t getLoadedChunkCount() const {
+        return chunks.size();
+    }
+
+private:
+    // A chunk that has been loaded and baked, its tile ids are in the collision and the vertices are kept here for drawing
+    struct Chunk {
+        sf::VertexBuffer vertexBuffer{ sf::Triangles, sf::VertexBuffer::Static };
+        std::vector<sf::Vertex> vertices;  // Only used when vertex buffers aren't supported by the graphics card
+        bool useVertexBuffer = false;
+        std::size_t vertexCount = 0;
+        std::size_t memory = 0;
+    };
+
+    // A chunk the worker thread has read from disk but that hasn't been baked yet
+    struct LoadedChunk {
+        std::int64_t key;
+        std::vector<std::uint8_t> tiles;
+    };
+
+    // Boolean method returning true if the chunk is around the view this frame, the list is only a few entries long so a search is fine
+    bool isWanted(std::int64_t key) const {
+        return std::find(wantedChunks.begin(), wantedChunks.end(), key) != wantedChunks.end();
+    }
+
+    // Returns the rectangle a chunk covers in the world
+    static sf::FloatRect chunkBounds(int x, int y) {
+        return sf::FloatRect(static_cast<float>(x * chunkSize), static_cast<float>(y * chunkSize),
+            static_cast<float>(chunkSize), static_cast<float>(chunkSize));
+    }
+
+    // Method run by the worker thread, it waits for chunk requests and reads the files off disk
+    void loaderLoop() {
+        while (true) {
+            std::int64_t key;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [this] { return !running || !loadQueue.empty(); });
+                if (!running) {
+                    return;
+                }
+                key = loadQueue.front();
+                loadQueue.pop_front();
+            }
+
+            LoadedChunk loaded;
+            loaded.key = key;
+            loaded.tiles = readChunkFile(mapDirectory, keyX(key), keyY(key));
+
+            std::lock_guard<std::mutex> lock(queueMutex);
+            loadedQueue.push_back(std::move(loaded));
+        }
+    }
+
+    // Method to build the triangles for every solid tile in a chunk and upload them to the graphics card in one buffer
+    void bakeChunk(Chunk& chunk, const std::vector<std::uint8_t>& tiles, int x, int y) {
+        std::vector<sf::Vertex> vertices;
+        sf::Vector2f origin(static_cast<float>(x * chunkSize), static_cast<float>(y * chunkSize));
+        for (int row = 0; row < chunkTiles; ++row) {
+            for (int column = 0; column < chunkTiles; ++column) {
+                int tile = tiles[row * chunkTiles + column];
+                if (tile == 0) {
+                    continue;
+                }
+                float left = origin.x + column * tileSize;
+                float top = origin.y + row * tileSize;
+                float u = static_cast<float>((tile - 1) * tileSize);
+
+                // Two triangles per tile
+                sf::Vertex topLeft(sf::Vector2f(left, top), sf::Vector2f(u, 0.f));
+                sf::Vertex topRight(sf::Vector2f(left + tileSize, top), sf::Vector2f(u + tileSize, 0.f));
+                sf::Vertex bottomLeft(sf::Vector2f(left, top + tileSize), sf::Vector2f(u, static_cast<float>(tileSize)));
+                sf::Vertex bottomRight(sf::Vector2f(left + tileSize, top + tileSize), sf::Vector2f(u + tileSize, static_cast<float>(tileSize)));
+                vertices.push_back(topLeft);
+                vertices.push_back(topRight);
+                vertices.push_back(bottomLeft);
+                vertices.push_back(bottomLeft);
+                vertices.push_back(topRight);
+                vertices.push_back(bottomRight);
+            }
+        }
+
+        chunk.vertexCount = vertices.size();
+        chunk.memory = tiles.size() + vertices.size() * sizeof(sf::Vertex);
+        if (vertices.empty()) {
+            return;
+        }
+        if (sf::VertexBuffer::isAvailable() && chunk.vertexBuffer.create(vertices.size()) && chunk.vertexBuffer.update(vertices.data())) {
+            chunk.useVertexBuffer = true;
+        }
+        else {
+            chunk.vertices = std::move(vertices);
+        }
+    }
+
+    // Method to throw away the chunks furthest from the view until the map is back under its memory budget
+    // Chunks the camera wants are never thrown away, so the budget can be exceeded if it is set smaller than the view needs
+    void evictChunks(const sf::FloatRect& viewBounds) {
+        if (memoryUsed <= memoryBudget) {
+            return;
+        }
+        sf::Vector2f center(viewBounds.left + viewBounds.width / 2.f, viewBounds.top + viewBounds.height / 2.f);
+
+        std::vector<std::pair<float, std::int64_t>> candidates;
+        for (const auto& entry : chunks) {
+            if (!isWanted(entry.first)) {
+                sf::FloatRect bounds = chunkBounds(keyX(entry.first), keyY(entry.first));
+                float dx = bounds.left + bounds.width / 2.f - center.x;
+                float dy = bounds.top + bounds.height / 2.f - center.y;
+                candidates.push_back(std::make_pair(dx * dx + dy * dy, entry.first));
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const std::pair<float, std::int64_t>& a, const std::pair<float, std::int64_t>& b) {
+            return a.first > b.first;  // Furthest first
+            });
+
+        for (const auto& candidate : candidates) {
+            if (memoryUsed <= memoryBudget) {
+                break;
+            }
+            auto found = chunks.find(candidate.second);
+            memoryUsed -= found->second->memory;
+            chunks.erase(found);
+            removeChunkTiles(candidate.second);
+        }
+    }
+
+    std::string mapDirectory;
+    int chunksX;
+    int chunksY;
+    std::size_t memoryBudget;
+    std::size_t memoryUsed;
+    sf::Texture atlas;
+
+    // Loaded chunks ready to draw, only used by the main thread
+    std::unordered_map<std::int64_t, std::unique_ptr<Chunk>> chunks;
+    std::vector<std::int64_t> wantedChunks;            // Chunks around the view this frame
+    std::vector<LoadedChunk> finishedChunks;           // Chunks taken from the worker this frame
+    std::unordered_set<std::int64_t> requestedChunks;  // Chunks sent to the worker that haven't come back yet
+
+    // Queues shared with the worker thread, guarded by the mutex
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<std::int64_t> loadQueue;
+    std::vector<LoadedChunk> loadedQueue;
+    bool running;
+    std::thread loader;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer for handing the newest copy of some data from one producer thread to one consumer thread
+// The producer always has a buffer to write into and the consumer always has a whole buffer to read, neither ever waits for the other.
+// The third buffer sits in the middle and is swapped with one side or the other using a single atomic exchange
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer()
+        : middle(2), writeIndex(0), readIndex(1) {
+    }
+
+    // Returns the buffer the producer should fill in next, only the producer thread may call this
+    T& getWriteBuffer() {
+        return buffers[writeIndex];
+    }
+
+    // Method for the producer to hand over the buffer it has just filled in, it gets the old middle buffer back to write into next
+    void publish() {
+        std::uint8_t previous = middle.exchange(static_cast<std::uint8_t>(writeIndex | freshBit), std::memory_order_acq_rel);
+        writeIndex = static_cast<std::uint8_t>(previous & indexMask);
+    }
+
+    // Method for the consumer to pick up the newest published buffer, returns false if nothing new has been published since last time
+    bool update() {
+        if ((middle.load(std::memory_order_acquire) & freshBit) == 0) {
+            return false;
+        }
+        std::uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = static_cast<std::uint8_t>(previous & indexMask);
+        return true;
+    }
+
+    // Returns the buffer the consumer is reading, only the consumer thread may call this
+    const T& getReadBuffer() const {
+        return buffers[readIndex];
+    }
+
+private:
+    static const std::uint8_t indexMask = 3;
+    static const std::uint8_t freshBit = 4;  // Set in the middle index when it holds data the consumer hasn't picked up yet
+
+    T buffers[3];
+    std::atomic<std::uint8_t> middle;
+    std::uint8_t writeIndex;  // Only touched by the producer
+    std::uint8_t readIndex;   // Only touched by the consumer
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "GameData.h"
+#include "SeededRandom.h"
+#include "TileCollision.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+// Makes the waves for the endless mode, each one a level layout like the ones in levels.txt so it spawns the same way
+// Every wave has more enemies than the last, and they move faster and fire more often until they reach a cap. The swarm archetypes
+// join in one at a time over the first few waves, after which every wave adds more of each.
+// Everything comes from one seeded random number generator, so the same seed always gives the same waves in the same places,
+// which makes the endless mode a workload that can be repeated and that keeps getting heavier the longer it is played.
+// Each wave takes the same amount of random numbers whatever the terrain and the player look like, so where one enemy lands never
+// changes the waves after it. The terrain should be the whole map (TileCollision::loadAllChunks) rather than the streamed chunks,
+// which depend on timing
+class WaveGenerator {
+public:
+    explicit WaveGenerator(std::uint32_t seed)
+        : random(seed) {
+    }
+
+    // Method to make the layout of a wave, numbered from 1. Enemies are placed inside the world, off the terrain and away from the player
+    // Waves have to be made in order for a seed to give the same waves every time
+    LevelDefinition generate(int wave, const sf::FloatRect& worldBounds, const TileCollision& terrain, const sf::Vector2f& playerPosition) {
+        LevelDefinition layout;
+        const float step = static_cast<float>(wave - 1);
+
+        // The level's own enemies, with health bars and bullet patterns
+        const int enemyCount = 2 + wave;
+        const float speedFactor = std::min(0.4f + 0.05f * step, 1.2f);  // Caps at a bit faster than the player
+        const float fireRate = std::min(1.f + 0.1f * step, 4.f);
+        for (int i = 0; i < enemyCount; ++i) {
+            EnemySpawn spawn;
+            pickPosition(worldBounds, terrain, playerPosition, spawn.x, spawn.y);
+            spawn.speedFactor = speedFactor * (0.85f + 0.3f * random.nextUnit());  // Not all the same speed, so they spread out
+            spawn.pattern = getPattern(random.next() % static_cast<std::uint32_t>(std::min(5, 2 + wave / 2)));
+            spawn.fireRate = fireRate;
+            layout.enemies.push_back(spawn);
+        }
+
+        // The swarm, one more archetype each wave until all five are in
+        const int kinds = std::min(wave, 5);
+        const int swarmCount = 3 * wave;
+        for (int i = 0; i < swarmCount; ++i) {
+            SwarmSpawn spawn;
+            spawn.kind = static_cast<SwarmKind>(random.next() % kinds);
+            pickPosition(worldBounds, terrain, playerPosition, spawn.x, spawn.y);
+            spawn.phase = random.nextUnit() * 6.2831853f;
+            layout.swarm.push_back(spawn);
+        }
+        return layout;
+    }
+
+private:
+    static constexpr float spawnSize = 64.f;        // Box kept clear of the terrain around each spawn, big enough for any enemy
+    static constexpr float minimumDistance = 700.f; // Closest an enemy can appear to the player
+
+    // Method to choose a spot for an enemy, the first of a few spots that is off the terrain and away from the player, or the last one
+    // if none are. Every spot is drawn even once one has been found, so the random numbers used don't depend on what was tried
+    void pickPosition(const sf::FloatRect& worldBounds, const TileCollision& terrain, const sf::Vector2f& playerPosition, float& x, float& y) {
+        bool found = false;
+        for (int attempt = 0; attempt < 16; ++attempt) {
+            float candidateX = worldBounds.left + random.nextUnit() * (worldBounds.width - spawnSize);
+            float candidateY = worldBounds.top + random.nextUnit() * (worldBounds.height - spawnSize);
+            if (found) {
+                continue;
+            }
+            x = candidateX;
+            y = candidateY;
+            sf::Vector2f offset(x - playerPosition.x, y - playerPosition.y);
+            bool farEnough = offset.x * offset.x + offset.y * offset.y >= minimumDistance * minimumDistance;
+            found = farEnough && !terrain.overlapsSolid(sf::FloatRect(x, y, spawnSize, spawnSize));
+        }
+    }
+
+    // Returns the name of one of the enemies' patterns, the later ones are only used from later waves
+    // They are named so the pattern a wave picks doesn't depend on the order the pattern library was filled in
+    static const char* getPattern(std::uint32_t index) {
+        static const char* const names[] = { "straight", "aimedBurst", "wave", "ring", "spiral" };
+        return names[index];
+    }
+
+    SeededRandom random;
+};
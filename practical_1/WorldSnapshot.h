@@ -0,0 +1,77 @@
+#pragma once
+
+#include "SpriteBatch.h"
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+// One rectangle to draw for an entity in a snapshot
+struct SnapshotRect {
+    sf::Vector2f position;
+    sf::Vector2f size;
+    sf::Color color;
+};
+
+// Copy of everything the renderer needs from the level at the end of one simulation tick
+// Once published a snapshot is never changed, so the render thread can read it while the simulation carries on with the next tick
+struct WorldSnapshot {
+    std::uint64_t tick = 0;  // Which simulation tick this snapshot came from, 0 means nothing has been simulated yet
+
+    SnapshotRect player;
+    int playerHealth = 0;
+    int playerMaxHealth = 0;
+
+    std::vector<SnapshotRect> enemies;
+    std::vector<int> enemyHealth;  // Health of the level's own enemies, in the same order as the start of enemies (swarm enemies come after and have no health bar)
+    std::vector<int> enemyMaxHealth;  // Health each of those enemies started with, so the boss's bar is measured against its own health
+    std::vector<std::uint32_t> enemyNumbers;  // Number each of those enemies' health bars is labelled with, it stays the same while the enemy is alive
+    std::vector<SnapshotRect> bullets;  // Player and enemy bullets together, they are drawn the same way
+    std::size_t playerBulletCount = 0;  // How many of the bullets at the start are the player's, the rest are the enemies'
+    std::size_t scriptsRunning = 0;  // Level scripts that haven't finished, the level isn't over until they have
+
+    // Method to empty the snapshot but keep the memory of its vectors, so filling it in every tick doesn't allocate
+    void clear() {
+        enemies.clear();
+        enemyHealth.clear();
+        enemyMaxHealth.clear();
+        enemyNumbers.clear();
+        bullets.clear();
+        playerBulletCount = 0;
+    }
+};
+
+// Draws the entities in a snapshot with their sprites from the atlas, all of them go into one sprite batch so the whole world
+// is a single draw call for each atlas page (normally just one). Rectangles outside the view are skipped while building
+class SnapshotRenderer {
+public:
+    explicit SnapshotRenderer(const SpriteAtlas& atlas)
+        : atlas(atlas), batch(atlas) {
+    }
+
+    // Method to build and draw the player, enemies and bullets of a snapshot, the target's view should already be set to the camera
+    void render(sf::RenderTarget& target, const WorldSnapshot& snapshot, const sf::FloatRect& viewBounds) {
+        batch.clear();  // Keeps the memory from last frame
+        appendRects(atlas.find("enemy"), snapshot.enemies, viewBounds);
+        appendRects(atlas.find("bullet"), snapshot.bullets, viewBounds);
+        appendRect(atlas.find("player"), snapshot.player, viewBounds);
+        batch.draw(target);
+    }
+
+private:
+    void appendRects(const AtlasRegion& sprite, const std::vector<SnapshotRect>& rects, const sf::FloatRect& viewBounds) {
+        for (const auto& rect : rects) {
+            appendRect(sprite, rect, viewBounds);
+        }
+    }
+
+    // Method to add one rectangle to the batch if it can be seen
+    void appendRect(const AtlasRegion& sprite, const SnapshotRect& rect, const sf::FloatRect& viewBounds) {
+        if (viewBounds.intersects(sf::FloatRect(rect.position, rect.size))) {
+            batch.add(sprite, rect.position, rect.size, rect.color);
+        }
+    }
+
+    const SpriteAtlas& atlas;
+    SpriteBatch batch;
+};
@@ -1,44 +1,107 @@
 #include <SFML/Graphics.hpp> // Included this for the graphics 
 #include <SFML/Audio.hpp> // included this for the sound effects and music
-#include <iostream>  // Include this header for std::cerr
 #include <vector>
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <memory>
+#include <atomic>
+#include "ParallaxBackground.h"
+#include "Camera.h"
+#include "TileMap.h"
+#include "FlowField.h"
+#include "EnemyBehaviours.h"
+#include "BulletPattern.h"
+#include "Projectiles.h"
+#include "GameAudio.h"
+#include "Logger.h"
+#include "SweptCollision.h"
+#include "FrameArena.h"
+#include "AllocationTracker.h"
+#include "FramePacer.h"
+#include "PlayerInput.h"
+#include "WorldSnapshot.h"
+#include "SimulationThread.h"
+#include "RenderCheck.h"
+#include "DisplayMode.h"
+#include "CoopClient.h"
+#include "DataWatcher.h"
+#include "AutoPlayer.h"
+#include "SoakMonitor.h"
+#include "SlotMap.h"
+#include "WaveGenerator.h"
+#include "FrameCapture.h"
+#include "LevelScript.h"
+
+// Folder the fonts, textures, music, data and terrain are loaded from, it can be changed from the command line with --assets <directory>
+// IMPORTANT NOTE: AN ABSOLUTE DIRECTORY HAD TO BE USED FOR THE ASSETS, REPLACE WITH YOUR OWN IF RUNNING FROM VISUAL STUDIO
+std::string assetDirectory = "C:/Users/kwood/source/Repos/3rdYEAR_GAME/practical_1/";
+
+// Returns the full path of a file in the asset folder
+std::string assetPath(const char* file) {
+    return assetDirectory + file;
+}
 
 // Initialization of global variables so they can be accessed throughout the game, such as coinCount, which needs to be displayed across all the UIs
 sf::Font font;
 sf::Text gameOverText;
 sf::Text victoryGameText;
 class Enemy;
-int coinCount = 0;
+std::atomic<int> coinCount(0);  // Atomic because the simulation thread adds coins while the main thread draws them
+
+// Arena for anything that only lives for one frame, such as the health bar labels, it is reset at the start of every frame
+FrameArena frameArena(64 * 1024);
+
+// Every bullet pattern the enemies can fire, by name
+BulletPatternLibrary bulletPatterns;
+
+// The text and shapes for one health bar, kept between frames so the HUD doesn't create new objects (and allocate) every frame
+struct HealthBarWidget {
+    sf::Text label;
+    std::string labelText;  // Copy of the label so it is only set on the sf::Text when it changes
+    sf::RectangleShape background;
+    sf::RectangleShape bar;
+};
+std::vector<HealthBarWidget> healthBarWidgets;
 
 
 
-// Method to render the health bar, with a parameters of the window, position, label, health and maxHealth so the healthbar percentage can be calculated and displayed
-void renderHealthBar(sf::RenderWindow& window, const sf::Vector2f& position, const std::string& label, int health, int maxHealth) {
+// Method to render the health bar, with a parameters of the window, the slot (which bar on the HUD this is), position, label, health and maxHealth so the healthbar percentage can be calculated and displayed
+void renderHealthBar(sf::RenderTarget& window, std::size_t slot, const sf::Vector2f& position, const char* label, int health, int maxHealth) {
+    // The widgets are made the first time each slot is used and then reused
+    if (slot >= healthBarWidgets.size()) {
+        healthBarWidgets.resize(slot + 1);
+    }
+    HealthBarWidget& widget = healthBarWidgets[slot];
+
     // Label for the health bar, such as for enemy, player
-    sf::Text healthLabel;
-    healthLabel.setFont(font);
-    healthLabel.setString(label);
-    healthLabel.setCharacterSize(24);
-    healthLabel.setFillColor(sf::Color::White);
-    healthLabel.setPosition(position.x, position.y);
+    if (widget.labelText.compare(label) != 0) {
+        widget.labelText = label;
+        widget.label.setFont(font);
+        widget.label.setString(label);
+        widget.label.setCharacterSize(24);
+        widget.label.setFillColor(sf::Color::White);
+    }
+    widget.label.setPosition(position.x, position.y);
 
     // Health bar background (black bar)
-    sf::RectangleShape healthBarBackground(sf::Vector2f(200.f, 20.f));
-    healthBarBackground.setPosition(position.x, position.y + 30.f);  // Slightly below the label
-    healthBarBackground.setFillColor(sf::Color::Black);
+    widget.background.setSize(sf::Vector2f(200.f, 20.f));
+    widget.background.setPosition(position.x, position.y + 30.f);  // Slightly below the label
+    widget.background.setFillColor(sf::Color::Black);
 
     // Health bar (green bar)
-    sf::RectangleShape healthBar(sf::Vector2f(200.f * (static_cast<float>(health) / maxHealth), 20.f));
-    healthBar.setPosition(position.x, position.y + 30.f);
-    healthBar.setFillColor(sf::Color::Green);
+    float fraction = maxHealth > 0 ? static_cast<float>(health) / maxHealth : 0.f;
+    widget.bar.setSize(sf::Vector2f(200.f * fraction, 20.f));
+    widget.bar.setPosition(position.x, position.y + 30.f);
+    widget.bar.setFillColor(sf::Color::Green);
 
 
 
     // Draw the label, background, and health bar
-    window.draw(healthLabel);
-    window.draw(healthBarBackground);
-    window.draw(healthBar);
+    window.draw(widget.label);
+    window.draw(widget.background);
+    window.draw(widget.bar);
 }
 
 
@@ -62,7 +125,7 @@ public:
     }
 
     // method so the button can be render alongside the label
-    void render(sf::RenderWindow& window) {
+    void render(sf::RenderTarget& window) {
         window.draw(button);
         window.draw(label);
     }
@@ -78,81 +141,9 @@ private:
     sf::Text label;
 };
 
-// Bullet class for the players bullets, storing variables shape, velocity, integer variable damage and a float variable speed
-class Bullet {
-
-
-public:
-
-    sf::RectangleShape shape;
-    sf::Vector2f velocity;
-    int damage;
-    float speed;
-
-    Bullet(float x, float y, float speed, sf::Color color, int damage) // Constructor for the bullet class so we can instantiate it with all the relevant variables of the bullet to be used throughout the game
-        : speed(speed), damage(damage) {
-        shape.setSize(sf::Vector2f(20.f, 5.f));  // Bullet size
-        shape.setFillColor(color); // sets the bullets colour to the defined color in the constructor
-        shape.setPosition(x, y); // Sets the position of the bullet
-    }
-
-    // Method to update the bullet and move it towards the right
-    void update() {
-        shape.move(speed, 0.f);  // Shoot bullets to the right of the screen
-    }
-
-    // Boolean variable to track if the player's bullets have exited the screen
-    bool isOutOfBounds(int windowWidth) const {
-        return shape.getPosition().x > windowWidth;  // Bullet is off the screen (right side)
-    }
-
-    // Render method so we can draw each bullet
-    void render(sf::RenderWindow& window) {
-        window.draw(shape);  // Draw the bullet on the screen
-    }
-
-    // Boolean variable to track the collision between the bullet and enemies
-    bool checkCollision(const sf::RectangleShape& targetShape) const {
-        return shape.getGlobalBounds().intersects(targetShape.getGlobalBounds());
-    }
-
-    sf::RectangleShape getShape() const {
-        return shape;
-    }
-
-    // Definition of the equality operator to allow std::remove to work for the removal of each bullet that exits the right side of the screen
-    bool operator==(const Bullet& other) const {
-        return shape.getPosition() == other.shape.getPosition() && speed == other.speed;
-    }
-
-    // Set bullet's velocity
-    void setVelocity(const sf::Vector2f& direction) {
-        velocity = direction * speed;
-    }
-
-    // Integer method that returns the damage inflicted by the bullet
-    int getDamage() const { return damage; }
-
-public:
-    sf::Vector2f position;
-    sf::Vector2f direction;  // Bullet's movement direction
-};
-
-// Enemy bullet class for each enemy that fires bullets, inherited from the bullet class, so the direction of the enemy bullet fires to the left of the screen
-class enemyBullet : public Bullet {
-public:
-    // Constructor: Initialize with position, speed, color, and damage
-    enemyBullet(float x, float y, float speed, sf::Color color, int damage)
-        : Bullet(x, y, speed, color, damage) {
-        // Set the bullet to move left by setting the direction to -1.x (negative X direction)
-        setVelocity(sf::Vector2f(-1.f, 0.f));  // Move left
-    }
+// Size of the player's bullets, they are kept in a ProjectileStorage like the enemy bullets but are long and thin and yellow
+const sf::Vector2f playerBulletSize(20.f, 5.f);
 
-    // Override the update method to move the bullet according to the new direction
-    void update() {
-        shape.move(velocity);  // Move the bullet in the direction defined by velocity
-    }
-};
 // Entity class to be used for the player and enemy classes from which they inherit
 class Entity {
 public:
@@ -195,9 +186,11 @@ public:
 // Definition of the player class
 class Player : public Entity {
 public:
-    float speed;  // Player movement speed
-    sf::Clock fireCooldownClock;  // Timer for firing cooldown
+    float speed;  // Player movement speed in pixels per second
+    float fireCooldownRemaining = 0.1f;  // Seconds of simulation until the player can fire again, counted in ticks rather than wall clock time
     float fireCooldownTime = 0.1f;  //Float var Cooldown time between shots (in seconds) to control how fast the player can shoot
+    float bulletSpeed = 1200.f;  // Pixels per second
+    int bulletDamage = 5;
 
     enum Direction {
         NONE,
@@ -221,56 +214,67 @@ public:
         position = sf::Vector2f(100.f, 100.f);  // Reset to a starting position
         shape.setPosition(position);  // Update the shape's position
         currentDirection = NONE;  // Reset direction to NONE
-        fireCooldownClock.restart();  // Reset cooldown clock
+        fireCooldownRemaining = fireCooldownTime;  // Reset cooldown timer
     }
 
-    // Method to handle player movement based on keyboard input wasd
-    void updateMovement() {
+    // Method to handle player movement based on the wasd input, scaled by the frame time so the speed doesn't depend on the frame rate
+    void updateMovement(const PlayerInput& input, float deltaTime) {
         // Check for key presses and update the currentDirection var
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) {
+        if (input.up) {
             currentDirection = UP;
         }
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) {
+        else if (input.down) {
             currentDirection = DOWN;
         }
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) {
+        else if (input.left) {
             currentDirection = LEFT;
         }
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) {
+        else if (input.right) {
             currentDirection = RIGHT;
         }
 
         // Move the player based on the currentDirection
+        float distance = speed * deltaTime;
         switch (currentDirection) {
         case UP:
-            shape.move(0.f, -speed);  // Move up
+            shape.move(0.f, -distance);  // Move up
             break;
         case DOWN:
-            shape.move(0.f, speed);   // Move down
+            shape.move(0.f, distance);   // Move down
             break;
         case LEFT:
-            shape.move(-speed, 0.f);  // Move left
+            shape.move(-distance, 0.f);  // Move left
             break;
         case RIGHT:
-            shape.move(speed, 0.f);   // Move right
+            shape.move(distance, 0.f);   // Move right
             break;
         default:
             break;  // Do nothing if no key is pressed
         }
     }
 
-    // Method to handle shooting for the player
-    void updateShooting(std::vector<Bullet>& bullets) {
+    // Method to stop the player leaving the world, clamping the box so it stays fully inside the bounds
+    void keepInsideWorld(const sf::FloatRect& worldBounds) {
+        sf::Vector2f clamped = shape.getPosition();
+        clamped.x = std::max(worldBounds.left, std::min(clamped.x, worldBounds.left + worldBounds.width - shape.getSize().x));
+        clamped.y = std::max(worldBounds.top, std::min(clamped.y, worldBounds.top + worldBounds.height - shape.getSize().y));
+        shape.setPosition(clamped);
+    }
+
+    // Method to handle shooting for the player, the cooldown counts down by the tick length so it is the same however fast the level is ticked
+    void updateShooting(ProjectileStorage& bullets, const PlayerInput& input, float deltaTime) {
+        fireCooldownRemaining = std::max(0.f, fireCooldownRemaining - deltaTime);
+
         // Only shoot if space is pressed and the cooldown is over
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space)) {
+        if (input.fire) {
             // Only fire if enough time has passed since the last shot
-            if (fireCooldownClock.getElapsedTime().asSeconds() >= fireCooldownTime) {
+            if (fireCooldownRemaining <= 0.f) {
                 float spawnX = shape.getPosition().x + shape.getSize().x;  // Right side of the red box
-                float spawnY = shape.getPosition().y + shape.getSize().y / 2.f - 2.5f;  // Center height of red box
+                float spawnY = shape.getPosition().y + shape.getSize().y / 2.f;  // Center height of red box
 
-                // Create a bullet and push it to the bullets vector
-                bullets.push_back(Bullet(spawnX, spawnY, 15.f, sf::Color::Yellow, 5));  // Bullet speed: 15.f, damage: 10
-                fireCooldownClock.restart();  // Restart the cooldown timer after firing to ensure consistent firing
+                // Add a bullet flying right from just in front of the player, it goes into storage reserved up front so firing doesn't allocate
+                bullets.push(spawnX + bullets.getProjectileSize().x / 2.f, spawnY, 1.f, 0.f, bulletSpeed, bulletDamage);  // Speed and damage come from the tuning data
+                fireCooldownRemaining = fireCooldownTime;  // Restart the cooldown timer after firing to ensure consistent firing
             }
         }
     }
@@ -299,7 +303,7 @@ public:
         Entity::takeDamage(amount);  // Call the base class takeDamage
 
         if (health == 0) {
-            std::cout << "Player is dead!" << std::endl;  // Output to the console to confirm the player is dead if their health is equal to 0
+            LOG_INFO("Player is dead!");  // Output to the console to confirm the player is dead if their health is equal to 0
         }
     }
 
@@ -316,23 +320,29 @@ public:
     }
 
     // Render coins in the top-right corner
-    void renderCoins(sf::RenderWindow& window, sf::Texture& coinTexture, sf::Font& font) {
+    void renderCoins(sf::RenderTarget& window, sf::Texture& coinTexture, sf::Font& font) {
         // Coin sprite
-        sf::Sprite coinSprite;
         coinSprite.setTexture(coinTexture);
         coinSprite.setPosition(window.getSize().x - 100.f, 20.f);  // Position it in the top-right corner
         window.draw(coinSprite);
 
-        // Coin amount
-        sf::Text coinText;
+        // Coin amount, the string is only rebuilt when the number of coins changes
+        if (displayedCoinCount != coinCount) {
+            displayedCoinCount = coinCount;
+            coinText.setString(std::to_string(coinCount));
+        }
         coinText.setFont(font);
-        coinText.setString(std::to_string(coinCount));
         coinText.setCharacterSize(30);
         coinText.setFillColor(sf::Color::Yellow);
         coinText.setPosition(window.getSize().x - 50.f, 20.f);  // Position next to coin image
         window.draw(coinText);
     }
 
+    // The coin sprite and text are kept between frames so drawing them doesn't allocate
+    sf::Sprite coinSprite;
+    sf::Text coinText;
+    int displayedCoinCount = -1;
+
 };
 
 
@@ -342,14 +352,29 @@ public:
 
     int health;
     float speed;
-    sf::Clock shootCooldownClock;
-    float shootCooldownTime = 0.2f;
-    sf::Vector2f shootDirection;  // Direction of the bullet when shootin
+    const BulletPattern* bulletPattern;  // What the enemy fires, every enemy starts with a single straight shot
+    float shootTimer;    // Seconds until the enemy can fire again
+    float patternPhase;  // How far a rotating pattern has turned
     float speedFactor;  // Factor to make the enemy slower than the player
+    float fireRate = 1.f;  // How many times as often as its pattern's cooldown the enemy fires
 
     // Constructor for Enemy, which calls the base Entity constructor
     Enemy(float x, float y, sf::Color color, float width, float height, int health, float speedFactor)
-        : Entity(x, y, color, width, height, health), speed(speed), speedFactor(speedFactor) {
+        : Entity(x, y, color, width, height, health), speed(speed), bulletPattern(bulletPatterns.find("straight")),
+        shootTimer(bulletPattern->getCooldown()), patternPhase(0.f), speedFactor(speedFactor) {
+    }
+
+    // Method to change the bullet pattern the enemy fires, the pattern is looked up by name and left alone if there isn't one
+    void setBulletPattern(const std::string& name) {
+        if (const BulletPattern* pattern = bulletPatterns.find(name)) {
+            bulletPattern = pattern;
+        }
+    }
+
+    // Method to make the enemy fire faster (or slower) than its pattern's cooldown, the next volley is brought forward to match
+    void setFireRate(float rate) {
+        fireRate = std::max(0.01f, rate);
+        shootTimer = std::min(shootTimer, bulletPattern->getCooldown() / fireRate);
     }
 
    
@@ -359,7 +384,7 @@ public:
         Entity::takeDamage(damage);  // Call base class takeDamage
 
         if (!isAlive()) {
-            std::cout << "Enemy destroyed!" << std::endl; // Output to the console to confirm the enemy is destroyed if they are notAlive
+            LOG_INFO("Enemy destroyed!"); // Output to the console to confirm the enemy is destroyed if they are notAlive
         }
     }
 
@@ -368,69 +393,208 @@ public:
         return getHealth() > 0;  // Assumes `getHealth()` is correctly implemented in the base class
     }
 
-    // Method to update the enemy's movement (towards the player)
-    void moveTowardsPlayer(const sf::Vector2f& playerPosition, float playerSpeed, const std::vector<Enemy>& enemies) {
+    // Method to update the enemy's movement (towards the player), scaled by the frame time
+    // The way to go is looked up in the flow field so the enemy goes around the terrain, only once it is in the player's cell does it head straight for them
+    void moveTowardsPlayer(const FlowField& flowField, const sf::Vector2f& playerPosition, float playerSpeed, const SlotMap<Enemy>& enemies, float deltaTime) {
         // Update the speed of the enemy to match the player's speed
         speed = playerSpeed * speedFactor;
 
-        // Calculate direction vector towards the player
-        sf::Vector2f direction = playerPosition - shape.getPosition();
-        float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        sf::Vector2f direction = flowField.sample(shape.getPosition() + shape.getSize() / 2.f);
+        float length = 1.f;
+        if (direction.x == 0.f && direction.y == 0.f) {
+            // Calculate direction vector towards the player
+            direction = playerPosition - shape.getPosition();
+            length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        }
 
         if (length != 0) {
             direction /= length;  // Normalize direction vector
-            sf::Vector2f newPosition = shape.getPosition() + direction * speed;  // Calculate the new position
+            sf::Vector2f newPosition = shape.getPosition() + direction * speed * deltaTime;  // Calculate the new position
 
             // Check if the new position causes an overlap with any other enemy
             if (!isOverlapping(newPosition, enemies)) {
-                shape.move(direction * speed);  // Only move if no overlap between enemies
+                shape.setPosition(newPosition);  // Only move if no overlap between enemies
             }
         }
     }
 
     // Check if this enemy's new position will overlap with any other enemy
-    bool isOverlapping(const sf::Vector2f& newPosition, const std::vector<Enemy>& enemies) {
-        // Create a temporary shape for the enemy's new position
-        sf::RectangleShape tempShape = shape;
-        tempShape.setPosition(newPosition);
+    bool isOverlapping(const sf::Vector2f& newPosition, const SlotMap<Enemy>& enemies) {
+        // Work out the bounds at the new position directly rather than copying the shape, which would allocate every frame
+        sf::FloatRect newBounds(newPosition, shape.getSize());
 
         // Check for overlap with other enemies
         for (const auto& enemy : enemies) {
-            if (&enemy != this && tempShape.getGlobalBounds().intersects(enemy.shape.getGlobalBounds())) {
+            if (&enemy != this && newBounds.intersects(enemy.shape.getGlobalBounds())) {
                 return true;  // Return true if there's an overlap
             }
         }
         return false;  // No overlap detected
     }
 
-    // Method for shooting at the player
-    void shootAtPlayer(const sf::Vector2f& playerPosition, std::vector<enemyBullet>& enemyBullets) {
-        if (shootCooldownClock.getElapsedTime().asSeconds() >= shootCooldownTime) {
-            // Calculate the direction of the bullet towards the player
-            sf::Vector2f bulletDirection(1.f, 0.f);
+    // Method for shooting at the player, each time the cooldown runs out the enemy fires one volley of its bullet pattern
+    void shootAtPlayer(const sf::Vector2f& playerPosition, ProjectileStorage& enemyBullets, float deltaTime) {
+        shootTimer -= deltaTime;
+        if (shootTimer <= 0.f) {
+            // Fire from the middle of the enemy
+            float spawnX = shape.getPosition().x + shape.getSize().x / 2.f;  // Middle of the enemy
+            float spawnY = shape.getPosition().y + shape.getSize().y / 2.f;  // Center height of the enemy
 
-            
-    
+            // Calculate the direction towards the player for the patterns that aim
+            float aimAngle = std::atan2(playerPosition.y - spawnY, playerPosition.x - spawnX);
+
+            // The whole volley is added to the enemy bullets in one batch
+            bulletPattern->fire(enemyBullets, spawnX, spawnY, aimAngle, patternPhase);
 
-                // Create a bullet and add it to the vector of bullets
-                float spawnX = shape.getPosition().x + shape.getSize().x / 2.f;  // Middle of the enemy
-                float spawnY = shape.getPosition().y + shape.getSize().y / 2.f;  // Center height of the enemy
+            // Reset the shoot cooldown timer
+            shootTimer = bulletPattern->getCooldown() / fireRate;
+        }
+    }
 
-                enemyBullets.push_back(enemyBullet(spawnX, spawnY, 10.f, sf::Color::Red, 5));  // Create bullet with damage 10
+};
 
-                // Reset the shoot cooldown timer
-                shootCooldownClock.restart();
-            
+
+// Method to add the enemies for level 10, this is also used by the render check so it draws the real level
+void spawnLevel10Enemies(SlotMap<Enemy>& enemies, EnemySwarm& swarm) {
+    enemies.insert(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); // Enemies with damage 1.f
+    enemies.insert(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+
+    enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+    SlotHandle waveEnemy = enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 2.f));
+
+    SlotHandle ringEnemy = enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+
+    // A pack of chasers and kamikazes coming from the right, with a spiral shooter behind them
+    for (int i = 0; i < 6; ++i) {
+        swarm.spawn<Chaser>(2400.f + i * 60.f, 150.f + i * 120.f, i * 0.3f);
+    }
+    for (int i = 0; i < 3; ++i) {
+        swarm.spawn<Kamikaze>(3000.f, 250.f + i * 250.f);
+    }
+    swarm.spawn<Spiral>(2000.f, 450.f);
+
+    // The last two enemies fire patterns instead of straight shots
+    enemies.get(waveEnemy)->setBulletPattern("wave");
+    enemies.get(ringEnemy)->setBulletPattern("ring");
+}
+
+// Method to replace the level's enemies with the ones built into the game for that level, used when the data files don't lay the level out
+void spawnBuiltInLevel(int level, SlotMap<Enemy>& enemies, EnemySwarm& swarm) {
+    enemies.clear();
+    swarm.clear();
+    switch (level) {
+    case 1:
+        enemies.insert(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 0.5f));
+        enemies.insert(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 0.5f));
+        break;
+    case 2:
+        enemies.insert(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        break;
+    case 3:
+        enemies.insert(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        break;
+    case 4:
+        enemies.insert(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        break;
+    case 5:
+    case 6:
+    case 7:
+    case 8:
+    case 9:
+        // Levels 5 to 9 share their enemies, one of them twice as fast as the rest
+        enemies.insert(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+        enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 2.f));
+        enemies.insert(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
+
+        // Strafers and a turret for level 6
+        if (level == 6) {
+            swarm.spawn<Strafer>(1800.f, 200.f, 0.f);
+            swarm.spawn<Strafer>(1800.f, 700.f, 3.14f);
+            swarm.spawn<Turret>(1400.f, 800.f);
+        }
+        break;
+    case 10:
+        spawnLevel10Enemies(enemies, swarm);
+        break;
+    }
+}
+
+// What the level scripts can see and change, they are resumed in the middle of the level's tick so these are the level's own objects
+struct LevelScriptContext {
+    SlotMap<Enemy>& enemies;
+    EnemySwarm& swarm;
+    Player& player;
+};
+
+// Signals the level raises for its scripts to wait on
+enum LevelSignal {
+    LevelCleared = 0  // Raised every tick there are no enemies left
+};
+
+// Level 10's finale, once the first enemies are cleared (or they have held out for 40 seconds) a boss comes in, and while it is alive
+// it is joined by a pack of chasers every 8 seconds. The level isn't won until the script has finished and everything is dead
+class Level10FinaleScript : public Script<LevelScriptContext> {
+public:
+    Wait resume(LevelScriptContext& level) override {
+        SCRIPT_BEGIN;
+        SCRIPT_AWAIT(waitForSignal(LevelCleared, 40.0));
+
+        boss = level.enemies.insert(Enemy(2800.f, 500.f, sf::Color::Magenta, 120.f, 120.f, 400, 0.6f));
+        level.enemies.get(boss)->setBulletPattern("bossRing");
+        LOG_INFO("Level 10 boss has arrived");
+
+        // Stops waiting as soon as the level is cleared, so the level ends when the boss dies rather than at the next escort
+        while (level.enemies.contains(boss)) {
+            SCRIPT_AWAIT(waitForSignal(LevelCleared, 8.0));
+            if (const Enemy* enemy = level.enemies.get(boss)) {
+                for (int i = 0; i < 4; ++i) {
+                    level.swarm.spawn<Chaser>(enemy->shape.getPosition().x + 140.f, enemy->shape.getPosition().y - 150.f + i * 100.f, i * 0.5f);
+                }
+            }
         }
+        SCRIPT_END;
     }
 
+private:
+    SlotHandle boss;  // Kept in the script since nothing on the stack survives a wait
 };
 
+// Method to start the scripts for a level, any scripts left from the last level are stopped first
+void startLevelScripts(int level, ScriptScheduler<LevelScriptContext>& scripts) {
+    scripts.clear();
+    if (level == 10) {
+        scripts.start(std::unique_ptr<Script<LevelScriptContext>>(new Level10FinaleScript()));
+    }
+}
+
+// Method to run a level's scripts after the level has been updated, on the same simulation time
+void runLevelScripts(ScriptScheduler<LevelScriptContext>& scripts, Player& player, SlotMap<Enemy>& enemies, EnemySwarm& swarm, float deltaTime) {
+    if (scripts.size() == 0) {
+        return;
+    }
+    if (enemies.size() + swarm.size() == 0) {
+        scripts.raise(LevelCleared);
+    }
+    LevelScriptContext context = { enemies, swarm, player };
+    scripts.update(context, deltaTime);
+}
+
 
 // Function to initialize font and text
 void initializeGameOverText() {
-    if (!font.loadFromFile("C:/Users/kwood/source/Repos/3rdYEAR_GAME/practical_1/robot.ttf")) {
-        std::cerr << "Error loading font!" << std::endl;
+    if (!font.loadFromFile(assetPath("robot.ttf"))) {
+        LOG_ERROR("Error loading font!");
     }
 
     gameOverText.setFont(font);
@@ -442,8 +606,8 @@ void initializeGameOverText() {
 
 // Method to initialize the text displayed when the player wins a level
 void initializeVictoryText() {
-    if (!font.loadFromFile("C:/Users/kwood/source/Repos/3rdYEAR_GAME/practical_1/robot.ttf")) {
-        std::cerr << "Error loading font!" << std::endl;
+    if (!font.loadFromFile(assetPath("robot.ttf"))) {
+        LOG_ERROR("Error loading font!");
     }
 
     victoryGameText.setFont(font);
@@ -517,9 +681,36 @@ void renderMainMenu(sf::RenderWindow& window, Button& startButton, Button& setti
     window.display();  // Update the display after rendering the main menu
 }
 
+// Method to draw the level choice menu, with the numbers for levels 1 to 10 in a box and the back button underneath
+void renderLevelSelect(sf::RenderTarget& window, Button& backButton, Player& player, sf::Texture& coinTexture, sf::Font& font, int width, int height) {
+    // Formatting the level choice menu
+    sf::RectangleShape levelBox(sf::Vector2f(1100.f, 333.f));
+    levelBox.setPosition((width - levelBox.getSize().x) / 2, (height - levelBox.getSize().y) / 2);
+    levelBox.setFillColor(sf::Color(0, 0, 255));
+    player.renderCoins(window, coinTexture, font);
+
+    // Draws the box where all of the levels through 1 to 10 are displayed
+    window.draw(levelBox);
+
+    // Display level numbers (1 to 10) horizontally
+    float levelSpacing = 100.f;
+    for (int i = 1; i <= 10; ++i) {
+        sf::Text levelText;
+        levelText.setFont(font);
+        levelText.setString(std::to_string(i));
+        levelText.setCharacterSize(50);
+        levelText.setFillColor(sf::Color::White);
+        levelText.setPosition((width - 1000.f) / 2 + levelSpacing * (i - 1), height / 2);
+
+        window.draw(levelText);
+    }
+
+    backButton.render(window);
+}
+
 // resetGameState method so we can reset all of the values of the game upon completion or faikure of a level
 void resetGameState(bool&level1Started, bool&levelWon, Player& player,
-    std::vector<Enemy>& enemies, std::vector<Bullet>& bullets, std::vector<enemyBullet>& enemyBullets) {
+    SlotMap<Enemy>& enemies, EnemySwarm& swarm, ProjectileStorage& bullets, ProjectileStorage& enemyBullets) {
     
     // Ensure you stop the game and go to the main menu with all game variables being reset
     level1Started = false;  // Stops the current level
@@ -527,221 +718,1295 @@ void resetGameState(bool&level1Started, bool&levelWon, Player& player,
 
     player.reset();  // Reset player state (e.g., health, position)
     enemies.clear(); // Clear any existing enemies
+    swarm.clear();
     bullets.clear(); // Clear bullets
     enemyBullets.clear(); // Clear enemy bullets
 }
 
-int main() {
-    // setting the integer variables for the screen width and the screen height
-    int width = 1920;
-    int height = 900;
+// Method to run one tick of whichever level is running, updating the player, enemies and bullets
+// This only touches the level's own objects and the terrain's collision, so it can run on the simulation thread or without a window
+void updateLevel(const PlayerInput& input, Player& player, SlotMap<Enemy>& enemies, EnemySwarm& swarm, ProjectileStorage& bullets,
+    ProjectileStorage& enemyBullets, const TileCollision& tileMap, FlowField& flowField, GameAudio& audio, const sf::FloatRect& worldBounds, float deltaTime) {
 
-    // Initalisation of 20 boolean variables which will track where the game state currently is so as to ensure a smooth transition between game menus
-    bool level1Won = false;
-    bool level2Won = false;
-    bool level3Won = false;
-    bool level4Won = false;
-    bool level5Won = false;
-    bool level6Won = false;
-    bool level7Won = false;
-    bool level8Won = false;
-    bool level9Won = false;
-    bool level10Won = false;
-    
-    bool level1Started = false;
-    bool level2Started = false;
-    bool level3Started = false;
-    bool level4Started = false;
-    bool level5Started = false;
-    bool level6Started = false;
-    bool level7Started = false;
-    bool level8Started = false;
-    bool level9Started = false;
-    bool level10Started = false;
+    // Update player bullets and remove the ones that have left the world or hit the terrain
+    bullets.update(deltaTime);
+    bullets.hitWorld(worldBounds, tileMap);
+    bullets.removeHit();
 
-    // Calling upon the sf RenderWindow method and setting the resolution to 1920x1080
-    sf::RenderWindow window(sf::VideoMode({ 1920, 1080 }), "Warfare In Sky");
-    bool isFullScreen = true; // tracking variable to track if we are in fullscreen or not (for the settings menu)
-    
+    // Update enemy bullets and mark the ones that have left the world or hit the terrain, they are removed once the player has been checked
+    enemyBullets.update(deltaTime);
+    enemyBullets.hitWorld(worldBounds, tileMap);
 
-    // Load the coin image from the file
-    // IMPORTANT NOTE: AN ABSOLUTE DIRECTORY HAD TO BE USED FOR THIS, REPLACE WITH YOUR OWN IF RUNNING FROM VISUAL STUDIO
-    sf::Texture coinTexture;
-    if (!coinTexture.loadFromFile("C:/Users/kwood/source/Repos/3rdYEAR_GAME/practical_1/key.png")) {
-        std::cerr << "Error loading coin image!" << std::endl;
-        return -1;
+    // Handle player and enemy updates here movement, collision detection
+
+
+    sf::Vector2f previousPosition = player.getPosition();
+    player.updateMovement(input, deltaTime);
+    player.keepInsideWorld(worldBounds);  // Stop the player flying off the edge of the world
+
+    // Put the player back where they were if they flew into the terrain
+    if (tileMap.overlapsSolid(player.shape.getGlobalBounds())) {
+        player.shape.setPosition(previousPosition);
+    }
+    std::size_t playerBulletCount = bullets.size();
+    player.updateShooting(bullets, input, deltaTime);  // This handles shooting and firing cooldown
+    if (bullets.size() > playerBulletCount) {
+        audio.play(SoundEffect::PlayerShot);
     }
 
-    // Load the font to be used
-    if (!font.loadFromFile("C:/Users/kwood/source/Repos/3rdYEAR_GAME/practical_1/robot.ttf")) {
-        std::cerr << "Error loading font!" << std::endl;
-        return -1;
+
+
+    // Check for collisions between enemy bullets and player, along the whole path each bullet moved this frame
+    int bulletDamage = enemyBullets.hitTarget(player.shape.getGlobalBounds());
+    if (bulletDamage > 0) {
+        player.takeDamage(bulletDamage);  // Player takes damage from enemy bullets
+        audio.play(SoundEffect::Hit, 0.8f);
     }
+    enemyBullets.removeHit();  // Remove every enemy bullet that hit the player or the world
+
+    // Check for collisions between player bullets and enemies, along the whole path each bullet moved this frame
+    const sf::Vector2f bulletSize = bullets.getProjectileSize();
+    for (std::size_t i = 0; i < bullets.size(); ++i) {
+        sf::FloatRect start(bullets.previousX[i], bullets.previousY[i], bulletSize.x, bulletSize.y);
+        sf::Vector2f displacement(bullets.x[i] - bullets.previousX[i], bullets.y[i] - bullets.previousY[i]);
+
+        // If the bullet's path crosses more than one enemy, the one it reaches first takes the hit
+        Enemy* hitEnemy = nullptr;
+        float earliestHit = 2.f;
+        for (auto& enemy : enemies) {
+            float hitTime;
+            if (sweptRectIntersects(start, displacement, enemy.shape.getGlobalBounds(), hitTime) && hitTime < earliestHit) {
+                earliestHit = hitTime;
+                hitEnemy = &enemy;
+            }
+        }
 
-    // Load the background image texture
-    // IMPORTANT NOTE: I had to use an absolute directory to load the background images as it would not work any other way, so replace my username with your own otherwise this won't work
-    sf::Texture backgroundTexture;
-    if (!backgroundTexture.loadFromFile("C:/Users/kwood/source/Repos/3rdYEAR_GAME/practical_1/pixelated-sky-2.jpg")) {
-        std::cerr << "Error loading background image!" << std::endl;
-        return -1;
+        // The swarm enemies are checked against the same path, if one of them is reached sooner it takes the hit instead
+        int* hitSwarmHealth = swarm.findSweptHit(start, displacement, earliestHit);
+
+        if (hitSwarmHealth != nullptr) {
+            *hitSwarmHealth -= bullets.damage[i];
+        }
+        else if (hitEnemy != nullptr) {
+            hitEnemy->takeDamage(bullets.damage[i]);  // Enemy takes damage from player bullet
+        }
+        if (hitSwarmHealth != nullptr || hitEnemy != nullptr) {
+            audio.play(SoundEffect::Hit);
+            bullets.hit[i] = 1;  // Removed once every bullet has been checked
+        }
+    }
+    bullets.removeHit();
+
+    // Remove the dead enemies, the last enemy is moved into each gap so nothing after it has to shift
+    std::size_t enemiesKilled = enemies.eraseIf([](const Enemy& enemy) {
+        return !enemy.isAlive();
+    });
+    for (std::size_t killed = enemiesKilled; killed > 0; --killed) {
+        player.addCoin();  // Add 1 coin when an enemy is destroyed
+    }
+    if (enemiesKilled > 0) {
+        audio.play(SoundEffect::Explosion);
     }
 
-    // a text button to toggle fullscreen
-    sf::Text fullscreenText;
-    fullscreenText.setFont(font);
-    fullscreenText.setString("Toggle Fullscreen (F)");
-    fullscreenText.setCharacterSize(30);
-    fullscreenText.setFillColor(sf::Color::White);
-    fullscreenText.setPosition(300, 200);  // Position for fullscreen toggle text
+    // Add 1 coin for every swarm enemy destroyed as well
+    std::size_t swarmKilled = swarm.removeDead();
+    for (std::size_t killed = swarmKilled; killed > 0; --killed) {
+        player.addCoin();
+    }
+    if (swarmKilled > 0) {
+        audio.play(SoundEffect::Explosion);
+    }
 
-    //  a text button to switch to windowed mode
-    sf::Text windowedModeText;
-    windowedModeText.setFont(font);
-    windowedModeText.setString("Windowed Mode (800x600)");
-    windowedModeText.setCharacterSize(30);
-    windowedModeText.setFillColor(sf::Color::White);
-    windowedModeText.setPosition(300, 250);  // Position for windowed mode text
 
+    // Reset coins if the player dies
+    if (!player.isAlive()) {
+        player.resetCoins();  // Reset the coin count on player death
+    }
 
-    // Create the sprites for the background cloud image animation
-    sf::Sprite backgroundSprite1;
-    sf::Sprite backgroundSprite2;
 
-    // Setting the background images to the same image
-    backgroundSprite1.setTexture(backgroundTexture);
-    backgroundSprite2.setTexture(backgroundTexture);
+    // Point the flow field at the player, this only searches again when the player has moved into another cell
+    flowField.update(player.getPosition() + player.shape.getSize() / 2.f, tileMap, worldBounds);
 
-    // Set the initial position of both sprites
-    backgroundSprite1.setPosition(0.f, 0.f);
-    backgroundSprite2.setPosition(backgroundTexture.getSize().x, 0.f);
+    // Move each enemy towards the player
+    std::size_t enemyBulletCount = enemyBullets.size();
+    for (auto& enemy : enemies) {
+        enemy.moveTowardsPlayer(flowField, player.getPosition(), player.getSpeed(), enemies, deltaTime);
 
-    // Define speed for cloud movement, using floats
-    float cloudSpeed = 0.1f;
-    float cloudWidth = backgroundTexture.getSize().x;
+        enemy.shootAtPlayer(player.getPosition(), enemyBullets, deltaTime);
+    }
 
-    // Load font
-    sf::Font font;
-    if (!font.loadFromFile("C:/Users/kwood/source/Repos/3rdYEAR_GAME/practical_1/robot.ttf")) {
-        std::cerr << "Error loading font!" << std::endl;
-        return -1;
+    // Run each archetype's behaviour over the swarm, their shots go straight into the enemy bullets
+    int contactDamage = swarm.update(player.shape.getGlobalBounds(), flowField, enemyBullets, deltaTime);
+    if (contactDamage > 0) {
+        player.takeDamage(contactDamage);
+        audio.play(SoundEffect::Hit, 0.8f);
     }
 
-    // Draw background clouds
-    window.draw(backgroundSprite1);
-    window.draw(backgroundSprite2);
+    // One enemy shot sound covers every bullet fired this tick
+    if (enemyBullets.size() > enemyBulletCount) {
+        audio.play(SoundEffect::EnemyShot);
+    }
+}
 
+// Method to copy the parts of the level the renderer needs into a snapshot
+void fillSnapshot(WorldSnapshot& snapshot, const Player& player, const SlotMap<Enemy>& enemies, const EnemySwarm& swarm,
+    const ProjectileStorage& bullets, const ProjectileStorage& enemyBullets) {
+    snapshot.player = { player.shape.getPosition(), player.shape.getSize(), player.shape.getFillColor() };
+    snapshot.playerHealth = player.getHealth();
+    snapshot.playerMaxHealth = player.maxHealth;
+
+    for (std::size_t i = 0; i < enemies.size(); ++i) {
+        const Enemy& enemy = enemies[i];
+        snapshot.enemies.push_back({ enemy.shape.getPosition(), enemy.shape.getSize(), enemy.shape.getFillColor() });
+        snapshot.enemyHealth.push_back(enemy.getHealth());
+        snapshot.enemyMaxHealth.push_back(enemy.maxHealth);
+        snapshot.enemyNumbers.push_back(enemies.handleAt(i).slot + 1);  // The slot doesn't change while the enemy is alive
+    }
+    swarm.fillSnapshot(snapshot.enemies);  // Swarm enemies go after the level's own enemies and have no health bars
+    bullets.fillSnapshot(snapshot.bullets);
+    snapshot.playerBulletCount = snapshot.bullets.size();
+    enemyBullets.fillSnapshot(snapshot.bullets);
+}
 
-    // Define button sizes and positions
-    float rectWidth = 800.f;
-    float rectHeight = 200.f;
-    float spacing = 50.f;
+// Method to draw a snapshot of the level, the world through the camera and then the HUD on top
+void renderLevel(sf::RenderTarget& window, Camera& camera, TileMap& tileMap, SnapshotRenderer& snapshotRenderer, const WorldSnapshot& snapshot,
+    Player& player, sf::Texture& coinTexture, sf::Font& font, int height) {
 
-    // DefinING the position for each button for main menu based on screen settings
-    sf::Vector2f position1((width - rectWidth) / 2, (height - 3 * rectHeight - 2 * spacing) / 2);
-    sf::Vector2f position2((width - rectWidth) / 2, (height - 3 * rectHeight - 2 * spacing) / 2 + rectHeight + spacing);
-    sf::Vector2f position3((width - rectWidth) / 2, (height - 3 * rectHeight - 2 * spacing) / 2 + 2 * (rectHeight + spacing));
-    sf::Vector2f position4((width - rectWidth) / 2, (height - 4 * rectHeight - 3 * spacing) / 2 + 3 * (rectHeight + spacing) + 100.f);
+    // Move the camera to the player and draw the world through its view
+    camera.follow(snapshot.player.position + snapshot.player.size / 2.f);
+    window.setView(camera.getView());
 
-    // Initialization of each button for the main menu, with a font and a relevant label
-    Button startButton(position1, "Start Game", font);
-    Button settingsButton(position2, "Settings", font);
-    Button garageButton(position3, "Garage", font);
-    Button exitButton(position4, "Exit Game", font);
+    // Stream the terrain chunks around the camera in and out, then draw the ones on screen behind everything else
+    tileMap.update(camera.getViewBounds());
+    tileMap.render(window, camera.getViewBounds());
 
-    // Create the fullscreen button
-    Button fullscreenButton(position1, "Fullscreen off/on", font);
+    // Draw the player, enemies and bullets the camera can see in one go
+    snapshotRenderer.render(window, snapshot, camera.getViewBounds());
 
-    
-    // Button for returning to the main menu from the game
-    Button backButton(sf::Vector2f((width - rectWidth) / 2, height - rectHeight - 30.f), "Back to Main Menu", font);
+    // Switch back to the window's own view so the HUD stays fixed to the screen
+    window.setView(window.getDefaultView());
 
-    bool levelWon = false;
-    bool inGameMenu = false;
-    bool inSettingsMenu = false;
-    bool inGarageMenu = false;  // Track if we are in the garage menu
-    bool inGame = false;  // Flag to track if we're in the game (red box)
-    bool inVictoryScreen = false;
-    bool inDefeatScreen = false;
+    player.renderCoins(window, coinTexture, font);
 
+    // Define the starting position for the health bars and labels
+    sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
 
-    // Create a text object for the header
-    sf::Text headerText;
-    headerText.setFont(font);
-    headerText.setString("Warfare In Sky");
-    headerText.setCharacterSize(80);
-    headerText.setFillColor(sf::Color::Blue);
+    // Render player health bar and label
+    renderHealthBar(window, 0, healthBarPosition, "Player", snapshot.playerHealth, snapshot.playerMaxHealth);
 
-    // Center the header text
-    float headerX = (width - headerText.getLocalBounds().width) / 2;
-    headerText.setPosition(headerX, (height - 3 * rectHeight - 2 * spacing) / 2 - 100.f);
+    // Adjust the vertical spacing between enemy health bars
+    float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
 
-    // Instantiate the Player object with similar properties
-    float playerSpeed = 0.1f;
-    int playerHealth = 100;
-    Player player(width / 5.f, height / 2.f, sf::Color::Green, 50.f, 50.f, playerHealth, playerSpeed);
+    // Render health bars for each enemy dynamically
+    for (size_t i = 0; i < snapshot.enemyHealth.size(); ++i) {
+        // Adjust the vertical position for each enemy's health bar
+        // The label is formatted into the frame arena so it doesn't allocate, each enemy keeps its number when others die
+        renderHealthBar(window, i + 1,
+            sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
+            frameArena.format("Enemy %u", static_cast<unsigned>(snapshot.enemyNumbers[i])),
+            snapshot.enemyHealth[i],
+            snapshot.enemyMaxHealth[i]);
+    }
+}
 
+// Method to switch the player's tuning and the bullet patterns over to a newly loaded set of data files
+// Enemies already in the level fire the new patterns from their next volley, the level layouts are only used when a level starts.
+// The patterns were built when the files were loaded, so this is only moves and a few assignments
+void applyGameData(GameData& data, Player& player) {
+    player.speed = data.player.speed;
+    player.fireCooldownTime = data.player.fireCooldown;
+    player.bulletSpeed = data.player.bulletSpeed;
+    player.bulletDamage = data.player.bulletDamage;
+
+    for (LoadedPattern& loaded : data.patterns) {
+        bulletPatterns.add(loaded.name, std::move(loaded.pattern));
+    }
+    data.patterns.clear();
+}
 
-    // Instantiate the enemies vector which will store all the enemies inside
-    std::vector<Enemy> enemies;
-    enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 0.5f));
-    enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 0.5f));
+// Method to replace the level's enemies with the ones in a layout, from the level files or made by the wave generator
+void spawnLayout(const LevelDefinition& layout, const EnemyTuning& tuning, SlotMap<Enemy>& enemies, EnemySwarm& swarm) {
+    enemies.clear();
+    swarm.clear();
+    for (const EnemySpawn& spawn : layout.enemies) {
+        enemies.insert(Enemy(spawn.x, spawn.y, sf::Color::Red, tuning.width, tuning.height, tuning.health, spawn.speedFactor));
+        enemies.back().setBulletPattern(spawn.pattern.empty() ? tuning.pattern : spawn.pattern);
+        enemies.back().setFireRate(spawn.fireRate);
+    }
+    for (const SwarmSpawn& spawn : layout.swarm) {
+        switch (spawn.kind) {
+        case SwarmKind::Chaser:
+            swarm.spawn<Chaser>(spawn.x, spawn.y, spawn.phase);
+            break;
+        case SwarmKind::Strafer:
+            swarm.spawn<Strafer>(spawn.x, spawn.y, spawn.phase);
+            break;
+        case SwarmKind::Kamikaze:
+            swarm.spawn<Kamikaze>(spawn.x, spawn.y, spawn.phase);
+            break;
+        case SwarmKind::Turret:
+            swarm.spawn<Turret>(spawn.x, spawn.y, spawn.phase);
+            break;
+        case SwarmKind::Spiral:
+            swarm.spawn<Spiral>(spawn.x, spawn.y, spawn.phase);
+            break;
+        }
+    }
+}
 
-    // Declare a clock to track the firing cooldown
-    sf::Clock fireCooldownClock;
-    float fireCooldownTime = 0.1f;  // Time in seconds between shots, this value ensures that the player wont fire too fast
+// Method to add the enemies for a level from a set of data files, returns false and leaves the level alone if the files don't have it
+bool spawnLevelFromData(const GameData& gameData, int level, SlotMap<Enemy>& enemies, EnemySwarm& swarm) {
+    auto found = gameData.levels.find(level);
+    if (found == gameData.levels.end()) {
+        return false;
+    }
+    spawnLayout(found->second, gameData.enemy, enemies, swarm);
+    return true;
+}
 
+// What the level blocks need to know each frame to decide if their level has been won or lost
+struct LevelStatus {
+    bool playerAlive;
+    std::size_t enemiesRemaining;
+};
 
-    // initialisation of vectors enemyBullets and bullets(for the player)
-    std::vector<enemyBullet> enemyBullets;
-    std::vector<Bullet> bullets;
+// Runs whichever level is active, every level block in main goes through this
+// Normally the level is updated and drawn one after the other on the main thread. With the threaded simulation turned on the level
+// is copied to the simulation thread when it starts, ticked there at a fixed rate, and the main thread only draws the newest snapshot.
+// The copy is handed back when the level stops, so the menus and level blocks only ever see the main thread's objects
+class LevelRunner {
+public:
+    LevelRunner(bool threaded, float tickRate, GameAudio& audio, DataWatcher& dataWatcher, const SpriteAtlas& spriteAtlas)
+        : threaded(threaded), simulation(tickRate), audio(audio), dataWatcher(dataWatcher), snapshotRenderer(spriteAtlas) {
+    }
 
-    
+    // Method to pick up data files that have changed, called at the start of every frame. While the simulation thread is running it
+    // picks them up itself at the start of its next tick instead, since the patterns and its copy of the player are only its to change
+    void applyDataUpdates(Player& player) {
+        if (!simulation.isRunning()) {
+            takeDataUpdate(player);
+        }
+    }
 
-    // Call the function to initialize the "Game Over" text to prepare for displaying the gameDefeatScreen
-    initializeGameOverText();
+    // Method to add the enemies for a level from the data files, returns false and leaves the level alone if the files don't have it
+    bool spawnLevel(int level, SlotMap<Enemy>& enemies, EnemySwarm& swarm) const {
+        return gameData && spawnLevelFromData(*gameData, level, enemies, swarm);
+    }
 
-    // Calls the function intializeVictoryText() to setup the text to be displayed in victory message
-    initializeVictoryText();
+    // Method to replace the level's enemies with a generated layout, with the enemy tuning from the data files
+    void spawnWave(const LevelDefinition& layout, SlotMap<Enemy>& enemies, EnemySwarm& swarm) const {
+        spawnLayout(layout, gameData ? gameData->enemy : EnemyTuning(), enemies, swarm);
+    }
 
-    // Main game loop while the window is open
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close(); // Closes the window
-            }
+    // Method to start a level's scripts, only call this while no level is running since the scripts are then only run by whichever
+    // thread runs the simulation
+    void startScripts(int level) {
+        startLevelScripts(level, scripts);
+    }
 
-            
-            
+    // Method to hand the controls to a scripted player instead of the keyboard, or back to the keyboard with nullptr
+    // Only call this while no level is running, when threaded the autoplayer is then only used by the simulation thread
+    void setAutoPlayer(AutoPlayer* player) {
+        autoPlayer = player;
+    }
 
-            // Button click handlers for the main menu (Start Game, Settings, Garage, Exit Game)
-            if (!inGameMenu && !inSettingsMenu && !inGarageMenu) {  // Main menu
-                if (startButton.isClicked(window)) {
-                    std::cout << "Start Game button clicked!" << std::endl;
-                    inGameMenu = true;  // Switch to the game menu
-                    player.renderCoins(window, coinTexture, font); // Render the currency at the top right hand of the screen
-                }
+    // Returns how many enemies and bullets were in the last snapshot drawn
+    std::size_t getDrawnEntityCount() const {
+        return drawnEntityCount;
+    }
 
-                if (settingsButton.isClicked(window)) {
-                    std::cout << "Settings button clicked!" << std::endl;
+    // Returns true if the simulation runs on its own thread
+    bool isThreaded() const {
+        return threaded;
+    }
+
+    // Method to check whether the player is alive and how many enemies are left, dead enemies are removed here when running on the main thread
+    LevelStatus getStatus(Player& player, SlotMap<Enemy>& enemies, const EnemySwarm& swarm) {
+        if (simulation.isRunning()) {
+            simulation.updateSnapshot();
+            const WorldSnapshot& latest = simulation.getSnapshot();
+            if (latest.tick > 0) {
+                return { latest.playerHealth > 0, latest.enemies.size() + latest.scriptsRunning };
+            }
+            return { snapshot.playerHealth > 0, snapshot.enemies.size() + snapshot.scriptsRunning };  // Nothing published yet, so the level is as it started
+        }
+
+        // Remove dead enemies safely
+        enemies.eraseIf([](const Enemy& enemy) {
+            return !enemy.isAlive();  // Remove enemies that are dead
+        });
+        return { player.isAlive(), enemies.size() + swarm.size() + scripts.size() };  // A level with scripts still to run isn't over
+    }
+
+    // Method to play one frame of the level
+    void play(sf::RenderWindow& window, Camera& camera, TileMap& tileMap, Player& player, SlotMap<Enemy>& enemies, EnemySwarm& swarm,
+        ProjectileStorage& bullets, ProjectileStorage& enemyBullets, sf::Texture& coinTexture, sf::Font& font, int height, float deltaTime) {
+
+        if (!threaded) {
+            // Update the level then draw it straight away
+            PlayerInput input = readInput(player, enemies, swarm, bullets, enemyBullets, camera.getWorldBounds(), deltaTime);
+            updateLevel(input, player, enemies, swarm, bullets, enemyBullets, tileMap, flowField, audio, camera.getWorldBounds(), deltaTime);
+            runLevelScripts(scripts, player, enemies, swarm, deltaTime);
+            snapshot.clear();
+            fillSnapshot(snapshot, player, enemies, swarm, bullets, enemyBullets);
+            renderLevel(window, camera, tileMap, snapshotRenderer, snapshot, player, coinTexture, font, height);
+            drawnEntityCount = snapshot.enemies.size() + snapshot.bullets.size();
+            return;
+        }
+
+        if (!simulation.isRunning()) {
+            startSimulation(tileMap, camera.getWorldBounds(), player, enemies, swarm, bullets, enemyBullets);
+        }
+
+        // Draw the newest snapshot, until the first tick comes through draw the level as it was when it started
+        simulation.updateSnapshot();
+        const WorldSnapshot& latest = simulation.getSnapshot().tick > 0 ? simulation.getSnapshot() : snapshot;
+        renderLevel(window, camera, tileMap, snapshotRenderer, latest, player, coinTexture, font, height);
+        drawnEntityCount = latest.enemies.size() + latest.bullets.size();
+    }
+
+    // Method to stop the simulation thread when no level is running and copy the level back to the main thread's objects
+    void stop(Player& player, SlotMap<Enemy>& enemies, EnemySwarm& swarm, ProjectileStorage& bullets, ProjectileStorage& enemyBullets) {
+        if (!simulation.isRunning()) {
+            return;
+        }
+        simulation.stop();
+        player = *simulationPlayer;
+        enemies = simulationEnemies;
+        swarm = simulationSwarm;
+        bullets = simulationBullets;
+        enemyBullets = simulationEnemyBullets;
+    }
+
+private:
+    // Method to copy the level to the simulation thread and start it ticking, the keyboard is read on the simulation thread every tick
+    // so input reaches the simulation without waiting for the next frame to be drawn
+    void startSimulation(const TileMap& tileMap, const sf::FloatRect& worldBounds, const Player& player, const SlotMap<Enemy>& enemies,
+        const EnemySwarm& swarm, const ProjectileStorage& bullets, const ProjectileStorage& enemyBullets) {
+        simulationPlayer.reset(new Player(player));
+        simulationEnemies = enemies;
+        simulationSwarm = swarm;
+        simulationBullets = bullets;
+        simulationEnemyBullets = enemyBullets;
+
+        snapshot.clear();
+        snapshot.tick = 0;
+        fillSnapshot(snapshot, player, enemies, swarm, bullets, enemyBullets);
+        snapshot.scriptsRunning = scripts.size();
+
+        simulation.start([this, &tileMap, worldBounds](float tickLength, WorldSnapshot& tickSnapshot) {
+            takeDataUpdate(*simulationPlayer);  // Between two ticks, so the whole tick runs on one set of data
+            PlayerInput input = readInput(*simulationPlayer, simulationEnemies, simulationSwarm, simulationBullets, simulationEnemyBullets, worldBounds, tickLength);
+            updateLevel(input, *simulationPlayer, simulationEnemies, simulationSwarm, simulationBullets, simulationEnemyBullets,
+                tileMap, flowField, audio, worldBounds, tickLength);
+            runLevelScripts(scripts, *simulationPlayer, simulationEnemies, simulationSwarm, tickLength);
+            fillSnapshot(tickSnapshot, *simulationPlayer, simulationEnemies, simulationSwarm, simulationBullets, simulationEnemyBullets);
+            tickSnapshot.scriptsRunning = scripts.size();
+        });
+    }
+
+    // Returns the controls for this tick, from the keyboard, or from the autoplayer looking at the level the same way the renderer would
+    PlayerInput readInput(const Player& player, const SlotMap<Enemy>& enemies, const EnemySwarm& swarm, const ProjectileStorage& bullets,
+        const ProjectileStorage& enemyBullets, const sf::FloatRect& worldBounds, float deltaTime) {
+        if (autoPlayer == nullptr) {
+            return PlayerInput::fromKeyboard();
+        }
+        autoPlayerView.clear();
+        fillSnapshot(autoPlayerView, player, enemies, swarm, bullets, enemyBullets);
+        return autoPlayer->decide(autoPlayerView, worldBounds, player.getSpeed(), deltaTime);
+    }
+
+    // Method to switch to the newest set of data files if there is one, only called by whichever thread is running the simulation
+    void takeDataUpdate(Player& player) {
+        if (std::shared_ptr<GameData> update = dataWatcher.takeUpdate()) {
+            applyGameData(*update, player);
+            gameData = std::move(update);
+        }
+    }
+
+    bool threaded;
+    SimulationThread simulation;
+    GameAudio& audio;  // Sounds are played by whichever thread is running the simulation
+    DataWatcher& dataWatcher;
+    std::shared_ptr<const GameData> gameData;  // The data in use, only changed by whichever thread is running the simulation
+    WorldSnapshot snapshot;  // Snapshot drawn when running on the main thread, or before the first tick when threaded
+    SnapshotRenderer snapshotRenderer;
+    FlowField flowField;  // Shared by every enemy in the level, only used by whichever thread is running the simulation
+    AutoPlayer* autoPlayer = nullptr;  // Plays instead of the keyboard when set, only used by whichever thread is running the simulation
+    WorldSnapshot autoPlayerView;  // What the autoplayer is shown each tick
+    ScriptScheduler<LevelScriptContext> scripts;  // The level's scripts, only run by whichever thread is running the simulation
+    std::size_t drawnEntityCount = 0;
+
+    // The simulation thread's copy of the level, only touched by that thread while it is running
+    std::unique_ptr<Player> simulationPlayer;
+    SlotMap<Enemy> simulationEnemies;
+    EnemySwarm simulationSwarm;
+    ProjectileStorage simulationBullets{ playerBulletSize, sf::Color::Yellow };
+    ProjectileStorage simulationEnemyBullets;
+};
+
+// Method to add a rectangle for a co-op enemy or bullet to a snapshot, sized and coloured the same as in the single player levels
+void addCoopEntity(WorldSnapshot& snapshot, const CoopEntityView& entity) {
+    sf::Vector2f position(entity.x, entity.y);
+    switch (entity.kind) {
+    case NetChaser: snapshot.enemies.push_back({ position, sf::Vector2f(BehaviourKernel<Chaser>::size, BehaviourKernel<Chaser>::size), BehaviourKernel<Chaser>::color() }); break;
+    case NetStrafer: snapshot.enemies.push_back({ position, sf::Vector2f(BehaviourKernel<Strafer>::size, BehaviourKernel<Strafer>::size), BehaviourKernel<Strafer>::color() }); break;
+    case NetKamikaze: snapshot.enemies.push_back({ position, sf::Vector2f(BehaviourKernel<Kamikaze>::size, BehaviourKernel<Kamikaze>::size), BehaviourKernel<Kamikaze>::color() }); break;
+    case NetTurret: snapshot.enemies.push_back({ position, sf::Vector2f(BehaviourKernel<Turret>::size, BehaviourKernel<Turret>::size), BehaviourKernel<Turret>::color() }); break;
+    case NetSpiral: snapshot.enemies.push_back({ position, sf::Vector2f(BehaviourKernel<Spiral>::size, BehaviourKernel<Spiral>::size), BehaviourKernel<Spiral>::color() }); break;
+    case NetPlayerBullet: snapshot.bullets.push_back({ position, sf::Vector2f(ProjectileStorage::width, ProjectileStorage::height), sf::Color::Yellow }); break;
+    default: snapshot.bullets.push_back({ position, sf::Vector2f(ProjectileStorage::width, ProjectileStorage::height), sf::Color::Red }); break;
+    }
+}
+
+// Method to play co-op on a dedicated server until the window is closed or Escape is pressed, returns the game's exit code
+// The client ticks at the server's tick rate so every input lines up with a server tick, and draws every frame in between
+// with the local player predicted and everyone else interpolated (see CoopClient.h)
+int runCoopClient(sf::RenderWindow& window, FramePacer& framePacer, Camera& camera, TileMap& tileMap, ParallaxBackground& background,
+    const SpriteAtlas& spriteAtlas, Player& player, sf::Texture& coinTexture, sf::Font& font, int height, const sf::IpAddress& address, unsigned short port) {
+    CoopClient client(tileMap);
+    if (!client.connect(address, port)) {
+        LOG_ERROR("Could not open a socket to join the co-op server");
+        return -1;
+    }
+    LOG_INFO("Joining the co-op server on port {}", port);
+
+    WorldSnapshot snapshot;
+    SnapshotRenderer snapshotRenderer(spriteAtlas);
+    std::vector<CoopEntityView> entities;
+    std::vector<CoopPlayerView> players;
+    sf::Clock clock;
+    sf::Time nextTick;
+    sf::Time lastFrame;
+
+    while (window.isOpen()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed || (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)) {
+                window.close();
+            }
+        }
+
+        // Run as many client ticks as are due, if the game stalls for a long time it carries on from now rather than catching up
+        sf::Time now = clock.getElapsedTime();
+        const sf::Time tickLength = sf::seconds(1.f / client.getTickRate());
+        for (int ticks = 0; nextTick <= now && ticks < 8; ++ticks) {
+            client.tick(PlayerInput::fromKeyboard(), now);
+            nextTick += tickLength;
+        }
+        if (nextTick <= now) {
+            nextTick = now + tickLength;
+        }
+
+        // Build a snapshot of what to draw, the teammate goes in with the enemies as it is drawn the same way
+        client.interpolate(now, entities, players);
+        snapshot.clear();
+        snapshot.player = { sf::Vector2f(-1000.f, -1000.f), sf::Vector2f(CoopSession::Player::size, CoopSession::Player::size), sf::Color::Green };
+        snapshot.playerHealth = 0;
+        snapshot.playerMaxHealth = CoopSession::Player::maxHealth;
+        for (const CoopPlayerView& view : players) {
+            SnapshotRect rect = { sf::Vector2f(view.x, view.y), sf::Vector2f(CoopSession::Player::size, CoopSession::Player::size),
+                view.local ? sf::Color::Green : sf::Color::Cyan };
+            if (view.local) {
+                snapshot.player = rect;
+                snapshot.playerHealth = view.health;
+            }
+            else if (view.health > 0) {
+                snapshot.enemies.push_back(rect);
+            }
+        }
+        for (const CoopEntityView& entity : entities) {
+            addCoopEntity(snapshot, entity);
+        }
+
+        background.update((now - lastFrame).asSeconds());
+        background.setCameraPosition(camera.getPosition());
+        background.render(window);
+        renderLevel(window, camera, tileMap, snapshotRenderer, snapshot, player, coinTexture, font, height);
+        window.display();
+        lastFrame = now;
+
+        framePacer.waitForNextFrame();
+    }
+
+    client.disconnect();
+    return 0;
+}
+
+// How long a soak run lasts and what fails it, set from the command line
+struct SoakSettings {
+    float minutes = 0.f;  // No soak run unless this is set
+    bool headless = false;
+    std::uint32_t seed = 1;
+    SoakThresholds thresholds;
+};
+
+// A level the autoplayer hasn't finished in this many seconds of game time is given up on, so every level keeps coming round
+const float soakLevelTimeLimit = 120.f;
+
+// Method to play the levels one after another with the autoplayer and no window, ticking as fast as they will go, returns the number of checks that failed
+// The level goes through the same updateLevel and level scripts as when it is played, on the same data files and terrain, just without anything being drawn.
+// Each tick is the same length as a simulation thread tick, so an hour of soaking covers many hours of play, and the frame time recorded is the tick's cost
+int runHeadlessSoak(const SoakSettings& settings, const std::string& dataDirectory, const std::string& mapDirectory, const sf::FloatRect& worldBounds) {
+    GameData data;
+    DataError error;
+    if (!loadGameData(dataDirectory, data, error)) {
+        LOG_ERROR("Soak test couldn't load the game data, {} line {}: {}", error.file, error.line, error.reason);
+        return -1;
+    }
+
+    Player player(1920.f / 5.f, 900.f / 2.f, sf::Color::Green, 50.f, 50.f, 100, 300.f);
+    applyGameData(data, player);
+
+    // The whole map is loaded up front, there is no camera to stream it around
+    TileCollision terrain;
+    terrain.loadAllChunks(mapDirectory, worldBounds);
+    FlowField flowField;
+    GameAudio audio;
+    audio.setMuted(true);
+
+    SlotMap<Enemy> enemies;
+    EnemySwarm swarm;
+    ProjectileStorage bullets(playerBulletSize, sf::Color::Yellow);
+    ProjectileStorage enemyBullets;
+    enemyBullets.reserve(4096);
+    bullets.reserve(512);
+
+    AutoPlayer autoPlayer(settings.seed);
+    ScriptScheduler<LevelScriptContext> scripts;
+    SoakMonitor monitor(settings.thresholds);
+    WorldSnapshot view;
+    const float tickLength = 1.f / 240.f;
+    const float duration = settings.minutes * 60.f;
+    LOG_INFO("[soak] Playing headless for {} minutes with seed {}", settings.minutes, settings.seed);
+
+    sf::Clock runClock;
+    int level = 0;
+    while (runClock.getElapsedTime().asSeconds() < duration) {
+        level = level % gameDataLevelCount + 1;
+        player.reset();
+        bullets.clear();
+        enemyBullets.clear();
+        if (!spawnLevelFromData(data, level, enemies, swarm)) {
+            spawnBuiltInLevel(level, enemies, swarm);
+        }
+        startLevelScripts(level, scripts);
+        autoPlayer.reset();
+        monitor.beginLevel(level);
+
+        float levelTime = 0.f;
+        sf::Clock tickClock;
+        while (player.isAlive() && enemies.size() + swarm.size() + scripts.size() > 0 && levelTime < soakLevelTimeLimit) {
+            view.clear();
+            fillSnapshot(view, player, enemies, swarm, bullets, enemyBullets);
+            PlayerInput input = autoPlayer.decide(view, worldBounds, player.getSpeed(), tickLength);
+            updateLevel(input, player, enemies, swarm, bullets, enemyBullets, terrain, flowField, audio, worldBounds, tickLength);
+            runLevelScripts(scripts, player, enemies, swarm, tickLength);
+            levelTime += tickLength;
+
+            float elapsed = runClock.getElapsedTime().asSeconds();
+            monitor.recordFrame(tickClock.restart().asSeconds(), elapsed, view.enemies.size() + view.bullets.size());
+            if (elapsed >= duration) {
+                break;
+            }
+        }
+        monitor.endLevel();
+        LOG_INFO("[soak] Level {} {} after {} s of game time", level,
+            !player.isAlive() ? "lost" : enemies.size() + swarm.size() + scripts.size() == 0 ? "won" : "given up", levelTime);
+    }
+    return monitor.report();
+}
+
+// Method to play the levels one after another with the autoplayer in the window, returns the number of checks that failed
+// This goes through the level runner exactly as the level blocks do, so it covers the drawing and the simulation thread when it is turned on,
+// and the frame time recorded is the time spent on each frame before the frame pacer waits
+int runWindowedSoak(sf::RenderWindow& window, FramePacer& framePacer, Camera& camera, TileMap& tileMap, ParallaxBackground& background,
+    LevelRunner& levelRunner, Player& player, SlotMap<Enemy>& enemies, EnemySwarm& swarm, ProjectileStorage& bullets,
+    ProjectileStorage& enemyBullets, sf::Texture& coinTexture, sf::Font& font, int height, const SoakSettings& settings) {
+    AutoPlayer autoPlayer(settings.seed);
+    levelRunner.setAutoPlayer(&autoPlayer);
+    SoakMonitor monitor(settings.thresholds);
+    const float duration = settings.minutes * 60.f;
+    LOG_INFO("[soak] Playing in the window for {} minutes with seed {}", settings.minutes, settings.seed);
+
+    sf::Clock runClock;
+    sf::Clock frameClock;
+    int level = 0;
+    bool levelRunning = false;
+    float levelTime = 0.f;
+    while (window.isOpen() && runClock.getElapsedTime().asSeconds() < duration) {
+        float deltaTime = std::min(frameClock.restart().asSeconds(), 0.1f);
+        frameArena.reset();
+        sf::Clock workClock;
+
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed || (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)) {
+                window.close();
+            }
+        }
+
+        // Start the next level once the last one is over, the same way the level select does
+        if (!levelRunning) {
+            levelRunner.applyDataUpdates(player);
+            level = level % gameDataLevelCount + 1;
+            player.reset();
+            bullets.clear();
+            enemyBullets.clear();
+            if (!levelRunner.spawnLevel(level, enemies, swarm)) {
+                spawnBuiltInLevel(level, enemies, swarm);
+            }
+            levelRunner.startScripts(level);
+            autoPlayer.reset();
+            monitor.beginLevel(level);
+            levelRunning = true;
+            levelTime = 0.f;
+        }
+
+        LevelStatus status = levelRunner.getStatus(player, enemies, swarm);
+        bool finished = !status.playerAlive || status.enemiesRemaining == 0 || levelTime >= soakLevelTimeLimit;
+
+        window.clear();
+        background.update(deltaTime);
+        background.setCameraPosition(camera.getPosition());
+        background.render(window);
+        levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
+        window.display();
+        levelTime += deltaTime;
+
+        monitor.recordFrame(workClock.getElapsedTime().asSeconds(), runClock.getElapsedTime().asSeconds(), levelRunner.getDrawnEntityCount());
+        if (finished) {
+            levelRunner.stop(player, enemies, swarm, bullets, enemyBullets);
+            monitor.endLevel();
+            LOG_INFO("[soak] Level {} {} after {} s", level,
+                !status.playerAlive ? "lost" : status.enemiesRemaining == 0 ? "won" : "given up", levelTime);
+            levelRunning = false;
+        }
+
+        framePacer.waitForNextFrame();
+    }
+
+    levelRunner.stop(player, enemies, swarm, bullets, enemyBullets);
+    levelRunner.setAutoPlayer(nullptr);
+    return monitor.report();
+}
+
+// Settings for the endless mode, set from the command line
+struct EndlessSettings {
+    bool enabled = false;
+    std::uint32_t seed = 1;   // Picks the waves, the same seed always gives the same waves
+    bool autoPlay = false;    // Let the autoplayer play, so the run is the same workload every time
+    float frameBudget = 1.f / 144.f;  // Seconds of work a frame may take, the frame pacer's frame length
+};
+
+// Method to play endless waves until the player dies, returns the game's exit code
+// Each wave comes from the wave generator and is bigger and faster than the last, the player is healed when a wave is cleared.
+// The time each frame takes before the frame pacer waits is checked against the frame budget, and the first wave where more than
+// a tenth of the frames went over it is reported, which makes this a workload that finds how much the game can take on a machine
+// The waves are placed against the whole map read up front, since which chunks the tile map has streamed in depends on timing
+int runEndless(sf::RenderWindow& window, FramePacer& framePacer, Camera& camera, TileMap& tileMap, ParallaxBackground& background,
+    LevelRunner& levelRunner, Player& player, SlotMap<Enemy>& enemies, EnemySwarm& swarm, ProjectileStorage& bullets,
+    ProjectileStorage& enemyBullets, sf::Texture& coinTexture, sf::Font& font, int height, const std::string& mapDirectory,
+    const EndlessSettings& settings) {
+    WaveGenerator waveGenerator(settings.seed);
+    TileCollision waveTerrain;
+    waveTerrain.loadAllChunks(mapDirectory, camera.getWorldBounds());
+    AutoPlayer autoPlayer(settings.seed);
+    if (settings.autoPlay) {
+        levelRunner.setAutoPlayer(&autoPlayer);
+    }
+    LOG_INFO("[endless] Starting with seed {}, frame budget {} ms", settings.seed, settings.frameBudget * 1000.f);
+
+    // The wave number drawn at the top of the screen, its string only changes when a new wave starts
+    sf::Text waveText;
+    waveText.setFont(font);
+    waveText.setCharacterSize(40);
+    waveText.setFillColor(sf::Color::White);
+    waveText.setPosition(20.f, 20.f);
+
+    player.reset();
+    bullets.clear();
+    enemyBullets.clear();
+
+    sf::Clock frameClock;
+    int wave = 0;
+    bool waveRunning = false;
+    bool playerAlive = true;
+    std::size_t waveFrames = 0;
+    std::size_t framesOverBudget = 0;
+    float worstFrame = 0.f;
+    int firstWaveOverBudget = 0;
+    while (window.isOpen() && playerAlive) {
+        float deltaTime = std::min(frameClock.restart().asSeconds(), 0.1f);
+        frameArena.reset();
+        sf::Clock workClock;
+
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed || (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)) {
+                window.close();
+            }
+        }
+
+        // Send in the next wave once the last one is cleared, the player keeps their position and is healed
+        if (!waveRunning) {
+            levelRunner.applyDataUpdates(player);
+            ++wave;
+            levelRunner.spawnWave(waveGenerator.generate(wave, camera.getWorldBounds(), waveTerrain, player.getPosition()), enemies, swarm);
+            player.health = player.maxHealth;
+            bullets.clear();
+            enemyBullets.clear();
+            autoPlayer.reset();
+            waveText.setString("Wave " + std::to_string(wave));
+            LOG_INFO("[endless] Wave {}: {} enemies and {} in the swarm", wave, static_cast<unsigned>(enemies.size()), static_cast<unsigned>(swarm.size()));
+            waveRunning = true;
+            waveFrames = 0;
+            framesOverBudget = 0;
+            worstFrame = 0.f;
+        }
+
+        LevelStatus status = levelRunner.getStatus(player, enemies, swarm);
+
+        window.clear();
+        background.update(deltaTime);
+        background.setCameraPosition(camera.getPosition());
+        background.render(window);
+        levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
+        window.draw(waveText);
+        window.display();
+
+        float frameTime = workClock.getElapsedTime().asSeconds();
+        ++waveFrames;
+        worstFrame = std::max(worstFrame, frameTime);
+        if (frameTime > settings.frameBudget) {
+            ++framesOverBudget;
+        }
+
+        if (!status.playerAlive || status.enemiesRemaining == 0) {
+            levelRunner.stop(player, enemies, swarm, bullets, enemyBullets);
+            LOG_INFO("[endless] Wave {} {}, {} of {} frames over budget, worst {} ms", wave, status.playerAlive ? "cleared" : "lost",
+                static_cast<unsigned>(framesOverBudget), static_cast<unsigned>(waveFrames), worstFrame * 1000.f);
+            if (firstWaveOverBudget == 0 && framesOverBudget * 10 > waveFrames) {
+                firstWaveOverBudget = wave;
+                LOG_WARNING("[endless] Wave {} is the first to go over the frame budget", wave);
+            }
+            waveRunning = false;
+            playerAlive = status.playerAlive;
+        }
+
+        framePacer.waitForNextFrame();
+    }
+
+    levelRunner.stop(player, enemies, swarm, bullets, enemyBullets);
+    levelRunner.setAutoPlayer(nullptr);
+    if (firstWaveOverBudget > 0) {
+        LOG_INFO("[endless] Reached wave {}, the frame budget was first exceeded on wave {}", wave, firstWaveOverBudget);
+    }
+    else {
+        LOG_INFO("[endless] Reached wave {}, every wave stayed within the frame budget", wave);
+    }
+
+    // Show the game over screen until the window is closed or Escape is pressed, unless the autoplayer was playing
+    while (window.isOpen() && !settings.autoPlay) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed || (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)) {
+                window.close();
+            }
+        }
+        window.clear();
+        background.render(window);
+        displayGameOverScreen(window);
+        window.draw(waveText);
+        window.display();
+        framePacer.waitForNextFrame();
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // setting the integer variables for the screen width and the screen height
+    int width = 1920;
+    int height = 900;
+
+    // Initalisation of 20 boolean variables which will track where the game state currently is so as to ensure a smooth transition between game menus
+    bool level1Won = false;
+    bool level2Won = false;
+    bool level3Won = false;
+    bool level4Won = false;
+    bool level5Won = false;
+    bool level6Won = false;
+    bool level7Won = false;
+    bool level8Won = false;
+    bool level9Won = false;
+    bool level10Won = false;
+    
+    bool level1Started = false;
+    bool level2Started = false;
+    bool level3Started = false;
+    bool level4Started = false;
+    bool level5Started = false;
+    bool level6Started = false;
+    bool level7Started = false;
+    bool level8Started = false;
+    bool level9Started = false;
+    bool level10Started = false;
+
+    // Frame rates for the frame pacer, gameplay runs at the target rate and the menus drop to the low power rate
+    // The gameplay rate can be changed from the command line with --fps <rate>
+    // --threaded-sim runs the level simulation on its own thread at the simulation tick rate
+    // --render-check <directory> checks the menus and level 10 against the golden images in the directory and exits (see RenderCheck.h),
+    // --update-goldens writes the golden images instead and --render-entities <count> sets how many extra entities level 10 is drawn with
+    // --connect <address> plays co-op on a dedicated server instead of the menus, on the default port or the one given with --port
+    // --assets <directory> loads the fonts, textures, music, data and terrain from another directory instead of the absolute one at the top of this file,
+    // --data <directory> loads the tuning, enemy and level files from another directory (see GameData.h), they are reloaded whenever they are saved
+    // --map <directory> loads the terrain chunks from another directory (see TileMap.h)
+    // --soak <minutes> lets the autoplayer play every level in turn for that long and fails if memory or frame times drift (see SoakMonitor.h),
+    // in the window or with --headless without one. --soak-seed <n> changes how the autoplayer moves, --soak-memory <MB> and
+    // --soak-frame-drift <percent> change how much memory growth and frame time growth are allowed
+    // --endless <seed> plays generated waves that keep getting bigger until the player dies (see WaveGenerator.h),
+    // with --autoplay the autoplayer plays them so the same seed is the same workload every time
+    // F12 saves a screenshot and F9 saves the last few seconds as a clip (see FrameCapture.h), into another directory with --capture-dir <directory>,
+    // --clip-seconds <seconds> changes how long the clip is and 0 turns the clip off
+    float targetFrameRate = 144.f;
+    float menuFrameRate = 30.f;
+    bool threadedSimulation = false;
+    float simulationTickRate = 240.f;
+    std::string renderCheckDirectory;
+    bool updateGoldens = false;
+    int renderEntityCount = 2000;
+    std::string connectAddress;
+    unsigned short connectPort = netDefaultPort;
+    // The data and captures directories are in the asset folder unless they are given on the command line
+    std::string dataDirectory;
+    bool dataDirectoryGiven = false;
+    SoakSettings soak;
+    EndlessSettings endless;
+    std::string captureDirectory;
+    bool captureDirectoryGiven = false;
+    std::string mapDirectory;
+    FrameCaptureSettings captureSettings;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--fps" && i + 1 < argc) {
+            targetFrameRate = std::max(1.f, static_cast<float>(std::atof(argv[++i])));
+        }
+        else if (argument == "--threaded-sim") {
+            threadedSimulation = true;
+        }
+        else if (argument == "--render-check" && i + 1 < argc) {
+            renderCheckDirectory = argv[++i];
+        }
+        else if (argument == "--update-goldens") {
+            updateGoldens = true;
+        }
+        else if (argument == "--render-entities" && i + 1 < argc) {
+            renderEntityCount = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (argument == "--connect" && i + 1 < argc) {
+            connectAddress = argv[++i];
+        }
+        else if (argument == "--port" && i + 1 < argc) {
+            connectPort = static_cast<unsigned short>(std::atoi(argv[++i]));
+        }
+        else if (argument == "--assets" && i + 1 < argc) {
+            assetDirectory = argv[++i];
+            if (!assetDirectory.empty() && assetDirectory.back() != '/' && assetDirectory.back() != '\\') {
+                assetDirectory += '/';
+            }
+        }
+        else if (argument == "--data" && i + 1 < argc) {
+            dataDirectory = argv[++i];
+            dataDirectoryGiven = true;
+            if (!dataDirectory.empty() && dataDirectory.back() != '/' && dataDirectory.back() != '\\') {
+                dataDirectory += '/';
+            }
+        }
+        else if (argument == "--map" && i + 1 < argc) {
+            mapDirectory = argv[++i];
+            if (!mapDirectory.empty() && mapDirectory.back() != '/' && mapDirectory.back() != '\\') {
+                mapDirectory += '/';
+            }
+        }
+        else if (argument == "--soak" && i + 1 < argc) {
+            soak.minutes = std::max(0.f, static_cast<float>(std::atof(argv[++i])));
+        }
+        else if (argument == "--headless") {
+            soak.headless = true;
+        }
+        else if (argument == "--soak-seed" && i + 1 < argc) {
+            soak.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--soak-memory" && i + 1 < argc) {
+            soak.thresholds.maxMemoryGrowthMB = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (argument == "--soak-frame-drift" && i + 1 < argc) {
+            soak.thresholds.maxFrameTimeGrowth = static_cast<float>(std::atof(argv[++i])) / 100.f;
+        }
+        else if (argument == "--endless" && i + 1 < argc) {
+            endless.enabled = true;
+            endless.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--autoplay") {
+            endless.autoPlay = true;
+        }
+        else if (argument == "--capture-dir" && i + 1 < argc) {
+            // An empty directory saves next to the game, anything else gets a slash on the end so file names can go straight after it
+            captureDirectory = argv[++i];
+            captureDirectoryGiven = true;
+            if (!captureDirectory.empty() && captureDirectory.back() != '/' && captureDirectory.back() != '\\') {
+                captureDirectory += '/';
+            }
+        }
+        else if (argument == "--clip-seconds" && i + 1 < argc) {
+            captureSettings.clipSeconds = std::max(0.f, static_cast<float>(std::atof(argv[++i])));
+            if (captureSettings.clipSeconds == 0.f) {
+                captureSettings.clipFramesPerSecond = 0.f;
+            }
+        }
+    }
+    if (!dataDirectoryGiven) {
+        dataDirectory = assetPath("data/");
+    }
+    if (!captureDirectoryGiven) {
+        captureDirectory = assetPath("captures/");
+    }
+    if (mapDirectory.empty()) {
+        mapDirectory = assetPath("maps/sky/");
+    }
+
+    // The world is bigger than the screen, the camera follows the player around it and anything it can't see isn't drawn
+    sf::FloatRect worldBounds(0.f, 0.f, 1920.f * 3.f, 1080.f * 2.f);
+
+    // Short soak runs warm up for a quarter of the run at most, so they still have something to check
+    soak.thresholds.warmUpSeconds = std::min(soak.thresholds.warmUpSeconds, soak.minutes * 60.f / 4.f);
+
+    // A headless soak run never opens the window
+    if (soak.minutes > 0.f && soak.headless) {
+        return runHeadlessSoak(soak, dataDirectory, mapDirectory, worldBounds) == 0 ? 0 : 1;
+    }
+
+    // Calling upon the sf RenderWindow method and setting the resolution to 1920x1080
+    sf::RenderWindow window(sf::VideoMode({ 1920, 1080 }), "Warfare In Sky");
+    if (!renderCheckDirectory.empty()) {
+        window.setVisible(false);  // The render check draws off screen, the window is only there for its OpenGL context
+    }
+    window.setVerticalSyncEnabled(false);  // The frame pacer decides when frames are shown instead of vsync
+
+    // Switches the window between windowed and fullscreen from the settings menu, without reloading any textures or fonts
+    DisplayModeSwitcher displayMode(window, "Warfare In Sky", sf::Vector2u(1920, 1080), false);
+    bool fullscreenButtonHeld = false;  // So holding the mouse button down on the fullscreen button only switches once
+    
+
+    // Load the coin image from the file
+    sf::Texture coinTexture;
+    if (!coinTexture.loadFromFile(assetPath("key.png"))) {
+        LOG_ERROR("Error loading coin image!");
+        return -1;
+    }
+
+    // Load the font to be used
+    if (!font.loadFromFile(assetPath("robot.ttf"))) {
+        LOG_ERROR("Error loading font!");
+        return -1;
+    }
+
+    // Load the background image texture
+    sf::Texture backgroundTexture;
+    if (!backgroundTexture.loadFromFile(assetPath("pixelated-sky-2.jpg"))) {
+        LOG_ERROR("Error loading background image!");
+        return -1;
+    }
+
+    // a text button to toggle fullscreen
+    sf::Text fullscreenText;
+    fullscreenText.setFont(font);
+    fullscreenText.setString("Toggle Fullscreen (F)");
+    fullscreenText.setCharacterSize(30);
+    fullscreenText.setFillColor(sf::Color::White);
+    fullscreenText.setPosition(300, 200);  // Position for fullscreen toggle text
+
+    //  a text button to switch to windowed mode
+    sf::Text windowedModeText;
+    windowedModeText.setFont(font);
+    windowedModeText.setString("Windowed Mode (800x600)");
+    windowedModeText.setCharacterSize(30);
+    windowedModeText.setFillColor(sf::Color::White);
+    windowedModeText.setPosition(300, 250);  // Position for windowed mode text
+
+
+    // Create the parallax background for the cloud animation, the sky texture repeats so one quad covers the whole screen
+    // More layers can be added with addLayer, each one is a single extra draw at its own speed
+    float cloudSpeed = 20.f;  // Speed for cloud movement in pixels per second
+    ParallaxBackground background;
+    background.addLayer(backgroundTexture, cloudSpeed);
+
+    // The camera follows the player around the world and anything it can't see isn't drawn
+    Camera camera(sf::Vector2f(window.getSize()), worldBounds);
+
+    // Terrain for the world, split into chunks that are streamed from disk around the camera and kept under a 4MB budget
+    TileMap tileMap(mapDirectory, worldBounds, 4 * 1024 * 1024);
+    tileMap.loadAtlas(assetPath("maps/sky/atlas.png"));
+
+    // Art for the player, enemies and bullets, packed into one texture by the atlas builder so the whole world is one draw call
+    // If the atlas hasn't been built the sprites are packed now, and if they can't be loaded the entities are drawn as plain rectangles
+    SpriteAtlas spriteAtlas;
+    if (!spriteAtlas.load(assetPath("sprites/atlas/"), assetPath("sprites/sprites.txt"))) {
+        LOG_WARNING("Sprite atlas couldn't be loaded, drawing plain rectangles: {}", spriteAtlas.getError().c_str());
+    }
+
+    // Load font
+    sf::Font font;
+    if (!font.loadFromFile(assetPath("robot.ttf"))) {
+        LOG_ERROR("Error loading font!");
+        return -1;
+    }
+
+    // Draw background clouds
+    background.render(window);
+
+
+    // Define button sizes and positions
+    float rectWidth = 800.f;
+    float rectHeight = 200.f;
+    float spacing = 50.f;
+
+    // DefinING the position for each button for main menu based on screen settings
+    sf::Vector2f position1((width - rectWidth) / 2, (height - 3 * rectHeight - 2 * spacing) / 2);
+    sf::Vector2f position2((width - rectWidth) / 2, (height - 3 * rectHeight - 2 * spacing) / 2 + rectHeight + spacing);
+    sf::Vector2f position3((width - rectWidth) / 2, (height - 3 * rectHeight - 2 * spacing) / 2 + 2 * (rectHeight + spacing));
+    sf::Vector2f position4((width - rectWidth) / 2, (height - 4 * rectHeight - 3 * spacing) / 2 + 3 * (rectHeight + spacing) + 100.f);
+
+    // Initialization of each button for the main menu, with a font and a relevant label
+    Button startButton(position1, "Start Game", font);
+    Button settingsButton(position2, "Settings", font);
+    Button garageButton(position3, "Garage", font);
+    Button exitButton(position4, "Exit Game", font);
+
+    // Create the fullscreen button
+    Button fullscreenButton(position1, "Fullscreen off/on", font);
+
+    
+    // Button for returning to the main menu from the game
+    Button backButton(sf::Vector2f((width - rectWidth) / 2, height - rectHeight - 30.f), "Back to Main Menu", font);
+
+    bool levelWon = false;
+    bool inGameMenu = false;
+    bool inSettingsMenu = false;
+    bool inGarageMenu = false;  // Track if we are in the garage menu
+    bool inGame = false;  // Flag to track if we're in the game (red box)
+    bool inVictoryScreen = false;
+    bool inDefeatScreen = false;
+
+
+    // Create a text object for the header
+    sf::Text headerText;
+    headerText.setFont(font);
+    headerText.setString("Warfare In Sky");
+    headerText.setCharacterSize(80);
+    headerText.setFillColor(sf::Color::Blue);
+
+    // Center the header text
+    float headerX = (width - headerText.getLocalBounds().width) / 2;
+    headerText.setPosition(headerX, (height - 3 * rectHeight - 2 * spacing) / 2 - 100.f);
+
+    // Instantiate the Player object with similar properties
+    float playerSpeed = 300.f;  // Pixels per second
+    int playerHealth = 100;
+    Player player(width / 5.f, height / 2.f, sf::Color::Green, 50.f, 50.f, playerHealth, playerSpeed);
+
+
+    // Instantiate the enemies vector which will store all the enemies inside
+    SlotMap<Enemy> enemies;
+    enemies.insert(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 0.5f));
+    enemies.insert(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 0.5f));
+
+    // The strafers, kamikazes, turrets and other archetype enemies, each type is stored and updated on its own
+    EnemySwarm swarm;
+
+    // Declare a clock to track the firing cooldown
+    sf::Clock fireCooldownClock;
+    float fireCooldownTime = 0.1f;  // Time in seconds between shots, this value ensures that the player wont fire too fast
+
+
+    // initialisation of the enemy bullet storage and the player bullet storage
+    ProjectileStorage enemyBullets;
+    ProjectileStorage bullets(playerBulletSize, sf::Color::Yellow);
+
+    // Reserve room for the bullets up front so the vectors don't have to grow (and allocate) during a level
+    enemyBullets.reserve(4096);
+    bullets.reserve(512);
+
+    // Render check mode, the scenes are drawn exactly as the game loop draws them but into a texture, then the game exits
+    if (!renderCheckDirectory.empty()) {
+        RenderCheck renderCheck(renderCheckDirectory, 1920, 1080, updateGoldens);
+
+        renderCheck.addScene("main_menu", [&](sf::RenderTarget& target) {
+            background.render(target);
+            target.draw(headerText);
+            startButton.render(target);
+            settingsButton.render(target);
+            garageButton.render(target);
+            exitButton.render(target);
+            player.renderCoins(target, coinTexture, font);
+        });
+
+        renderCheck.addScene("level_select", [&](sf::RenderTarget& target) {
+            background.render(target);
+            target.draw(headerText);
+            renderLevelSelect(target, backButton, player, coinTexture, font, width, height);
+        });
+
+        // Level 10 as it starts, plus a grid of chasers over the screen and a boss volley that has had a second to spread out
+        SlotMap<Enemy> checkEnemies;
+        EnemySwarm checkSwarm;
+        ProjectileStorage checkProjectiles;
+        ProjectileStorage checkBullets(playerBulletSize, sf::Color::Yellow);
+        spawnLevel10Enemies(checkEnemies, checkSwarm);
+        int extraEnemies = renderEntityCount / 2;
+        for (int i = 0; i < extraEnemies; ++i) {
+            checkSwarm.spawn<Chaser>(60.f + (i % 40) * 45.f, 60.f + (i / 40 % 22) * 45.f);
+        }
+        float volleyPhase = 0.f;
+        const BulletPattern* bossRing = bulletPatterns.find("bossRing");
+        while (static_cast<int>(checkProjectiles.size()) < renderEntityCount - extraEnemies) {
+            bossRing->fire(checkProjectiles, 960.f, 540.f, 0.f, volleyPhase);
+            checkProjectiles.update(0.25f);
+        }
+
+        WorldSnapshot levelSnapshot;
+        fillSnapshot(levelSnapshot, player, checkEnemies, checkSwarm, checkBullets, checkProjectiles);
+
+        // Stream in the terrain around the player before drawing, so every frame has the same chunks
+        Camera checkCamera(sf::Vector2f(1920.f, 1080.f), worldBounds);
+        checkCamera.follow(levelSnapshot.player.position + levelSnapshot.player.size / 2.f);
+        for (int i = 0; i < 500; ++i) {
+            tileMap.update(checkCamera.getViewBounds());
+            if (!tileMap.isLoading()) {
+                break;
+            }
+            sf::sleep(sf::milliseconds(10));
+        }
+
+        SnapshotRenderer checkRenderer(spriteAtlas);
+        renderCheck.addScene("level10", [&](sf::RenderTarget& target) {
+            frameArena.reset();
+            background.render(target);
+            target.draw(headerText);
+            renderLevel(target, checkCamera, tileMap, checkRenderer, levelSnapshot, player, coinTexture, font, height);
+        });
+
+        return renderCheck.run() == 0 ? 0 : 1;
+    }
+
+    // Sound effects and the background music, the sounds are all made here once so playing them during a level doesn't allocate
+    // IMPORTANT NOTE: like the other assets the music is loaded from an absolute path, change it to where the repo is on your machine
+    GameAudio gameAudio;
+    gameAudio.playMusic(assetPath("background-music.mp3"));
+
+    // Watches the tuning, enemy and level files and reloads them in the background whenever one is saved
+    DataWatcher dataWatcher(dataDirectory);
+    dataWatcher.start();
+
+    // Runs the levels, either on the main thread or with the simulation on its own thread
+    LevelRunner levelRunner(threadedSimulation, simulationTickRate, gameAudio, dataWatcher, spriteAtlas);
+
+    // Counts heap allocations made during gameplay frames when built with WARFARE_TRACK_ALLOCATIONS
+    AllocationMonitor allocationMonitor;
+
+    
+
+    // Call the function to initialize the "Game Over" text to prepare for displaying the gameDefeatScreen
+    initializeGameOverText();
+
+    // Calls the function intializeVictoryText() to setup the text to be displayed in victory message
+    initializeVictoryText();
+
+    // Clock used to measure how long each frame took, so movement can be scaled by the frame time
+    sf::Clock frameClock;
+
+    // Holds each frame until its deadline so the game doesn't spin a core drawing thousands of identical frames
+    FramePacer framePacer(targetFrameRate, menuFrameRate);
+
+    // Co-op mode skips the menus and goes straight into the server's game
+    if (!connectAddress.empty()) {
+        return runCoopClient(window, framePacer, camera, tileMap, background, spriteAtlas, player, coinTexture, font, height, sf::IpAddress(connectAddress), connectPort);
+    }
+
+    // Endless mode skips the menus too, the frame budget is the length of a gameplay frame
+    if (endless.enabled) {
+        endless.frameBudget = 1.f / targetFrameRate;
+        return runEndless(window, framePacer, camera, tileMap, background, levelRunner, player, enemies, swarm, bullets, enemyBullets,
+            coinTexture, font, height, mapDirectory, endless);
+    }
+
+    // Soak mode skips the menus too and lets the autoplayer play the levels in the window
+    if (soak.minutes > 0.f) {
+        gameAudio.stopMusic();
+        gameAudio.setMuted(true);
+        return runWindowedSoak(window, framePacer, camera, tileMap, background, levelRunner, player, enemies, swarm, bullets, enemyBullets,
+            coinTexture, font, height, soak) == 0 ? 0 : 1;
+    }
+
+    // Screenshots and clips for bug reports, read back from the GPU and saved on a worker thread so the frame doesn't wait for them
+    FrameCapture frameCapture(captureDirectory, captureSettings);
+
+    // Main game loop while the window is open
+    while (window.isOpen()) {
+        // Time in seconds since the last frame, capped so a long stall (such as dragging the window) doesn't make everything jump
+        float deltaTime = std::min(frameClock.restart().asSeconds(), 0.1f);
+        frameArena.reset();  // Free everything the last frame put in the arena
+        allocationMonitor.beginFrame();
+        levelRunner.applyDataUpdates(player);  // Switch to any data files that were saved since the last frame
+
+        displayMode.update();
+
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                window.close(); // Closes the window
+            }
+            displayMode.handleEvent(event);  // A switch to or from fullscreen finishes when the window manager resizes the window
+
+            // Screenshot and clip keys, they work on every screen
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F12) {
+                frameCapture.requestScreenshot();
+            }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F9) {
+                frameCapture.saveClip();
+            }
+
+            
+            
+
+            // Button click handlers for the main menu (Start Game, Settings, Garage, Exit Game)
+            if (!inGameMenu && !inSettingsMenu && !inGarageMenu) {  // Main menu
+                if (startButton.isClicked(window)) {
+                    LOG_INFO("Start Game button clicked!");
+                    inGameMenu = true;  // Switch to the game menu
+                    player.renderCoins(window, coinTexture, font); // Render the currency at the top right hand of the screen
+                }
+
+                if (settingsButton.isClicked(window)) {
+                    LOG_INFO("Settings button clicked!");
                     inSettingsMenu = true;  // Switch to the settings menu
                     player.renderCoins(window, coinTexture, font); // Render the currency at the top right of the screen
                 }
 
                 if (garageButton.isClicked(window)) {
-                    std::cout << "Garage button clicked!" << std::endl;
+                    LOG_INFO("Garage button clicked!");
                     inGarageMenu = true;  // Switch to the garage menu
                     player.renderCoins(window, coinTexture, font); // Render the currency at the top right of the screen
                 }
 
                 if (exitButton.isClicked(window)) {
-                    std::cout << "Exit Game button clicked!" << std::endl; // Console output so we can track if this button was being pressed for debugging purposes
+                    LOG_INFO("Exit Game button clicked!"); // Console output so we can track if this button was being pressed for debugging purposes
                     window.close();
                 }
             }
             else if (inGameMenu) {  // Game menu (Level selection)
                 if (backButton.isClicked(window)) {
-                    std::cout << "Back to Main Menu button clicked!" << std::endl; // This is for debugging purposes
+                    LOG_INFO("Back to Main Menu button clicked!"); // This is for debugging purposes
                     inGameMenu = false;  // Goes back to main menu
                     player.renderCoins(window, coinTexture, font); // // Render the currency at the top right of the screen
                 }
@@ -757,7 +2022,7 @@ int main() {
                         if (mousePos.x > buttonPosX && mousePos.x < buttonPosX + 100 &&
                             mousePos.y > buttonPosY && mousePos.y < buttonPosY + 100) {
 
-                            std::cout << "Level " << level << " clicked!" << std::endl;
+                            LOG_INFO("Level {} clicked!", level);
 
                             inGame = true;  // Enter the game
                             inGameMenu = false;  // Exit the level selection menu
@@ -774,35 +2039,22 @@ int main() {
                                 levelWon = false;      // Ensure the victory flag is false
                                 player.reset();        // Reset the players variables
                                 enemies.clear();       // Clear the enemies list (or initialize new enemies for the level)
+                                swarm.clear();
                                 bullets.clear();       // Clear player bullets 
                                 enemyBullets.clear();  // Clear enemy bullets 
 
-                                // Enemies to spawn for level 1
-                                enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 0.5f)); // Enemy for level 1
-                                enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 0.5f)); // Enemy for level 1
-
-
                                 break;
                              case 2:
-                                
-
-                                
 
                                 // Reset the level flag and victory flag before starting
                                 level2Started = true;  // Indicate that Level 2 has started
                                 level2Won = false;      // Ensure the victory flag level 2 is false
                                 player.reset();        // Reset the player
                                 enemies.clear();       // Clear the enemies list or initialize new enemies for new level
+                                swarm.clear();
                                 bullets.clear();       
                                 enemyBullets.clear();  
 
-                                // Enemies for level 2
-                                enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
-
-                                enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-
-
                                 break;
 
                                 case 3:
@@ -812,16 +2064,10 @@ int main() {
                                     level3Won = false;      // Ensure the victory flag is false
                                     player.reset();        // Reset the player (position, health, etc.)
                                     enemies.clear();      
+                                    swarm.clear();
                                     bullets.clear();       
                                     enemyBullets.clear();  
 
-                                    // enemies for level 3
-                                    enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                    enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
-
                                     break;
                                 case 4:
 
@@ -830,19 +2076,10 @@ int main() {
                                     level4Won = false;      
                                     player.reset();        
                                     enemies.clear();       
+                                    swarm.clear();
                                     bullets.clear();       
                                     enemyBullets.clear();  
 
-                                    // Enemies for level 4
-                                    enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                    enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
-
-
                                     break;
                                 case 5:
 
@@ -851,17 +2088,10 @@ int main() {
                                     level5Won = false;     
                                     player.reset();        
                                     enemies.clear();       
+                                    swarm.clear();
                                     bullets.clear();       
                                     enemyBullets.clear();  
 
-                                    // Enemies for level 5
-                                    enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                    enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 2.f));
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
                                     break;
 
                                 case 6:
@@ -871,17 +2101,10 @@ int main() {
                                     level6Won = false;      
                                     player.reset();        
                                     enemies.clear();      
+                                    swarm.clear();
                                     bullets.clear();       
                                     enemyBullets.clear();  
 
-                                    // Enemies for level 6
-                                    enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
-                                    enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 2.f));
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
                                     break;
 
                                 case 7:
@@ -891,17 +2114,10 @@ int main() {
                                     level5Won = false;      
                                     player.reset();        
                                     enemies.clear();       
+                                    swarm.clear();
                                     bullets.clear();       
                                     enemyBullets.clear();  
 
-                                    // Enemies for level 7
-                                    enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
-                                    enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 2.f));
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
                                     break;
 
                                 case 8:
@@ -911,17 +2127,10 @@ int main() {
                                     level5Won = false;      // Ensure the victory flag is false
                                     player.reset();        // Reset the player (position, health, etc.)
                                     enemies.clear();       // Clear the enemies list (or initialize new enemies for the level)
+                                    swarm.clear();
                                     bullets.clear();       // Clear player bullets (reset for the level)
                                     enemyBullets.clear();  // Clear enemy bullets (reset for the level)
 
-                                    // Optionally: Add code to spawn enemies for Level 1
-                                    enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); // Example enemy
-                                    enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); // Example enemy
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); // Example enemy
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 2.f));
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
                                     break;
 
                                 case 9:
@@ -930,17 +2139,10 @@ int main() {
                                     level5Won = false;      
                                     player.reset();        
                                     enemies.clear();       
+                                    swarm.clear();
                                     bullets.clear();       
                                     enemyBullets.clear();  
 
-                                    // enemies for Level 9
-                                    enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                    enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 2.f));
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
                                     break;
                                     
                                 case 10:
@@ -949,20 +2151,18 @@ int main() {
                                     level10Won = false;      
                                     player.reset();        
                                     enemies.clear();       
+                                    swarm.clear();
                                     bullets.clear();       
                                     enemyBullets.clear();  
 
-                                    // enemies for Level 10
-                                    enemies.push_back(Enemy(1700.f, 300.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); // Enemies with damage 1.f
-                                    enemies.push_back(Enemy(1600.f, 500.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f)); 
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 2.f));
-
-                                    enemies.push_back(Enemy(1500.f, 200.f, sf::Color::Red, 50.f, 50.f, 50, 1.f));
                                     break;
                                 
                             }
+
+                            // The enemies built into the game for the level, if the data files lay the level out their enemies replace these
+                            spawnBuiltInLevel(level, enemies, swarm);
+                            levelRunner.spawnLevel(level, enemies, swarm);
+                            levelRunner.startScripts(level);
                             break;  // Exit the loop after the level is selected
                         }
                     }
@@ -975,19 +2175,19 @@ int main() {
                     
 
 
-                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                    LOG_INFO("Back to Main Menu button clicked!");
                     inSettingsMenu = false;  // Go back to main menu
                     player.renderCoins(window, coinTexture, font);
                 }
             }
             else if (inGarageMenu) {  // Garage menu
                 if (backButton.isClicked(window)) {
-                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                    LOG_INFO("Back to Main Menu button clicked!");
                     inGarageMenu = false;  // Go back to main menu
                 }
             } // Handle the Back to Main Menu button click when in the game
             else if (inGame && backButton.isClicked(window)) {
-                std::cout << "Back to Main Menu clicked!" << std::endl;
+                LOG_INFO("Back to Main Menu clicked!");
                 inGame = false;  // Set inGame to false, going back to the main menu
                 inGameMenu = false;  // Ensure the game menu doesn't stay active so it doesnt overlap with other menu items
             } else if (inVictoryScreen && levelWon) {
@@ -1000,17 +2200,9 @@ int main() {
         player.renderCoins(window, coinTexture, font); // Render the currency to the screen constantly
         
 
-        // Update cloud background position 
-        backgroundSprite1.move(-cloudSpeed, 0.f);
-        backgroundSprite2.move(-cloudSpeed, 0.f);
-
-        if (backgroundSprite1.getPosition().x <= -cloudWidth) {
-            backgroundSprite1.setPosition(backgroundSprite2.getPosition().x + cloudWidth, 0.f);
-        }
-
-        if (backgroundSprite2.getPosition().x <= -cloudWidth) {
-            backgroundSprite2.setPosition(backgroundSprite1.getPosition().x + cloudWidth, 0.f);
-        }
+        // Update cloud background position, shifting the layers by where the camera is for the parallax effect
+        background.update(deltaTime);
+        background.setCameraPosition(camera.getPosition());
 
         // Handle movement of red box when inGame is true
         // Movement speed
@@ -1023,11 +2215,6 @@ int main() {
 
             player.renderCoins(window, coinTexture, font);
 
-            // Remove bullets that are out of bounds (right side of the screen)
-            bullets.erase(std::remove_if(bullets.begin(), bullets.end(), [&](const Bullet& bullet) {
-                return bullet.isOutOfBounds(window.getSize().x);  // Bullet is off the screen
-                }), bullets.end());
-
             
             
 
@@ -1037,8 +2224,7 @@ int main() {
 
        
         // Draw background clouds
-        window.draw(backgroundSprite1);
-        window.draw(backgroundSprite2);
+        background.render(window);
 
         // Draw header text
         window.draw(headerText);
@@ -1053,48 +2239,19 @@ int main() {
             
         }
         else if (inGameMenu) {  // Game menu (Level selection)
-            // Formatting the level choice menu
-            sf::RectangleShape levelBox(sf::Vector2f(1100.f, 333.f));
-            levelBox.setPosition((width - levelBox.getSize().x) / 2, (height - levelBox.getSize().y) / 2);
-            levelBox.setFillColor(sf::Color(0, 0, 255));
-            player.renderCoins(window, coinTexture, font);
-
-            // Draws the box where all of the levels through 1 to 10 are displayed
-            window.draw(levelBox);
-
-            // Display level numbers (1 to 10) horizontally
-            float levelSpacing = 100.f;
-            for (int i = 1; i <= 10; ++i) {
-                sf::Text levelText;
-                levelText.setFont(font);
-                levelText.setString(std::to_string(i));
-                levelText.setCharacterSize(50);
-                levelText.setFillColor(sf::Color::White);
-                levelText.setPosition((width - 1000.f) / 2 + levelSpacing * (i - 1), height / 2);
-
-                window.draw(levelText);
-            }
-
-            backButton.render(window);
+            renderLevelSelect(window, backButton, player, coinTexture, font, width, height);
         }
         else if (inSettingsMenu) {  // Settings menu
             
             player.renderCoins(window, coinTexture, font);
 
-            // Handle the fullscreen toggle button click
-            if (fullscreenButton.isClicked(window)) {
-                std::cout << "Fullscreen button clicked!" << std::endl;
-                if (isFullScreen) {
-                    // Set window to windowed mode (800x600)
-                    window.create(sf::VideoMode(1920, 1080), "Game", sf::Style::Close);
-                    isFullScreen = false;
-                }
-                else {
-                    // Set window to fullscreen mode (use the current screen resolution)
-                    window.create(sf::VideoMode::getDesktopMode(), "Game", sf::Style::Fullscreen);
-                    isFullScreen = true;
-                }
+            // Handle the fullscreen toggle button click, only once per click rather than every frame the mouse button is held down
+            bool fullscreenClicked = fullscreenButton.isClicked(window);
+            if (fullscreenClicked && !fullscreenButtonHeld) {
+                LOG_INFO("Fullscreen button clicked!");
+                displayMode.toggle();  // Switches between windowed and fullscreen, keeping the window where it can
             }
+            fullscreenButtonHeld = fullscreenClicked;
 
             
 
@@ -1122,151 +2279,23 @@ int main() {
             inVictoryScreen = false;
             inDefeatScreen = false;
 
-            // Remove dead enemies safely
-            enemies.erase(
-                std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-                    return !enemy.isAlive();  // Remove enemies that are dead
-                    }),
-                enemies.end()
-            );
+            // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+            LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
             // Check if player is dead
-            if (!player.isAlive()) {
-                std::cout << "Game Over! Player has died!" << std::endl;
+            if (!levelStatus.playerAlive) {
+                LOG_INFO("Game Over! Player has died!");
                 level1Started = false;
             }
 
-            if (enemies.empty()) {
+            if (levelStatus.enemiesRemaining == 0) {
                 level1Won = true;  // The player has won the level
                 level1Started = false;
-                std::cout << "Congratulations! You've defeated all enemies!" << std::endl;
-            }
-
-            // Draw the player box (red box)
-            player.render(window);  // The player's red box
-
-            player.renderCoins(window, coinTexture, font);
-
-
-
-            // Draw the enemies
-            for (auto& enemy : enemies) {
-                enemy.render(window);  // Render each enemy from the enemies vector
+                LOG_INFO("Congratulations! You've defeated all enemies!");
             }
 
-            
-
-            // Update player bullets and remove out-of-bounds ones
-            for (auto it = bullets.begin(); it != bullets.end(); ) {
-                it->update();  // Update the bullet's position
-
-                // Check if the bullet is off-screen
-                if (it->isOutOfBounds(width)) {
-                    it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-                }
-                else {
-                    ++it;  // Move to the next bullet
-                }
-            }
-
-            // Update enemy bullets and remove out-of-bounds ones
-            for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-                it->update();  // Update the enemy bullet's position
-
-                // Check if the bullet is off-screen (out of bounds)
-                if (it->isOutOfBounds(width)) {
-                    it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-                }
-                else {
-                    ++it;  // Move to the next enemy bullet
-                }
-            }
-
-            // Render the player bullets
-            for (const auto& bullet : bullets) {
-                window.draw(bullet.shape);
-            }
-
-            // Render the enemy bullets
-            for (const auto& bullet : enemyBullets) {
-                window.draw(bullet.shape);
-            }
-
-
-            // Define the starting position for the health bars and labels
-            sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-            // Render player health bar and label
-            renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-            // Adjust the vertical spacing between enemy health bars
-            float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-            // Render health bars for each enemy dynamically
-            for (size_t i = 0; i < enemies.size(); ++i) {
-                // Adjust the vertical position for each enemy's health bar
-                renderHealthBar(window,
-                    sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-                    "Enemy " + std::to_string(i + 1),
-                    enemies[i].getHealth(),
-                    50);
-            }
-
-            // Handle player and enemy updates here movement, collision detection
-
-
-            player.updateMovement();
-            player.updateShooting(bullets);  // This handles shooting and firing cooldown
-
-
-
-
-
-            // Check for collisions between enemy bullets and player
-            for (auto& bullet : enemyBullets) {
-                if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-                    player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-                    bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-                }
-            }
-
-            // Check for collisions between player bullets and enemies
-            for (auto& bullet : bullets) {
-                // If the bullet is fired by the player and hits an enemy
-                for (auto& enemy : enemies) {
-                    if (bullet.checkCollision(enemy.shape)) {
-                        enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                        bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                        break;  // Exit the inner loop as the bullet has already hit an enemy
-                    }
-                }
-            }
-
-            for (auto it = enemies.begin(); it != enemies.end(); ) {
-                if (!it->isAlive()) {
-                    player.addCoin();  // Add 1 coin when an enemy is destroyed
-                    it = enemies.erase(it);  // Remove enemy from the list
-                }
-                else {
-                    ++it;
-                }
-            }
-
-            
-
-
-            // Reset coins if the player dies
-            if (!player.isAlive()) {
-                player.resetCoins();  // Reset the coin count on player death
-            }
-
-
-            // Move each enemy towards the player
-            for (auto& enemy : enemies) {
-                enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-                enemy.shootAtPlayer(player.getPosition(), enemyBullets);
-            }
+            // Update the player, enemies and bullets and draw the world for this frame
+            levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
 
 
         }
@@ -1277,7 +2306,7 @@ int main() {
      backButton.render(window);
 
      if (backButton.isClicked(window)) {
-         std::cout << "Back to Main Menu button clicked!" << std::endl;
+         LOG_INFO("Back to Main Menu button clicked!");
 
          // Reset all flags
          inGame = false;            // Ensure the game isn't active
@@ -1293,6 +2322,7 @@ int main() {
 
          
          enemies.clear();          
+         swarm.clear();
 
          // Reset the UI elements
          renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -1309,7 +2339,7 @@ int main() {
      backButton.render(window);
 
      if (backButton.isClicked(window)) {
-         std::cout << "Back to Main Menu button clicked!" << std::endl;
+         LOG_INFO("Back to Main Menu button clicked!");
 
          // Reset all flags
          inGame = false;            // Ensure the game isn't active
@@ -1325,162 +2355,37 @@ int main() {
 
          // Reset the enemies 
          enemies.clear();   // Clear all enemies
+         swarm.clear();
 
-         // Reset the UI elements
-         renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
-     }
-
-
-        }
- else if (level2Started) {
-
-     inVictoryScreen = false;
-     inDefeatScreen = false;
-
-     // Remove dead enemies safely
-     enemies.erase(
-         std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-             return !enemy.isAlive();  // Remove enemies that are dead
-             }),
-         enemies.end()
-     );
-
-     // Check if player is dead
-     if (!player.isAlive()) {
-         std::cout << "Game Over! Player has died!" << std::endl;
-         level2Started = false;
-     }
-
-     if (enemies.empty()) {
-         level2Won = true;  // The player has won the level
-         level2Started = false;
-         std::cout << "Congratulations! You've defeated all enemies!" << std::endl;
-     }
-
-     // Draw the player box (red box)
-     player.render(window);  // The player's red box
-
-
-     player.renderCoins(window, coinTexture, font);
-
-
-     // Draw the enemies
-     for (auto& enemy : enemies) {
-         enemy.render(window);  // Render each enemy from the enemies vector
-     }
-
-
-     // Update player bullets and remove out-of-bounds ones
-     for (auto it = bullets.begin(); it != bullets.end(); ) {
-         it->update();  // Update the bullet's position
-
-         // Check if the bullet is off-screen (out of bounds)
-         if (it->isOutOfBounds(width)) {
-             it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-         }
-         else {
-             ++it;  // Move to the next bullet
-         }
-     }
-
-     // Update enemy bullets and remove out-of-bounds ones
-     for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-         it->update();  // Update the enemy bullet's position
-
-         // Check if the bullet is off-screen (out of bounds)
-         if (it->isOutOfBounds(width)) {
-             it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-         }
-         else {
-             ++it;  // Move to the next enemy bullet
-         }
-     }
-
-     // Render the player bullets
-     for (const auto& bullet : bullets) {
-         window.draw(bullet.shape);
-     }
-
-     // Render the enemy bullets
-     for (const auto& bullet : enemyBullets) {
-         window.draw(bullet.shape);
-     }
-
-
-     // Define the starting position for the health bars and labels
-     sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-     // Render player health bar and label
-     renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-     // Adjust the vertical spacing between enemy health bars
-     float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-     // Render health bars for each enemy dynamically
-     for (size_t i = 0; i < enemies.size(); ++i) {
-         // Adjust the vertical position for each enemy's health bar
-         renderHealthBar(window,
-             sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-             "Enemy " + std::to_string(i + 1),
-             enemies[i].getHealth(),
-             50);
-     }
-
-     // Handle player and enemy updates here (movement, collision detection, etc.)
-
-
-     player.updateMovement();
-     player.updateShooting(bullets);  // This handles shooting and firing cooldown
-
-
-
-
-
-     // Check for collisions between enemy bullets and player
-     for (auto& bullet : enemyBullets) {
-         if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-             player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-             bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-         }
-     }
-
-     // Check for collisions between player bullets and enemies
-     for (auto& bullet : bullets) {
-         // If the bullet is fired by the player and hits an enemy
-         for (auto& enemy : enemies) {
-             if (bullet.checkCollision(enemy.shape)) {
-                 enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                 bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                 break;  // Exit the inner loop as the bullet has already hit an enemy
-             }
-         }
-     }
-
-     for (auto it = enemies.begin(); it != enemies.end(); ) {
-         if (!it->isAlive()) {
-             player.addCoin();  // Add 1 coin when an enemy is destroyed
-             it = enemies.erase(it);  // Remove enemy from the list
-         }
-         else {
-             ++it;
-         }
+         // Reset the UI elements
+         renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
      }
 
 
+        }
+ else if (level2Started) {
+
+     inVictoryScreen = false;
+     inDefeatScreen = false;
 
+     // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+     LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
-     // Reset coins if the player dies
-     if (!player.isAlive()) {
-         player.resetCoins();  // Reset the coin count on player death
+     // Check if player is dead
+     if (!levelStatus.playerAlive) {
+         LOG_INFO("Game Over! Player has died!");
+         level2Started = false;
      }
 
-     // Move each enemy towards the player
-     for (auto& enemy : enemies) {
-         enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-         enemy.shootAtPlayer(player.getPosition(), enemyBullets);
+     if (levelStatus.enemiesRemaining == 0) {
+         level2Won = true;  // The player has won the level
+         level2Started = false;
+         LOG_INFO("Congratulations! You've defeated all enemies!");
      }
 
+     // Update the player, enemies and bullets and draw the world for this frame
+     levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
+
         }
  else if (!level2Started && level2Won == true) {
      {
@@ -1490,7 +2395,7 @@ int main() {
          backButton.render(window);
 
          if (backButton.isClicked(window)) {
-             std::cout << "Back to Main Menu button clicked!" << std::endl;
+             LOG_INFO("Back to Main Menu button clicked!");
 
              // Reset all flags
              inGame = false;            
@@ -1506,6 +2411,7 @@ int main() {
 
              // Reset the enemies
              enemies.clear();           // Clear all enemies
+             swarm.clear();
 
              // Reset the UI elements
              renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -1518,7 +2424,7 @@ int main() {
      backButton.render(window);
 
      if (backButton.isClicked(window)) {
-         std::cout << "Back to Main Menu button clicked!" << std::endl;
+         LOG_INFO("Back to Main Menu button clicked!");
 
          // Reset all flags
          inGame = false;           
@@ -1534,6 +2440,7 @@ int main() {
 
          // Reset the enemies (if needed)
          enemies.clear();           // Clear all enemies
+         swarm.clear();
 
          // Reset the UI elements
          renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -1545,150 +2452,23 @@ int main() {
             inVictoryScreen = false;
             inDefeatScreen = false;
 
-            // Remove dead enemies safely
-            enemies.erase(
-                std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-                    return !enemy.isAlive();  // Remove enemies that are dead
-                    }),
-                enemies.end()
-            );
+            // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+            LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
             // Check if player is dead
-            if (!player.isAlive()) {
-                std::cout << "Game Over! Player has died!" << std::endl;
+            if (!levelStatus.playerAlive) {
+                LOG_INFO("Game Over! Player has died!");
                 level3Started = false;
             }
 
-            if (enemies.empty()) {
+            if (levelStatus.enemiesRemaining == 0) {
                 level3Won = true;  // The player has won the level
                 level3Started = false;
-                std::cout << "Congratulations! You've defeated all enemies!" << std::endl;
-            }
-
-            // Draw the player box (red box)
-            player.render(window);  // The player's red box
-
-
-            player.renderCoins(window, coinTexture, font);
-
-
-            // Draw the enemies
-            for (auto& enemy : enemies) {
-                enemy.render(window);  // Render each enemy from the enemies vector
-            }
-
-
-            // Update player bullets and remove out-of-bounds ones
-            for (auto it = bullets.begin(); it != bullets.end(); ) {
-                it->update();  // Update the bullet's position
-
-                // Check if the bullet is off-screen (out of bounds)
-                if (it->isOutOfBounds(width)) {
-                    it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-                }
-                else {
-                    ++it;  // Move to the next bullet
-                }
-            }
-
-            // Update enemy bullets and remove out-of-bounds ones
-            for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-                it->update();  // Update the enemy bullet's position
-
-                // Check if the bullet is off-screen (out of bounds)
-                if (it->isOutOfBounds(width)) {
-                    it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-                }
-                else {
-                    ++it;  // Move to the next enemy bullet
-                }
-            }
-
-            // Render the player bullets
-            for (const auto& bullet : bullets) {
-                window.draw(bullet.shape);
-            }
-
-            // Render the enemy bullets
-            for (const auto& bullet : enemyBullets) {
-                window.draw(bullet.shape);
-            }
-
-
-            // Define the starting position for the health bars and labels
-            sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-            // Render player health bar and label
-            renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-            // Adjust the vertical spacing between enemy health bars
-            float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-            // Render health bars for each enemy dynamically
-            for (size_t i = 0; i < enemies.size(); ++i) {
-                // Adjust the vertical position for each enemy's health bar
-                renderHealthBar(window,
-                    sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-                    "Enemy " + std::to_string(i + 1),
-                    enemies[i].getHealth(),
-                    50);
-            }
-
-            // Handle player and enemy updates here (movement, collision detection, etc.)
-
-
-
-            player.updateMovement();
-            player.updateShooting(bullets);  // This handles shooting and firing cooldown
-
-
-
-
-
-            // Check for collisions between enemy bullets and player
-            for (auto& bullet : enemyBullets) {
-                if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-                    player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-                    bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-                }
-            }
-
-            // Check for collisions between player bullets and enemies
-            for (auto& bullet : bullets) {
-                // If the bullet is fired by the player and hits an enemy
-                for (auto& enemy : enemies) {
-                    if (bullet.checkCollision(enemy.shape)) {
-                        enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                        bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                        break;  // Exit the inner loop as the bullet has already hit an enemy
-                    }
-                }
-            }
-
-            for (auto it = enemies.begin(); it != enemies.end(); ) {
-                if (!it->isAlive()) {
-                    player.addCoin();  // Add 1 coin when an enemy is destroyed
-                    it = enemies.erase(it);  // Remove enemy from the list
-                }
-                else {
-                    ++it;
-                }
-            }
-
-
-
-
-            // Reset coins if the player dies
-            if (!player.isAlive()) {
-                player.resetCoins();  // Reset the coin count on player death
+                LOG_INFO("Congratulations! You've defeated all enemies!");
             }
 
-            // Move each enemy towards the player
-            for (auto& enemy : enemies) {
-                enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-                enemy.shootAtPlayer(player.getPosition(), enemyBullets);
-            }
+            // Update the player, enemies and bullets and draw the world for this frame
+            levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
 
         }
         else if (!level3Started && level3Won == true) {
@@ -1699,7 +2479,7 @@ int main() {
                 backButton.render(window);
 
                 if (backButton.isClicked(window)) {
-                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                    LOG_INFO("Back to Main Menu button clicked!");
 
                     // Reset all flags
                     inGame = false;           
@@ -1715,6 +2495,7 @@ int main() {
 
                     // Reset the enemies
                     enemies.clear();           // Clear all enemies
+                    swarm.clear();
 
                     // Reset the UI elements
                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -1728,7 +2509,7 @@ int main() {
                 backButton.render(window);
 
                 if (backButton.isClicked(window)) {
-                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                    LOG_INFO("Back to Main Menu button clicked!");
 
                     // Reset all flags
                     inGame = false;            
@@ -1744,6 +2525,7 @@ int main() {
 
                     // Reset the enemies 
                     enemies.clear();           // Clear all enemies
+                    swarm.clear();
 
                     // Reset the UI elements
                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -1756,150 +2538,23 @@ int main() {
                     inVictoryScreen = false;
                     inDefeatScreen = false;
 
-                    // Remove dead enemies safely
-                    enemies.erase(
-                        std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-                            return !enemy.isAlive();  // Remove enemies that are dead
-                            }),
-                        enemies.end()
-                    );
+                    // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+                    LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
                     // Check if player is dead
-                    if (!player.isAlive()) {
-                        std::cout << "Game Over! Player has died!" << std::endl;
+                    if (!levelStatus.playerAlive) {
+                        LOG_INFO("Game Over! Player has died!");
                         level2Started = false;
                     }
 
-                    if (enemies.empty()) {
+                    if (levelStatus.enemiesRemaining == 0) {
                         level4Won = true;  // The player has won the level
                         level4Started = false;
-                        std::cout << "Congratulations! You've defeated all enemies!" << std::endl;
-                    }
-
-                    // Draw the player box (red box)
-                    player.render(window);  // The player's red box
-
-
-                    player.renderCoins(window, coinTexture, font);
-
-
-                    // Draw the enemies
-                    for (auto& enemy : enemies) {
-                        enemy.render(window);  // Render each enemy from the enemies vector
-                    }
-
-
-                    // Update player bullets and remove out-of-bounds ones
-                    for (auto it = bullets.begin(); it != bullets.end(); ) {
-                        it->update();  // Update the bullet's position
-
-                        // Check if the bullet is off-screen (out of bounds)
-                        if (it->isOutOfBounds(width)) {
-                            it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-                        }
-                        else {
-                            ++it;  // Move to the next bullet
-                        }
-                    }
-
-                    // Update enemy bullets and remove out-of-bounds ones
-                    for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-                        it->update();  // Update the enemy bullet's position
-
-                        // Check if the bullet is off-screen (out of bounds)
-                        if (it->isOutOfBounds(width)) {
-                            it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-                        }
-                        else {
-                            ++it;  // Move to the next enemy bullet
-                        }
-                    }
-
-                    // Render the player bullets
-                    for (const auto& bullet : bullets) {
-                        window.draw(bullet.shape);
-                    }
-
-                    // Render the enemy bullets
-                    for (const auto& bullet : enemyBullets) {
-                        window.draw(bullet.shape);
-                    }
-
-
-                    // Define the starting position for the health bars and labels
-                    sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-                    // Render player health bar and label
-                    renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-                    // Adjust the vertical spacing between enemy health bars
-                    float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-                    // Render health bars for each enemy dynamically
-                    for (size_t i = 0; i < enemies.size(); ++i) {
-                        // Adjust the vertical position for each enemy's health bar
-                        renderHealthBar(window,
-                            sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-                            "Enemy " + std::to_string(i + 1),
-                            enemies[i].getHealth(),
-                            50);
-                    }
-
-                    // Handle player and enemy updates here (movement, collision detection, etc.)
-
-
-
-                    player.updateMovement();
-                    player.updateShooting(bullets);  // This handles shooting and firing cooldown
-
-
-
-
-
-                    // Check for collisions between enemy bullets and player
-                    for (auto& bullet : enemyBullets) {
-                        if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-                            player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-                            bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-                        }
-                    }
-
-                    // Check for collisions between player bullets and enemies
-                    for (auto& bullet : bullets) {
-                        // If the bullet is fired by the player and hits an enemy
-                        for (auto& enemy : enemies) {
-                            if (bullet.checkCollision(enemy.shape)) {
-                                enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                                bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                                break;  // Exit the inner loop as the bullet has already hit an enemy
-                            }
-                        }
+                        LOG_INFO("Congratulations! You've defeated all enemies!");
                     }
 
-                    for (auto it = enemies.begin(); it != enemies.end(); ) {
-                        if (!it->isAlive()) {
-                            player.addCoin();  // Add 1 coin when an enemy is destroyed
-                            it = enemies.erase(it);  // Remove enemy from the list
-                        }
-                        else {
-                            ++it;
-                        }
-                    }
-
-
-
-
-                    // Reset coins if the player dies
-                    if (!player.isAlive()) {
-                        player.resetCoins();  // Reset the coin count on player death
-                    }
-
-                    // Move each enemy towards the player
-                    for (auto& enemy : enemies) {
-                        enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-                        enemy.shootAtPlayer(player.getPosition(), enemyBullets);
-                    }
+                    // Update the player, enemies and bullets and draw the world for this frame
+                    levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
 
                 }
                 else if (!level4Started && level4Won == true) {
@@ -1910,7 +2565,7 @@ int main() {
                         backButton.render(window);
 
                         if (backButton.isClicked(window)) {
-                            std::cout << "Back to Main Menu button clicked!" << std::endl;
+                            LOG_INFO("Back to Main Menu button clicked!");
 
                             // Reset all flags
                             inGame = false;            
@@ -1926,6 +2581,7 @@ int main() {
 
                             // Reset the enemies 
                             enemies.clear();           // Clear all enemies
+                            swarm.clear();
 
                             // Reset the UI elements
                             renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -1938,7 +2594,7 @@ int main() {
                         backButton.render(window);
 
                         if (backButton.isClicked(window)) {
-                            std::cout << "Back to Main Menu button clicked!" << std::endl;
+                            LOG_INFO("Back to Main Menu button clicked!");
 
                             // Reset all flags
                             inGame = false;            
@@ -1954,6 +2610,7 @@ int main() {
 
                             // Reset the enemies 
                             enemies.clear();     // Clear all enemies
+                            swarm.clear();
 
                             // Reset the UI elements
                             renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -1965,150 +2622,23 @@ int main() {
                             inVictoryScreen = false;
                             inDefeatScreen = false;
 
-                            // Remove dead enemies safely
-                            enemies.erase(
-                                std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-                                    return !enemy.isAlive();  // Remove enemies that are dead
-                                    }),
-                                enemies.end()
-                            );
+                            // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+                            LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
                             // Check if player is dead
-                            if (!player.isAlive()) {
-                                std::cout << "Game Over! Player has died!" << std::endl;
+                            if (!levelStatus.playerAlive) {
+                                LOG_INFO("Game Over! Player has died!");
                                 level5Started = false;
                             }
 
-                            if (enemies.empty()) {
+                            if (levelStatus.enemiesRemaining == 0) {
                                 level5Won = true;  // The player has won the level
                                 level5Started = false;
-                                std::cout << "Congratulations! You've defeated all enemies!" << std::endl;
-                            }
-
-                            // Draw the player box (red box)
-                            player.render(window);  // The player's red box
-
-
-                            player.renderCoins(window, coinTexture, font);
-
-
-                            // Draw the enemies
-                            for (auto& enemy : enemies) {
-                                enemy.render(window);  // Render each enemy from the enemies vector
-                            }
-
-
-                            // Update player bullets and remove out-of-bounds ones
-                            for (auto it = bullets.begin(); it != bullets.end(); ) {
-                                it->update();  // Update the bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next bullet
-                                }
-                            }
-
-                            // Update enemy bullets and remove out-of-bounds ones
-                            for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-                                it->update();  // Update the enemy bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next enemy bullet
-                                }
-                            }
-
-                            // Render the player bullets
-                            for (const auto& bullet : bullets) {
-                                window.draw(bullet.shape);
-                            }
-
-                            // Render the enemy bullets
-                            for (const auto& bullet : enemyBullets) {
-                                window.draw(bullet.shape);
-                            }
-
-
-                            // Define the starting position for the health bars and labels
-                            sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-                            // Render player health bar and label
-                            renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-                            // Adjust the vertical spacing between enemy health bars
-                            float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-                            // Render health bars for each enemy dynamically
-                            for (size_t i = 0; i < enemies.size(); ++i) {
-                                // Adjust the vertical position for each enemy's health bar
-                                renderHealthBar(window,
-                                    sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-                                    "Enemy " + std::to_string(i + 1),
-                                    enemies[i].getHealth(),
-                                    50);
-                            }
-
-                            // Handle player and enemy updates here (movement, collision detection, etc.)
-
-
-
-                            player.updateMovement();
-                            player.updateShooting(bullets);  // This handles shooting and firing cooldown
-
-
-
-
-
-                            // Check for collisions between enemy bullets and player
-                            for (auto& bullet : enemyBullets) {
-                                if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-                                    player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-                                    bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-                                }
-                            }
-
-                            // Check for collisions between player bullets and enemies
-                            for (auto& bullet : bullets) {
-                                // If the bullet is fired by the player and hits an enemy
-                                for (auto& enemy : enemies) {
-                                    if (bullet.checkCollision(enemy.shape)) {
-                                        enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                                        bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                                        break;  // Exit the inner loop as the bullet has already hit an enemy
-                                    }
-                                }
-                            }
-
-                            for (auto it = enemies.begin(); it != enemies.end(); ) {
-                                if (!it->isAlive()) {
-                                    player.addCoin();  // Add 1 coin when an enemy is destroyed
-                                    it = enemies.erase(it);  // Remove enemy from the list
-                                }
-                                else {
-                                    ++it;
-                                }
+                                LOG_INFO("Congratulations! You've defeated all enemies!");
                             }
 
-
-
-
-                            // Reset coins if the player dies
-                            if (!player.isAlive()) {
-                                player.resetCoins();  // Reset the coin count on player death
-                            }
-
-                            // Move each enemy towards the player
-                            for (auto& enemy : enemies) {
-                                enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-                                enemy.shootAtPlayer(player.getPosition(), enemyBullets);
-                            }
+                            // Update the player, enemies and bullets and draw the world for this frame
+                            levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
 
                         }
                         else if (!level5Started && level5Won == true) {
@@ -2119,7 +2649,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;            
@@ -2133,194 +2663,69 @@ int main() {
                                     level5Won = false;          // Reset the win flag
                                     player.reset();            // Reset the player 
 
-                                    // Reset the enemies
-                                    enemies.clear();           // Clear all enemies
-
-                                    // Reset the UI elements
-                                    renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
-                                }
-                            }
-                        }
-                        else if (!level5Started && !player.isAlive()) {
-
-                            inDefeatScreen = true;
-                            displayGameOverScreen(window);
-                            backButton.render(window);
-
-                            if (backButton.isClicked(window)) {
-                                std::cout << "Back to Main Menu button clicked!" << std::endl;
-
-                                // Reset all flags
-                                inGame = false;            
-                                inVictoryScreen = false;   
-                                inGameMenu = false;        
-                                inSettingsMenu = false;    
-                                inGarageMenu = false;      
-
-                                // Reset level flags
-                                level5Started = false;     
-                                level5Won = false;          
-                                player.reset();            
-
-                                // Reset the enemies 
-                                enemies.clear();           // Clear all enemies
-
-                                // Reset the UI elements
-                                renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
-                            }
-
-                            
-                        }
-                        else if (level6Started) {
-
-                            inVictoryScreen = false;
-                            inDefeatScreen = false;
-
-                            // Remove dead enemies safely
-                            enemies.erase(
-                                std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-                                    return !enemy.isAlive();  // Remove enemies that are dead
-                                    }),
-                                enemies.end()
-                            );
-
-                            // Check if player is dead
-                            if (!player.isAlive()) {
-                                std::cout << "Game Over! Player has died!" << std::endl;
-                                level6Started = false;
-                            }
-
-                            if (enemies.empty()) {
-                                level6Won = true;  // The player has won the level
-                                level6Started = false;
-                                std::cout << "Congratulations! You've defeated all enemies!" << std::endl;
-                            }
-
-                            // Draw the player box (red box)
-                            player.render(window);  // The player's red box
-
-
-                            player.renderCoins(window, coinTexture, font);
-
-
-                            // Draw the enemies
-                            for (auto& enemy : enemies) {
-                                enemy.render(window);  // Render each enemy from the enemies vector
-                            }
-
-
-                            // Update player bullets and remove out-of-bounds ones
-                            for (auto it = bullets.begin(); it != bullets.end(); ) {
-                                it->update();  // Update the bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next bullet
-                                }
-                            }
-
-                            // Update enemy bullets and remove out-of-bounds ones
-                            for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-                                it->update();  // Update the enemy bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next enemy bullet
-                                }
-                            }
-
-                            // Render the player bullets
-                            for (const auto& bullet : bullets) {
-                                window.draw(bullet.shape);
-                            }
-
-                            // Render the enemy bullets
-                            for (const auto& bullet : enemyBullets) {
-                                window.draw(bullet.shape);
-                            }
-
-
-                            // Define the starting position for the health bars and labels
-                            sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-                            // Render player health bar and label
-                            renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-                            // Adjust the vertical spacing between enemy health bars
-                            float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-                            // Render health bars for each enemy dynamically
-                            for (size_t i = 0; i < enemies.size(); ++i) {
-                                // Adjust the vertical position for each enemy's health bar
-                                renderHealthBar(window,
-                                    sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-                                    "Enemy " + std::to_string(i + 1),
-                                    enemies[i].getHealth(),
-                                    50);
-                            }
-
-                            // Handle player and enemy updates here (movement, collision detection, etc.)
-
-
-
-                            player.updateMovement();
-                            player.updateShooting(bullets);  // This handles shooting and firing cooldown
+                                    // Reset the enemies
+                                    enemies.clear();           // Clear all enemies
+                                    swarm.clear();
 
+                                    // Reset the UI elements
+                                    renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
+                                }
+                            }
+                        }
+                        else if (!level5Started && !player.isAlive()) {
 
+                            inDefeatScreen = true;
+                            displayGameOverScreen(window);
+                            backButton.render(window);
 
+                            if (backButton.isClicked(window)) {
+                                LOG_INFO("Back to Main Menu button clicked!");
 
+                                // Reset all flags
+                                inGame = false;            
+                                inVictoryScreen = false;   
+                                inGameMenu = false;        
+                                inSettingsMenu = false;    
+                                inGarageMenu = false;      
 
-                            // Check for collisions between enemy bullets and player
-                            for (auto& bullet : enemyBullets) {
-                                if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-                                    player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-                                    bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-                                }
-                            }
+                                // Reset level flags
+                                level5Started = false;     
+                                level5Won = false;          
+                                player.reset();            
 
-                            // Check for collisions between player bullets and enemies
-                            for (auto& bullet : bullets) {
-                                // If the bullet is fired by the player and hits an enemy
-                                for (auto& enemy : enemies) {
-                                    if (bullet.checkCollision(enemy.shape)) {
-                                        enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                                        bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                                        break;  // Exit the inner loop as the bullet has already hit an enemy
-                                    }
-                                }
-                            }
+                                // Reset the enemies 
+                                enemies.clear();           // Clear all enemies
+                                swarm.clear();
 
-                            for (auto it = enemies.begin(); it != enemies.end(); ) {
-                                if (!it->isAlive()) {
-                                    player.addCoin();  // Add 1 coin when an enemy is destroyed
-                                    it = enemies.erase(it);  // Remove enemy from the list
-                                }
-                                else {
-                                    ++it;
-                                }
+                                // Reset the UI elements
+                                renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
                             }
 
+                            
+                        }
+                        else if (level6Started) {
 
+                            inVictoryScreen = false;
+                            inDefeatScreen = false;
 
+                            // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+                            LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
-                            // Reset coins if the player dies
-                            if (!player.isAlive()) {
-                                player.resetCoins();  // Reset the coin count on player death
+                            // Check if player is dead
+                            if (!levelStatus.playerAlive) {
+                                LOG_INFO("Game Over! Player has died!");
+                                level6Started = false;
                             }
 
-                            // Move each enemy towards the player
-                            for (auto& enemy : enemies) {
-                                enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-                                enemy.shootAtPlayer(player.getPosition(), enemyBullets);
+                            if (levelStatus.enemiesRemaining == 0) {
+                                level6Won = true;  // The player has won the level
+                                level6Started = false;
+                                LOG_INFO("Congratulations! You've defeated all enemies!");
                             }
 
+                            // Update the player, enemies and bullets and draw the world for this frame
+                            levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
+
                             }
                         else if (!level6Started && level6Won == true) {
                             {
@@ -2330,7 +2735,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;            
@@ -2346,6 +2751,7 @@ int main() {
 
                                     // Reset the enemies
                                     enemies.clear();   // Clear all enemies
+                                    swarm.clear();
 
                                     // Reset the UI elements
                                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -2359,7 +2765,7 @@ int main() {
                             backButton.render(window);
 
                             if (backButton.isClicked(window)) {
-                                std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                LOG_INFO("Back to Main Menu button clicked!");
 
                                 // Reset all flags
                                 inGame = false;            
@@ -2375,6 +2781,7 @@ int main() {
 
                                 // Reset the enemies (if needed)
                                 enemies.clear();           // Clear all enemies
+                                swarm.clear();
 
                                 // Reset the UI elements
                                 renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -2386,150 +2793,23 @@ int main() {
                             inVictoryScreen = false;
                             inDefeatScreen = false;
 
-                            // Remove dead enemies safely
-                            enemies.erase(
-                                std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-                                    return !enemy.isAlive();  // Remove enemies that are dead
-                                    }),
-                                enemies.end()
-                            );
+                            // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+                            LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
                             // Check if player is dead
-                            if (!player.isAlive()) {
-                                std::cout << "Game Over! Player has died!" << std::endl;
+                            if (!levelStatus.playerAlive) {
+                                LOG_INFO("Game Over! Player has died!");
                                 level7Started = false;
                             }
 
-                            if (enemies.empty()) {
+                            if (levelStatus.enemiesRemaining == 0) {
                                 level7Won = true;  // The player has won the level
                                 level7Started = false;
-                                std::cout << "Congratulations! You've defeated all enemies!" << std::endl;
-                            }
-
-                            // Draw the player box (red box)
-                            player.render(window);  // The player's red box
-
-
-                            player.renderCoins(window, coinTexture, font);
-
-
-                            // Draw the enemies
-                            for (auto& enemy : enemies) {
-                                enemy.render(window);  // Render each enemy from the enemies vector
-                            }
-
-
-                            // Update player bullets and remove out-of-bounds ones
-                            for (auto it = bullets.begin(); it != bullets.end(); ) {
-                                it->update();  // Update the bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next bullet
-                                }
-                            }
-
-                            // Update enemy bullets and remove out-of-bounds ones
-                            for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-                                it->update();  // Update the enemy bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next enemy bullet
-                                }
-                            }
-
-                            // Render the player bullets
-                            for (const auto& bullet : bullets) {
-                                window.draw(bullet.shape);
-                            }
-
-                            // Render the enemy bullets
-                            for (const auto& bullet : enemyBullets) {
-                                window.draw(bullet.shape);
+                                LOG_INFO("Congratulations! You've defeated all enemies!");
                             }
 
-
-                            // Define the starting position for the health bars and labels
-                            sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-                            // Render player health bar and label
-                            renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-                            // Adjust the vertical spacing between enemy health bars
-                            float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-                            // Render health bars for each enemy dynamically
-                            for (size_t i = 0; i < enemies.size(); ++i) {
-                                // Adjust the vertical position for each enemy's health bar
-                                renderHealthBar(window,
-                                    sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-                                    "Enemy " + std::to_string(i + 1),
-                                    enemies[i].getHealth(),
-                                    50);
-                            }
-
-                            // Handle player and enemy updates here (movement, collision detection, etc.)
-
-
-
-                            player.updateMovement();
-                            player.updateShooting(bullets);  // This handles shooting and firing cooldown
-
-
-
-
-
-                            // Check for collisions between enemy bullets and player
-                            for (auto& bullet : enemyBullets) {
-                                if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-                                    player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-                                    bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-                                }
-                            }
-
-                            // Check for collisions between player bullets and enemies
-                            for (auto& bullet : bullets) {
-                                // If the bullet is fired by the player and hits an enemy
-                                for (auto& enemy : enemies) {
-                                    if (bullet.checkCollision(enemy.shape)) {
-                                        enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                                        bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                                        break;  // Exit the inner loop as the bullet has already hit an enemy
-                                    }
-                                }
-                            }
-
-                            for (auto it = enemies.begin(); it != enemies.end(); ) {
-                                if (!it->isAlive()) {
-                                    player.addCoin();  // Add 1 coin when an enemy is destroyed
-                                    it = enemies.erase(it);  // Remove enemy from the list
-                                }
-                                else {
-                                    ++it;
-                                }
-                            }
-
-
-
-
-                            // Reset coins if the player dies
-                            if (!player.isAlive()) {
-                                player.resetCoins();  // Reset the coin count on player death
-                            }
-
-                            // Move each enemy towards the player
-                            for (auto& enemy : enemies) {
-                                enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-                                enemy.shootAtPlayer(player.getPosition(), enemyBullets);
-                            }
+                            // Update the player, enemies and bullets and draw the world for this frame
+                            levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
 
                             }
                         else if (!level7Started && level7Won == true) {
@@ -2540,7 +2820,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;            // Ensure the game isn't active
@@ -2556,6 +2836,7 @@ int main() {
 
                                     // Reset the enemies (if needed)
                                     enemies.clear();           // Clear all enemies
+                                    swarm.clear();
 
                                     // Reset the UI elements
                                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -2569,7 +2850,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;            // Ensure the game isn't active
@@ -2585,6 +2866,7 @@ int main() {
 
                                     // Reset the enemies (if needed)
                                     enemies.clear();           // Clear all enemies
+                                    swarm.clear();
 
                                     // Reset the UI elements
                                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -2596,150 +2878,23 @@ int main() {
                             inVictoryScreen = false;
                             inDefeatScreen = false;
 
-                            // Remove dead enemies safely
-                            enemies.erase(
-                                std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-                                    return !enemy.isAlive();  // Remove enemies that are dead
-                                    }),
-                                enemies.end()
-                            );
+                            // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+                            LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
                             // Check if player is dead
-                            if (!player.isAlive()) {
-                                std::cout << "Game Over! Player has died!" << std::endl;
+                            if (!levelStatus.playerAlive) {
+                                LOG_INFO("Game Over! Player has died!");
                                 level8Started = false;
                             }
 
-                            if (enemies.empty()) {
+                            if (levelStatus.enemiesRemaining == 0) {
                                 level8Won = true;  // The player has won the level
                                 level8Started = false;
-                                std::cout << "Congratulations! You've defeated all enemies!" << std::endl;
-                            }
-
-                            // Draw the player box (red box)
-                            player.render(window);  // The player's red box
-
-
-                            player.renderCoins(window, coinTexture, font);
-
-
-                            // Draw the enemies
-                            for (auto& enemy : enemies) {
-                                enemy.render(window);  // Render each enemy from the enemies vector
-                            }
-
-
-                            // Update player bullets and remove out-of-bounds ones
-                            for (auto it = bullets.begin(); it != bullets.end(); ) {
-                                it->update();  // Update the bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next bullet
-                                }
-                            }
-
-                            // Update enemy bullets and remove out-of-bounds ones
-                            for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-                                it->update();  // Update the enemy bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next enemy bullet
-                                }
-                            }
-
-                            // Render the player bullets
-                            for (const auto& bullet : bullets) {
-                                window.draw(bullet.shape);
-                            }
-
-                            // Render the enemy bullets
-                            for (const auto& bullet : enemyBullets) {
-                                window.draw(bullet.shape);
-                            }
-
-
-                            // Define the starting position for the health bars and labels
-                            sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-                            // Render player health bar and label
-                            renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-                            // Adjust the vertical spacing between enemy health bars
-                            float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-                            // Render health bars for each enemy dynamically
-                            for (size_t i = 0; i < enemies.size(); ++i) {
-                                // Adjust the vertical position for each enemy's health bar
-                                renderHealthBar(window,
-                                    sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-                                    "Enemy " + std::to_string(i + 1),
-                                    enemies[i].getHealth(),
-                                    50);
-                            }
-
-                            // Handle player and enemy updates here (movement, collision detection, etc.)
-
-
-
-                            player.updateMovement();
-                            player.updateShooting(bullets);  // This handles shooting and firing cooldown
-
-
-
-
-
-                            // Check for collisions between enemy bullets and player
-                            for (auto& bullet : enemyBullets) {
-                                if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-                                    player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-                                    bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-                                }
-                            }
-
-                            // Check for collisions between player bullets and enemies
-                            for (auto& bullet : bullets) {
-                                // If the bullet is fired by the player and hits an enemy
-                                for (auto& enemy : enemies) {
-                                    if (bullet.checkCollision(enemy.shape)) {
-                                        enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                                        bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                                        break;  // Exit the inner loop as the bullet has already hit an enemy
-                                    }
-                                }
-                            }
-
-                            for (auto it = enemies.begin(); it != enemies.end(); ) {
-                                if (!it->isAlive()) {
-                                    player.addCoin();  // Add 1 coin when an enemy is destroyed
-                                    it = enemies.erase(it);  // Remove enemy from the list
-                                }
-                                else {
-                                    ++it;
-                                }
-                            }
-
-
-
-
-                            // Reset coins if the player dies
-                            if (!player.isAlive()) {
-                                player.resetCoins();  // Reset the coin count on player death
+                                LOG_INFO("Congratulations! You've defeated all enemies!");
                             }
 
-                            // Move each enemy towards the player
-                            for (auto& enemy : enemies) {
-                                enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-                                enemy.shootAtPlayer(player.getPosition(), enemyBullets);
-                            }
+                            // Update the player, enemies and bullets and draw the world for this frame
+                            levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
 
                             }
                         else if (!level8Started && level8Won == true) {
@@ -2750,7 +2905,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;            // Ensure the game isn't active
@@ -2766,6 +2921,7 @@ int main() {
 
                                     // Reset the enemies (if needed)
                                     enemies.clear();           // Clear all enemies
+                                    swarm.clear();
 
                                     // Reset the UI elements
                                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -2779,7 +2935,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;            // Ensure the game isn't active
@@ -2795,6 +2951,7 @@ int main() {
 
                                     // Reset the enemies (if needed)
                                     enemies.clear();           // Clear all enemies
+                                    swarm.clear();
 
                                     // Reset the UI elements
                                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -2806,150 +2963,23 @@ int main() {
                             inVictoryScreen = false;
                             inDefeatScreen = false;
 
-                            // Remove dead enemies safely
-                            enemies.erase(
-                                std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-                                    return !enemy.isAlive();  // Remove enemies that are dead
-                                    }),
-                                enemies.end()
-                            );
+                            // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+                            LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
                             // Check if player is dead
-                            if (!player.isAlive()) {
-                                std::cout << "Game Over! Player has died!" << std::endl;
+                            if (!levelStatus.playerAlive) {
+                                LOG_INFO("Game Over! Player has died!");
                                 level6Started = false;
                             }
 
-                            if (enemies.empty()) {
+                            if (levelStatus.enemiesRemaining == 0) {
                                 level9Won = true;  // The player has won the level
                                 level9Started = false;
-                                std::cout << "Congratulations! You've defeated all enemies!" << std::endl;
-                            }
-
-                            // Draw the player box (red box)
-                            player.render(window);  // The player's red box
-
-
-                            player.renderCoins(window, coinTexture, font);
-
-
-                            // Draw the enemies
-                            for (auto& enemy : enemies) {
-                                enemy.render(window);  // Render each enemy from the enemies vector
-                            }
-
-
-                            // Update player bullets and remove out-of-bounds ones
-                            for (auto it = bullets.begin(); it != bullets.end(); ) {
-                                it->update();  // Update the bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next bullet
-                                }
-                            }
-
-                            // Update enemy bullets and remove out-of-bounds ones
-                            for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-                                it->update();  // Update the enemy bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next enemy bullet
-                                }
-                            }
-
-                            // Render the player bullets
-                            for (const auto& bullet : bullets) {
-                                window.draw(bullet.shape);
-                            }
-
-                            // Render the enemy bullets
-                            for (const auto& bullet : enemyBullets) {
-                                window.draw(bullet.shape);
-                            }
-
-
-                            // Define the starting position for the health bars and labels
-                            sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-                            // Render player health bar and label
-                            renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-                            // Adjust the vertical spacing between enemy health bars
-                            float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-                            // Render health bars for each enemy dynamically
-                            for (size_t i = 0; i < enemies.size(); ++i) {
-                                // Adjust the vertical position for each enemy's health bar
-                                renderHealthBar(window,
-                                    sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-                                    "Enemy " + std::to_string(i + 1),
-                                    enemies[i].getHealth(),
-                                    50);
-                            }
-
-                            // Handle player and enemy updates here (movement, collision detection, etc.)
-
-
-
-                            player.updateMovement();
-                            player.updateShooting(bullets);  // This handles shooting and firing cooldown
-
-
-
-
-
-                            // Check for collisions between enemy bullets and player
-                            for (auto& bullet : enemyBullets) {
-                                if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-                                    player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-                                    bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-                                }
-                            }
-
-                            // Check for collisions between player bullets and enemies
-                            for (auto& bullet : bullets) {
-                                // If the bullet is fired by the player and hits an enemy
-                                for (auto& enemy : enemies) {
-                                    if (bullet.checkCollision(enemy.shape)) {
-                                        enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                                        bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                                        break;  // Exit the inner loop as the bullet has already hit an enemy
-                                    }
-                                }
-                            }
-
-                            for (auto it = enemies.begin(); it != enemies.end(); ) {
-                                if (!it->isAlive()) {
-                                    player.addCoin();  // Add 1 coin when an enemy is destroyed
-                                    it = enemies.erase(it);  // Remove enemy from the list
-                                }
-                                else {
-                                    ++it;
-                                }
+                                LOG_INFO("Congratulations! You've defeated all enemies!");
                             }
 
-
-
-
-                            // Reset coins if the player dies
-                            if (!player.isAlive()) {
-                                player.resetCoins();  // Reset the coin count on player death
-                            }
-
-                            // Move each enemy towards the player
-                            for (auto& enemy : enemies) {
-                                enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-                                enemy.shootAtPlayer(player.getPosition(), enemyBullets);
-                            }
+                            // Update the player, enemies and bullets and draw the world for this frame
+                            levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
 
                             }
                         else if (!level9Started && level9Won == true) {
@@ -2960,7 +2990,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;            
@@ -2976,6 +3006,7 @@ int main() {
 
                                     // Reset the enemies 
                                     enemies.clear();  
+                                    swarm.clear();
 
                                     // Reset the UI elements
                                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -2989,7 +3020,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;            
@@ -3005,6 +3036,7 @@ int main() {
 
                                     // Reset the enemies 
                                     enemies.clear(); 
+                                    swarm.clear();
 
                                     // Reset the UI elements
                                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -3016,153 +3048,26 @@ int main() {
                             inVictoryScreen = false;
                             inDefeatScreen = false;
 
-                            // Remove dead enemies safely
-                            enemies.erase(
-                                std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& enemy) {
-                                    return !enemy.isAlive();  // Remove enemies that are dead
-                                    }),
-                                enemies.end()
-                            );
+                            // Check how the level is going, this comes from the newest snapshot when the simulation is on its own thread
+                            LevelStatus levelStatus = levelRunner.getStatus(player, enemies, swarm);
 
                             // Check if player is dead
-                            if (!player.isAlive()) {
-                                std::cout << "Game Over! Player has died!" << std::endl;
+                            if (!levelStatus.playerAlive) {
+                                LOG_INFO("Game Over! Player has died!");
                                 level10Started = false;
                             }
 
-                            if (enemies.empty()) {
+                            if (levelStatus.enemiesRemaining == 0) {
                                 level10Won = true;  // The player has won the level
                                 level10Started = false;
-                                std::cout << "Congratulations! You've defeated all enemies! And Won the game!" << std::endl;
-                            }
-
-                            // Draw the player box (red box)
-                            player.render(window);  // The player's red box
-
-
-                            player.renderCoins(window, coinTexture, font);
-
-
-                            // Draw the enemies
-                            for (auto& enemy : enemies) {
-                                enemy.render(window);  // Render each enemy from the enemies vector
-                            }
-
-
-                            // Update player bullets and remove out-of-bounds ones
-                            for (auto it = bullets.begin(); it != bullets.end(); ) {
-                                it->update();  // Update the bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = bullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next bullet
-                                }
-                            }
-
-                            // Update enemy bullets and remove out-of-bounds ones
-                            for (auto it = enemyBullets.begin(); it != enemyBullets.end(); ) {
-                                it->update();  // Update the enemy bullet's position
-
-                                // Check if the bullet is off-screen (out of bounds)
-                                if (it->isOutOfBounds(width)) {
-                                    it = enemyBullets.erase(it);  // Remove the bullet if it's out of bounds
-                                }
-                                else {
-                                    ++it;  // Move to the next enemy bullet
-                                }
-                            }
-
-                            // Render the player bullets
-                            for (const auto& bullet : bullets) {
-                                window.draw(bullet.shape);
-                            }
-
-                            // Render the enemy bullets
-                            for (const auto& bullet : enemyBullets) {
-                                window.draw(bullet.shape);
-                            }
-
-
-                            // Define the starting position for the health bars and labels
-                            sf::Vector2f healthBarPosition(20.f, height - 120.f);  // Starting position in bottom-left corner
-
-                            // Render player health bar and label
-                            renderHealthBar(window, healthBarPosition, "Player", player.getHealth(), 100);  // Assuming player's health is 50 out of 50
-
-                            // Adjust the vertical spacing between enemy health bars
-                            float enemyHealthBarSpacing = 60.f;  // Vertical space between each enemy's health bar
-
-                            // Render health bars for each enemy dynamically
-                            for (size_t i = 0; i < enemies.size(); ++i) {
-                                // Adjust the vertical position for each enemy's health bar
-                                renderHealthBar(window,
-                                    sf::Vector2f(healthBarPosition.x, healthBarPosition.y + (i + 1) * enemyHealthBarSpacing),
-                                    "Enemy " + std::to_string(i + 1),
-                                    enemies[i].getHealth(),
-                                    50);
-                            }
-
-                            // Handle player and enemy updates here (movement, collision detection, etc.)
-
-
-
-                            player.updateMovement();
-                            player.updateShooting(bullets);  // This handles shooting and firing cooldown
-
-
-
-
-
-                            // Check for collisions between enemy bullets and player
-                            for (auto& bullet : enemyBullets) {
-                                if (bullet.shape.getGlobalBounds().intersects(player.shape.getGlobalBounds())) {
-                                    player.takeDamage(bullet.getDamage());  // Player takes damage from enemy bullet
-                                    bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen (move off-screen)
-                                }
-                            }
-
-                            // Check for collisions between player bullets and enemies
-                            for (auto& bullet : bullets) {
-                                // If the bullet is fired by the player and hits an enemy
-                                for (auto& enemy : enemies) {
-                                    if (bullet.checkCollision(enemy.shape)) {
-                                        enemy.takeDamage(bullet.getDamage());  // Enemy takes damage from player bullet
-                                        bullet.shape.setPosition(-100.f, -100.f);  // Remove bullet from screen
-                                        break;  // Exit the inner loop as the bullet has already hit an enemy
-                                    }
-                                }
+                                LOG_INFO("Congratulations! You've defeated all enemies! And Won the game!");
                             }
 
-                            for (auto it = enemies.begin(); it != enemies.end(); ) {
-                                if (!it->isAlive()) {
-                                    player.addCoin();  // Add 1 coin when an enemy is destroyed
-                                    it = enemies.erase(it);  // Remove enemy from the list
-                                }
-                                else {
-                                    ++it;
-                                }
-                            }
-
-
-
-
-                            // Reset coins if the player dies
-                            if (!player.isAlive()) {
-                                player.resetCoins();  // Reset the coin count on player death
-                            }
-
-                            // Move each enemy towards the player
-                            for (auto& enemy : enemies) {
-                                enemy.moveTowardsPlayer(player.getPosition(), player.getSpeed(), enemies);
-
-                                enemy.shootAtPlayer(player.getPosition(), enemyBullets);
-                            }
+                            // Update the player, enemies and bullets and draw the world for this frame
+                            levelRunner.play(window, camera, tileMap, player, enemies, swarm, bullets, enemyBullets, coinTexture, font, height, deltaTime);
 
                             }
-                        else if (!level9Started && level9Won == true) {
+                        else if (!level10Started && level10Won == true) {
                             {
 
                                 inVictoryScreen = true;
@@ -3170,7 +3075,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;
@@ -3186,6 +3091,7 @@ int main() {
 
                                     // Reset the enemies 
                                     enemies.clear();
+                                    swarm.clear();
 
                                     // Reset the UI elements
                                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -3199,7 +3105,7 @@ int main() {
                                 backButton.render(window);
 
                                 if (backButton.isClicked(window)) {
-                                    std::cout << "Back to Main Menu button clicked!" << std::endl;
+                                    LOG_INFO("Back to Main Menu button clicked!");
 
                                     // Reset all flags
                                     inGame = false;
@@ -3215,6 +3121,7 @@ int main() {
 
                                     // Reset the enemies 
                                     enemies.clear();
+                                    swarm.clear();
 
                                     // Reset the UI elements
                                     renderMainMenu(window, startButton, settingsButton, garageButton, exitButton);    // Ensure the main menu is rendered
@@ -3222,7 +3129,22 @@ int main() {
 
                                 }
 
+        frameCapture.capture(window);  // Read back the finished frame before it is shown
         window.display();  // Display the window contents
+
+        // Only frames where a level is being played count towards the allocation report
+        bool levelRunning = level1Started || level2Started || level3Started || level4Started || level5Started ||
+            level6Started || level7Started || level8Started || level9Started || level10Started;
+        allocationMonitor.endFrame(levelRunning);
+
+        // Once the level has finished, bring the simulation thread's copy of it back so the menus see the final state
+        if (!levelRunning) {
+            levelRunner.stop(player, enemies, swarm, bullets, enemyBullets);
+        }
+
+        // Wait for the next frame, menus and the victory and defeat screens run at the lower rate to save power
+        framePacer.setLowPowerMode(!levelRunning);
+        framePacer.waitForNextFrame();
     }
    
     
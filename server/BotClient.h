@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoopClient.h"
+#include "PlayerInput.h"
+#include "SeededRandom.h"
+#include "TileCollision.h"
+
+#include <SFML/Network.hpp>
+#include <SFML/System/Time.hpp>
+#include <cstdint>
+#include <vector>
+
+// A co-op client with no window that plays by itself, it joins a server, flies around at random holding fire and checks the snapshots it gets back
+// It runs the same CoopClient the game does, so it predicts its own player, interpolates everything else and acknowledges each snapshot it reads
+class BotClient {
+public:
+    BotClient(std::uint32_t seed, const TileCollision& terrain)
+        : client(terrain), random(seed) {
+    }
+
+    // Method to open the bot's socket and join the server, returns false if no socket could be opened
+    bool connect(const sf::IpAddress& serverAddress, unsigned short serverPort) {
+        return client.connect(serverAddress, serverPort);
+    }
+
+    // Method to run the bot for one tick, then work out what it would draw like a real client does every frame
+    void update(sf::Time now) {
+        // Pick a new direction about once a second, always holding fire
+        if (client.isWelcomed() && now - lastTurn > sf::seconds(1.f)) {
+            lastTurn = now;
+            input = PlayerInput::unpack(static_cast<std::uint8_t>((1u << (random.next() % 4)) | 16u));
+        }
+        client.tick(input, now);
+        client.interpolate(now, entities, players);
+    }
+
+    // Method to tell the server the bot is leaving
+    void disconnect() {
+        client.disconnect();
+    }
+
+    const CoopClient& getClient() const {
+        return client;
+    }
+
+private:
+    CoopClient client;
+    SeededRandom random;
+    PlayerInput input;
+    sf::Time lastTurn;
+    std::vector<CoopEntityView> entities;
+    std::vector<CoopPlayerView> players;
+};
@@ -0,0 +1,307 @@
+#pragma once
+
+#include "CoopSession.h"
+#include "Logger.h"
+#include "NetProtocol.h"
+#include "PlayerInput.h"
+#include "TileCollision.h"
+
+#include <SFML/Network.hpp>
+#include <SFML/System/Clock.hpp>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Settings for the dedicated server, they can be changed from the command line
+struct ServerSettings {
+    sf::IpAddress address = sf::IpAddress::Any;  // Which network interface to listen on, the loopback bots only listen on localhost
+    unsigned short port = netDefaultPort;        // 0 lets the system pick a free port
+    float tickRate = 60.f;       // Simulation ticks per second for every session
+    int ticksPerSnapshot = 2;    // A snapshot is sent to every client after this many ticks
+    sf::Vector2f interestSize = sf::Vector2f(1920.f * 1.5f, 1080.f * 1.5f);  // Area around each client's player it is sent enemies and bullets in
+    std::size_t maxSessions = 64;
+    float clientTimeout = 5.f;   // Seconds without hearing from a client before it is dropped
+    float reportInterval = 10.f; // Seconds between the server's load reports, 0 turns them off
+    bool deterministic = false;  // Play every session on the deterministic simulation, the tick rate must then be deterministicTickRate
+};
+
+// Dedicated server for co-op play, it runs every session's simulation on one thread at a fixed tick rate with no window or audio,
+// takes the clients' input over a single UDP socket and sends each client snapshots of its session.
+// A client joins by saying Hello, it is put in the first session with a free slot and a new session is started when they are all full.
+// Sessions are thrown away when their last player leaves or times out.
+// Each client has its own replication encoder, so the entities it is sent are only the changes since the snapshot it last acknowledged, near its player
+class DedicatedServer {
+public:
+    DedicatedServer(const ServerSettings& settings, const TileCollision& terrain, const sf::FloatRect& worldBounds)
+        : settings(settings), terrain(terrain), worldBounds(worldBounds), quantizer(worldBounds), running(false) {
+    }
+
+    // Method to open the socket, returns false if the port can't be used
+    bool start() {
+        if (socket.bind(settings.port, settings.address) != sf::Socket::Done) {
+            LOG_ERROR("Server could not bind UDP port {}", settings.port);
+            return false;
+        }
+        socket.setBlocking(false);
+        selector.add(socket);
+        running = true;
+        LOG_INFO("Server listening on UDP port {} at {} ticks per second", socket.getLocalPort(), settings.tickRate);
+        if (settings.deterministic) {
+            LOG_INFO("Server sessions play on the deterministic simulation in lockstep");
+        }
+        return true;
+    }
+
+    // Returns the port the server is bound to, useful when it was started on port 0 and the system picked one
+    unsigned short getPort() const {
+        return socket.getLocalPort();
+    }
+
+    // Method to run the server until stop() is called, this can be called from any one thread
+    void run() {
+        const sf::Time tickLength = sf::seconds(1.f / settings.tickRate);
+        sf::Clock clock;
+        sf::Time nextTick = clock.getElapsedTime();
+        sf::Time nextReport = sf::seconds(settings.reportInterval);
+
+        while (running) {
+            // Sleep until a packet arrives or it is time for the next tick, whichever is first
+            sf::Time now = clock.getElapsedTime();
+            if (nextTick > now && selector.wait(nextTick - now)) {
+                receive(clock.getElapsedTime());
+                continue;
+            }
+
+            now = clock.getElapsedTime();
+            sf::Clock tickClock;
+            for (auto& session : sessions) {
+                session->step(tickLength.asSeconds());
+            }
+            ++tickCount;
+            if (tickCount % settings.ticksPerSnapshot == 0) {
+                sendSnapshots();
+            }
+            dropQuietClients(now);
+            tickTime += tickClock.getElapsedTime();
+
+            // If the server has fallen a long way behind it carries on from now instead of trying to catch up
+            nextTick += tickLength;
+            if (now - nextTick > tickLength * 4.f) {
+                nextTick = now;
+            }
+
+            if (settings.reportInterval > 0.f && now >= nextReport) {
+                report();
+                nextReport += sf::seconds(settings.reportInterval);
+            }
+        }
+    }
+
+    // Method to make run() return after its current tick, safe to call from another thread
+    void stop() {
+        running = false;
+    }
+
+    std::size_t getSessionCount() const {
+        return sessions.size();
+    }
+
+    std::size_t getClientCount() const {
+        return clients.size();
+    }
+
+private:
+    // A connected client, identified by the address and port its packets come from
+    struct Client {
+        sf::IpAddress address;
+        unsigned short port;
+        CoopSession* session;
+        int slot;
+        sf::Time lastHeard;
+        ReplicationEncoder encoder;
+    };
+
+    // Method to handle every packet waiting on the socket
+    void receive(sf::Time now) {
+        sf::Packet packet;
+        sf::IpAddress address;
+        unsigned short port;
+        while (socket.receive(packet, address, port) == sf::Socket::Done) {
+            sf::Uint8 type = 0;
+            if (!(packet >> type)) {
+                continue;
+            }
+            Client* client = findClient(address, port);
+            if (client != nullptr) {
+                client->lastHeard = now;
+            }
+
+            switch (static_cast<NetMessage>(type)) {
+            case NetMessage::Hello: {
+                sf::Uint16 version = 0;
+                if (packet >> version && version == netProtocolVersion) {
+                    welcome(client != nullptr ? client : addClient(address, port, now), address, port);
+                }
+                break;
+            }
+            case NetMessage::Input: {
+                sf::Uint32 acknowledged = 0;
+                sf::Uint32 newest = 0;
+                sf::Uint8 count = 0;
+                if (client == nullptr || !(packet >> acknowledged >> newest >> count) || count > netInputsPerMessage || newest < count) {
+                    break;
+                }
+                client->encoder.acknowledge(acknowledged);
+                for (sf::Uint8 i = 0; i < count; ++i) {
+                    sf::Uint8 bits = 0;
+                    if (packet >> bits) {
+                        client->session->setInput(client->slot, newest - count + 1 + i, PlayerInput::unpack(bits));
+                    }
+                }
+                break;
+            }
+            case NetMessage::Goodbye:
+                if (client != nullptr) {
+                    removeClient(client);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // Method to answer a Hello, a client that has already joined is sent its Welcome again in case the first one was lost
+    void welcome(Client* client, const sf::IpAddress& address, unsigned short port) {
+        sf::Packet reply;
+        if (client == nullptr) {
+            reply << static_cast<sf::Uint8>(NetMessage::Full);
+        }
+        else {
+            std::size_t sessionIndex = 0;
+            while (sessions[sessionIndex].get() != client->session) {
+                ++sessionIndex;
+            }
+            reply << static_cast<sf::Uint8>(NetMessage::Welcome) << static_cast<sf::Uint16>(sessionIndex)
+                << static_cast<sf::Uint8>(client->slot) << settings.tickRate
+                << worldBounds.left << worldBounds.top << worldBounds.width << worldBounds.height;
+        }
+        socket.send(reply, address, port);
+    }
+
+    // Method to put a new client in a session, returns nullptr if every session is full and no more can be started
+    Client* addClient(const sf::IpAddress& address, unsigned short port, sf::Time now) {
+        CoopSession* session = nullptr;
+        for (auto& candidate : sessions) {
+            if (candidate->hasFreeSlot()) {
+                session = candidate.get();
+                break;
+            }
+        }
+        if (session == nullptr) {
+            if (sessions.size() >= settings.maxSessions) {
+                return nullptr;
+            }
+            sessions.emplace_back(new CoopSession(terrain, worldBounds, settings.deterministic));
+            session = sessions.back().get();
+        }
+
+        clients.emplace_back();
+        Client& client = clients.back();
+        client.address = address;
+        client.port = port;
+        client.session = session;
+        client.slot = session->addPlayer();
+        client.lastHeard = now;
+        return &client;
+    }
+
+    // Method to take a client out of its session, the session is thrown away if nobody is left in it
+    void removeClient(Client* client) {
+        CoopSession* session = client->session;
+        session->removePlayer(client->slot);
+        clients.erase(clients.begin() + (client - clients.data()));
+        if (session->getPlayerCount() == 0) {
+            sessions.erase(std::remove_if(sessions.begin(), sessions.end(), [session](const std::unique_ptr<CoopSession>& candidate) {
+                return candidate.get() == session;
+                }), sessions.end());
+        }
+    }
+
+    Client* findClient(const sf::IpAddress& address, unsigned short port) {
+        for (Client& client : clients) {
+            if (client.port == port && client.address == address) {
+                return &client;
+            }
+        }
+        return nullptr;
+    }
+
+    void dropQuietClients(sf::Time now) {
+        for (std::size_t i = clients.size(); i > 0; --i) {
+            if (now - clients[i - 1].lastHeard > sf::seconds(settings.clientTimeout)) {
+                removeClient(&clients[i - 1]);
+            }
+        }
+    }
+
+    // Method to send each client a snapshot of its session, each session's snapshot is only built once
+    // and then every client in it is sent the entities around its own player as a delta from what it last acknowledged
+    void sendSnapshots() {
+        for (auto& session : sessions) {
+            session->writeSnapshot(snapshot, quantizer);
+            for (Client& client : clients) {
+                if (client.session != session.get()) {
+                    continue;
+                }
+                const CoopSession::Player& player = session->getPlayer(client.slot);
+                sf::FloatRect interest(player.x + CoopSession::Player::size / 2.f - settings.interestSize.x / 2.f,
+                    player.y + CoopSession::Player::size / 2.f - settings.interestSize.y / 2.f, settings.interestSize.x, settings.interestSize.y);
+                writer.clear();
+                client.encoder.encode(snapshot.tick, snapshot.entities, quantizer.quantizeArea(interest), quantizer, NetSnapshot::entityByteBudget, writer);
+                writer.flush();
+
+                packet.clear();
+                packet << static_cast<sf::Uint8>(NetMessage::Snapshot);
+                snapshot.write(packet);
+                writeEntityDelta(packet, writer);
+                socket.send(packet, client.address, client.port);
+                sentBytes += packet.getDataSize();
+                ++sentSnapshots;
+            }
+        }
+    }
+
+    void report() {
+        double averageTick = tickCount > reportedTicks ? tickTime.asMicroseconds() / 1000.0 / (tickCount - reportedTicks) : 0.0;
+        double averageSnapshot = sentSnapshots > 0 ? static_cast<double>(sentBytes) / sentSnapshots : 0.0;
+        LOG_INFO("Server: {} sessions, {} clients, {} ms per tick for every session, {} bytes per snapshot", sessions.size(), clients.size(),
+            averageTick, averageSnapshot);
+        reportedTicks = tickCount;
+        tickTime = sf::Time::Zero;
+        sentBytes = 0;
+        sentSnapshots = 0;
+    }
+
+    ServerSettings settings;
+    const TileCollision& terrain;
+    sf::FloatRect worldBounds;
+    PositionQuantizer quantizer;
+    std::atomic<bool> running;
+
+    sf::UdpSocket socket;
+    sf::SocketSelector selector;
+    std::vector<std::unique_ptr<CoopSession>> sessions;
+    std::vector<Client> clients;
+
+    NetSnapshot snapshot;  // Reused for every session's snapshot so sending doesn't allocate once it has grown
+    BitWriter writer;
+    sf::Packet packet;
+
+    std::uint64_t tickCount = 0;
+    std::uint64_t reportedTicks = 0;
+    sf::Time tickTime;  // Time spent ticking and sending since the last report
+    std::size_t sentBytes = 0;
+    std::size_t sentSnapshots = 0;
+};
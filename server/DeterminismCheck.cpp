@@ -0,0 +1,407 @@
+#include "CoopSession.h"
+#include "DeterministicWorld.h"
+#include "SeededRandom.h"
+#include "TileCollision.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Determinism check for the fixed point simulation in DeterministicWorld.h
+// It plays a scripted co-op game, two bots flying around at random holding fire, and compares the state hash after every tick:
+//  - the game is played twice in the same process and must match on every tick,
+//  - a copy of the world taken halfway through must carry on exactly like the original, which is what a lockstep rollback relies on,
+//  - --record <file> writes the inputs and hashes of every tick to a replay file, --verify <file> plays a replay file's inputs and stops
+//    at the first tick whose hash is different. The determinism_check target records with an optimised build and verifies with an
+//    unoptimised one, so a difference between compilers or optimisation levels shows up as the tick it happened on.
+// --bench times the fixed point swarm and projectiles against the float ones (EnemySwarm and ProjectileStorage) with the same enemies and
+// bullets, and a whole DeterministicWorld against a CoopSession playing the same inputs.
+// Options: --ticks <count> (default 3600), --seed <number>, --map <directory>, --record <file>, --verify <file>, --bench,
+// --enemies <count> and --bullets <count> for the bench. The exit code is the number of checks that failed
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    const sf::IntRect worldArea(0, 0, 1920 * 3, 1080 * 2);
+
+    // Inputs for the scripted game, each bot picks a new direction about once a second and always holds fire
+    class ScriptedInputs {
+    public:
+        explicit ScriptedInputs(std::uint32_t seed) : random(seed) {
+            for (int slot = 0; slot < DeterministicWorld::maxPlayers; ++slot) {
+                current[slot] = PlayerInput::unpack(16u);
+            }
+        }
+
+        void next(PlayerInput (&inputs)[DeterministicWorld::maxPlayers]) {
+            for (int slot = 0; slot < DeterministicWorld::maxPlayers; ++slot) {
+                if (random.next() % deterministicTickRate == 0) {
+                    current[slot] = PlayerInput::unpack(static_cast<std::uint8_t>((1u << (random.next() % 4)) | 16u));
+                }
+                inputs[slot] = current[slot];
+            }
+        }
+
+    private:
+        SeededRandom random;
+        PlayerInput current[DeterministicWorld::maxPlayers];
+    };
+
+    // One tick of a recorded game
+    struct ReplayTick {
+        std::uint8_t inputs[DeterministicWorld::maxPlayers];
+        std::uint64_t hash;
+    };
+
+    // Method to play the scripted game and keep every tick's inputs and hash
+    std::vector<ReplayTick> play(const TileCollision& terrain, std::uint32_t seed, int ticks) {
+        DeterministicWorld world(terrain, worldArea);
+        for (int slot = 0; slot < DeterministicWorld::maxPlayers; ++slot) {
+            world.addPlayer();
+        }
+        ScriptedInputs script(seed);
+        std::vector<ReplayTick> replay(ticks);
+        PlayerInput inputs[DeterministicWorld::maxPlayers];
+        for (int tick = 0; tick < ticks; ++tick) {
+            script.next(inputs);
+            world.step(inputs);
+            for (int slot = 0; slot < DeterministicWorld::maxPlayers; ++slot) {
+                replay[tick].inputs[slot] = inputs[slot].pack();
+            }
+            replay[tick].hash = world.getStateHash();
+        }
+        return replay;
+    }
+
+    // Returns the first tick, counting from 1, the two games differ on, or 0 if they match all the way through
+    int firstDifference(const std::vector<ReplayTick>& a, const std::vector<ReplayTick>& b) {
+        for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) {
+            if (a[i].hash != b[i].hash) {
+                return static_cast<int>(i + 1);
+            }
+        }
+        return a.size() == b.size() ? 0 : static_cast<int>(std::min(a.size(), b.size()) + 1);
+    }
+
+    // Method to play half the game, copy the world and play the rest on the original and the copy, returns true if they stay the same
+    bool checkCopy(const TileCollision& terrain, std::uint32_t seed, int ticks) {
+        DeterministicWorld world(terrain, worldArea);
+        for (int slot = 0; slot < DeterministicWorld::maxPlayers; ++slot) {
+            world.addPlayer();
+        }
+        ScriptedInputs script(seed);
+        PlayerInput inputs[DeterministicWorld::maxPlayers];
+        for (int tick = 0; tick < ticks / 2; ++tick) {
+            script.next(inputs);
+            world.step(inputs);
+        }
+        DeterministicWorld copy = world;
+        for (int tick = ticks / 2; tick < ticks; ++tick) {
+            script.next(inputs);
+            world.step(inputs);
+            copy.step(inputs);
+            if (world.getStateHash() != copy.getStateHash()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // A replay file is a header line then one line per tick with each player's packed input and the hash after the tick, all as text
+    // so it reads the same on every platform
+    bool writeReplay(const std::string& path, std::uint32_t seed, const std::vector<ReplayTick>& replay) {
+        std::ofstream file(path);
+        if (!file) {
+            return false;
+        }
+        file << "warfare-replay 1 " << DeterministicWorld::maxPlayers << " " << seed << " " << replay.size() << "\n";
+        char line[64];
+        for (const ReplayTick& tick : replay) {
+            std::snprintf(line, sizeof(line), "%u %u %016llx\n", static_cast<unsigned>(tick.inputs[0]), static_cast<unsigned>(tick.inputs[1]),
+                static_cast<unsigned long long>(tick.hash));
+            file << line;
+        }
+        return static_cast<bool>(file);
+    }
+
+    bool readReplay(const std::string& path, std::vector<ReplayTick>& replay) {
+        std::ifstream file(path);
+        std::string magic;
+        int version = 0;
+        int players = 0;
+        std::uint32_t seed = 0;
+        std::size_t ticks = 0;
+        if (!(file >> magic >> version >> players >> seed >> ticks) || magic != "warfare-replay" || version != 1 || players != DeterministicWorld::maxPlayers) {
+            return false;
+        }
+        replay.resize(ticks);
+        for (ReplayTick& tick : replay) {
+            unsigned first = 0;
+            unsigned second = 0;
+            unsigned long long hash = 0;
+            if (!(file >> first >> second >> std::hex >> hash >> std::dec)) {
+                return false;
+            }
+            tick.inputs[0] = static_cast<std::uint8_t>(first);
+            tick.inputs[1] = static_cast<std::uint8_t>(second);
+            tick.hash = hash;
+        }
+        return true;
+    }
+
+    // Method to play a replay's inputs and return the first tick whose hash is different, or 0 if every tick matches
+    int verifyReplay(const TileCollision& terrain, const std::vector<ReplayTick>& replay) {
+        DeterministicWorld world(terrain, worldArea);
+        for (int slot = 0; slot < DeterministicWorld::maxPlayers; ++slot) {
+            world.addPlayer();
+        }
+        PlayerInput inputs[DeterministicWorld::maxPlayers];
+        for (std::size_t tick = 0; tick < replay.size(); ++tick) {
+            for (int slot = 0; slot < DeterministicWorld::maxPlayers; ++slot) {
+                inputs[slot] = PlayerInput::unpack(replay[tick].inputs[slot]);
+            }
+            world.step(inputs);
+            if (world.getStateHash() != replay[tick].hash) {
+                return static_cast<int>(tick + 1);
+            }
+        }
+        return 0;
+    }
+
+    // Method to time the float swarm and projectiles, the enemies are spread over the world and the bullets are topped back up every tick
+    // Returns the milliseconds per tick
+    double benchFloat(const TileCollision& terrain, int enemyCount, int bulletCount, int ticks) {
+        const sf::FloatRect worldBounds(worldArea);
+        const sf::FloatRect player(worldBounds.width / 2.f, worldBounds.height / 2.f, 50.f, 50.f);
+        const float deltaTime = 1.f / deterministicTickRate;
+        EnemySwarm swarm;
+        ProjectileStorage bullets;
+        FlowField flowField;
+        bullets.reserve(bulletCount * 2);
+        SeededRandom random;
+        for (int i = 0; i < enemyCount; ++i) {
+            float x = static_cast<float>(random.next() % worldArea.width);
+            float y = static_cast<float>(random.next() % worldArea.height);
+            switch (i % 10) {
+            case 0: swarm.spawn<Turret>(x, y, i * 0.1f); break;
+            case 1: swarm.spawn<Spiral>(x, y, i * 0.1f); break;
+            case 2: case 3: swarm.spawn<Strafer>(x, y, i * 0.1f); break;
+            default: swarm.spawn<Chaser>(x, y, i * 0.1f); break;
+            }
+        }
+
+        double milliseconds = 0.0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            while (bullets.size() < static_cast<std::size_t>(bulletCount)) {
+                bullets.push(static_cast<float>(random.next() % worldArea.width), static_cast<float>(random.next() % worldArea.height),
+                    0.6f, 0.8f, 400.f, 1);
+            }
+            Clock::time_point start = Clock::now();
+            bullets.update(deltaTime);
+            bullets.hitWorld(worldBounds, terrain);
+            bullets.hitTarget(player);
+            bullets.removeHit();
+            flowField.update(sf::Vector2f(player.left + 25.f, player.top + 25.f), terrain, worldBounds);
+            swarm.update(player, flowField, bullets, deltaTime);
+            milliseconds += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+        return milliseconds / ticks;
+    }
+
+    // The same as benchFloat with the fixed point swarm and projectiles, the random numbers come out the same so the worlds match
+    double benchFixed(const TileCollision& terrain, int enemyCount, int bulletCount, int ticks) {
+        const FixedRect worldBounds{ intToFixed(worldArea.left), intToFixed(worldArea.top), intToFixed(worldArea.width), intToFixed(worldArea.height) };
+        const FixedRect player{ intToFixed(worldArea.width / 2), intToFixed(worldArea.height / 2), intToFixed(50), intToFixed(50) };
+        FixedSwarm swarm;
+        FixedProjectiles bullets;
+        FlowField flowField;
+        bullets.reserve(bulletCount * 2);
+        SeededRandom random;
+        for (int i = 0; i < enemyCount; ++i) {
+            Fixed x = intToFixed(static_cast<int>(random.next() % worldArea.width));
+            Fixed y = intToFixed(static_cast<int>(random.next() % worldArea.height));
+            switch (i % 10) {
+            case 0: swarm.spawn<Turret>(x, y, i * toFixed(0.1f)); break;
+            case 1: swarm.spawn<Spiral>(x, y, i * toFixed(0.1f)); break;
+            case 2: case 3: swarm.spawn<Strafer>(x, y, i * toFixed(0.1f)); break;
+            default: swarm.spawn<Chaser>(x, y, i * toFixed(0.1f)); break;
+            }
+        }
+
+        double milliseconds = 0.0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            while (bullets.size() < static_cast<std::size_t>(bulletCount)) {
+                bullets.push(intToFixed(static_cast<int>(random.next() % worldArea.width)), intToFixed(static_cast<int>(random.next() % worldArea.height)),
+                    toFixed(0.6f), toFixed(0.8f), perTick(400.f), 1);
+            }
+            Clock::time_point start = Clock::now();
+            bullets.update();
+            bullets.hitWorld(worldBounds, terrain);
+            bullets.hitTarget(player);
+            bullets.removeHit();
+            flowField.update(sf::Vector2f(static_cast<float>(worldArea.width / 2 + 25), static_cast<float>(worldArea.height / 2 + 25)),
+                terrain, sf::FloatRect(worldArea));
+            swarm.update(player, flowField, bullets);
+            milliseconds += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+        return milliseconds / ticks;
+    }
+
+    // How long a whole game took per tick and how many enemies and bullets it had on average
+    struct GameTiming {
+        double microseconds;
+        double entities;
+    };
+
+    // Methods to time a whole CoopSession and a whole DeterministicWorld playing the scripted game
+    // The games don't play out the same, the float timers drift so shooters sometimes wait an extra tick, so the entity counts are reported too
+    GameTiming benchSession(const TileCollision& terrain, std::uint32_t seed, int ticks) {
+        CoopSession session(terrain, sf::FloatRect(worldArea));
+        for (int slot = 0; slot < CoopSession::maxPlayers; ++slot) {
+            session.addPlayer();
+        }
+        ScriptedInputs script(seed);
+        PlayerInput inputs[DeterministicWorld::maxPlayers];
+        PositionQuantizer quantizer{ sf::FloatRect(worldArea) };
+        NetSnapshot snapshot;
+        GameTiming timing = { 0.0, 0.0 };
+        for (int tick = 0; tick < ticks; ++tick) {
+            script.next(inputs);
+            for (int slot = 0; slot < CoopSession::maxPlayers; ++slot) {
+                session.setInput(slot, static_cast<std::uint32_t>(tick + 1), inputs[slot]);
+            }
+            Clock::time_point start = Clock::now();
+            session.step(1.f / deterministicTickRate);
+            timing.microseconds += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            session.writeSnapshot(snapshot, quantizer);
+            timing.entities += snapshot.entities.size();
+        }
+        timing.microseconds /= ticks;
+        timing.entities /= ticks;
+        return timing;
+    }
+
+    GameTiming benchWorld(const TileCollision& terrain, std::uint32_t seed, int ticks) {
+        DeterministicWorld world(terrain, worldArea);
+        for (int slot = 0; slot < DeterministicWorld::maxPlayers; ++slot) {
+            world.addPlayer();
+        }
+        ScriptedInputs script(seed);
+        PlayerInput inputs[DeterministicWorld::maxPlayers];
+        GameTiming timing = { 0.0, 0.0 };
+        for (int tick = 0; tick < ticks; ++tick) {
+            script.next(inputs);
+            Clock::time_point start = Clock::now();
+            world.step(inputs);
+            timing.microseconds += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            timing.entities += world.getSwarm().size() + world.getPlayerBullets().size() + world.getEnemyBullets().size();
+        }
+        timing.microseconds /= ticks;
+        timing.entities /= ticks;
+        return timing;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    int ticks = 3600;
+    std::uint32_t seed = 1;
+    std::string mapDirectory;
+    std::string recordPath;
+    std::string verifyPath;
+    bool bench = false;
+    int enemyCount = 10000;
+    int bulletCount = 50000;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--ticks" && i + 1 < argc) {
+            ticks = std::max(2, std::atoi(argv[++i]));
+        }
+        else if (argument == "--seed" && i + 1 < argc) {
+            seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--map" && i + 1 < argc) {
+            mapDirectory = argv[++i];
+        }
+        else if (argument == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (argument == "--verify" && i + 1 < argc) {
+            verifyPath = argv[++i];
+        }
+        else if (argument == "--bench") {
+            bench = true;
+        }
+        else if (argument == "--enemies" && i + 1 < argc) {
+            enemyCount = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--bullets" && i + 1 < argc) {
+            bulletCount = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+
+    // With no map the world is open, with one the enemies and bullets have terrain to go around and hit
+    TileCollision terrain;
+    if (!mapDirectory.empty()) {
+        terrain.loadAllChunks(mapDirectory, sf::FloatRect(worldArea));
+    }
+
+    int failures = 0;
+    auto check = [&failures](bool passed, const char* description) {
+        std::printf("  [%s] %s\n", passed ? "PASS" : "FAIL", description);
+        failures += passed ? 0 : 1;
+    };
+
+    if (!verifyPath.empty()) {
+        std::vector<ReplayTick> replay;
+        if (!readReplay(verifyPath, replay)) {
+            std::printf("Determinism check: could not read the replay %s\n", verifyPath.c_str());
+            return 1;
+        }
+        int difference = verifyReplay(terrain, replay);
+        if (difference > 0) {
+            std::printf("Determinism check: the replay went out of sync on tick %d of %u\n", difference, static_cast<unsigned>(replay.size()));
+        }
+        check(difference == 0, "this build played the replay to the same state on every tick");
+        return failures;
+    }
+
+    std::vector<ReplayTick> first = play(terrain, seed, ticks);
+    std::vector<ReplayTick> second = play(terrain, seed, ticks);
+    int difference = firstDifference(first, second);
+    std::printf("Determinism check: %d ticks with seed %u, final hash %016llx\n", ticks, seed, static_cast<unsigned long long>(first.back().hash));
+    if (difference > 0) {
+        std::printf("Determinism check: the second game went out of sync on tick %d\n", difference);
+    }
+    check(difference == 0, "the same inputs gave the same state on every tick");
+    check(checkCopy(terrain, seed, ticks), "a copy of the world carried on exactly like the original");
+    if (!recordPath.empty()) {
+        check(writeReplay(recordPath, seed, first), "the replay was written");
+    }
+
+    if (bench) {
+        const int benchTicks = std::min(ticks, 300);
+        double floatTick = benchFloat(terrain, enemyCount, bulletCount, benchTicks);
+        double fixedTick = benchFixed(terrain, enemyCount, bulletCount, benchTicks);
+        std::printf("Determinism bench: %d enemies and %d bullets, float %.3f ms per tick, fixed point %.3f ms per tick (%.2fx)\n",
+            enemyCount, bulletCount, floatTick, fixedTick, floatTick / fixedTick);
+        // The whole game is mostly the flow field searches both share, so it is noisy, take the fastest of a few runs of each
+        GameTiming session = benchSession(terrain, seed, ticks);
+        GameTiming world = benchWorld(terrain, seed, ticks);
+        for (int run = 1; run < 5; ++run) {
+            session.microseconds = std::min(session.microseconds, benchSession(terrain, seed, ticks).microseconds);
+            world.microseconds = std::min(world.microseconds, benchWorld(terrain, seed, ticks).microseconds);
+        }
+        std::printf("Determinism bench: whole co-op game, CoopSession %.2f us per tick with %.0f entities, DeterministicWorld %.2f us per tick "
+            "with %.0f entities including the hashing\n", session.microseconds, session.entities, world.microseconds, world.entities);
+    }
+
+    std::printf("Determinism check: %d check(s) failed\n", failures);
+    return failures;
+}
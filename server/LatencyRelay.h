@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Logger.h"
+#include "NetProtocol.h"
+#include "SeededRandom.h"
+
+#include <SFML/Network.hpp>
+#include <SFML/System/Clock.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Settings for the latency relay, they can be changed from the command line
+struct RelaySettings {
+    unsigned short listenPort = netDefaultPort + 1;  // Port clients connect to instead of the server's, 0 lets the system pick one
+    sf::IpAddress serverAddress = sf::IpAddress::LocalHost;
+    unsigned short serverPort = netDefaultPort;
+    float latency = 0.05f;  // Seconds every datagram is held for in each direction
+    float jitter = 0.f;     // Each datagram is held for up to this many seconds more or less than the latency, so they can arrive out of order
+    float loss = 0.f;       // Fraction of datagrams thrown away, from 0 to 1
+    std::uint32_t seed = 1; // Seed for the jitter and loss, so a run can be repeated
+};
+
+// UDP relay that sits between co-op clients and the dedicated server on one machine and makes the connection behave like a real one,
+// every datagram is held for the latency plus or minus some jitter and a fraction of them are dropped.
+// Each client gets its own socket towards the server, so the server still sees every client as a different address
+class LatencyRelay {
+public:
+    explicit LatencyRelay(const RelaySettings& settings)
+        : settings(settings), running(false), random(settings.seed), forwarded(0), dropped(0), buffer(sf::UdpSocket::MaxDatagramSize) {
+    }
+
+    // Method to open the socket clients connect to, returns false if the port can't be used
+    bool start() {
+        if (listener.bind(settings.listenPort) != sf::Socket::Done) {
+            LOG_ERROR("Relay could not bind UDP port {}", settings.listenPort);
+            return false;
+        }
+        listener.setBlocking(false);
+        selector.add(listener);
+        running = true;
+        LOG_INFO("Relay on UDP port {} adding {} ms latency and {} ms jitter", listener.getLocalPort(),
+            settings.latency * 1000.f, settings.jitter * 1000.f);
+        return true;
+    }
+
+    // Returns the port clients should connect to
+    unsigned short getPort() const {
+        return listener.getLocalPort();
+    }
+
+    // Method to relay datagrams until stop() is called
+    void run() {
+        while (running) {
+            // Sleep until a datagram arrives or the next held one is due, but never so long that stop() isn't noticed
+            sf::Time wait = sf::milliseconds(5);
+            if (!held.empty()) {
+                wait = std::min(wait, held.front().release - clock.getElapsedTime());
+            }
+            if (selector.wait(std::max(wait, sf::microseconds(100)))) {
+                receive();
+            }
+            release();
+        }
+    }
+
+    // Method to make run() return, safe to call from another thread
+    void stop() {
+        running = false;
+    }
+
+    std::size_t getForwardedCount() const { return forwarded; }
+    std::size_t getDroppedCount() const { return dropped; }
+
+private:
+    // A client the relay has heard from and the socket its datagrams go to the server from
+    struct Route {
+        sf::IpAddress address;
+        unsigned short port;
+        std::unique_ptr<sf::UdpSocket> upstream;
+    };
+
+    // A datagram waiting for its delay to pass
+    struct HeldDatagram {
+        sf::Time release;
+        std::size_t route;
+        bool toServer;
+        std::vector<char> data;
+    };
+
+    // Orders the held datagrams into a heap with the soonest due at the front
+    static bool dueLater(const HeldDatagram& a, const HeldDatagram& b) {
+        return a.release > b.release;
+    }
+
+    void receive() {
+        std::size_t received = 0;
+        sf::IpAddress address;
+        unsigned short port = 0;
+        while (listener.receive(buffer.data(), buffer.size(), received, address, port) == sf::Socket::Done) {
+            hold(findRoute(address, port), true, received);
+        }
+        for (std::size_t i = 0; i < routes.size(); ++i) {
+            while (routes[i].upstream->receive(buffer.data(), buffer.size(), received, address, port) == sf::Socket::Done) {
+                hold(i, false, received);
+            }
+        }
+    }
+
+    // Returns the route for a client, opening a new socket towards the server the first time the client is heard from
+    std::size_t findRoute(const sf::IpAddress& address, unsigned short port) {
+        for (std::size_t i = 0; i < routes.size(); ++i) {
+            if (routes[i].port == port && routes[i].address == address) {
+                return i;
+            }
+        }
+        Route route;
+        route.address = address;
+        route.port = port;
+        route.upstream.reset(new sf::UdpSocket());
+        route.upstream->bind(sf::Socket::AnyPort);
+        route.upstream->setBlocking(false);
+        selector.add(*route.upstream);
+        routes.push_back(std::move(route));
+        return routes.size() - 1;
+    }
+
+    // Method to hold the datagram in the buffer until its delay has passed, or drop it
+    void hold(std::size_t route, bool toServer, std::size_t size) {
+        if (random.nextUnit() < settings.loss) {
+            ++dropped;
+            return;
+        }
+        float delay = std::max(0.f, settings.latency + (random.nextUnit() * 2.f - 1.f) * settings.jitter);
+        HeldDatagram datagram;
+        datagram.release = clock.getElapsedTime() + sf::seconds(delay);
+        datagram.route = route;
+        datagram.toServer = toServer;
+        datagram.data.assign(buffer.begin(), buffer.begin() + size);
+        held.push_back(std::move(datagram));
+        std::push_heap(held.begin(), held.end(), dueLater);
+    }
+
+    // Method to send on every held datagram that is due
+    void release() {
+        sf::Time now = clock.getElapsedTime();
+        while (!held.empty() && held.front().release <= now) {
+            std::pop_heap(held.begin(), held.end(), dueLater);
+            HeldDatagram& datagram = held.back();
+            Route& route = routes[datagram.route];
+            if (datagram.toServer) {
+                route.upstream->send(datagram.data.data(), datagram.data.size(), settings.serverAddress, settings.serverPort);
+            }
+            else {
+                listener.send(datagram.data.data(), datagram.data.size(), route.address, route.port);
+            }
+            ++forwarded;
+            held.pop_back();
+        }
+    }
+
+    RelaySettings settings;
+    std::atomic<bool> running;
+    SeededRandom random;  // Only used by the relay thread
+    std::size_t forwarded;
+    std::size_t dropped;
+
+    sf::Clock clock;
+    sf::UdpSocket listener;
+    sf::SocketSelector selector;
+    std::vector<Route> routes;
+    std::vector<HeldDatagram> held;  // A heap, the next datagram due is at the front
+    std::vector<char> buffer;
+};
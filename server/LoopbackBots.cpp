@@ -0,0 +1,180 @@
+#include "BotClient.h"
+#include "DedicatedServer.h"
+#include "LatencyRelay.h"
+#include "TileCollision.h"
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loopback check for the dedicated server, it starts a server on localhost and a number of bot clients in the same process,
+// lets them play for a while and then checks that every bot joined, was paired into a co-op session, had its input used by the server
+// received snapshots at about the rate the server sends them and could decode every entity delta in them. Nothing leaves the machine.
+// With --latency, --jitter or --loss the bots connect through a LatencyRelay instead. Either way the checks also cover the client side:
+// the predicted players should only need small corrections and the interpolation should nearly always have a snapshot to move towards.
+// Options: --bots <count> (default 8), --seconds <duration> (default 5), --latency <ms>, --jitter <ms>, --loss <percent>.
+// The exit code is the number of checks that failed
+int main(int argc, char* argv[]) {
+    int botCount = 8;
+    float seconds = 5.f;
+    RelaySettings relaySettings;
+    relaySettings.listenPort = 0;
+    relaySettings.latency = 0.f;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--bots" && i + 1 < argc) {
+            botCount = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--seconds" && i + 1 < argc) {
+            seconds = std::max(1.f, static_cast<float>(std::atof(argv[++i])));
+        }
+        else if (argument == "--latency" && i + 1 < argc) {
+            relaySettings.latency = std::max(0.f, static_cast<float>(std::atof(argv[++i]))) / 1000.f;
+        }
+        else if (argument == "--jitter" && i + 1 < argc) {
+            relaySettings.jitter = std::max(0.f, static_cast<float>(std::atof(argv[++i]))) / 1000.f;
+        }
+        else if (argument == "--loss" && i + 1 < argc) {
+            relaySettings.loss = std::max(0.f, std::min(100.f, static_cast<float>(std::atof(argv[++i])))) / 100.f;
+        }
+    }
+    bool useRelay = relaySettings.latency > 0.f || relaySettings.jitter > 0.f || relaySettings.loss > 0.f;
+
+    // The server listens on localhost only, on whichever port is free, with an empty map
+    ServerSettings settings;
+    settings.address = sf::IpAddress::LocalHost;
+    settings.port = 0;
+    settings.reportInterval = 0.f;
+    settings.maxSessions = static_cast<std::size_t>((botCount + CoopSession::maxPlayers - 1) / CoopSession::maxPlayers);
+    sf::FloatRect worldBounds(0.f, 0.f, 1920.f * 3.f, 1080.f * 2.f);
+    TileCollision terrain;
+
+    DedicatedServer server(settings, terrain, worldBounds);
+    if (!server.start()) {
+        std::printf("Loopback bots: the server could not start\n");
+        return 1;
+    }
+    std::thread serverThread([&server] { server.run(); });
+
+    // The relay goes between the bots and the server when the connection is meant to be a bad one
+    relaySettings.serverPort = server.getPort();
+    LatencyRelay relay(relaySettings);
+    std::thread relayThread;
+    unsigned short botPort = server.getPort();
+    if (useRelay) {
+        if (!relay.start()) {
+            std::printf("Loopback bots: the relay could not start\n");
+            server.stop();
+            serverThread.join();
+            return 1;
+        }
+        relayThread = std::thread([&relay] { relay.run(); });
+        botPort = relay.getPort();
+    }
+
+    std::vector<std::unique_ptr<BotClient>> bots;
+    for (int i = 0; i < botCount; ++i) {
+        bots.emplace_back(new BotClient(static_cast<std::uint32_t>(i + 1), terrain));
+        if (!bots.back()->connect(sf::IpAddress::LocalHost, botPort)) {
+            std::printf("Loopback bots: bot %d could not open a socket\n", i);
+        }
+    }
+
+    // Run the bots at the server's tick rate for the time asked for
+    sf::Clock clock;
+    const sf::Time tickLength = sf::seconds(1.f / settings.tickRate);
+    sf::Time firstWelcome;
+    auto welcomed = [](const std::unique_ptr<BotClient>& bot) { return bot->getClient().isWelcomed(); };
+    while (clock.getElapsedTime() < sf::seconds(seconds)) {
+        sf::Time now = clock.getElapsedTime();
+        for (auto& bot : bots) {
+            bot->update(now);
+        }
+        if (firstWelcome == sf::Time::Zero && std::all_of(bots.begin(), bots.end(), welcomed)) {
+            firstWelcome = now;
+        }
+        sf::sleep(tickLength - (clock.getElapsedTime() - now));
+    }
+
+    // Collect the results before the bots leave
+    std::set<int> sessions;
+    std::vector<std::size_t> snapshotCounts;
+    std::size_t totalSnapshots = 0;
+    std::size_t totalBytes = 0;
+    std::size_t corrections = 0;
+    double correctionDistance = 0.0;
+    float largestCorrection = 0.f;
+    std::size_t renders = 0;
+    std::size_t underruns = 0;
+    float longestDelay = 0.f;
+    for (auto& bot : bots) {
+        const CoopClient& client = bot->getClient();
+        sessions.insert(client.getSession());
+        snapshotCounts.push_back(client.getSnapshotCount());
+        totalSnapshots += client.getSnapshotCount();
+        totalBytes += client.getReceivedBytes();
+        corrections += client.getCorrectionCount();
+        correctionDistance += client.getAverageCorrection() * client.getCorrectionCount();
+        largestCorrection = std::max(largestCorrection, client.getLargestCorrection());
+        renders += client.getRenderCount();
+        underruns += client.getUnderrunCount();
+        longestDelay = std::max(longestDelay, client.getInterpolationDelay());
+        bot->disconnect();
+    }
+
+    // Give the server a moment to handle the goodbyes, then stop it so its counts can be read safely
+    sf::sleep(sf::milliseconds(300) + sf::seconds(relaySettings.latency + relaySettings.jitter));
+    server.stop();
+    serverThread.join();
+    if (useRelay) {
+        relay.stop();
+        relayThread.join();
+    }
+
+    int failures = 0;
+    auto check = [&failures](bool passed, const char* description) {
+        std::printf("  [%s] %s\n", passed ? "PASS" : "FAIL", description);
+        failures += passed ? 0 : 1;
+    };
+    auto everyBot = [&bots](std::function<bool(const CoopClient&)> test) {
+        return std::all_of(bots.begin(), bots.end(), [&test](const std::unique_ptr<BotClient>& bot) { return test(bot->getClient()); });
+    };
+
+    double playedSeconds = (sf::seconds(seconds) - firstWelcome).asSeconds();
+    double expectedSnapshots = playedSeconds * settings.tickRate / settings.ticksPerSnapshot;
+    std::size_t fewest = *std::min_element(snapshotCounts.begin(), snapshotCounts.end());
+    std::printf("Loopback bots: %d bots for %.1f s, %u sessions, fewest snapshots %u of about %.0f, %.0f bytes received per snapshot\n", botCount, seconds,
+        static_cast<unsigned>(sessions.size()), static_cast<unsigned>(fewest), expectedSnapshots,
+        totalSnapshots > 0 ? static_cast<double>(totalBytes) / totalSnapshots : 0.0);
+    if (useRelay) {
+        std::printf("Loopback bots: through a relay adding %.0f ms +- %.0f ms each way with %.0f%% loss, it dropped %u datagrams\n",
+            relaySettings.latency * 1000.f, relaySettings.jitter * 1000.f, relaySettings.loss * 100.f, static_cast<unsigned>(relay.getDroppedCount()));
+    }
+    std::printf("Loopback bots: %u prediction corrections averaging %.2f px (largest %.1f px), %u of %u frames had nothing to interpolate to, delay up to %.0f ms\n",
+        static_cast<unsigned>(corrections), corrections > 0 ? correctionDistance / corrections : 0.0, largestCorrection,
+        static_cast<unsigned>(underruns), static_cast<unsigned>(renders), longestDelay * 1000.f);
+
+    check(everyBot([](const CoopClient& client) { return client.getFullCount() == 0; }) && firstWelcome > sf::Time::Zero, "every bot was welcomed");
+    check(sessions.size() == settings.maxSessions, "bots were paired two to a session");
+    check(fewest >= expectedSnapshots * 0.8 * (1.f - relaySettings.loss), "every bot received at least 80% of the snapshots that got through");
+    if (relaySettings.jitter == 0.f) {
+        check(everyBot([](const CoopClient& client) { return client.getOutOfOrderCount() == 0; }), "snapshots arrived in tick order");
+    }
+    check(everyBot([](const CoopClient& client) { return client.getLastAckedInput() > 0; }), "the server used every bot's input");
+    check(everyBot([](const CoopClient& client) { return client.getDecodeFailures() == 0 && client.getMostEntities() > 0; }),
+        "every bot decoded the entity deltas it was sent");
+    check(corrections == 0 || correctionDistance / corrections < 10.0, "predicted players only needed small corrections");
+    check(underruns <= renders / 20, "interpolation had a snapshot to move towards in at least 95% of frames");
+    check(server.getClientCount() == 0 && server.getSessionCount() == 0, "every client and session was cleaned up after the bots left");
+
+    std::printf("Loopback bots: %d check(s) failed\n", failures);
+    return failures;
+}
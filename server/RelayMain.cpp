@@ -0,0 +1,60 @@
+#include "LatencyRelay.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <string>
+
+// The relay being run, so Ctrl+C can ask it to stop
+static LatencyRelay* runningRelay = nullptr;
+
+static void stopRelay(int) {
+    if (runningRelay != nullptr) {
+        runningRelay->stop();
+    }
+}
+
+// Latency relay for trying co-op play over a bad connection on one machine, start the server, start this, then point the game at the relay's port
+// Options: --listen-port <port>, --server <address>, --server-port <port>, --latency <ms>, --jitter <ms>, --loss <percent> and --seed <number>
+int main(int argc, char* argv[]) {
+    RelaySettings settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--listen-port" && i + 1 < argc) {
+            settings.listenPort = static_cast<unsigned short>(std::atoi(argv[++i]));
+        }
+        else if (argument == "--server" && i + 1 < argc) {
+            settings.serverAddress = sf::IpAddress(argv[++i]);
+        }
+        else if (argument == "--server-port" && i + 1 < argc) {
+            settings.serverPort = static_cast<unsigned short>(std::atoi(argv[++i]));
+        }
+        else if (argument == "--latency" && i + 1 < argc) {
+            settings.latency = std::max(0.f, static_cast<float>(std::atof(argv[++i]))) / 1000.f;
+        }
+        else if (argument == "--jitter" && i + 1 < argc) {
+            settings.jitter = std::max(0.f, static_cast<float>(std::atof(argv[++i]))) / 1000.f;
+        }
+        else if (argument == "--loss" && i + 1 < argc) {
+            settings.loss = std::max(0.f, std::min(100.f, static_cast<float>(std::atof(argv[++i])))) / 100.f;
+        }
+        else if (argument == "--seed" && i + 1 < argc) {
+            settings.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+
+    LatencyRelay relay(settings);
+    if (!relay.start()) {
+        return 1;
+    }
+
+    runningRelay = &relay;
+    std::signal(SIGINT, stopRelay);
+    std::signal(SIGTERM, stopRelay);
+    relay.run();
+    runningRelay = nullptr;
+
+    LOG_INFO("Relay stopped after forwarding {} datagrams and dropping {}", relay.getForwardedCount(), relay.getDroppedCount());
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include "NetReplication.h"
+#include "SeededRandom.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Benchmark for the snapshot replication, it runs a made up world of moving enemies and bullets through a ReplicationEncoder and straight into
+// a ReplicationDecoder (an in process loopback, so the numbers are the encoding and not the network) and reports the bytes per tick
+// and the time to encode and decode at 1k, 10k and 50k entities. Every decoded snapshot is checked against what was encoded.
+// Each size is run twice, once sending the whole world and once with the interest area the dedicated server uses around a moving player.
+// Acknowledgements reach the encoder a few ticks late, like they would over a real connection.
+// Options: --ticks <count> (default 300), --entities <count> to run a single size. The exit code is the number of snapshots that didn't match
+
+namespace {
+
+    // A made up entity, a quarter are enemies drifting around the world and the rest are bullets that fly straight until they leave it
+    struct BenchEntity {
+        std::uint32_t id;
+        std::uint8_t kind;
+        float x;
+        float y;
+        float velocityX;
+        float velocityY;
+    };
+
+    struct BenchResult {
+        double bytesPerTick = 0.0;
+        double fullBytes = 0.0;   // Size of a snapshot with nothing acknowledged, everything sent as new
+        double encodeMicroseconds = 0.0;
+        double decodeMicroseconds = 0.0;
+        double entitiesSent = 0.0;
+        int mismatches = 0;
+    };
+
+    class BenchWorld {
+    public:
+        BenchWorld(std::size_t count, const sf::FloatRect& bounds) : bounds(bounds), random(12345u), nextId(1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                entities.push_back(makeEntity(i % 4 == 0));
+            }
+        }
+
+        // Method to move everything for one tick, bullets that leave the world are replaced with new ones so there is always some churn
+        void update(float deltaTime) {
+            for (BenchEntity& entity : entities) {
+                entity.x += entity.velocityX * deltaTime;
+                entity.y += entity.velocityY * deltaTime;
+                bool isEnemy = entity.kind < 5;
+                if (isEnemy) {
+                    if (entity.x < bounds.left || entity.x > bounds.left + bounds.width) entity.velocityX = -entity.velocityX;
+                    if (entity.y < bounds.top || entity.y > bounds.top + bounds.height) entity.velocityY = -entity.velocityY;
+                }
+            }
+            std::size_t removed = 0;
+            entities.erase(std::remove_if(entities.begin(), entities.end(), [this, &removed](const BenchEntity& entity) {
+                bool gone = entity.kind >= 5 && !bounds.contains(entity.x, entity.y);
+                removed += gone ? 1 : 0;
+                return gone;
+                }), entities.end());
+            for (std::size_t i = 0; i < removed; ++i) {
+                entities.push_back(makeEntity(false));
+            }
+        }
+
+        // Method to quantize the world into the list the encoder takes, ids only ever grow so it is already sorted
+        void quantize(const PositionQuantizer& quantizer, std::vector<ReplicatedEntity>& out) const {
+            out.clear();
+            for (const BenchEntity& entity : entities) {
+                out.push_back({ entity.id, entity.kind, quantizer.quantizeX(entity.x), quantizer.quantizeY(entity.y) });
+            }
+        }
+
+    private:
+        BenchEntity makeEntity(bool enemy) {
+            BenchEntity entity;
+            entity.id = nextId++;
+            entity.kind = static_cast<std::uint8_t>(enemy ? next() % 5 : 5 + next() % 2);
+            entity.x = bounds.left + (next() % 10000) / 10000.f * bounds.width;
+            entity.y = bounds.top + (next() % 10000) / 10000.f * bounds.height;
+            float angle = (next() % 6283) / 1000.f;
+            // A fifth of the enemies sit still like turrets, the rest drift slowly. Bullets fly at 300 to 1200 pixels per second
+            float speed = enemy ? (next() % 5 == 0 ? 0.f : 50.f + next() % 200) : 300.f + next() % 900;
+            entity.velocityX = std::cos(angle) * speed;
+            entity.velocityY = std::sin(angle) * speed;
+            return entity;
+        }
+
+        std::uint32_t next() {
+            return random.next();
+        }
+
+        sf::FloatRect bounds;
+        SeededRandom random;
+        std::uint32_t nextId;
+        std::vector<BenchEntity> entities;
+    };
+
+    BenchResult run(std::size_t count, int ticks, bool useInterest) {
+        typedef std::chrono::steady_clock Clock;
+        const sf::FloatRect worldBounds(0.f, 0.f, 1920.f * 3.f, 1080.f * 2.f);
+        const sf::Vector2f interestSize(1920.f * 1.5f, 1080.f * 1.5f);
+        const float deltaTime = 1.f / 60.f;
+        const int acknowledgementDelay = 3;  // Ticks before the encoder hears the client has a snapshot, about 50 ms round trip at 60 Hz
+        const int warmUpTicks = 10;
+
+        PositionQuantizer quantizer(worldBounds);
+        BenchWorld world(count, worldBounds);
+        ReplicationEncoder encoder;
+        ReplicationDecoder decoder;
+        BitWriter writer;
+        std::vector<ReplicatedEntity> current;
+        std::vector<ReplicatedEntity> decoded;
+        std::vector<ReplicatedEntity> expected;
+        std::deque<std::uint32_t> acknowledgements;
+        BenchResult result;
+
+        // The player the interest area follows flies a slow circle around the middle of the world
+        for (int tick = 1; tick <= ticks + warmUpTicks; ++tick) {
+            world.update(deltaTime);
+            world.quantize(quantizer, current);
+
+            float angle = tick * deltaTime * 0.5f;
+            sf::Vector2f player(worldBounds.width / 2.f + std::cos(angle) * 1500.f, worldBounds.height / 2.f + std::sin(angle) * 500.f);
+            InterestArea area = useInterest
+                ? quantizer.quantizeArea(sf::FloatRect(player.x - interestSize.x / 2.f, player.y - interestSize.y / 2.f, interestSize.x, interestSize.y))
+                : quantizer.everywhere();
+
+            writer.clear();
+            Clock::time_point encodeStart = Clock::now();
+            encoder.encode(static_cast<std::uint32_t>(tick), current, area, quantizer, 0, writer);
+            writer.flush();
+            Clock::time_point encodeEnd = Clock::now();
+
+            BitReader reader(writer.getBytes().data(), writer.getBytes().size());
+            Clock::time_point decodeStart = Clock::now();
+            bool decodedOk = decoder.decode(static_cast<std::uint32_t>(tick), reader, quantizer, decoded);
+            Clock::time_point decodeEnd = Clock::now();
+
+            // With no byte budget the client ends up with exactly the entities inside its area
+            expected.clear();
+            std::copy_if(current.begin(), current.end(), std::back_inserter(expected), [&area](const ReplicatedEntity& entity) { return area.contains(entity); });
+            bool matches = decodedOk && decoded.size() == expected.size() && std::equal(decoded.begin(), decoded.end(), expected.begin(),
+                [](const ReplicatedEntity& a, const ReplicatedEntity& b) { return a.id == b.id && a.kind == b.kind && a.x == b.x && a.y == b.y; });
+            result.mismatches += matches ? 0 : 1;
+
+            if (tick == 1) {
+                result.fullBytes = static_cast<double>(writer.getBytes().size());
+            }
+            if (tick > warmUpTicks) {
+                result.bytesPerTick += writer.getBytes().size();
+                result.encodeMicroseconds += std::chrono::duration<double, std::micro>(encodeEnd - encodeStart).count();
+                result.decodeMicroseconds += std::chrono::duration<double, std::micro>(decodeEnd - decodeStart).count();
+                result.entitiesSent += expected.size();
+            }
+
+            if (decodedOk) {
+                acknowledgements.push_back(decoder.getNewestTick());
+            }
+            if (acknowledgements.size() > static_cast<std::size_t>(acknowledgementDelay)) {
+                encoder.acknowledge(acknowledgements.front());
+                acknowledgements.pop_front();
+            }
+        }
+
+        result.bytesPerTick /= ticks;
+        result.encodeMicroseconds /= ticks;
+        result.decodeMicroseconds /= ticks;
+        result.entitiesSent /= ticks;
+        return result;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    int ticks = 300;
+    std::vector<std::size_t> sizes = { 1000, 10000, 50000 };
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--ticks" && i + 1 < argc) {
+            ticks = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--entities" && i + 1 < argc) {
+            sizes = { static_cast<std::size_t>(std::max(1, std::atoi(argv[++i]))) };
+        }
+    }
+
+    // A snapshot of plain sf::Packet fields would be a 32 bit id, an 8 bit kind and two 16 bit positions for every entity
+    const double packetBytesPerEntity = 4 + 1 + 2 + 2;
+
+    int mismatches = 0;
+    std::printf("%9s %9s %10s %12s %12s %12s %11s %11s\n", "entities", "area", "sent", "bytes/tick", "full bytes", "packet bytes", "encode us", "decode us");
+    for (std::size_t count : sizes) {
+        for (int interest = 0; interest < 2; ++interest) {
+            BenchResult result = run(count, ticks, interest == 1);
+            std::printf("%9u %9s %10.0f %12.0f %12.0f %12.0f %11.1f %11.1f\n", static_cast<unsigned>(count), interest ? "interest" : "world",
+                result.entitiesSent, result.bytesPerTick, result.fullBytes, result.entitiesSent * packetBytesPerEntity,
+                result.encodeMicroseconds, result.decodeMicroseconds);
+            mismatches += result.mismatches;
+        }
+    }
+    std::printf("Replication bench: %d snapshot(s) decoded differently to what was encoded\n", mismatches);
+    return mismatches;
+}
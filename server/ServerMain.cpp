@@ -0,0 +1,75 @@
+#include "DedicatedServer.h"
+#include "Logger.h"
+#include "TileCollision.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <string>
+
+// The server being run, so Ctrl+C can ask it to stop
+static DedicatedServer* runningServer = nullptr;
+
+static void stopServer(int) {
+    if (runningServer != nullptr) {
+        runningServer->stop();
+    }
+}
+
+// Dedicated co-op server, it has no window and no audio so it can run on a machine without a display or sound card
+// Options: --port <port>, --tick-rate <ticks per second>, --snapshot-every <ticks>, --max-sessions <count>, --map <directory>
+// and --deterministic, which plays the sessions on the fixed point simulation in lockstep (see DeterministicWorld.h)
+int main(int argc, char* argv[]) {
+    ServerSettings settings;
+
+    // The map the sessions collide with, the same chunk files the game streams
+    // IMPORTANT NOTE: like the game's assets this is an absolute directory by default, pass --map or replace my username with your own
+    std::string mapDirectory = "C:/Users/kwood/source/Repos/3rdYEAR_GAME/practical_1/maps/sky/";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--port" && i + 1 < argc) {
+            settings.port = static_cast<unsigned short>(std::atoi(argv[++i]));
+        }
+        else if (argument == "--tick-rate" && i + 1 < argc) {
+            settings.tickRate = std::max(1.f, static_cast<float>(std::atof(argv[++i])));
+        }
+        else if (argument == "--snapshot-every" && i + 1 < argc) {
+            settings.ticksPerSnapshot = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--max-sessions" && i + 1 < argc) {
+            settings.maxSessions = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (argument == "--map" && i + 1 < argc) {
+            mapDirectory = argv[++i];
+        }
+        else if (argument == "--deterministic") {
+            settings.deterministic = true;
+        }
+    }
+
+    // The deterministic simulation counts its timers in ticks of a fixed length, so it can only be stepped at its own rate
+    if (settings.deterministic && settings.tickRate != static_cast<float>(deterministicTickRate)) {
+        LOG_WARNING("The deterministic simulation runs at {} ticks per second, ignoring --tick-rate {}", deterministicTickRate, settings.tickRate);
+        settings.tickRate = static_cast<float>(deterministicTickRate);
+    }
+
+    // The same world as the game, the whole map is loaded up front and shared by every session
+    sf::FloatRect worldBounds(0.f, 0.f, 1920.f * 3.f, 1080.f * 2.f);
+    TileCollision terrain;
+    terrain.loadAllChunks(mapDirectory, worldBounds);
+
+    DedicatedServer server(settings, terrain, worldBounds);
+    if (!server.start()) {
+        return 1;
+    }
+
+    runningServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    server.run();
+    runningServer = nullptr;
+
+    LOG_INFO("Server stopped");
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "SpriteAtlas.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Atlas builder, packs every sprite in a sprite manifest onto atlas pages and writes the pages and the table of regions
+// the game loads (see SpriteAtlas.h). The build runs this whenever the manifest or one of the sprites changes.
+// Usage: AtlasBuilder <manifest> <output directory> [--page-size <pixels>] (default 1024)
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::printf("Usage: AtlasBuilder <manifest> <output directory> [--page-size <pixels>]\n");
+        return 1;
+    }
+    std::string manifest = argv[1];
+    std::string output = argv[2];
+    if (output.back() != '/' && output.back() != '\\') {
+        output += '/';
+    }
+    int pageSize = 1024;
+    for (int i = 3; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--page-size" && i + 1 < argc) {
+            pageSize = std::max(16, std::atoi(argv[++i]));
+        }
+    }
+
+    AtlasPacker packer(pageSize);
+    std::string error;
+    if (!packer.addManifest(manifest, error) || !packer.pack(error) || !packer.save(output, error)) {
+        std::printf("Atlas builder: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::size_t area = 0;
+    std::size_t used = 0;
+    for (const sf::Image& page : packer.getPages()) {
+        area += page.getSize().x * page.getSize().y;
+    }
+    for (const auto& entry : packer.getRegions()) {
+        used += static_cast<std::size_t>(entry.second.rect.width + AtlasPacker::padding * 2) * (entry.second.rect.height + AtlasPacker::padding * 2);
+    }
+    std::printf("Atlas builder: packed %u sprites onto %u page(s) in %s, %.0f%% of the page area used\n",
+        static_cast<unsigned>(packer.getRegions().size()), static_cast<unsigned>(packer.getPages().size()), output.c_str(),
+        area > 0 ? 100.0 * used / area : 0.0);
+    return 0;
+}